@@ -1,17 +1,16 @@
 #pragma once
 
-#include "rckid/filesystem.h"
-#include "rckid/audio/mp3.h"
-#include "benchmark.h"
+#include <rckid/rckid.h>
+#include <rckid/filesystem.h>
+#include <rckid/audio/mp3.h>
 
 namespace rckid {
 
-    /** A very simple barebones MP3 decoder benchmark. 
-     
-        Results on RCKid running at normal speed are:
+    /** A very simple barebones MP3 decoder benchmark.
 
-        320kbps : 94.5%
+        Decodes the whole file as fast as possible and logs the total time, the time spent reading the SD card and decoding, and the time needed to decode one second of audio, which must stay well below 1_000_000us for the playback to keep up.
 
+        Results on RCKid running at normal speed with the old memmove compacting input buffer were:
 
         320 kbps:
 
@@ -22,103 +21,65 @@ namespace rckid {
         Bytes read: 3_230_824
 
      */
-
     class MP3DecoderBenchmark {
     public:
-        void run(Canvas<ColorRGB> & g_) {
-            measure("128kbps.mp3");
-            g_.text(0, 30) << 
-                status_ << "\n\n" << 
-                "MP3 Decodring [us]\n\n" <<
-                "Total:      " << total_ << "\n" <<
-                "SD read:    " << read_ << "\n" <<
-                "Decode:     " << decode_ << "\n" <<
-                "Frames:     " << frames_ << "\n" <<
-                "Bytes read: " << bytesRead_ << "\n" << 
-                "Error:      " << error_;
-        }
 
-        void measure(char const * filepath) {
-            frames_ = 0;
+        void run(char const * path = "/files/music/benchmark.mp3") {
+            total_ = 0;
             read_ = 0;
-            decode_ = 0;
-            bytesRead_ = 0;
-            error_ = 0;
-            status_ = "Working...";
-            MEASURE_TIME(total_, {
-                status_ = decodeFile(filepath);
-            });
+            auto f = fs::readFile(path, fs::Drive::SD);
+            if (f == nullptr) {
+                LOG(LL_INFO, "MP3 benchmark: " << path << " not found");
+                return;
+            }
+            audio::MP3DecoderStream mp3{unique_ptr<ReadStream>{new TimedReadStream{std::move(f), read_}}, 2};
+            uint64_t samples = 0;
+            int16_t * buffer = nullptr;
+            uint32_t n = 0;
+            uint64_t start = time::uptimeUs();
+            while (true) {
+                mp3.update();
+                mp3.callback(buffer, n);
+                if (buffer == nullptr)
+                    break;
+                samples += n;
+            }
+            total_ = time::uptimeUs() - start;
+            LOG(LL_INFO, "MP3 decoding [us]");
+            LOG(LL_INFO, "Total:      " << static_cast<uint32_t>(total_));
+            LOG(LL_INFO, "SD read:    " << static_cast<uint32_t>(read_));
+            LOG(LL_INFO, "Decode:     " << static_cast<uint32_t>(total_ - read_));
+            LOG(LL_INFO, "Frames:     " << mp3.frames());
+            LOG(LL_INFO, "Errors:     " << mp3.frameErrors());
+            LOG(LL_INFO, "Bytes read: " << mp3.bytesRead());
+            if (samples > 0)
+                LOG(LL_INFO, "Per second: " << static_cast<uint32_t>(total_ * mp3.sampleRate() / samples));
         }
 
-        char const *  decodeFile(char const * filepath) {
-            namespace fs = rckid::filesystem;
-            if (!fs::mount())
-                return "Cannot mount SD card";
-            fs::FileRead f = fs::fileRead(filepath);
-            if (!f.good())
-                return "Cannot open file";
-            NewArenaScope _{};
-            MP3 mp3{& f};
-            DoubleBuffer<int16_t> out{1152 * 2};
-            MEASURE_TIME(total_, {
-                while (!mp3.eof()) {
-                    if (mp3.decodeNextFrame(out.front()) == 0)
-                        read_ += 1;
-                    ++frames_;
-                }
-            });
-            error_ = mp3.lastError();
-
-/*
-            uint8_t * buffer = new uint8_t[8192];
-            uint32_t bufSize = 0;
-            DoubleBuffer<int16_t> out{1152 * 2};
-            bool eof = false;
-            HMP3Decoder dec = MP3InitDecoder();
-
-            while (!eof/ * || bufSize > 0* /) {
-                uint32_t t;
-                MEASURE_TIME(t, {
-                    if (!eof && bufSize < 7000) {
-                        uint32_t x = f.read(buffer + bufSize, 1024);
-                        bufSize += x;
-                        bytesRead_ += x;
-                        if (x == 0)
-                            eof = true;
-                    }
-                });
-                read_ += t;
-                int32_t syncWord = MP3FindSyncWord(buffer, bufSize);
-                if (syncWord == -1 && !eof)
-                    continue;
-                uint8_t * x = buffer + syncWord;
-                int remaining = bufSize - syncWord;
-                MEASURE_TIME(t, {
-                    error_ = MP3Decode(dec, & x, & remaining, out.front(), 0);
-                });
-                decode_ += t;
-                // not enough data in the buffer, read some more
-                if (error_ == -1 && !eof)
-                    continue; 
-                if (error_)
-                    return "Error decoding MP3 file";
-                // move the remaining data in the buffer
-                memcpy(buffer, x, remaining);
-                bufSize = remaining;
-                frames_ += 1;
-            }*/
-
-            return "All OK";
-        }
+    private:
+
+        /** Wrapper around the file that measures the time spent reading it.
+         */
+        class TimedReadStream : public ReadStream {
+        public:
+            TimedReadStream(unique_ptr<RandomReadStream> in, uint64_t & elapsed): in_{std::move(in)}, time_{elapsed} {}
+
+            uint32_t read(uint8_t * buffer, uint32_t bufferSize) override {
+                uint64_t start = time::uptimeUs();
+                uint32_t result = in_->read(buffer, bufferSize);
+                time_ += time::uptimeUs() - start;
+                return result;
+            }
+
+            bool eof() const override { return in_->eof(); }
 
-        char const * status_;
-        uint32_t total_;
-        uint32_t frames_;
-        uint32_t read_;
-        uint32_t decode_;
-        uint32_t bytesRead_;
-        int error_;
-    }; 
+        private:
+            unique_ptr<RandomReadStream> in_;
+            uint64_t & time_;
+        };
 
+        uint64_t total_ = 0;
+        uint64_t read_ = 0;
+    };
 
-} // namespace rckid 
\ No newline at end of file
+} // namespace rckid
@@ -0,0 +1,338 @@
+#include <rckid/rckid.h>
+#include <rckid/graphics/bitmap.h>
+#include <rckid/graphics/transform.h>
+#include <rckid/graphics/png.h>
+#include <rckid/graphics/qoi.h>
+#include <rckid/ui/animation.h>
+#include <rckid/ui/tween.h>
+#include <rckid/audio/opus.h>
+#include <rckid/audio/adpcm.h>
+#include <rckid/audio/mixer.h>
+#include <rckid/audio/resampler.h>
+#include <rckid/audio/dsp.h>
+
+#include <libopus/include/opus.h>
+
+#include <assets/images.h>
+
+#include <benchmarks/MP3Decoder.h>
+
+using namespace rckid;
+
+/** Simple benchmarks of the graphics & audio hot paths.
+
+    Each benchmark renders (or decodes) a full 320x240 frame several times and logs the average time per frame in microseconds. The results are only logged over serial so that the display does not interfere with the measurement.
+ */
+
+static constexpr Coord WIDTH = 320;
+static constexpr Coord HEIGHT = 240;
+static constexpr uint32_t REPEATS = 10;
+
+template<typename T>
+void measure(char const * name, T fn) {
+    uint64_t start = time::uptimeUs();
+    for (uint32_t i = 0; i < REPEATS; ++i)
+        fn();
+    uint64_t t = (time::uptimeUs() - start) / REPEATS;
+    LOG(LL_INFO, name << ": " << static_cast<uint32_t>(t) << " us/frame");
+}
+
+Bitmap testBitmap(Coord w, Coord h) {
+    Bitmap bmp{w, h, Color::Representation::RGB565};
+    for (Coord x = 0; x < w; ++x)
+        for (Coord y = 0; y < h; ++y)
+            bmp.setPixel(x, y, Color::HSV(static_cast<uint16_t>(x * 8), 255, static_cast<uint8_t>(y * 255 / h)).toRGB565());
+    bmp.setTransparentColor(std::nullopt);
+    return bmp;
+}
+
+void benchmarkAffine() {
+    Bitmap bmp = testBitmap(160, 120);
+    Color::RGB565 column[HEIGHT];
+    auto frame = [&](Transform const & t, Filter filter) {
+        Transform inv = t.inverse();
+        for (Coord x = WIDTH - 1; x >= 0; --x)
+            bmp.renderColumn(x, 0, column, HEIGHT, inv, filter);
+    };
+    measure("affine 1:1", [&]() {
+        for (Coord x = WIDTH - 1; x >= 0; --x)
+            bmp.renderColumn(x % 160, 0, column, 120);
+    });
+    measure("affine translate", [&]() { frame(Transform::Translate(80, 60), Filter::Nearest); });
+    measure("affine scale 2x", [&]() { frame(Transform::Scale(2), Filter::Nearest); });
+    measure("affine scale 1.5x", [&]() { frame(Transform::Scale(1.5f), Filter::Nearest); });
+    measure("affine rotate 30 nearest", [&]() { frame(Transform::RotateScale(30, 2, Point{80, 60}), Filter::Nearest); });
+    measure("affine rotate 30 box", [&]() { frame(Transform::RotateScale(30, 2, Point{80, 60}), Filter::Box); });
+}
+
+void benchmarkQOI() {
+    // reencode the PNG logo as QOI so that we compare the same image
+    Bitmap logo{ImageSource{assets::images::logo}};
+    MemoryStream qoi = MemoryStream::withCapacity(WIDTH * HEIGHT * 2);
+    QOIEncoder::encode(logo, qoi);
+    uint32_t qoiSize = qoi.tell();
+    LOG(LL_INFO, "PNG size: " << static_cast<uint32_t>(sizeof(assets::images::logo)) << ", QOI size: " << qoiSize);
+    measure("decode PNG", [&]() {
+        PNGImageDecoder dec{ImageSource{assets::images::logo}};
+        Bitmap bmp = dec.decode();
+    });
+    qoi.seek(0);
+    unique_ptr<uint8_t> qoiData{new uint8_t[qoiSize]};
+    qoi.read(qoiData.get(), qoiSize);
+    // the decoder takes ownership of RAM buffers, so each iteration decodes a fresh copy (the memcpy is negligible)
+    auto decodeQOI = [&](Color::Representation rep) {
+        uint8_t * data = new uint8_t[qoiSize];
+        memcpy(data, qoiData.get(), qoiSize);
+        QOIImageDecoder dec{ImageSource{immutable_ptr<uint8_t>{data, qoiSize}}, rep};
+        Bitmap bmp = dec.decode();
+    };
+    measure("decode QOI (RGB565)", [&]() { decodeQOI(Color::Representation::RGB565); });
+    measure("decode QOI (Index16)", [&]() { decodeQOI(Color::Representation::Index16); });
+}
+
+/** Updates 120 simultaneous value animations per frame, first as Animation objects with callbacks, then as batched tweens.
+ */
+void benchmarkTweens() {
+    static constexpr uint32_t NUM_TWEENS = 120;
+    static constexpr uint32_t FRAMES = 1000;
+    Coord values[NUM_TWEENS];
+    auto measureFrames = [&](char const * name, auto updateAll) {
+        uint32_t start = time::uptimeUs();
+        // simulate frames 1ms apart so that the animations do not finish during the measurement
+        for (uint32_t i = 0; i < FRAMES; ++i)
+            updateAll(start + i * 1000);
+        uint32_t t = (time::uptimeUs() - start) / FRAMES;
+        LOG(LL_INFO, name << " (" << NUM_TWEENS << "): " << t << " us/frame");
+    };
+    ui::Widget owner;
+    for (uint32_t i = 0; i < NUM_TWEENS; ++i) {
+        Coord * target = values + i;
+        owner.animate() << (new ui::Animation{[target](FixedRatio progress) { *target = progress.scale(320); }, 5000})
+            ->setEasingFunction(i % 2 ? ui::easing::inOut : ui::easing::out);
+    }
+    measureFrames("animations", [](uint32_t) { ui::Animation::updateAll(); });
+    owner.cancelAnimations();
+    ui::Tweens::Handle handles[NUM_TWEENS];
+    for (uint32_t i = 0; i < NUM_TWEENS; ++i)
+        handles[i] = ui::Tweens::start(ui::Tween::Value(values + i, 0, 320, 5000).withEasing(i % 2 ? ui::Tween::Easing::InOut : ui::Tween::Easing::Out));
+    measureFrames("tweens", [](uint32_t nowUs) { ui::Tweens::updateAll(nowUs); });
+    for (uint32_t i = 0; i < NUM_TWEENS; ++i)
+        ui::Tweens::cancel(handles[i]);
+}
+
+/** Decodes the same song encoded as MP3, Opus, QOA and PCM WAV and logs the decoding time per second of audio. 
+ 
+    The files are not part of the cartridge, copy them to the SD card under /files/music/benchmark.mp3 (.opus, .qoa, .wav) before running the benchmark. Missing files are skipped. 
+ */
+void benchmarkAudio() {
+    static constexpr uint32_t MAX_SECONDS = 10;
+    LOG(LL_INFO, "Opus decoder state: " << audio::OpusDecoderStream::decoderStateSize() << " bytes");
+    auto decode = [](char const * name, char const * path) {
+        uint32_t heapBefore = Heap::usedBytes();
+        unique_ptr<audio::DecoderStream> d = audio::DecoderStream::fromFile(path, fs::Drive::SD);
+        if (d == nullptr) {
+            LOG(LL_INFO, name << ": " << path << " not found");
+            return;
+        }
+        LOG(LL_INFO, name << " heap: " << (Heap::usedBytes() - heapBefore) << " bytes");
+        uint32_t samples = 0;
+        int16_t * buffer = nullptr;
+        uint32_t n = 0;
+        uint64_t start = time::uptimeUs();
+        while (samples < d->sampleRate() * MAX_SECONDS) {
+            d->update();
+            d->callback(buffer, n);
+            if (buffer == nullptr)
+                break;
+            samples += n;
+        }
+        uint64_t t = time::uptimeUs() - start;
+        if (samples == 0)
+            return;
+        LOG(LL_INFO, name << ": " << static_cast<uint32_t>(t * d->sampleRate() / samples) << " us/s of audio");
+    };
+    decode("decode MP3", "/files/music/benchmark.mp3");
+    decode("decode Opus", "/files/music/benchmark.opus");
+    decode("decode QOA", "/files/music/benchmark.qoa");
+    decode("decode WAV", "/files/music/benchmark.wav");
+    // full decode of the MP3 file with SD read and decode times separated
+    MP3DecoderBenchmark{}.run();
+    // seek to the middle of the MP3 file, without a table of contents the first seek scans the frame headers and builds the index, the second uses it
+    unique_ptr<audio::DecoderStream> mp3 = audio::DecoderStream::fromFile("/files/music/benchmark.mp3", fs::Drive::SD);
+    if (mp3 != nullptr && mp3->seekable()) {
+        for (uint32_t i = 0; i < 2; ++i) {
+            uint64_t start = time::uptimeUs();
+            mp3->seek(mp3->durationMs() / 2);
+            LOG(LL_INFO, "seek MP3: " << static_cast<uint32_t>(time::uptimeUs() - start) << " us");
+        }
+    }
+}
+
+/** Mixes 8 looped voices at 44.1kHz, half of them at 22.05kHz so that they are resampled, and logs the mixing time per second of audio and the share of the CPU it takes.
+
+    To leave enough time for the game and the decoders of the streamed voices, the mixing should stay under 10% of the CPU.
+ */
+void benchmarkMixer() {
+    static constexpr uint32_t SAMPLE_RATE = 44100;
+    static constexpr uint32_t NUM_VOICES = 8;
+    static constexpr uint32_t LENGTH = 4410;
+    unique_ptr<int16_t> data{new int16_t[LENGTH * 2]};
+    for (uint32_t i = 0; i < LENGTH * 2; ++i)
+        data.get()[i] = static_cast<int16_t>(sinf(i * 0.05f) * 8000);
+    auto mixSecond = [&](char const * name, bool interpolation) {
+        audio::Mixer m{SAMPLE_RATE, NUM_VOICES};
+        m.setInterpolation(interpolation);
+        for (uint32_t i = 0; i < NUM_VOICES; ++i) {
+            m.play(i, audio::Sample{data.get(), LENGTH, (i % 2) ? SAMPLE_RATE / 2 : SAMPLE_RATE, i >= NUM_VOICES / 2}, true);
+            m.setPan(i, static_cast<int8_t>(i * 32 - 128));
+            m.setVolume(i, audio::Mixer::VOLUME_FULL / 2);
+        }
+        int16_t * buffer = nullptr;
+        uint32_t n = 0;
+        uint32_t samples = 0;
+        uint64_t start = time::uptimeUs();
+        while (samples < SAMPLE_RATE) {
+            m.update();
+            m.callback(buffer, n);
+            samples += n;
+        }
+        uint32_t t = static_cast<uint32_t>((time::uptimeUs() - start) * SAMPLE_RATE / samples);
+        LOG(LL_INFO, name << ": " << t << " us/s of audio (" << (t / 10000) << "% CPU)");
+    };
+    mixSecond("mix 8 voices", true);
+    mixSecond("mix 8 voices nearest", false);
+}
+
+/** Resamples 1 second of audio between the common rates and logs the time per second of output audio and channel.
+ */
+void benchmarkResampler() {
+    // source of a looped buffer so that only the resampling itself is measured
+    class LoopStream : public audio::DecoderStream {
+    public:
+        LoopStream(uint32_t sampleRate): DecoderStream{512, 2}, sampleRate_{sampleRate} {}
+        uint32_t sampleRate() const override { return sampleRate_; }
+    protected:
+        uint32_t refillSamples(int16_t * buffer, uint32_t numStereoSamples) override {
+            for (uint32_t i = 0; i < numStereoSamples * 2; ++i)
+                buffer[i] = static_cast<int16_t>((i * 7919) & 0x3fff);
+            return numStereoSamples;
+        }
+    private:
+        uint32_t sampleRate_;
+    };
+    auto resample = [](char const * name, uint32_t from, uint32_t to) {
+        audio::ResamplingStream r{unique_ptr<audio::DecoderStream>{new LoopStream{from}}, to};
+        int16_t * buffer = nullptr;
+        uint32_t n = 0;
+        uint32_t samples = 0;
+        uint64_t start = time::uptimeUs();
+        while (samples < to) {
+            r.update();
+            r.callback(buffer, n);
+            samples += n;
+        }
+        uint32_t t = static_cast<uint32_t>((time::uptimeUs() - start) * to / samples);
+        LOG(LL_INFO, name << " (" << r.taps() << " taps): " << t / 2 << " us/s per channel");
+    };
+    resample("resample 8k -> 44.1k", 8000, 44100);
+    resample("resample 32768 -> 44.1k", 32768, 44100);
+    resample("resample 44.1k -> 48k", 44100, 48000);
+    resample("resample 48k -> 44.1k", 48000, 44100);
+    resample("resample 48k -> 8k", 48000, 8000);
+}
+
+/** Processes 1 second of 44.1kHz audio by the playback DSP chain with increasing number of equalizer bands and logs the time per second of audio and the cycles per sample and channel, assuming the default 150MHz clock (PowerMode::Normal).
+ */
+void benchmarkDSP() {
+    static constexpr uint32_t SAMPLE_RATE = 44100;
+    static constexpr uint32_t BUFFER_STEREO_SAMPLES = 1152;
+    static constexpr uint32_t CPU_MHZ = 150;
+    unique_ptr<int16_t> buffer{new int16_t[BUFFER_STEREO_SAMPLES * 2]};
+    auto process = [&](char const * name, audio::DSP & dsp, int32_t gain) {
+        uint64_t t = 0;
+        uint32_t samples = 0;
+        for (; samples < SAMPLE_RATE; samples += BUFFER_STEREO_SAMPLES) {
+            // loud input so that the limiter is busy too
+            for (uint32_t i = 0; i < BUFFER_STEREO_SAMPLES * 2; ++i)
+                buffer.get()[i] = static_cast<int16_t>(static_cast<int32_t>((i * 7919) & 0x7fff) - 16384);
+            uint64_t start = time::uptimeUs();
+            dsp.process(buffer.get(), BUFFER_STEREO_SAMPLES, SAMPLE_RATE, gain);
+            t += time::uptimeUs() - start;
+        }
+        uint32_t us = static_cast<uint32_t>(t * SAMPLE_RATE / samples);
+        LOG(LL_INFO, name << ": " << us << " us/s, " << (us * CPU_MHZ / (SAMPLE_RATE * 2)) << " cycles/sample");
+    };
+    audio::DSP dsp;
+    int32_t gain = dsp.gain(audio::ReplayGain{-6.5f, std::nullopt});
+    process("dsp gain & limiter", dsp, gain);
+    dsp.setLimiter(false);
+    process("dsp gain", dsp, gain);
+    dsp.setLimiter(true);
+    dsp.setBand(0, audio::Biquad::Type::LowShelf, 250, 6);
+    process("dsp 1 band", dsp, gain);
+    dsp.setBand(1, audio::Biquad::Type::Peaking, 1000, -3, 1);
+    process("dsp 2 bands", dsp, gain);
+    dsp.setBand(2, audio::Biquad::Type::Peaking, 3000, 3, 1);
+    dsp.setBand(3, audio::Biquad::Type::HighShelf, 8000, 3);
+    process("dsp 4 bands", dsp, gain);
+}
+
+/** Encodes and decodes 1 second of 8kHz voice-like audio with IMA-ADPCM, as the recorder does, and compares the encoding with Opus in VOIP mode.
+ */
+void benchmarkRecording() {
+    static constexpr uint32_t SAMPLE_RATE = 8000;
+    unique_ptr<int16_t> pcm{new int16_t[SAMPLE_RATE]};
+    for (uint32_t i = 0; i < SAMPLE_RATE; ++i)
+        pcm.get()[i] = static_cast<int16_t>((sinf(i * 0.35f) + sinf(i * 0.11f) * 0.5f) * 8000 + (i * 7919 % 1024) - 512);
+    MemoryStream out = MemoryStream::withCapacity(8192);
+    uint32_t size = 0;
+    measure("encode ADPCM 1s", [&]() {
+        out.seek(0);
+        audio::ADPCMEncoder enc{out, SAMPLE_RATE};
+        enc.encode(pcm.get(), SAMPLE_RATE);
+        enc.finish();
+        size = out.tell();
+    });
+    LOG(LL_INFO, "ADPCM size: " << size);
+    measure("decode ADPCM 1s", [&]() {
+        out.seek(0);
+        unique_ptr<uint8_t> data{new uint8_t[size]};
+        out.read(data.get(), size);
+        audio::ADPCMDecoderStream d{unique_ptr<ReadStream>{new MemoryStream{unique_ptr<uint8_t>{data.release()}, size}}};
+        int16_t * buffer = nullptr;
+        uint32_t n = 0;
+        do {
+            d.update();
+            d.callback(buffer, n);
+        } while (buffer != nullptr);
+    });
+    int err;
+    OpusEncoder * enc = opus_encoder_create(SAMPLE_RATE, 1, OPUS_APPLICATION_VOIP, & err);
+    opus_encoder_ctl(enc, OPUS_SET_COMPLEXITY(0));
+    LOG(LL_INFO, "Opus encoder state: " << static_cast<uint32_t>(opus_encoder_get_size(1)) << " bytes");
+    uint8_t packet[256];
+    measure("encode Opus VOIP 1s", [&]() {
+        size = 0;
+        // 20ms frames
+        for (uint32_t i = 0; i < SAMPLE_RATE; i += 160)
+            size += opus_encode(enc, pcm.get() + i, 160, packet, sizeof(packet));
+    });
+    LOG(LL_INFO, "Opus size: " << size);
+    opus_encoder_destroy(enc);
+}
+
+int main() {
+    initialize();
+    LOG(LL_INFO, "Benchmarks (" << REPEATS << " repeats each)");
+    benchmarkAffine();
+    benchmarkQOI();
+    benchmarkTweens();
+    benchmarkAudio();
+    benchmarkMixer();
+    benchmarkResampler();
+    benchmarkDSP();
+    benchmarkRecording();
+    LOG(LL_INFO, "Done");
+    while (true)
+        yield();
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <fstream>
@@ -93,6 +94,39 @@ inline Glyphs getDefaultGlyphs() {
     return result;
 }
 
+/** Generates printable ASCII glyphs followed by the Latin-1 Supplement and Latin Extended-A letters (U+00C0 to U+017F), which covers Czech, Slovak, German, Polish and most other European languages using latin script. 
+ */
+inline Glyphs getLatinGlyphs() {
+    Glyphs result;
+    for (int i = 32; i < 127; ++i) {
+        result.names.push_back(STR((char)i));
+        result.codepoints.push_back(i);
+    }
+    for (int i = 0xc0; i < 0x180; ++i) {
+        result.names.push_back(STR("U+" << std::hex << i));
+        result.codepoints.push_back(i);
+    }
+    std::cout << "        generating latin glyphs (" << result.codepoints.size() << " glyphs)" << std::endl;
+    return result;
+}
+
+/** Sorts the glyphs by their codepoints and removes duplicates so that the glyphs can be described by sorted codepoint ranges. 
+ */
+inline Glyphs sortGlyphs(Glyphs const & glyphs) {
+    std::vector<size_t> order;
+    for (size_t i = 0; i < glyphs.size(); ++i)
+        order.push_back(i);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return glyphs.codepoints[a] < glyphs.codepoints[b]; });
+    Glyphs result;
+    for (size_t i : order) {
+        if (!result.codepoints.empty() && result.codepoints.back() == glyphs.codepoints[i])
+            continue;
+        result.names.push_back(glyphs.names[i]);
+        result.codepoints.push_back(glyphs.codepoints[i]);
+    }
+    return result;
+}
+
 /** Default font glyphs for tiles, where the index of the tile corresponds to the ASCII character. 
  */
 inline Glyphs getDefaultTileGlyphs () {
@@ -1,27 +1,330 @@
+#include <cmath>
 #include <filesystem>
+#include <map>
+#include <optional>
+#include <tuple>
 
 #include <platform.h>
 #include <platform/args.h>
 
 #include "assets_utils.h"
 
+/** Minimal reader of the OpenType font tables that hold the kerning.
+
+    Raylib only exposes the rasterized glyphs, so the kerning is read from the font file directly. Supports the GPOS pair adjustment lookups (both the glyph pair and class pair formats, also via extension lookups) of the kern feature, which is where current fonts keep their kerning, and the legacy kern table (format 0) for fonts without them. Only the horizontal advance adjustment of the first glyph is used, which is what kerning of horizontal text amounts to.
+ */
+class OpenTypeFont {
+public:
+
+    OpenTypeFont(std::string const & filename) {
+        std::ifstream input(filename, std::ios::binary);
+        data_.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        if (data_.size() < 12)
+            throw std::runtime_error(STR("Invalid font file " << filename));
+        for (uint32_t i = 0, e = u16(4); i < e; ++i) {
+            uint32_t record = 12 + i * 16;
+            tables_[std::string(reinterpret_cast<char const *>(data_.data() + record), 4)] = u32(record + 8);
+        }
+        cmap_ = findCmap();
+    }
+
+    /** Scale from font units to pixels for given font size, same as raylib (stb_truetype) uses when rasterizing the glyphs.
+     */
+    float scale(int fontSize) const {
+        uint32_t hhea = table("hhea");
+        return static_cast<float>(fontSize) / (s16(hhea + 4) - s16(hhea + 6));
+    }
+
+    /** Returns the glyph id of given codepoint, 0 (missing glyph) if not found.
+     */
+    uint16_t glyphId(uint32_t codepoint) const {
+        if (cmap_ == 0)
+            return 0;
+        if (u16(cmap_) == 4) {
+            uint32_t segX2 = u16(cmap_ + 6);
+            uint32_t ends = cmap_ + 14;
+            uint32_t starts = ends + segX2 + 2;
+            uint32_t deltas = starts + segX2;
+            uint32_t rangeOffsets = deltas + segX2;
+            for (uint32_t i = 0; i < segX2; i += 2) {
+                if (codepoint > u16(ends + i))
+                    continue;
+                if (codepoint < u16(starts + i))
+                    return 0;
+                uint32_t ro = u16(rangeOffsets + i);
+                if (ro == 0)
+                    return static_cast<uint16_t>(codepoint + u16(deltas + i));
+                uint16_t g = u16(rangeOffsets + i + ro + (codepoint - u16(starts + i)) * 2);
+                return g == 0 ? 0 : static_cast<uint16_t>(g + u16(deltas + i));
+            }
+        } else {
+            // format 12
+            for (uint32_t i = 0, e = u32(cmap_ + 12); i < e; ++i) {
+                uint32_t group = cmap_ + 16 + i * 12;
+                if (codepoint >= u32(group) && codepoint <= u32(group + 4))
+                    return static_cast<uint16_t>(u32(group + 8) + codepoint - u32(group));
+            }
+        }
+        return 0;
+    }
+
+    /** Returns the kerning of the glyph pair in font units.
+     */
+    int kerning(uint16_t left, uint16_t right) const {
+        std::vector<uint32_t> lookups = kernLookups();
+        if (lookups.empty())
+            return kernTable(left, right);
+        int result = 0;
+        for (uint32_t lookup : lookups) {
+            uint32_t type = u16(lookup);
+            for (uint32_t i = 0, e = u16(lookup + 4); i < e; ++i) {
+                uint32_t sub = lookup + u16(lookup + 6 + i * 2);
+                uint32_t subType = type;
+                if (type == 9) {
+                    subType = u16(sub + 2);
+                    sub += u32(sub + 4);
+                }
+                if (subType != 2)
+                    continue;
+                std::optional<int> k = pairAdjustment(sub, left, right);
+                if (k.has_value()) {
+                    result += k.value();
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+
+    uint16_t u16(uint32_t offset) const { 
+        if (offset + 2 > data_.size())
+            throw std::runtime_error("Font table out of bounds");
+        return static_cast<uint16_t>((data_[offset] << 8) | data_[offset + 1]); 
+    }
+
+    int16_t s16(uint32_t offset) const { return static_cast<int16_t>(u16(offset)); }
+
+    uint32_t u32(uint32_t offset) const { return (static_cast<uint32_t>(u16(offset)) << 16) | u16(offset + 2); }
+
+    uint32_t table(std::string const & tag) const {
+        auto i = tables_.find(tag);
+        return i == tables_.end() ? 0 : i->second;
+    }
+
+    /** Returns the offset of the unicode cmap subtable, preferring the full unicode one (format 12) over the BMP one (format 4).
+     */
+    uint32_t findCmap() const {
+        uint32_t cmap = table("cmap");
+        if (cmap == 0)
+            return 0;
+        uint32_t result = 0;
+        for (uint32_t i = 0, e = u16(cmap + 2); i < e; ++i) {
+            uint32_t record = cmap + 4 + i * 8;
+            uint16_t platform = u16(record);
+            uint16_t encoding = u16(record + 2);
+            uint32_t sub = cmap + u32(record + 4);
+            bool unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+            if (! unicode)
+                continue;
+            if (u16(sub) == 12)
+                return sub;
+            if (u16(sub) == 4)
+                result = sub;
+        }
+        return result;
+    }
+
+    /** Returns the offsets of the GPOS lookups used by the kern feature of any script.
+     */
+    std::vector<uint32_t> kernLookups() const {
+        std::vector<uint32_t> result;
+        uint32_t gpos = table("GPOS");
+        if (gpos == 0)
+            return result;
+        uint32_t features = gpos + u16(gpos + 6);
+        uint32_t lookups = gpos + u16(gpos + 8);
+        std::vector<uint16_t> indices;
+        for (uint32_t i = 0, e = u16(features); i < e; ++i) {
+            uint32_t record = features + 2 + i * 6;
+            if (std::string(reinterpret_cast<char const *>(data_.data() + record), 4) != "kern")
+                continue;
+            uint32_t feature = features + u16(record + 4);
+            for (uint32_t j = 0, je = u16(feature + 2); j < je; ++j)
+                indices.push_back(u16(feature + 4 + j * 2));
+        }
+        std::sort(indices.begin(), indices.end());
+        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+        for (uint16_t index : indices)
+            result.push_back(lookups + u16(lookups + 2 + index * 2));
+        return result;
+    }
+
+    /** Returns the coverage index of the glyph, or -1 if not covered.
+     */
+    int coverage(uint32_t offset, uint16_t glyph) const {
+        if (u16(offset) == 1) {
+            for (uint32_t i = 0, e = u16(offset + 2); i < e; ++i)
+                if (u16(offset + 4 + i * 2) == glyph)
+                    return static_cast<int>(i);
+        } else {
+            for (uint32_t i = 0, e = u16(offset + 2); i < e; ++i) {
+                uint32_t range = offset + 4 + i * 6;
+                if (glyph >= u16(range) && glyph <= u16(range + 2))
+                    return u16(range + 4) + glyph - u16(range);
+            }
+        }
+        return -1;
+    }
+
+    uint16_t glyphClass(uint32_t offset, uint16_t glyph) const {
+        if (u16(offset) == 1) {
+            uint16_t first = u16(offset + 2);
+            if (glyph >= first && glyph - first < u16(offset + 4))
+                return u16(offset + 6 + (glyph - first) * 2);
+        } else {
+            for (uint32_t i = 0, e = u16(offset + 2); i < e; ++i) {
+                uint32_t range = offset + 4 + i * 6;
+                if (glyph >= u16(range) && glyph <= u16(range + 2))
+                    return u16(range + 4);
+            }
+        }
+        return 0;
+    }
+
+    static uint32_t valueRecordSize(uint16_t format) { return static_cast<uint32_t>(__builtin_popcount(format)) * 2; }
+
+    /** Returns the x advance adjustment from the value record, which is the third field if present.
+     */
+    int xAdvance(uint32_t offset, uint16_t format) const {
+        if (! (format & 0x04))
+            return 0;
+        return s16(offset + valueRecordSize(format & 0x03));
+    }
+
+    /** Returns the adjustment of the pair from a PairPos subtable, or nothing if the subtable does not apply to the pair.
+     */
+    std::optional<int> pairAdjustment(uint32_t sub, uint16_t left, uint16_t right) const {
+        int index = coverage(sub + u16(sub + 2), left);
+        if (index < 0)
+            return std::nullopt;
+        uint16_t format1 = u16(sub + 4);
+        uint16_t format2 = u16(sub + 6);
+        if (u16(sub) == 1) {
+            uint32_t pairSet = sub + u16(sub + 10 + index * 2);
+            uint32_t recordSize = 2 + valueRecordSize(format1) + valueRecordSize(format2);
+            for (uint32_t i = 0, e = u16(pairSet); i < e; ++i) {
+                uint32_t record = pairSet + 2 + i * recordSize;
+                if (u16(record) == right)
+                    return xAdvance(record + 2, format1);
+            }
+            return std::nullopt;
+        }
+        uint16_t class1 = glyphClass(sub + u16(sub + 8), left);
+        uint16_t class2 = glyphClass(sub + u16(sub + 10), right);
+        uint32_t class2Count = u16(sub + 14);
+        uint32_t recordSize = valueRecordSize(format1) + valueRecordSize(format2);
+        return xAdvance(sub + 16 + (class1 * class2Count + class2) * recordSize, format1);
+    }
+
+    /** Kerning from the legacy kern table, horizontal format 0 subtables only.
+     */
+    int kernTable(uint16_t left, uint16_t right) const {
+        uint32_t kern = table("kern");
+        if (kern == 0 || u16(kern) != 0)
+            return 0;
+        int result = 0;
+        uint32_t sub = kern + 4;
+        for (uint32_t i = 0, e = u16(kern + 2); i < e; ++i, sub += u16(sub + 2)) {
+            uint16_t cov = u16(sub + 4);
+            if ((cov >> 8) != 0 || ! (cov & 1))
+                continue;
+            for (uint32_t j = 0, je = u16(sub + 6); j < je; ++j) {
+                uint32_t pair = sub + 14 + j * 6;
+                if (u16(pair) == left && u16(pair + 2) == right)
+                    result += s16(pair + 4);
+            }
+        }
+        return result;
+    }
+
+    std::vector<uint8_t> data_;
+    std::map<std::string, uint32_t> tables_;
+    uint32_t cmap_ = 0;
+}; 
+
+/** Returns the kerning pairs of the glyphs from the font file, scaled to the font size. Returns (left glyph, right glyph, adjustment) triplets sorted by the glyph indices.
+ */
+std::vector<std::tuple<size_t, size_t, int>> getKerningPairs(std::string const & fontFile, Glyphs const & glyphs, int fontSize) {
+    OpenTypeFont font{fontFile};
+    float scale = font.scale(fontSize);
+    std::vector<uint16_t> ids;
+    for (size_t i = 0, e = glyphs.size(); i < e; ++i)
+        ids.push_back(font.glyphId(static_cast<uint32_t>(glyphs.codepoints[i])));
+    std::vector<std::tuple<size_t, size_t, int>> result;
+    for (size_t i = 0, e = glyphs.size(); i < e; ++i) {
+        if (ids[i] == 0)
+            continue;
+        for (size_t j = 0; j < e; ++j) {
+            if (ids[j] == 0)
+                continue;
+            int adjust = static_cast<int>(std::lround(font.kerning(ids[i], ids[j]) * scale));
+            if (adjust != 0)
+                result.push_back({i, j, std::clamp(adjust, -128, 127)});
+        }
+    }
+    std::cout << "        " << result.size() << " kerning pairs" << std::endl;
+    return result;
+}
+
 /** Takes font in ttf or otf format and produces font glyphs from it. 
  
     Usage: 
 
-        font-converter FONT_FILE OUTPUT_FILE FONT_SIZE [ --glyphs GLYPH_FILE ] [--namespace NAMESPACE]
+        font-converter FONT_FILE OUTPUT_FILE FONT_SIZE [ --glyphs GLYPH_FILE ] [ --charset ascii|latin ] [ --kerning ] [--namespace NAMESPACE]
+
+    When no glyph file is given, the charset determines the glyphs, printable ASCII being the default. The glyphs are sorted by their codepoints and if they are not just a single range starting at space, sorted codepoint ranges are generated as well so that the SDK can find glyphs for any codepoint by binary search. Codepoints without glyphs are rendered as question mark, if the font has it, or the first glyph otherwise.
 
+    With --kerning, the kerning pairs of the glyphs are read from the font's GPOS, or kern table (see OpenTypeFont) and stored with the font. This is intended for proportional fonts, monospace fonts have no kerning.
  */
 int main(int argc, char const * argv[]) {
     Args::Arg<std::string> inputFile{""};
     Args::Arg<std::string> outputFile{""};
     Args::Arg<unsigned> fontSize{16};
     Args::Arg<std::string> glyphs{"glyphs", ""};
+    Args::Arg<std::string> charset{"charset", "ascii"};
+    Args::Arg<bool> kerning{"kerning", false};
     Args::Arg<std::string> ns{"namespace", "rckid::assets"};
-    Args::parse(argc, argv, { inputFile, outputFile, fontSize, glyphs, ns});
+    Args::parse(argc, argv, { inputFile, outputFile, fontSize, glyphs, charset, kerning, ns});
     // get the glyphs 
-    Glyphs fontGlyphs = glyphs.isDefault() ? getDefaultGlyphs() :  loadGlyphIndices(glyphs.value());
+    Glyphs fontGlyphs;
+    if (! glyphs.isDefault())
+        fontGlyphs = loadGlyphIndices(glyphs.value());
+    else if (charset.value() == "latin")
+        fontGlyphs = getLatinGlyphs();
+    else if (charset.value() == "ascii")
+        fontGlyphs = getDefaultGlyphs();
+    else
+        throw std::runtime_error(STR("Unknown charset " << charset.value()));
+    fontGlyphs = sortGlyphs(fontGlyphs);
+    // determine the codepoint ranges and the fallback glyph
+    std::vector<std::pair<int, size_t>> ranges; // first codepoint, number of glyphs
+    size_t fallback = 0;
+    for (size_t i = 0, e = fontGlyphs.size(); i < e; ++i) {
+        int cp = fontGlyphs.codepoints[i];
+        if (cp == '?')
+            fallback = i;
+        if (!ranges.empty() && ranges.back().first + static_cast<int>(ranges.back().second) == cp && ranges.back().second < 0xffff)
+            ++ranges.back().second;
+        else
+            ranges.push_back({cp, 1});
+    }
+    bool asciiOnly = ranges.size() == 1 && ranges[0].first == 32 && fallback == '?' - 32;
     GlyphInfo * ginfos = loadFontGlyphs(inputFile.value(), fontSize.value(), fontGlyphs);
+    std::vector<std::tuple<size_t, size_t, int>> kerningPairs;
+    if (kerning.value())
+        kerningPairs = getKerningPairs(inputFile.value(), fontGlyphs, fontSize.value());
     // and output them, creating the directories if necessary
     std::filesystem::create_directories(std::filesystem::path{outputFile.value()}.parent_path());
     std::ofstream ofile{outputFile.value()};
@@ -59,8 +362,10 @@ int main(int argc, char const * argv[]) {
     ofile << indent << "   Size:        " << fontSize.value() << std::endl;
     ofile << indent << "   Glyphs:      " << fontGlyphs.size() << std::endl;
     ofile << indent << "   Glyphs size: " << (fontGlyphs.size() * 8) << std::endl;
+    ofile << indent << "   Ranges:      " << (asciiOnly ? 0 : ranges.size()) << std::endl;
+    ofile << indent << "   Kerning:     " << kerningPairs.size() << std::endl;
     ofile << indent << "   Pixels size: " << pixelOffset << std::endl;
-    ofile << indent << "   Total size:  " << (pixelOffset + fontGlyphs.size() * 8) << std::endl;
+    ofile << indent << "   Total size:  " << (pixelOffset + fontGlyphs.size() * 8 + (asciiOnly ? 0 : ranges.size() * 8) + kerningPairs.size() * 6) << std::endl;
     ofile << indent << " */" << std::endl;
     ofile << indent << "class " << className << "FontData {" << std::endl;
     ofile << indent << "public:" << std::endl;
@@ -71,12 +376,45 @@ int main(int argc, char const * argv[]) {
     ofile << indent << "    inline static constexpr uint8_t pixels[] = {"; // endl from pixels
     ofile << pixelData.str() << std::endl;
     ofile << indent << "    }; // " << className << "::pixels" << std::endl;
+    if (! asciiOnly) {
+        ofile << std::endl << indent << "    inline static constexpr GlyphRange ranges[] = {" << std::endl;
+        size_t glyphIndex = 0;
+        for (auto const & r : ranges) {
+            ofile << indent << "        GlyphRange{" << r.first << ", " << r.second << ", " << glyphIndex << "}, // U+" << std::hex << r.first << " - U+" << (r.first + r.second - 1) << std::dec << std::endl;
+            glyphIndex += r.second;
+        }
+        ofile << indent << "    }; // " << className << "::ranges" << std::endl;
+    }
+    if (! kerningPairs.empty()) {
+        ofile << std::endl << indent << "    inline static constexpr KerningPair kerning[] = {" << std::endl;
+        for (auto const & [left, right, adjust] : kerningPairs)
+            ofile << indent << "        KerningPair{" << left << ", " << right << ", " << adjust << "}, // '" << fontGlyphs.names[left] << "' '" << fontGlyphs.names[right] << "'" << std::endl;
+        ofile << indent << "    }; // " << className << "::kerning" << std::endl;
+    }
     ofile << indent << "}; // class " << ns.value() << "::" << className << std::endl << std::endl;
     ofile << indent << "inline constexpr rckid::FontData const " << className << " = {"  << std::endl;
     ofile << indent << "    " << className << "FontData::size," << std::endl;
     ofile << indent << "    " << fontGlyphs.size() << "," << std::endl;
     ofile << indent << "    " << className << "FontData::glyphs," << std::endl;
-    ofile << indent << "    " << className << "FontData::pixels" << std::endl;    
+    if (asciiOnly && kerningPairs.empty()) {
+        ofile << indent << "    " << className << "FontData::pixels" << std::endl;    
+    } else {
+        ofile << indent << "    " << className << "FontData::pixels," << std::endl;    
+        if (asciiOnly) {
+            ofile << indent << "    0," << std::endl;
+            ofile << indent << "    nullptr," << std::endl;
+        } else {
+            ofile << indent << "    " << ranges.size() << "," << std::endl;
+            ofile << indent << "    " << className << "FontData::ranges," << std::endl;
+        }
+        if (kerningPairs.empty()) {
+            ofile << indent << "    " << fallback << std::endl;
+        } else {
+            ofile << indent << "    " << fallback << "," << std::endl;
+            ofile << indent << "    " << kerningPairs.size() << "," << std::endl;
+            ofile << indent << "    " << className << "FontData::kerning" << std::endl;
+        }
+    }
     ofile << indent << "};" << std::endl;
     if (! ns.value().empty())
         ofile << "} // namespace " << ns.value() << std::endl;
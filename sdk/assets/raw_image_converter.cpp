@@ -4,6 +4,7 @@
 #include <platform/args.h>
 
 #include <rckid/graphics/color.h>
+#include <rckid/graphics/qoi_encoder.h>
 
 #include "assets_utils.h"
 
@@ -37,29 +38,50 @@ void convertSingleFile(std::string input, std::string output) {
     UnloadImage(img);
 }
 
+void convertSingleFileQOI(std::string input, std::string output) {
+    std::filesystem::create_directories(std::filesystem::path{output}.parent_path());
+    std::ofstream ofile(output, std::ios::binary);
+    Image img = LoadImage(input.c_str());
+    rckid::QOIEncoder enc{img.width, img.height, [&](uint8_t const * data, uint32_t size) {
+        ofile.write(reinterpret_cast<char const *>(data), size);
+    }, 4};
+    for (int y = 0; y < img.height; ++y) {
+        for (int x = 0; x < img.width; ++x) {
+            ::Color pixel = GetImageColor(img, x, y);
+            enc.push(pixel.r, pixel.g, pixel.b, pixel.a);
+        }
+    }
+    enc.finish();
+    UnloadImage(img);
+}
+
 /** Takes image, loads it and converts it to the raw format rom bitmap. 
  
     Usage: 
 
-        raw-image-converter IMAGE_FILE OUTPUT_FILE
+        raw-image-converter IMAGE_FILE OUTPUT_FILE [--qoi]
     
     If directory is given instead of input file, then directory as output is expected and *all* files in the input directory will be converted. 
+
+    With --qoi the images are converted to the QOI format instead, which is much smaller than the raw format and still very fast to decode (see QOIImageDecoder).
  */
 
 int main(int argc, char const * argv[]) {
     Args::Arg<std::string> inputFile{""};
     Args::Arg<std::string> outputFile{""};
-    Args::parse(argc, argv, { inputFile, outputFile});
+    Args::Arg<bool> qoi{"qoi", false};
+    Args::parse(argc, argv, { inputFile, outputFile, qoi});
+    auto convert = qoi.value() ? convertSingleFileQOI : convertSingleFile;
     if (std::filesystem::is_directory(inputFile.value())) {
         for (const auto & entry : std::filesystem::directory_iterator(inputFile.value())) {
             if (entry.is_regular_file()) {
                 std::string inputPath = entry.path().string();
-                std::string outputPath = outputFile.value() + "/" + entry.path().stem().string() + ".raw";
-                convertSingleFile(inputPath, outputPath);
+                std::string outputPath = outputFile.value() + "/" + entry.path().stem().string() + (qoi.value() ? ".qoi" : ".raw");
+                convert(inputPath, outputPath);
             }
         }
     } else {
-        convertSingleFile(inputFile.value(), outputFile.value());
+        convert(inputFile.value(), outputFile.value());
     }
    return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <fstream>
 #include <filesystem>
+#include <vector>
 
 #include <rckid/filesystem.h>
 
@@ -379,6 +380,78 @@ namespace rckid::fs {
         }
         return count;
     }
+
+    /** The host directory iterator cannot go back, so the host folder reader lists the folder when opened and then only moves its position in the list.
+     */
+    class HostFolderReader : public FolderReader {
+    public:
+        ~HostFolderReader() override {
+            // the list was allocated by the system malloc
+            SystemMallocGuard g;
+            delete entries_;
+        }
+
+    protected:
+
+        void rewind() override {
+            position_ = 0;
+        }
+
+        bool next(FolderEntry * entry) override {
+            if (position_ >= entries_->size())
+                return false;
+            if (entry != nullptr) {
+                SystemMallocGuard g;
+                std::filesystem::directory_entry const & e = (*entries_)[position_];
+                std::error_code ec;
+                bool isFolder = e.is_directory(ec);
+                uint32_t size = e.is_regular_file(ec) ? static_cast<uint32_t>(e.file_size(ec)) : 0;
+                std::string name = e.path().filename().string();
+                g.release();
+                entry->name = name.c_str();
+                entry->isFolder = isFolder;
+                entry->size = size;
+                g.acquire();
+            }
+            ++position_;
+            return true;
+        }
+
+        void saveCheckpoint(uint32_t) override {
+        }
+
+        void restoreCheckpoint(uint32_t index) override {
+            position_ = index * CHECKPOINT_INTERVAL;
+        }
+
+    private:
+
+        friend unique_ptr<FolderReader> openFolder(String const & path, Drive dr);
+
+        std::vector<std::filesystem::directory_entry> * entries_ = nullptr;
+        size_t position_ = 0;
+    }; // fs::HostFolderReader
+
+    unique_ptr<FolderReader> openFolder(String const & path, Drive dr) {
+        if (! isMounted(dr))
+            return nullptr;
+        auto result = new HostFolderReader();
+        {
+            SystemMallocGuard g;
+            result->entries_ = new std::vector<std::filesystem::directory_entry>{};
+            std::filesystem::path hostPath{getHostPath(dr, path)};
+            std::error_code ec;
+            if (! std::filesystem::is_directory(hostPath, ec)) {
+                g.release();
+                delete result;
+                g.acquire();
+                return nullptr;
+            }
+            for (auto it = std::filesystem::directory_iterator{hostPath, ec}; ! ec && it != std::filesystem::directory_iterator{}; it.increment(ec))
+                result->entries_->push_back(*it);
+        }
+        return unique_ptr<FolderReader>{result};
+    }
 #endif // RCKID_CUSTOM_FILESYSTEM
 
 } // namespace rckid::fs
\ No newline at end of file
@@ -64,8 +64,7 @@ namespace rckid {
                 current_->onLoopStart();
                 while (! app.shouldExit()) {
                     tick();
-                    current_->loop();
-                    current_->render();
+                    current_->frame();
                 }
                 current_->onBlur();
                 current_ = current_->parent_;
@@ -96,8 +95,7 @@ namespace rckid {
                 current_->onLoopStart();
                 while (! app.shouldExit()) {
                     tick();
-                    current_->loop();
-                    current_->render();
+                    current_->frame();
                 }
                 current_->onBlur();
                 current_ = current_->parent_;
@@ -210,15 +208,20 @@ namespace rckid {
 
         /** Saves screen capture in any of the SDK supported image formats to the given stream.
          
-            Override this method in apps that support screen capture. Note that the app must declare the canCaptureScreen capability in order for the method to be called. Returns true of the screen capture was successful, false otherwise.
+            Override this method in apps that can produce the screen capture themselves, such as when the whole screen is backed by a single bitmap. Note that the app must declare the canCaptureScreen capability in order for the method to be called. Returns true of the screen capture was successful, false otherwise. 
+            
+            The default implementation returns false, in which case the screen is captured from the next frames sent to the display by a background ScreenCapture task.
 
             The method can be called any time after the onLoopStart() method returns.
          */
         virtual bool captureScreen([[maybe_unused]] RandomWriteStream & stream) const {
-            UNREACHABLE;
             return false;
         }
 
+        /** Convenience function that captures the screen to the given file in the app's screenshots folder. 
+         */
+        void captureScreen(String filename);
+
         /** Called by the system when standalone app is about to be started. 
          
             When called, the app should release all of its resources (memory, file handles, HW resources, etc.) if supported in order to give the standalone app as much of the system available resources as possible. The default implementation is empty (no support). 
@@ -289,6 +292,10 @@ namespace rckid {
 
         void enforceCapabilities();
 
+        /** Runs the app's loop() followed by render(). While a screen capture is in progress, the loop is skipped so that the app renders the same frame until all of it is captured (see ScreenCapture).
+         */
+        void frame();
+
         App * parent_ = nullptr;
         // flag indicating whether the app should exit
         bool shouldExit_ = false;
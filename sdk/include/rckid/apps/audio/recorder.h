@@ -3,6 +3,7 @@
 #include <rckid/ui/app.h>
 #include <rckid/ui/label.h>
 #include <rckid/ui/image.h>
+#include <rckid/audio/recording.h>
 #include <assets/OpenDyslexic128.h>
 #include <assets/OpenDyslexic64.h>
 
@@ -30,31 +31,37 @@ namespace rckid {
 
             //time_ = g_.addChild(new ui::Label{Rect::XYWH(0, 0, 320, 20), ""});
             //waveform_ = g_.addChild(new Waveform{});
-            
-            auto f = [this](int16_t * & samples, uint32_t & numSamples) {
-                    if (samples == nullptr) {
-                        // provide buffer to fill
-                        samples = buf_.front().data();
-                        numSamples = buf_.size() / 2;
-                        buf_.swap();
-                    } else {
-                        waveform_->processSamples(samples, numSamples);
-                    }
-                };
-            if (source == Source::Mic) {
-                audio::recordMic(8000, f);
-            } else {
-                audio::recordLineIn(8000, f);
+
+            // recordings are stored as IMA-ADPCM compressed WAV files in the recordings folder
+            fs::createFolders(RECORDINGS_FOLDER);
+            uint32_t index = 0;
+            do {
+                path_ = STR(RECORDINGS_FOLDER << "/rec-" << fillLeft(++index, 3, '0') << ".wav");
+            } while (fs::exists(path_));
+            file_ = fs::writeFile(path_);
+            if (file_ == nullptr) {
+                LOG(LL_ERROR, "Cannot create recording " << path_);
+                return;
             }
+            recording_ = std::make_unique<audio::Recording>(*file_);
+            recording_->setOnSamples([this](int16_t const * samples, uint32_t numSamples) {
+                waveform_->processSamples(samples, numSamples);
+            });
+            recording_->start(source == Source::Mic ? audio::Recording::Source::Mic : audio::Recording::Source::LineIn);
         }
 
         ~Recorder() override {
-            audio::stop();
+            // finish the recording before the file is closed
+            recording_ = nullptr;
+            file_ = nullptr;
         }
 
         void loop() override {
             ui::App<void>::loop();
-            //time_->setText(STR(min_ << " -- " << max_ << ", " << delta_));
+            if (recording_ != nullptr) {
+                uint32_t s = recording_->samples() / recording_->sampleRate();
+                time_->setText(STR(s / 60 << ":" << fillLeft(s % 60, 2, '0')));
+            }
             if (!btnDown(Btn::A))
                 exit();
         }   
@@ -70,7 +77,7 @@ namespace rckid {
             }
 
             void processSamples(int16_t const * samples, uint32_t numSamples) {
-                for (uint32_t i = 0; i < numSamples; i += 2) {
+                for (uint32_t i = 0; i < numSamples; ++i) {
                     if (sampleIndex_ >= samplesPerPixel_) {
                         sampleIndex_ = 0;
                         wave_[waveIndex_++] = (max_ - min_) / 256;
@@ -113,12 +120,14 @@ namespace rckid {
             int16_t max_ = -32768;
         };
 
-        ui::Label * time_;
-
-        uint32_t samples_ = 0;
+        static constexpr char const * RECORDINGS_FOLDER = "/files/recordings";
 
-        DoubleBuffer<int16_t> buf_{1024};
+        ui::Label * time_;
         Waveform * waveform_;
+
+        String path_;
+        unique_ptr<RandomWriteStream> file_;
+        unique_ptr<audio::Recording> recording_;
         
     }; // rckid::Recorder
 
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <rckid/app.h>
+#include <rckid/graphics/canvas.h>
+
+namespace rckid {
+
+    /** Application that renders its contents into a canvas. 
+     
+        One of the simplest application types, the canvas app is backed by a framebuffer canvas that can be updated at each loop iteration and is then sent to the display. This is super simple, retains state between frames, which can lead to faster draw times with only changes being updated at every frame. 
+     */
+    template<typename RESULT>
+    class CanvasApp : public ModalApp<RESULT> {
+    public:
+        explicit CanvasApp(Rect rect):
+            rect_{rect},
+            canvas_{rect.width(), rect.height()},
+            renderBuffer_{static_cast<uint32_t>(rect.height())} {
+        }
+
+        CanvasApp(): CanvasApp{Rect::WH(display::WIDTH, display::HEIGHT)} {}
+
+        Rect rect() const { return rect_; }
+
+        Coord width() const { return rect_.width(); }
+        Coord height() const { return rect_.height(); }
+    
+    protected:
+
+        Canvas & canvas() { return canvas_; }
+        
+        void onFocus() override {
+            ModalApp<RESULT>::onFocus();
+            display::enable(rect_, hal::display::RefreshDirection::ColumnFirst);
+            // deal with header
+        }
+
+        void render() override {
+            renderCol_ = width() - 1;
+            display::update([this](Color::RGB565 * & buffer, uint32_t & bufferSize) {
+                if (renderCol_ < 0) {
+                    buffer = nullptr;
+                    return;
+                } else if (buffer == nullptr) {
+                    buffer = renderBuffer_.front().data();
+                    bufferSize = height();
+                    ASSERT(bufferSize <= renderBuffer_.size());
+                    renderBuffer_.swap();
+                }
+                canvas_.renderColumn(renderCol_--, 0, buffer, height());
+            });
+        }
+
+    private:
+        Rect rect_;
+        Canvas canvas_;
+
+        DoubleBuffer<Color::RGB565> renderBuffer_;
+        Coord renderCol_;
+    
+    }; // rckid::CanvasApp
+
+} // namespace rckid
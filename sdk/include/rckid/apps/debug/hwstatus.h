@@ -13,6 +13,8 @@ namespace rckid {
             using namespace ui;
             text_ = addChild(new ui::TileGrid{40, 15, Palette256})
                 << SetRect(Rect::WH(320, 240));
+            // only the few changing characters are redrawn each frame
+            text_->enableCache();
             tg_ = & text_->contents();
               
             tg_->text(0, 1) << "Buttons:";
@@ -31,6 +31,8 @@ namespace rckid {
             root_.setUseHeader(Header::Visibility::OnChange);
             text_ = addChild(new ui::TileGrid{40, 15, Palette256})
                 << SetRect(Rect::WH(320, 240));
+            // only the few changing characters are redrawn each frame
+            text_->enableCache();
             tg_ = & text_->contents();
 #if (defined PLATFORM_RP2350)
             uart_init(RCKID_USER_UART, baudrate_);
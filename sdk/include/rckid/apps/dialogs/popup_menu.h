@@ -46,46 +46,54 @@ namespace rckid {
             Coord width = 0;
             bool images = false;
             Font f{assets::OpenDyslexic24};
-            for (auto & i : *menu) {
-                images = images | (! i.icon.empty());
-                width = std::max(width, f->textWidth(i.text));
+            if (menu->isVirtual()) {
+                // virtual menus can be arbitrarily large, do not create all of their items just to determine the width
+                images = true;
+                width = display::WIDTH;
+            } else {
+                for (auto & i : *menu) {
+                    images = images | (! i.icon.empty());
+                    width = std::max(width, f->textWidth(i.text));
+                }
+                width += images ? 40 : 10;
             }
-            width += images ? 40 : 10;
             if (width < 100)
                 width = 100;
             else if (width > display::WIDTH)
                 width = display::WIDTH;
             rows_ = static_cast<Coord>(menu->size());
-            Coord height = std::min(MAX_ROWS, rows_) * 24;
+            Coord height = std::min(MAX_ROWS, rows_) * ROW_HEIGHT;
             root_.setRect(Rect::XYWH(0, display::HEIGHT - height, width, height));
 
+            // the row widgets are recycled as the menu scrolls, so there only has to be enough of them for the visible rows and the rows that scroll in and out of the view
+            poolSize_ = std::min(MAX_ROWS + 2, rows_);
             if (images)
-                icons_ = unique_ptr<ui::Image*>(new ui::Image * [rows_]);
-            labels_ = unique_ptr<ui::Label*>(new ui::Label * [rows_]);
+                icons_ = unique_ptr<ui::Image*>(new ui::Image * [poolSize_]);
+            labels_ = unique_ptr<ui::Label*>(new ui::Label * [poolSize_]);
+            boundRows_ = unique_ptr<Coord>(new Coord[poolSize_]);
 
             view_ = addChild(new ScrollView{})
                 << SetRect(Rect::WH(width, height));
 
             sel_ = view_->addChild(new Panel{}) 
                 << SetBg(Style::defaultStyle().accentFg())
-                << SetRect(Rect::XYWH(2, 2, width - 4, 22));
+                << SetRect(Rect::XYWH(2, 2, width - 4, ROW_HEIGHT - 2));
 
             Style const & style = Style::defaultStyle();
 
-            for (Coord i = 0; i < rows_; ++i) {
-                MenuItem const & mi = menu->at(i);
+            for (Coord i = 0; i < poolSize_; ++i) {
                 if (images) {
                     icons_.get()[i] = view_->addChild(new Image{})
-                        << SetRect(Rect::XYWH(5, i * 24, 24, 24))
-                        << SetBitmap(mi.icon);
+                        << SetRect(Rect::XYWH(5, 0, 24, ROW_HEIGHT));
                 }
                 labels_.get()[i] = view_->addChild(new Label{})
-                    << SetRect(Rect::XYWH(images ? 30 : 5, i * 24, width - (images ? 35 : 5), 24))
+                    << SetRect(Rect::XYWH(images ? 30 : 5, 0, width - (images ? 35 : 5), ROW_HEIGHT))
                     << SetFont(f)
                     << SetUseAlpha(true)
-                    << SetText(mi.text)
                     << SetFgGradient(style.defaultFg(), style.accentBg());
+                boundRows_.get()[i] = -1;
             }
+            bindRows(0);
 
             root_.useBackgroundImage(false);
                 
@@ -112,42 +120,78 @@ namespace rckid {
     private:
 
         static constexpr Coord MAX_ROWS = 7;
+        static constexpr Coord ROW_HEIGHT = 24;
 
         void moveUp() {
+            Coord oldOffset = rowOffset_;
             if (--selRow_ < 0) {
                 selRow_ = menu_->size() - 1;
                 rowOffset_ = std::max<Coord>(0, selRow_ - MAX_ROWS + 1);
             } else if (selRow_ < rowOffset_) {
                 --rowOffset_;
             }
-            updatePosition();
+            updatePosition(oldOffset);
         }
 
         void moveDown() {
+            Coord oldOffset = rowOffset_;
             if (++selRow_ == static_cast<Coord>(menu_->size())) {
                 selRow_ = 0;
                 rowOffset_ = 0;
             } else if (selRow_ - rowOffset_ >= MAX_ROWS) {
                 ++rowOffset_;
             }
-            updatePosition();
+            updatePosition(oldOffset);
         }
 
-        void updatePosition() {
+        void updatePosition(Coord oldOffset) {
             cancelAnimations();
+            if (std::abs(rowOffset_ - oldOffset) > 1) {
+                // wrapped around, jump to the new position instead of scrolling through all the rows in between
+                view_->setScrollOffset(Point{0, rowOffset_ * ROW_HEIGHT});
+                sel_->setRect(Rect::XYWH(2, 2 + selRow_ * ROW_HEIGHT, sel_->width(), sel_->height()));
+                bindRows(rowOffset_);
+                return;
+            }
+            // the view may be anywhere between the old position and the one before it if the previous scroll has been cancelled
+            bindRows(std::min(rowOffset_, oldOffset) - 1);
             animate()
-                << ui::ScrollTo(view_, Point{0, rowOffset_ * 24})
-                << ui::MoveTo(sel_, Point{2, 2 + selRow_ * 24});
+                << ui::ScrollTo(view_, Point{0, rowOffset_ * ROW_HEIGHT})
+                << ui::MoveTo(sel_, Point{2, 2 + selRow_ * ROW_HEIGHT});
+        }
+
+        /** Binds the pooled row widgets to the menu rows starting with the given one. Each row always uses the same pooled widgets (row modulo pool size), so that only the rows that came into the view have to be updated.
+         */
+        void bindRows(Coord first) {
+            first = std::max<Coord>(0, std::min<Coord>(first, rows_ - poolSize_));
+            for (Coord row = first, e = first + poolSize_; row < e; ++row) {
+                Coord slot = row % poolSize_;
+                if (boundRows_.get()[slot] == row)
+                    continue;
+                boundRows_.get()[slot] = row;
+                ui::MenuItem const & mi = menu_->at(row);
+                if (icons_ != nullptr) {
+                    ui::Image * icon = icons_.get()[slot];
+                    icon->setRect(Rect::XYWH(icon->x(), row * ROW_HEIGHT, icon->width(), icon->height()));
+                    icon->setContents(Bitmap{ImageSource{mi.icon}});
+                }
+                ui::Label * label = labels_.get()[slot];
+                label->setRect(Rect::XYWH(label->x(), row * ROW_HEIGHT, label->width(), label->height()));
+                label->setText(mi.text);
+            }
         }
 
         Coord rows_;
         Coord rowOffset_ = 0;
         Coord selRow_ = 0;
+        Coord poolSize_;
 
         ui::ScrollView * view_;
         ui::Menu * menu_;
         unique_ptr<ui::Image *> icons_;
         unique_ptr<ui::Label *> labels_;
+        // menu row each of the pooled widgets currently shows, or -1 if none
+        unique_ptr<Coord> boundRows_;
         ui::Panel * sel_;
 
     }; // rckid::PopupMenu
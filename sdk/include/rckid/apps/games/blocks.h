@@ -1,6 +1,6 @@
 #pragma once
 
-#include <rckid/graphics/canvas.h>
+#include <rckid/apps/canvas_app.h>
 
 #include <assets/OpenDyslexic24.h>
 #include <assets/MetalLord64.h>
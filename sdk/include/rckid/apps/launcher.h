@@ -67,10 +67,6 @@ namespace rckid {
 
         ui::CarouselMenu * carousel() const { return carousel_; }
 
-        /** Updates the style used by the launcher. Useful for style changes previews, etc.
-         */
-        static void updateStyle(ui::Style & style);
-
         static Launcher * instance() { return instance_; }
 
 
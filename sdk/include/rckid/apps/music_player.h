@@ -1,6 +1,5 @@
 #pragma once
 
-#include <rckid/timer.h>
 #include <rckid/ui/app.h>
 #include <rckid/apps/launcher.h>
 #include <rckid/apps/utils/file_browser.h>
@@ -12,16 +11,29 @@
 #include <assets/icons_24.h>
 #include <assets/OpenDyslexic32.h>
 #include <assets/Iosevka24.h>
+#include <assets/Iosevka16.h>
 
 namespace rckid {
 
     /** Simple music player. 
+
+        Left and right buttons move to the previous and next track, or seek 10 seconds back and forward when select is held. The current track and position are saved with the app state so that long files, such as audiobooks, can be resumed where they were left off.
+
+        The tracks are played through a DSP chain that normalizes their loudness by their ReplayGain tags and, when playing through the speaker, boosts the bass it lacks. The limiter keeps the boosted samples from clipping.
+
+        In debug mode, the playback statistics of the last second are displayed below the track position: total underruns (u), minimum ready buffers (r), maximum decode time per buffer (d) and maximum refill latency (l), both in microseconds.
      */
     class MusicPlayer : public ui::App<void> {
     public:
 
         String name() const override { return "Music"; }
 
+        Capabilities capabilities() const override {
+            return {
+                .canPersistState = true,
+            };
+        }
+
         MusicPlayer() {
             using namespace ui;
             carousel_ = addChild(new Launcher::BorrowedCarousel());
@@ -50,6 +62,11 @@ namespace rckid {
             playbackDuration_ = playbackInfo_->addChild(new Label{})
                 << SetRect(Rect::XYWH(320, 40, 220, 24))
                 << SetFont(assets::Iosevka24);
+            playbackStats_ = playbackInfo_->addChild(new Label{})
+                << SetRect(Rect::XYWH(100, 72, 220, 16))
+                << SetFont(assets::Iosevka16);
+            // the speaker's bass boost is only enabled when the speaker is used, see render()
+            dsp_.setBand(0, audio::Biquad::Type::LowShelf, SPEAKER_BASS_HZ, 0);
         }
 
     protected:
@@ -70,10 +87,29 @@ namespace rckid {
             /** Starts the playback.
              */
             void start() {
-                playbackTask_ = std::make_unique<audio::Playback>(this);
+                playbackTask_ = std::make_unique<audio::Playback>(this, & player_->dsp_);
+            }
+
+            /** Starts the playback of given file at given position instead of the file selected in the carousel.
+             */
+            void resume(String path, uint32_t positionMs) {
+                resumePath_ = std::move(path);
+                resumePositionMs_ = positionMs;
+                start();
             }
 
             unique_ptr<audio::DecoderStream> next() override {
+                if (! resumePath_.empty()) {
+                    // continue after the resumed track, or with the selected one if the track is no longer there
+                    index_ = player_->selectTrack(resumePath_) ? player_->carousel_->index() : NOT_INITIALIZED;
+                    currentPath_ = std::move(resumePath_);
+                    resumePath_ = "";
+                    player_->playbackTitle_->setText(fs::stem(currentPath_));
+                    auto result = audio::DecoderStream::fromFile(currentPath_, fs::Drive::SD);
+                    if (result != nullptr)
+                        result->seek(resumePositionMs_);
+                    return result;
+                }
                 if (index_ == NOT_INITIALIZED)
                     index_ = player_->carousel_->index();
                 else
@@ -83,8 +119,6 @@ namespace rckid {
                 // calling the action will set our path
                 player_->carousel_->menu()->at(index_).action()();
                 player_->playbackTitle_->setText(fs::stem(player_->playlist_->currentPath_));
-                // reset the timer
-                player_->timer_.start();
                 // create and return the stream
                 return audio::DecoderStream::fromFile(currentPath_, fs::Drive::SD);
             }
@@ -99,8 +133,6 @@ namespace rckid {
                 // calling the action will set our path
                 player_->carousel_->menu()->at(index_).action()();
                 player_->playbackTitle_->setText(fs::stem(player_->playlist_->currentPath_));
-                // reset the timer
-                player_->timer_.start();
                 // create and return the stream
                 return audio::DecoderStream::fromFile(currentPath_, fs::Drive::SD);
             }
@@ -135,6 +167,8 @@ namespace rckid {
             std::unique_ptr<audio::Playback> playbackTask_;
             uint32_t index_ = NOT_INITIALIZED;
             String currentPath_;
+            String resumePath_;
+            uint32_t resumePositionMs_ = 0;
 
         }; 
 
@@ -145,7 +179,36 @@ namespace rckid {
                     ASSERT(playlist_ != nullptr);
                     playlist_->setCurrentPath(std::move(path));
                     // TODO and display that we are playing that file, etc.
-                }, "/files/music", fs::Drive::SD, FileBrowser::audioFileFilter); });
+                }, MUSIC_FOLDER, fs::Drive::SD, FileBrowser::audioFileFilter); });
+        }
+
+        /** Moves the carousel to the given track, entering its folders from the music folder, so that the playlist continues from it. Returns false if the track is not in the music folder.
+         */
+        bool selectTrack(String const & path) {
+            String folder{MUSIC_FOLDER};
+            if (! path.startsWith(STR(folder << "/")))
+                return false;
+            while (! carousel_->atRoot())
+                carousel_->moveDown();
+            uint32_t start = folder.size() + 1;
+            while (start < path.size()) {
+                uint32_t end = start;
+                while (end < path.size() && path[end] != '/')
+                    ++end;
+                String name = path.substr(start, end - start);
+                bool last = end == path.size();
+                ui::Menu * menu = carousel_->menu();
+                uint32_t i = 0;
+                while (i < menu->size() && (menu->at(i).text != name || menu->at(i).isAction() != last))
+                    ++i;
+                if (i == menu->size())
+                    return false;
+                carousel_->setItem(i);
+                if (! last)
+                    carousel_->moveUp(menu->at(i).generator());
+                start = end + 1;
+            }
+            return true;
         }
 
         void onFocus() override {
@@ -155,13 +218,72 @@ namespace rckid {
 
         void render() {
             ui::App<void>::render();
+            float bass = audio::headphonesConnected() ? 0 : SPEAKER_BASS_DB;
+            if (dsp_.bandGain(0) != bass)
+                dsp_.setBandGain(0, bass);
             if (playlist_ != nullptr) {
-                timer_.tick();
-                TinyTime t = timer_.time();
+                TinyTime t{playlist_->playbackTask_->positionMs() / 1000};
                 playbackDuration_->setText(STR(nonZero(t.hour(), ":") << alignRight(t.minute(), 2, '0') << ":" << alignRight(t.second(), 2, '0')));
+                if (debug::debugMode()) {
+                    audio::Playback * playback = playlist_->playbackTask_.get();
+                    audio::StreamStats const & s = playback->lastStats();
+                    playbackStats_->setText(STR("u:" << playback->underruns() << " r:" << s.minReady() << " d:" << s.maxDecodeUs() << " l:" << s.maxLatencyUs()));
+                } else {
+                    playbackStats_->setText("");
+                }
             }
         }
 
+        /** Saves the current track and position, or the last played track if the playback has been stopped already (the state is saved when the app exits, which is only possible when not playing).
+         */
+        void saveState(RandomWriteStream & into) const override {
+            into.binaryWriter() << VERSION;
+            if (playlist_ == nullptr) {
+                into.binaryWriter()
+                    << lastPath_
+                    << lastPositionMs_;
+            } else {
+                into.binaryWriter()
+                    << playlist_->currentPath_
+                    << playlist_->playbackTask_->positionMs();
+            }
+        }
+
+        bool loadState(RandomReadStream & from) override {
+            auto rd = from.binaryReader();
+            if (read<uint8_t>(rd) != VERSION) {
+                LOG(LL_WARN, "Unsupported save version, skipping");
+                return false;
+            }
+            String path = read<String>(rd);
+            uint32_t positionMs = read<uint32_t>(rd);
+            if (path.empty())
+                return true;
+            // stop current playback, if any and start the saved track at the saved position
+            playlist_ = nullptr;
+            startPlayback();
+            playlist_->resume(std::move(path), positionMs);
+            return true;
+        }
+
+        /** Shows the playback info and creates the playlist without starting the playback.
+         */
+        void startPlayback() {
+            focusWidget(nullptr);
+            // animate the transition to playback
+            playbackInfo_->setVisibility(true);
+            shuffleIcon_->setVisibility(shuffle_);
+            repeatIcon_->setVisibility(repeat_);
+            playlist_ = std::make_unique<FolderPlaylist>(this);
+            animate()
+                << ui::FlyOut(pauseIcon_, Point{100, 0})
+                << ui::FlyOut(playIcon_, Point{100, 0})
+                << ui::FlyOut(shuffleIcon_, Point{100, 0})->setDelayMs(animationSpeed() / 2)
+                << ui::FlyOut(repeatIcon_, Point{100, 0})->setDelayMs(animationSpeed() / 2)
+                << ui::FlyOut(playbackTitle_, Point{-220, 0})
+                << ui::FlyOut(playbackDuration_, Point{-220, 0})->setDelayMs(animationSpeed() / 2);
+        }
+
         void loop() override {
             ui::App<void>::loop();
             if (playlist_ == nullptr) {
@@ -169,21 +291,9 @@ namespace rckid {
                 if (btnPressed(Btn::A) || btnPressed(Btn::Up)) {
                     btnClear(Btn::A);
                     btnClear(Btn::Up);
-                    focusWidget(nullptr);
                     ASSERT(playlist_ == nullptr);
-                    // animate the transition to playback
-                    playbackInfo_->setVisibility(true);
-                    shuffleIcon_->setVisibility(shuffle_);
-                    repeatIcon_->setVisibility(repeat_);
-                    playlist_ = std::make_unique<FolderPlaylist>(this);
+                    startPlayback();
                     playlist_->start();
-                    animate()
-                        << ui::FlyOut(pauseIcon_, Point{100, 0})
-                        << ui::FlyOut(playIcon_, Point{100, 0})
-                        << ui::FlyOut(shuffleIcon_, Point{100, 0})->setDelayMs(animationSpeed() / 2)
-                        << ui::FlyOut(repeatIcon_, Point{100, 0})->setDelayMs(animationSpeed() / 2)
-                        << ui::FlyOut(playbackTitle_, Point{-220, 0})
-                        << ui::FlyOut(playbackDuration_, Point{-220, 0})->setDelayMs(animationSpeed() / 2);
                     waitUntilIdle();
                 }
                 if (btnPressed(Btn::B) || btnPressed(Btn::Down)) {
@@ -197,10 +307,8 @@ namespace rckid {
                         audio::resume();
                         pauseIcon_->setVisibility(false);
                         playIcon_->setVisibility(true);
-                        timer_.resume();
                     } else {
                         audio::pause();
-                        timer_.pause();
                         pauseIcon_->setVisibility(true);
                         playIcon_->setVisibility(false);
                     }
@@ -217,14 +325,25 @@ namespace rckid {
                     shuffleIcon_->setVisibility(shuffle_);
                     repeatIcon_->setVisibility(repeat_);
                 }
-                if (btnPressed(Btn::Left))
-                    playlist_->playbackTask_->prev();
-                if (btnPressed(Btn::Right))
-                    playlist_->playbackTask_->next();
+                audio::Playback * playback = playlist_->playbackTask_.get();
+                if (btnPressed(Btn::Left)) {
+                    if (btnDown(Btn::Select))
+                        playback->seek(playback->positionMs() > SEEK_STEP_MS ? playback->positionMs() - SEEK_STEP_MS : 0);
+                    else
+                        playback->prev();
+                }
+                if (btnPressed(Btn::Right)) {
+                    if (btnDown(Btn::Select))
+                        playback->seek(playback->positionMs() + SEEK_STEP_MS);
+                    else
+                        playback->next();
+                }
                 if (btnPressed(Btn::B) || btnPressed(Btn::Down)) {
                     btnClear(Btn::B);
                     btnClear(Btn::Down);
-                    // delete playlist, which also destroys the playback task and stops the music
+                    // remember where we stopped and delete playlist, which also destroys the playback task and stops the music
+                    lastPath_ = playlist_->currentPath_;
+                    lastPositionMs_ = playlist_->playbackTask_->positionMs();
                     playlist_ = nullptr;
                     focusWidget(carousel_);
                     // animate the transition back to carousel
@@ -242,11 +361,20 @@ namespace rckid {
         }
 
     private:
+
+        static constexpr uint8_t VERSION = 1;
+        static constexpr uint32_t SEEK_STEP_MS = 10000;
+        static constexpr char const * MUSIC_FOLDER = "/files/music";
+        static constexpr float SPEAKER_BASS_HZ = 250;
+        static constexpr float SPEAKER_BASS_DB = 6;
+
         Launcher::BorrowedCarousel * carousel_;
+        audio::DSP dsp_;
         bool repeat_ = false;
         bool shuffle_ = false;
         unique_ptr<FolderPlaylist> playlist_;
-        Timer timer_;
+        String lastPath_;
+        uint32_t lastPositionMs_ = 0;
 
         ui::Panel * playbackInfo_;
         ui::Image * playIcon_;
@@ -255,6 +383,7 @@ namespace rckid {
         ui::Image * repeatIcon_;
         ui::Label * playbackTitle_;
         ui::Label * playbackDuration_;
+        ui::Label * playbackStats_;
 
     }; // rckid::MusicPlayer
 
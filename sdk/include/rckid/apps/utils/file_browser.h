@@ -25,26 +25,15 @@ namespace rckid {
         }
 
         /** Menu generator for given folder. 
+
+            The menu is virtual and backed by lazily enumerated folder (see fs::FolderReader), so that only the items around the current one exist at any time and even folders with hundreds of files open instantly.
          
             TODO and some options, such as sorting, etc.
             TODO add icon settings for different file types
             TODO add decorator support as well
          */
         static unique_ptr<ui::Menu> folderMenuGenerator(FileActionEvent fileAction, String folder, fs::Drive drive, FileFilter filter = nullptr) {
-            auto result = std::make_unique<ui::Menu>();
-            fs::readFolder(folder, drive, [fileAction, folder, drive, filter, & result](fs::FolderEntry const & entry) {
-                if (entry.isFolder) {
-                    (*result)
-                      << ui::MenuItem::Generator(entry.name, assets::icons_64::folder, [fileAction, filter, path = fs::join(folder, entry.name), drive]() {
-                            return folderMenuGenerator(fileAction, path, drive, filter);
-                        });
-                } else if (filter == nullptr || filter(fs::join(folder, entry.name))) {
-                    result->emplace_back(entry.name, assets::icons_64::poo, [fileAction, path = fs::join(folder, entry.name)]() {
-                        fileAction(path);
-                    });
-                } 
-            });
-            return result;
+            return std::make_unique<ui::Menu>(unique_ptr<ui::Menu::Source>{new FolderMenuSource{std::move(fileAction), std::move(folder), drive, std::move(filter)}});
         }
 
         static bool audioFileFilter(String const & path) {
@@ -76,6 +65,86 @@ namespace rckid {
         }
 
     private:
+
+        /** Virtual menu source over folder entries. 
+         
+            Folders are always shown, files only if they pass the filter. The items are in the order of the folder entries, i.e. not sorted. The folder is read once when the source is created to count the items, remembering the folder entry of every ANCHOR_INTERVAL-th item on the way. The source also remembers the last found item and its folder entry and continues from there for subsequent items, while going back, or far ahead, starts from the closest remembered item before the requested one, so that each item takes at most ANCHOR_INTERVAL items to find regardless of the folder size.
+         */
+        class FolderMenuSource : public ui::Menu::Source {
+        public:
+            static constexpr uint32_t ANCHOR_INTERVAL = 16;
+
+            FolderMenuSource(FileActionEvent fileAction, String folder, fs::Drive drive, FileFilter filter):
+                fileAction_{std::move(fileAction)},
+                folder_{std::move(folder)},
+                drive_{drive},
+                filter_{std::move(filter)},
+                reader_{fs::openFolder(folder_, drive_)} {
+                if (reader_ == nullptr)
+                    return;
+                fs::FolderEntry entry;
+                for (uint32_t i = 0; reader_->entryAt(i, entry); ++i) {
+                    if (! accepts(entry))
+                        continue;
+                    if (size_ % ANCHOR_INTERVAL == 0)
+                        anchors_.push_back(i);
+                    ++size_;
+                }
+            }
+
+            uint32_t size() override { return size_; }
+
+            ui::MenuItem itemAt(uint32_t index) override {
+                if (reader_ != nullptr && index < size_) {
+                    if (index < nextItem_ || index >= nextItem_ + ANCHOR_INTERVAL) {
+                        nextItem_ = index / ANCHOR_INTERVAL * ANCHOR_INTERVAL;
+                        nextEntry_ = anchors_[index / ANCHOR_INTERVAL];
+                    }
+                    fs::FolderEntry entry;
+                    while (reader_->entryAt(nextEntry_++, entry)) {
+                        if (! accepts(entry))
+                            continue;
+                        if (nextItem_++ == index)
+                            return createItem(entry);
+                    }
+                }
+                // the folder has changed since it was opened
+                LOG(LL_ERROR, "Folder item " << index << " not found in " << folder_);
+                return ui::MenuItem{"?", assets::icons_64::poo, []() {}};
+            }
+
+        private:
+
+            bool accepts(fs::FolderEntry const & entry) const {
+                return entry.isFolder || filter_ == nullptr || filter_(fs::join(folder_, entry.name));
+            }
+
+            ui::MenuItem createItem(fs::FolderEntry const & entry) const {
+                if (entry.isFolder) {
+                    return ui::MenuItem::Generator(entry.name, assets::icons_64::folder, [fileAction = fileAction_, filter = filter_, path = fs::join(folder_, entry.name), drive = drive_]() {
+                        return folderMenuGenerator(fileAction, path, drive, filter);
+                    });
+                } else {
+                    return ui::MenuItem{entry.name, assets::icons_64::poo, [fileAction = fileAction_, path = fs::join(folder_, entry.name)]() {
+                        fileAction(path);
+                    }};
+                }
+            }
+
+            FileActionEvent fileAction_;
+            String folder_;
+            fs::Drive drive_;
+            FileFilter filter_;
+            unique_ptr<fs::FolderReader> reader_;
+            uint32_t size_ = 0;
+            // folder entries of every ANCHOR_INTERVAL-th item
+            std::vector<uint32_t> anchors_;
+            // index of the next item and the folder entry to start looking for it from
+            uint32_t nextItem_ = 0;
+            uint32_t nextEntry_ = 0;
+
+        }; // FileBrowser::FolderMenuSource
+
         Launcher::BorrowedCarousel * carousel_;
 
     }; // rckid::FileBrowser
@@ -3,6 +3,7 @@
 #include <rckid/ui/app.h>
 #include <rckid/ui/label.h>
 #include <rckid/ui/image.h>
+#include <rckid/ui/layout.h>
 #include <rckid/ui/animation.h>
 
 #include <rckid/apps/dialogs/info_dialog.h>
@@ -31,25 +32,22 @@ namespace rckid {
                 state_.load(reader);
                 checkTopUp();
             }
-            // when not available, show error message and exit the app
-            icon_ = addChild(new Image())
-                << SetRect(Rect::XYWH(0, 50, 320, 64))
+            // the icon, ballance and next top up row are stacked in a column below each other
+            Stack * layout = addChild(new Stack{})
+                << SetRect(Rect::XYWH(0, 50, 320, 160))
+                << SetVAlign(VAlign::Top);
+            icon_ = layout->addChild(new Image())
                 << SetBitmap(assets::icons_64::piggy_bank);
-            ballance_ = addChild(new Label())
-                << SetRect(Rect::XYWH(0, 120, 320, 64))
+            ballance_ = layout->addChild(new Label())
                 << SetText("300")
-                << SetFont(assets::OpenDyslexic64)
-                << SetHAlign(HAlign::Center);
-            nextTopUp_ = addChild(new Label())
-                << SetRect(Rect::XYWH(0, 0, 320, 32))
-                << SetHAlign(HAlign::Left)
+                << SetFont(assets::OpenDyslexic64);
+            Stack * topUpRow = layout->addChild(new Stack{Stack::Orientation::Row})
+                << SetSpacing(8);
+            topUp_ = topUpRow->addChild(new Image())
+                << SetBitmap(assets::icons_24::money_bag);
+            nextTopUp_ = topUpRow->addChild(new Label())
                 << SetText(STR(state_.allowance << " in " << daysTillTopUp_ << " days"))
                 << SetFont(assets::OpenDyslexic32);
-            topUp_ = addChild(new Image())
-                << SetRect(Rect::XYWH((320 - 30 - nextTopUp_->textWidth()) / 2, 170, 32, 32))
-                << SetBitmap(assets::icons_24::money_bag);
-            with(nextTopUp_)
-                << RightOf(topUp_);
         }
 
         ~PiggyBank() override {
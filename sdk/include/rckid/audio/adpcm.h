@@ -0,0 +1,136 @@
+#pragma once
+
+#include <rckid/rckid.h>
+#include <rckid/memory.h>
+#include <rckid/stream.h>
+#include <rckid/audio/decoder_stream.h>
+#include <rckid/audio/wav.h>
+
+namespace rckid::audio {
+
+    /** IMA-ADPCM codec state of a single channel.
+
+        Each 16bit sample is encoded as a 4bit difference from the predicted value, scaled by an adaptive step size. The encoder tracks the decoder's state so that both stay in sync.
+     */
+    struct ADPCMState {
+        int16_t predictor = 0;
+        uint8_t stepIndex = 0;
+
+        uint8_t encode(int16_t sample);
+
+        int16_t decode(uint8_t nibble);
+    }; // rckid::audio::ADPCMState
+
+    /** Streaming IMA-ADPCM encoder that writes mono WAV files.
+
+        Samples are encoded as they arrive, directly into the write buffer, so that the encoder only needs the write buffer itself (4kB). The buffer is written to the stream in whole 4kB chunks, which the SD card handles much better than the many small writes of the raw samples. The compression is 4:1, i.e. 4kB per second of 8kHz audio.
+
+        The WAV header is written when the encoder is created, and rewritten with the actual sizes by finish(), which is why the output must be a random access stream. The last block is padded to full size, the fact chunk contains the actual number of samples.
+     */
+    class ADPCMEncoder {
+    public:
+
+        static constexpr uint32_t BLOCK_SIZE = 512;
+        static constexpr uint32_t SAMPLES_PER_BLOCK = (BLOCK_SIZE - 4) * 2 + 1;
+        static constexpr uint32_t WRITE_BUFFER_SIZE = BLOCK_SIZE * 8;
+        static constexpr uint32_t HEADER_SIZE = 60;
+
+        ADPCMEncoder(RandomWriteStream & out, uint32_t sampleRate);
+
+        ADPCMEncoder(ADPCMEncoder const &) = delete;
+
+        /** Encodes given mono samples.
+         */
+        void encode(int16_t const * samples, uint32_t numSamples);
+
+        /** Pads and writes the last block and updates the header. No more samples can be encoded afterwards.
+         */
+        void finish();
+
+        uint32_t sampleRate() const { return sampleRate_; }
+
+        /** Number of samples encoded so far.
+         */
+        uint32_t samples() const { return samples_; }
+
+        /** Number of bytes written to the stream so far (excluding the header).
+         */
+        uint32_t bytesWritten() const { return bytesWritten_; }
+
+    private:
+
+        void writeHeader();
+
+        void flush();
+
+        RandomWriteStream & out_;
+        uint32_t sampleRate_;
+        ADPCMState state_;
+        unique_ptr<uint8_t> buffer_;
+        uint32_t bufferSize_ = 0;
+        // index of the next sample within the current block
+        uint32_t blockSample_ = 0;
+        uint32_t samples_ = 0;
+        uint32_t bytesWritten_ = 0;
+        bool finished_ = false;
+
+    }; // rckid::audio::ADPCMEncoder
+
+    /** Decoder stream for IMA-ADPCM WAV files (mono or stereo), such as those written by the ADPCMEncoder.
+
+        The samples are decoded one block at a time, the block buffer is the only memory needed in addition to the playback buffers. Mono files are played on both channels.
+     */
+    class ADPCMDecoderStream : public DecoderStream {
+    public:
+
+        static constexpr uint32_t BUFFER_STEREO_SAMPLES = 1024;
+
+        ADPCMDecoderStream(unique_ptr<ReadStream> input, uint32_t numBuffers = 4);
+
+        /** Creates the decoder for stream whose WAV header has already been read.
+         */
+        ADPCMDecoderStream(unique_ptr<ReadStream> input, WAVFormat const & format, uint32_t numBuffers = 4);
+
+        ADPCMDecoderStream(ADPCMDecoderStream const &) = delete;
+
+        uint32_t sampleRate() const override { return sampleRate_; }
+
+        /** Returns true if the stream is a supported IMA-ADPCM WAV file.
+         */
+        bool valid() const { return block_ != nullptr; }
+
+        uint32_t channels() const { return channels_; }
+
+        /** Total number of samples per channel in the file, as stated by its fact chunk.
+         */
+        uint32_t samples() const { return samples_; }
+
+    protected:
+
+        uint32_t refillSamples(int16_t * buffer, uint32_t numStereoSamples) override;
+
+    private:
+
+        bool initialize(WAVFormat const & format);
+
+        bool readBlock();
+
+        int16_t decodeSample(uint32_t channel);
+
+        unique_ptr<ReadStream> in_;
+        unique_ptr<uint8_t> block_;
+        uint32_t blockAlign_ = 0;
+        uint32_t channels_ = 0;
+        uint32_t sampleRate_ = 0;
+        uint32_t samples_ = 0;
+        // samples still to be decoded and bytes of the data chunk still to be read
+        uint32_t remaining_ = 0;
+        uint32_t dataRemaining_ = 0;
+        // position within the current block and the number of samples in it
+        uint32_t blockSample_ = 0;
+        uint32_t blockSamples_ = 0;
+        ADPCMState state_[2];
+
+    }; // rckid::audio::ADPCMDecoderStream
+
+} // namespace rckid::audio
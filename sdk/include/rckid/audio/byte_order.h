@@ -0,0 +1,39 @@
+#pragma once
+
+#include <rckid/rckid.h>
+
+/** Little and big endian integers in the headers of the audio file formats, shared by the decoders and encoders.
+ */
+namespace rckid::audio::internal {
+
+    inline uint16_t le16(uint8_t const * x) {
+        return static_cast<uint16_t>(x[0] | (x[1] << 8));
+    }
+
+    inline uint32_t le32(uint8_t const * x) {
+        return static_cast<uint32_t>(x[0]) | (static_cast<uint32_t>(x[1]) << 8) | (static_cast<uint32_t>(x[2]) << 16) | (static_cast<uint32_t>(x[3]) << 24);
+    }
+
+    inline void setLe16(uint8_t * x, uint16_t value) {
+        x[0] = static_cast<uint8_t>(value);
+        x[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    inline void setLe32(uint8_t * x, uint32_t value) {
+        for (uint32_t i = 0; i < 4; ++i)
+            x[i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+
+    inline uint16_t be16(uint8_t const * x) {
+        return static_cast<uint16_t>((x[0] << 8) | x[1]);
+    }
+
+    inline uint32_t be32(uint8_t const * x) {
+        return (static_cast<uint32_t>(x[0]) << 24) | (static_cast<uint32_t>(x[1]) << 16) | (static_cast<uint32_t>(x[2]) << 8) | static_cast<uint32_t>(x[3]);
+    }
+
+    inline uint64_t be64(uint8_t const * x) {
+        return (static_cast<uint64_t>(be32(x)) << 32) | be32(x + 4);
+    }
+
+} // namespace rckid::audio::internal
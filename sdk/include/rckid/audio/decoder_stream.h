@@ -3,18 +3,110 @@
 #include <rckid/task.h>
 #include <rckid/buffer.h>
 #include <rckid/filesystem.h>
+#include <rckid/audio/stats.h>
+#include <rckid/audio/dsp.h>
 
 namespace rckid::audio {
 
+    /** Base class for streams that decode audio files into stereo 16bit samples for playback.
+
+        Decoders for the different formats are kept in a registry. Each decoder is registered with the file extension it handles and optionally with magic bytes found at a fixed offset at the beginning of its files. When opening a file, the first decoder whose magic bytes match is used, regardless of the file extension. Only if no magic bytes match is the decoder selected by the extension. The built-in decoders (WAV PCM & IMA-ADPCM, QOA, Ogg Opus and MP3) are registered first, apps can register their own decoders via registerDecoder(). The decoders are tried in the reverse order of their registration, so that the app decoders take precedence over the built-in ones.
+
+        The magic bytes of the built-in decoders are specific to the codec, not just to the container, e.g. Ogg Opus files are recognized by the Opus identification header in the first Ogg page, so that other codecs in the same container (such as Ogg Vorbis) can be registered by their own magic bytes.
+     */
     class DecoderStream {
     public:
 
+        /** Creates the decoder for the given stream, or returns nullptr if the stream is not valid.
+         */
+        using Factory = unique_ptr<DecoderStream> (*)(unique_ptr<RandomReadStream> input);
+
+        /** Maximum end of the magic bytes (their offset plus length) in the file.
+         */
+        static constexpr uint32_t MAX_MAGIC_END = 40;
+
+        /** Registers decoder for the given file extension (including the dot, e.g. ".mp3"). The magic bytes are optional, when nullptr, the decoder is only selected by the extension.
+         */
+        static void registerDecoder(char const * extension, char const * magic, uint32_t magicOffset, Factory factory);
+
         static unique_ptr<DecoderStream> fromFile(String const & path, fs::Drive drive);
 
+        /** Creates decoder for the given stream, the path is only used to determine the extension if the stream has no magic bytes known to the registry.
+         */
+        static unique_ptr<DecoderStream> fromStream(unique_ptr<RandomReadStream> input, String const & path);
+
         virtual ~DecoderStream() = default;
 
         virtual uint32_t sampleRate() const = 0;
 
+        /** Returns true if the stream supports seeking.
+         */
+        virtual bool seekable() const { return false; }
+
+        /** Returns the duration of the stream in milliseconds, or 0 if not known.
+         */
+        virtual uint32_t durationMs() const { return 0; }
+
+        /** Called by fromFile() with the path of the decoded file, so that decoders can keep auxiliary data, such as seek indices, next to it.
+         */
+        virtual void attachFile([[maybe_unused]] String const & path, [[maybe_unused]] fs::Drive drive) {}
+
+        /** Returns the ReplayGain stored in the stream's tags, if any.
+         */
+        virtual ReplayGain replayGain() const { return ReplayGain{}; }
+
+        /** Sets the DSP chain that processes the samples as they are decoded, with the stream's gain in 1/4096ths (see DSP::gain()). The chain is not owned by the stream and can be shared by several streams, nullptr disables the processing. Already decoded buffers are not affected.
+         */
+        void setDSP(DSP * dsp, int32_t gain = DSP::UNITY_GAIN) {
+            dsp_ = dsp;
+            dspGain_ = gain;
+        }
+
+        DSP * dsp() const { return dsp_; }
+
+        /** Returns the playback position in milliseconds, i.e. the position of the samples already played, not just decoded.
+         */
+        uint32_t positionMs() const {
+            uint32_t rate = sampleRate();
+            return rate == 0 ? 0 : static_cast<uint32_t>(static_cast<uint64_t>(played_) * 1000 / rate);
+        }
+
+        /** Seeks to the given position in milliseconds.
+         
+            Discards all decoded samples, so the playback must be stopped while seeking and restarted afterwards (see Playback::seek()). The actual position may differ slightly, depending on the format. Returns false if the stream does not support seeking, in which case the position is left unchanged.
+         */
+        bool seek(uint32_t ms) {
+            if (! seekable())
+                return false;
+            uint32_t sample = static_cast<uint32_t>(static_cast<uint64_t>(ms) * sampleRate() / 1000);
+            if (! seekTo(sample))
+                return false;
+            playbackBuffer_.reset();
+            done_ = false;
+            played_ = sample;
+            inFlight_ = 0;
+            decoded_ = 0;
+            acquired_ = 0;
+            return true;
+        }
+
+        /** Returns true if the whole stream has been decoded, i.e. no more buffers will become ready.
+         */
+        bool done() const { return done_; }
+
+        /** Returns the number of buffers handed to the audio output and not returned yet.
+         */
+        uint32_t inFlight() const { return inFlight_; }
+
+        /** Returns true if the given buffer belongs to the stream.
+         */
+        bool owns(int16_t const * buffer) const { return playbackBuffer_.contains(buffer); }
+
+        /** Playback statistics of the stream.
+         */
+        StreamStats const & stats() const { return stats_; }
+        StreamStats & stats() { return stats_; }
+
         void update() {
             if (done_)
                 return;
@@ -22,7 +114,11 @@ namespace rckid::audio {
                 Buffer<int16_t> * buffer = playbackBuffer_.nextFree();
                 if (buffer == nullptr)
                     break;
+                uint32_t start = stats_.refillStarted();
                 buffer->setUsed(refillSamples(buffer->data(), playbackBuffer_.size() / 2));
+                if (dsp_ != nullptr && buffer->used() > 0)
+                    dsp_->process(buffer->data(), buffer->used(), sampleRate(), dspGain_);
+                stats_.refillFinished(start);
                 // break prematurely, if use bytes in the buffer is 0 (we are done decoding)
                 if (buffer->used() == 0) {
                     done_ = true;
@@ -31,20 +127,41 @@ namespace rckid::audio {
                     break;
                 }
                 playbackBuffer_.markReady(buffer);
+                decoded_ = decoded_ + 1;
             }
 
         }
 
         void callback(int16_t * & buffer, uint32_t & numStereoSamples) {
             if (buffer != nullptr)
-                playbackBuffer_.markFree(buffer);
+                release(buffer);
+            acquire(buffer, numStereoSamples);
+        }
+
+        /** Returns buffer previously obtained by acquire() after it has been played.
+         */
+        void release(int16_t * buffer) {
+            played_ = played_ + MultiBuffer<int16_t>::fromData(buffer)->used();
+            playbackBuffer_.markFree(buffer);
+            inFlight_ = inFlight_ - 1;
+            stats_.bufferReleased();
+        }
+
+        /** Obtains the next buffer to play, or nullptr if there is none ready.
+         */
+        void acquire(int16_t * & buffer, uint32_t & numStereoSamples) {
             Buffer<int16_t> * b = playbackBuffer_.nextReady();
             if (b == nullptr) {
                 buffer = nullptr;
                 numStereoSamples = 0;
+                if (! done_)
+                    stats_.bufferUnderrun();
             } else {
                 buffer = b->data();
                 numStereoSamples = b->used();
+                inFlight_ = inFlight_ + 1;
+                acquired_ = acquired_ + 1;
+                stats_.bufferAcquired(decoded_ - acquired_);
             }
         }
 
@@ -59,10 +176,23 @@ namespace rckid::audio {
          */
         virtual uint32_t refillSamples(int16_t * buffer, uint32_t numStereoSamples) = 0;
 
+        /** Moves the decoder to the given stereo sample, which should be updated to the actual position after the seek. Returns false if seeking failed. Only called when seekable() is true.
+         */
+        virtual bool seekTo([[maybe_unused]] uint32_t & sample) { return false; }
+
     private:
 
         MultiBuffer<int16_t> playbackBuffer_;
         bool done_ = false;
+        // stereo samples already played, updated from the audio callback when the buffers are returned
+        volatile uint32_t played_ = 0;
+        volatile uint32_t inFlight_ = 0;
+        // buffers decoded by update() and taken by acquire(), each written from one side only, their difference is the number of ready buffers
+        volatile uint32_t decoded_ = 0;
+        volatile uint32_t acquired_ = 0;
+        StreamStats stats_;
+        DSP * dsp_ = nullptr;
+        int32_t dspGain_ = DSP::UNITY_GAIN;
 
     }; // rckid::audio::DecoderStream
 
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <optional>
+
+#include <rckid/rckid.h>
+
+namespace rckid::audio {
+
+    /** ReplayGain loudness normalization of a track, as stored in its tags.
+
+        The gains are in dB and bring the track, or the whole album it belongs to, to the same reference loudness. Either may be missing.
+     */
+    struct ReplayGain {
+        std::optional<float> track;
+        std::optional<float> album;
+    }; // rckid::audio::ReplayGain
+
+    /** Second order IIR filter with the shelving and peaking responses from the RBJ audio EQ cookbook.
+
+        The coefficients are computed in floating point when the filter is configured and then stored as 32bit fixed point numbers with COEFF_BITS fractional bits, which leaves enough range for shelves of up to +12dB. The filter runs in direct form I with 64bit accumulators on samples with 8 extra fractional bits, so that the rounding errors, which are amplified by the feedback of low frequency filters, stay well below the 16bit output. The rounding error of each output is carried over to the next one (first order error feedback). The state is kept for both stereo channels.
+     */
+    class Biquad {
+    public:
+
+        enum class Type {
+            LowShelf,
+            HighShelf,
+            Peaking,
+        }; // rckid::audio::Biquad::Type
+
+        static constexpr uint32_t COEFF_BITS = 27;
+        static constexpr int64_t MAX_SAMPLE = 1 << 30;
+
+        /** Sets the filter's response. The frequency is the shelf's midpoint, or the peak's center, the Q determines the shelf's slope (0.707 for the steepest shelf without overshoot), or the peak's width.
+         */
+        void configure(Type type, uint32_t sampleRate, float frequency, float gainDb, float q);
+
+        /** Clears the filter's history, e.g. before an unrelated stream.
+         */
+        void reset() {
+            for (uint32_t i = 0; i < 2; ++i) {
+                x1_[i] = 0;
+                x2_[i] = 0;
+                y1_[i] = 0;
+                y2_[i] = 0;
+                err_[i] = 0;
+            }
+        }
+
+        /** Filters the next sample of the given channel. The sample has 8 fractional bits, the output is saturated to +/- 2^30, which leaves headroom for the rounding.
+         */
+        int32_t process(int32_t x, uint32_t channel) {
+            int64_t acc = static_cast<int64_t>(b0_) * x + static_cast<int64_t>(b1_) * x1_[channel] + static_cast<int64_t>(b2_) * x2_[channel]
+                        - static_cast<int64_t>(a1_) * y1_[channel] - static_cast<int64_t>(a2_) * y2_[channel] + err_[channel];
+            // the truncated fraction is added to the next sample so that the filter does not get stuck at a small constant output when the input stops
+            err_[channel] = static_cast<int32_t>(acc & ((1 << COEFF_BITS) - 1));
+            int32_t y = static_cast<int32_t>(std::clamp(acc >> COEFF_BITS, - MAX_SAMPLE, MAX_SAMPLE));
+            x2_[channel] = x1_[channel];
+            x1_[channel] = x;
+            y2_[channel] = y1_[channel];
+            y1_[channel] = y;
+            return y;
+        }
+
+        int32_t b0() const { return b0_; }
+        int32_t b1() const { return b1_; }
+        int32_t b2() const { return b2_; }
+        int32_t a1() const { return a1_; }
+        int32_t a2() const { return a2_; }
+
+    private:
+        // normalized so that a0 is 1, identity filter by default
+        int32_t b0_ = 1 << COEFF_BITS;
+        int32_t b1_ = 0;
+        int32_t b2_ = 0;
+        int32_t a1_ = 0;
+        int32_t a2_ = 0;
+        int32_t x1_[2] = { 0, 0 };
+        int32_t x2_[2] = { 0, 0 };
+        int32_t y1_[2] = { 0, 0 };
+        int32_t y2_[2] = { 0, 0 };
+        int32_t err_[2] = { 0, 0 };
+
+    }; // rckid::audio::Biquad
+
+    /** Fixed point DSP chain for the playback of decoded streams.
+
+        The samples first get the stream's gain, which combines its ReplayGain (see gain()) with the preamp, then go through up to MAX_BANDS equalizer bands and finally through the limiter, which keeps the boosted samples within the 16bit range. The limiter is transparent below LIMITER_THRESHOLD and above it bends the samples smoothly towards full scale, which is never reached, as y = T + R * d / (d + R) where T is the threshold, d is how much the sample is above it and R = 32767 - T. Only samples above the threshold need the division. When disabled, the samples are just saturated.
+
+        The chain is attached to decoder streams (see DecoderStream::setDSP()), which process each buffer as it is decoded, i.e. in the main loop and never in the audio callback. Streams decoded one after another share the filter state, so that the gapless transitions between tracks stay seamless. The filters are recomputed and their state cleared when a stream of different sample rate comes. When there is nothing to do (unity gain and no bands), the samples are not touched at all.
+
+        Each active band costs 5 multiply-accumulates per sample and channel, see the test cartridge's benchmark for the cycles per sample.
+     */
+    class DSP {
+    public:
+
+        enum class ReplayGainMode {
+            Off,
+            Track,
+            Album,
+        }; // rckid::audio::DSP::ReplayGainMode
+
+        static constexpr uint32_t MAX_BANDS = 4;
+        static constexpr float MAX_BAND_GAIN_DB = 12;
+        /** Range of the total gain (ReplayGain and preamp) in dB. ReplayGain of very quiet tracks can be much higher, which would only boost their noise.
+         */
+        static constexpr float MIN_GAIN_DB = -24;
+        static constexpr float MAX_GAIN_DB = 12;
+        /** Unity of the stream gain, which is in 1/4096ths.
+         */
+        static constexpr int32_t UNITY_GAIN = 4096;
+        /** Samples below ~-2.5dBFS are not changed by the limiter.
+         */
+        static constexpr int32_t LIMITER_THRESHOLD = 24576;
+
+        /** Sets the equalizer band at given index. Bands with 0dB gain are skipped. The gain is clamped to +/- MAX_BAND_GAIN_DB.
+         */
+        void setBand(uint32_t index, Biquad::Type type, float frequency, float gainDb, float q = 0.707f);
+
+        /** Changes the gain of already set band, e.g. from the equalizer settings.
+         */
+        void setBandGain(uint32_t index, float gainDb) {
+            ASSERT(index < numBands_);
+            setBand(index, bands_[index].type, bands_[index].frequency, gainDb, bands_[index].q);
+        }
+
+        float bandGain(uint32_t index) const {
+            ASSERT(index < numBands_);
+            return bands_[index].gainDb;
+        }
+
+        uint32_t numBands() const { return numBands_; }
+
+        void clearBands() {
+            numBands_ = 0;
+            numActive_ = 0;
+        }
+
+        /** Gain applied to all streams on top of their ReplayGain, in dB. Since ReplayGain mostly lowers the volume to the reference loudness, some preamp makes up for it.
+         */
+        float preamp() const { return preampDb_; }
+        void setPreamp(float db) { preampDb_ = db; }
+
+        ReplayGainMode replayGainMode() const { return mode_; }
+        void setReplayGainMode(ReplayGainMode mode) { mode_ = mode; }
+
+        bool limiter() const { return limiter_; }
+        void setLimiter(bool enabled) { limiter_ = enabled; }
+
+        /** Returns the gain for a stream with the given ReplayGain in 1/4096ths. The album gain falls back to the track gain and vice versa, streams without either only get the preamp.
+         */
+        int32_t gain(ReplayGain const & replayGain) const;
+
+        /** Processes the stereo samples in place with the given stream gain.
+         */
+        void process(int16_t * buffer, uint32_t numStereoSamples, uint32_t sampleRate, int32_t gain);
+
+        /** Clears the state of the filters.
+         */
+        void reset() {
+            for (uint32_t i = 0; i < numBands_; ++i)
+                filters_[i].reset();
+        }
+
+        /** The limiter's transfer function for a single sample, see the class description.
+         */
+        static int16_t limit(int32_t x) {
+            if (x > LIMITER_THRESHOLD)
+                return static_cast<int16_t>(LIMITER_THRESHOLD + limitAbove(x - LIMITER_THRESHOLD));
+            if (x < -LIMITER_THRESHOLD)
+                return static_cast<int16_t>(- LIMITER_THRESHOLD - limitAbove(- LIMITER_THRESHOLD - x));
+            return static_cast<int16_t>(x);
+        }
+
+    private:
+
+        static constexpr int32_t LIMITER_RANGE = 32767 - LIMITER_THRESHOLD;
+
+        static int32_t limitAbove(int32_t d) {
+            return static_cast<int32_t>(static_cast<int64_t>(LIMITER_RANGE) * d / (static_cast<int64_t>(d) + LIMITER_RANGE));
+        }
+
+        struct Band {
+            Biquad::Type type;
+            float frequency;
+            float gainDb;
+            float q;
+        };
+
+        /** Recomputes the coefficients of the active filters for the current sample rate and clears their state.
+         */
+        void configure();
+
+        Band bands_[MAX_BANDS];
+        Biquad filters_[MAX_BANDS];
+        uint32_t numBands_ = 0;
+        // indices of the bands with non-zero gain, in order
+        uint32_t active_[MAX_BANDS];
+        uint32_t numActive_ = 0;
+        uint32_t sampleRate_ = 0;
+        float preampDb_ = 0;
+        ReplayGainMode mode_ = ReplayGainMode::Track;
+        bool limiter_ = true;
+
+    }; // rckid::audio::DSP
+
+} // namespace rckid::audio
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <rckid/rckid.h>
+#include <rckid/memory.h>
+#include <rckid/audio/decoder_stream.h>
+
+namespace rckid::audio {
+
+    /** Audio sample in memory, such as a short sound effect stored in the cartridge flash.
+
+        The sample data is not owned and must outlive any mixer voice that plays it. Mono samples are played on both channels, stereo samples are interleaved.
+     */
+    struct Sample {
+        int16_t const * data = nullptr;
+        // number of samples per channel
+        uint32_t length = 0;
+        uint32_t sampleRate = 0;
+        bool stereo = false;
+    }; // rckid::audio::Sample
+
+    /** Software mixer that plays multiple streams and in-memory samples at once.
+
+        The audio output supports only a single producer, so the mixer is itself a decoder stream whose samples are the mix of all its voices and which is played via audio::play(DecoderStream *) like any other stream. Each voice plays either a decoder stream (owned by the voice), or an in-memory sample, optionally looped, with its own volume and pan.
+
+        As with the other decoder streams, the mixing happens in update(), which must be called regularly from the main loop (e.g. in the app's loop()), while the audio callback only hands over the already mixed buffers. All voice functions must therefore be called from the main loop as well. The latency of voice changes is given by the number and size of the mixer buffers, ~23ms with the defaults at 44.1kHz.
+
+        Voices whose sample rate differs from the mixer's are resampled with linear interpolation, or nearest neighbour if interpolation is disabled. Voices at the mixer's sample rate take a faster path that simply adds the samples. The voices are mixed into a 32bit accumulator which is saturated to 16bits when the buffer is complete, so that loud voices clip instead of wrapping around.
+     */
+    class Mixer : public DecoderStream {
+    public:
+
+        static constexpr uint32_t BUFFER_STEREO_SAMPLES = 256;
+
+        /** Volume at which the voice is played unchanged. Volumes above amplify the voice.
+         */
+        static constexpr uint32_t VOLUME_FULL = 256;
+
+        Mixer(uint32_t sampleRate, uint32_t numVoices = 8, uint32_t numBuffers = 4);
+
+        Mixer(Mixer const &) = delete;
+
+        uint32_t sampleRate() const override { return sampleRate_; }
+
+        uint32_t numVoices() const { return static_cast<uint32_t>(voices_.size()); }
+
+        /** Plays the stream on the given voice, replacing anything the voice was playing. The voice stops when the stream is fully played.
+         */
+        void play(uint32_t voice, unique_ptr<DecoderStream> stream);
+
+        /** Plays the in-memory sample on the given voice, replacing anything the voice was playing.
+         */
+        void play(uint32_t voice, Sample const & sample, bool loop = false);
+
+        void stop(uint32_t voice);
+
+        bool isPlaying(uint32_t voice) const;
+
+        /** Returns the first voice that is not playing, or numVoices() if all voices are busy.
+         */
+        uint32_t freeVoice() const;
+
+        /** Sets the voice volume, VOLUME_FULL being the original volume and up to 4 times VOLUME_FULL. The volume is kept when the voice starts playing something else.
+         */
+        void setVolume(uint32_t voice, uint32_t volume);
+
+        /** Sets the voice pan from -128 (left only) to 127 (right only), 0 plays both channels at full volume.
+         */
+        void setPan(uint32_t voice, int8_t pan);
+
+        bool interpolation() const { return interpolation_; }
+
+        /** Enables or disables the linear interpolation of resampled voices.
+         */
+        void setInterpolation(bool value) { interpolation_ = value; }
+
+    protected:
+
+        uint32_t refillSamples(int16_t * buffer, uint32_t numStereoSamples) override;
+
+    private:
+
+        struct Voice {
+            unique_ptr<DecoderStream> stream;
+            // stream buffer being mixed, returned to the stream when fully used
+            int16_t * buffer = nullptr;
+            // current chunk of the source, i.e. the stream buffer, or the whole sample
+            int16_t const * data = nullptr;
+            uint32_t length = 0;
+            bool stereo = false;
+            Sample sample;
+            bool loop = false;
+            bool active = false;
+            // position in the current chunk, the fraction is in 1/65536ths of a sample
+            uint32_t pos = 0;
+            uint32_t frac = 0;
+            // source samples per output sample in 16.16 fixed point
+            uint32_t step = 0;
+            // last sample of the previous chunk for the interpolation across chunk boundaries
+            int32_t lastLeft = 0;
+            int32_t lastRight = 0;
+            uint32_t volume = VOLUME_FULL;
+            int8_t pan = 0;
+            int32_t gainLeft = VOLUME_FULL;
+            int32_t gainRight = VOLUME_FULL;
+        };
+
+        void start(Voice & v, uint32_t sourceRate);
+
+        /** Stops the voice and returns the stream buffer it holds, if any, deleting the stream.
+         */
+        void finish(Voice & v);
+
+        /** Moves the voice to the next chunk of its source. Returns false if there is none, either because the voice has finished, or because its stream has no decoded buffer ready.
+         */
+        bool nextChunk(Voice & v);
+
+        void updateGain(Voice & v);
+
+        void mixVoice(Voice & v, int32_t * acc, uint32_t n);
+
+        uint32_t sampleRate_;
+        std::vector<Voice> voices_;
+        unique_ptr<int32_t> acc_;
+        bool interpolation_ = true;
+
+    }; // rckid::audio::Mixer
+
+} // namespace rckid::audio
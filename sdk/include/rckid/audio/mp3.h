@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <libhelix-mp3/mp3dec.h>
 
 #include <rckid/rckid.h>
@@ -9,23 +11,43 @@
 
 namespace rckid::audio {
 
+    /** Decoder stream for MP3 files using libhelix.
+
+        The input is kept in a ring buffer that is refilled by whole SD card blocks (multiples of 512 bytes), so that the file reads stay block aligned and the unconsumed data never has to be moved. The decoder needs each frame in contiguous memory, which is why the ring buffer is followed by a tail window that mirrors the beginning of the ring. A frame that starts near the end of the ring continues in the tail window. The window is large enough for the largest MP3 frame (1441 bytes at 320kbps and 32kHz).
+
+        Before decoding, the frame header is parsed to get the frame length so that the decoder is only called once the whole frame is in the buffer, instead of retrying after input underflows.
+
+        When created from a random access stream, the decoder supports seeking. If the first frame contains a Xing (or Info) or VBRI header, its table of contents is used to jump straight to the approximate position. Otherwise the decoder keeps an index with the offset of every INDEX_INTERVAL-th frame, which is filled in as the file is decoded. Seeking to an indexed frame then only needs to skip at most INDEX_INTERVAL frame headers from the closest indexed frame. Seeking up to MAX_SCAN_FRAMES past the indexed part scans the frame headers, which extends the index. Farther seeks do not read the file up to the target, but jump to the offset extrapolated from the indexed part (or from the bitrate), which is exact for constant bitrate files and approximate otherwise. The index is not extended after such jump, until a seek back to the indexed part. Once complete, the index is stored next to the file (with .idx extension appended) if the decoder was created via DecoderStream::fromFile(), so that the scan happens only once per file.
+
+        For gapless playback, the Xing/VBRI frame, which would decode as silence, is not output. If the Xing header is followed by a LAME (or libavcodec) tag, the encoder delay and padding it stores are trimmed as well, together with the decoder delay of 529 samples, so that only the original samples are output. Positions and durations are in the trimmed samples. After a seek, the decoder's bit reservoir is empty and the first frame(s) that depend on it are decoded as silence.
+
+        The ReplayGain is read from the REPLAYGAIN_TRACK_GAIN and REPLAYGAIN_ALBUM_GAIN TXXX frames of the ID3v2.3 and 2.4 tags, as written by most taggers, or from the LAME tag. Frames that do not fit in the tail window (such as embedded cover art) are skipped without being read.
+     */
     class MP3DecoderStream : public DecoderStream {
     public:
+
+        static constexpr uint32_t RING_SIZE = 4096;
+        static constexpr uint32_t TAIL_SIZE = 2048;
+        static constexpr uint32_t BLOCK_SIZE = 512;
+        /** Number of frames between two frame index entries (~3 seconds at 44.1kHz, so that an hour long audiobook needs a ~4.5kB index).
+         */
+        static constexpr uint32_t INDEX_INTERVAL = 128;
+        /** Delay of the decoder's synthesis filterbank in samples, as assumed by the LAME tag.
+         */
+        static constexpr uint32_t DECODER_DELAY = 529;
+
         MP3DecoderStream(unique_ptr<ReadStream> input, uint32_t numBuffers = 8):
-            DecoderStream{1152 * 4, numBuffers},
-            in_{std::move(input)}, 
-            buffer_{new uint8_t[MP3_BUFFER_SIZE]},
-            dec_{MP3InitDecoder()} {
-            // initially fill the buffer
-            bufferSize_ = in_->read(buffer_, MP3_BUFFER_SIZE);
-            // and skip the ID3 tag, if any - this is necessary for the decoder to work properly
-            skipID3v2Tags();
-            // get next frame infor for sample rate
-            int32_t sw = ensureFrameInBuffer();
-            if (sw >= 0)
-                err_ = MP3GetNextFrameInfo(dec_, &fInfo_, buffer_ + sw);
-            else
-                err_ = sw;
+            MP3DecoderStream{nullptr, std::move(input), numBuffers} {
+        }
+
+        /** Maximum number of frames past the indexed part that are scanned when seeking, farther seeks jump to an estimated offset (~13 seconds at 44.1kHz).
+         */
+        static constexpr uint32_t MAX_SCAN_FRAMES = 4 * INDEX_INTERVAL;
+
+        /** Creates seekable decoder stream.
+         */
+        MP3DecoderStream(unique_ptr<RandomReadStream> input, uint32_t numBuffers = 8):
+            MP3DecoderStream{input.get(), std::move(input), numBuffers} {
         }
 
         MP3DecoderStream(MP3DecoderStream const &) = delete;
@@ -38,25 +60,29 @@ namespace rckid::audio {
         uint32_t refillSamples(int16_t * buffer, [[maybe_unused]] uint32_t numSamples) override {
             // we don't expect to be called with less free space than one full frame
             ASSERT(numSamples >= 1152);
-            uint32_t res = 0;
-            while (res == 0) {
-                res = decodeNextFrame(buffer);
-                if ((res == 0) && eof())
+            while (true) {
+                // decoded position of the frame, only keep the samples between the skip position and the end of the stream
+                uint32_t start = frame_ * samplesPerFrame_;
+                uint32_t n = decodeNextFrame(buffer) / 2;
+                if (n == 0 || start >= lastSample_)
                     return 0;
+                uint32_t end = std::min(start + n, lastSample_);
+                uint32_t from = std::max(start, skipUntil_);
+                if (from >= end)
+                    continue;
+                if (from > start)
+                    memmove(buffer, buffer + (from - start) * 2, (end - from) * 4);
+                return end - from;
             }
-            int32_t crc = 0;
-            for (uint32_t i = 0; i < res; ++i)
-                crc += buffer[i];
-            return res / 2;
         };
 
-        uint32_t sampleRate() const override { 
-            return fInfo_.samprate; 
+        uint32_t sampleRate() const override {
+            return fInfo_.samprate;
         }
 
         int lastError() const { return err_; }
 
-        bool eof() const { return eof_ && bufferSize_ == 0; }
+        bool eof() const { return eof_ && available() == 0; }
 
         uint32_t frames() const { return frames_; }
 
@@ -66,159 +92,278 @@ namespace rckid::audio {
 
         uint32_t bitrate() const { return fInfo_.bitrate; }
 
+        /** Number of bytes read from the input so far.
+         */
+        uint32_t bytesRead() const { return bytesRead_; }
+
+        bool seekable() const override { return random_ != nullptr; }
+
+        uint32_t durationMs() const override;
+
+        void attachFile(String const & path, fs::Drive drive) override;
+
+        ReplayGain replayGain() const override { return replayGain_; }
+
+        /** Returns true if the stream has a Xing/VBRI table of contents used for seeking.
+         */
+        bool hasTOC() const { return ! toc_.empty(); }
+
+        /** Returns true if the frame index covers the whole stream.
+         */
+        bool indexComplete() const { return indexComplete_; }
+
+        /** Loads the frame index previously saved by saveIndex(). Returns false if the index does not belong to the stream (its size differs), in which case the stream's index is left unchanged.
+         */
+        bool loadIndex(ReadStream & from);
+
+        /** Saves the frame index. Only complete indices should be saved.
+         */
+        void saveIndex(WriteStream & into) const;
+
+        /** Returns the length of the frame starting with the given header in bytes, or 0 if the header is not a valid MPEG Layer III header. For free format frames, whose length cannot be determined from the header, returns TAIL_SIZE.
+         */
+        static uint32_t frameLength(uint8_t const * header) {
+            static constexpr uint16_t bitrates[2][15] = {
+                { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 }, // MPEG 1
+                { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 }, // MPEG 2 & 2.5
+            };
+            static constexpr uint16_t sampleRates[3] = { 44100, 48000, 32000 };
+            // sync word, version (01 is reserved) and layer III
+            if (header[0] != 0xff || (header[1] & 0xe0) != 0xe0 || (header[1] & 0x18) == 0x08 || (header[1] & 0x06) != 0x02)
+                return 0;
+            uint32_t version = (header[1] >> 3) & 3; // 3 = MPEG 1, 2 = MPEG 2, 0 = MPEG 2.5
+            uint32_t bitrateIndex = header[2] >> 4;
+            uint32_t sampleRateIndex = (header[2] >> 2) & 3;
+            if (bitrateIndex == 15 || sampleRateIndex == 3)
+                return 0;
+            if (bitrateIndex == 0)
+                return TAIL_SIZE;
+            uint32_t sampleRate = sampleRates[sampleRateIndex] >> (version == 3 ? 0 : (version == 2 ? 1 : 2));
+            uint32_t padding = (header[2] >> 1) & 1;
+            if (version == 3)
+                return 144000 * bitrates[0][bitrateIndex] / sampleRate + padding;
+            return 72000 * bitrates[1][bitrateIndex] / sampleRate + padding;
+        }
+
     protected:
 
-        void skipID3v2Tags() {
-            // check for ID3v2 tag at the beginning of the stream
-            if (bufferSize_ >= 10 && buffer_[0] == 'I' && buffer_[1] == 'D' && buffer_[2] == '3') {
-                // size is stored in bytes 6-9 as "synchsafe integers"
-                uint32_t tagSize = (static_cast<uint32_t>(buffer_[6] & 0x7f) << 21) |
-                                   (static_cast<uint32_t>(buffer_[7] & 0x7f) << 14) |
-                                   (static_cast<uint32_t>(buffer_[8] & 0x7f) << 7)  |
-                                   (static_cast<uint32_t>(buffer_[9] & 0x7f) << 0);
-                tagSize += 10; // include header size
-                LOG(LL_MP3, "ID3v2 tag detected, size " << tagSize);
-                while (tagSize > 0) {
-                    if (tagSize > bufferSize_) {
-                        tagSize -= bufferSize_;
-                        bufferSize_ = in_->read(buffer_, MP3_BUFFER_SIZE);
-                        // this is eof, there is nothing more, return
-                        if (bufferSize_ == 0)
-                            return;
-                    } else {
-                        // tag is fully in the buffer
-                        memmove(buffer_, buffer_ + tagSize, bufferSize_ - tagSize);
-                        bufferSize_ -= tagSize;
-                        tagSize = 0;
-                    }
-                }
-            }
+        bool seekTo(uint32_t & sample) override;
+
+        /** Number of bytes in the ring buffer.
+         */
+        uint32_t available() const { return writePos_ - readPos_; }
+
+        /** Pointer to the first unconsumed byte.
+         */
+        uint8_t * window() { return buffer_ + (readPos_ % RING_SIZE); }
+
+        /** Number of unconsumed bytes available contiguously from window(), which is always at least TAIL_SIZE bytes, unless there is less data available in total.
+         */
+        uint32_t contiguous() const { return std::min(available(), RING_SIZE + TAIL_SIZE - (readPos_ % RING_SIZE)); }
+
+        void consume(uint32_t bytes) {
+            ASSERT(bytes <= available());
+            readPos_ += bytes;
         }
 
-        int32_t ensureFrameInBuffer() {
-            // we always start at the beginning of the buffer 
-            int32_t sw = -1;
+        /** Reads as many whole blocks from the input as fit in the ring buffer.
+
+            If the input returned less than requested, the write position is no longer block aligned. The next read then only goes up to the end of the ring, which aligns it again.
+         */
+        void fill() {
             while (! eof_) {
-                sw = MP3FindSyncWord(buffer_, bufferSize_);
-                // if we have found the sync word, progress to decoding
-                if (sw != -1)
+                uint32_t free = RING_SIZE - available();
+                if (free < BLOCK_SIZE)
                     break;
-                // otherwise read next chunk - we can completely throw what we have in the buffer because if there is no sync word, no need to worry about it. This should definitely be enough to hold an mp3 frame
-                bufferSize_ = in_->read(buffer_, 512 * 3);
-                //TRACE_MP3("buffer reset: " << bufferSize_);
-                // if nothing was read, we are done decoding
-                if (bufferSize_ == 0) {
+                uint32_t pos = writePos_ % RING_SIZE;
+                uint32_t size = std::min(free, RING_SIZE - pos);
+                if (size >= BLOCK_SIZE)
+                    size -= size % BLOCK_SIZE;
+                uint32_t rd = in_->read(buffer_ + pos, size);
+                LOG(LL_MP3, "buffer refill " << rd << " bytes (max " << size << "), at " << pos);
+                if (rd == 0) {
                     eof_ = true;
-                    return -1;
+                    break;
                 }
+                // mirror the beginning of the ring to the tail window
+                if (pos < TAIL_SIZE)
+                    memcpy(buffer_ + RING_SIZE + pos, buffer_ + pos, std::min(rd, TAIL_SIZE - pos));
+                writePos_ += rd;
+                bytesRead_ += rd;
             }
-            return sw;
         }
 
-        /** Decodes next frame in the mp3 stream and returns the number of samples read. Returning 0 signifies eof, or an error.
+        /** Skips the ID3v2 tag at the beginning of the stream, if any. ReplayGain is read from its TXXX frames on the way.
          */
-        uint32_t decodeNextFrame(int16_t * out) {
-            int32_t sw = ensureFrameInBuffer();
-            // if ensuring frame failed, we are at eof by definition and the rest of the buffer should be discarded
-            if (sw == -1) {
-                eof_ = true;
-                bufferSize_ = 0;
-                return 0;
+        void skipID3v2Tags();
+
+        /** Consumes the given number of bytes, refilling the ring buffer as needed.
+         */
+        void skip(uint32_t bytes) {
+            while (bytes > 0 && available() > 0) {
+                uint32_t n = std::min(bytes, available());
+                consume(n);
+                bytes -= n;
+                fill();
             }
-            LOG(LL_MP3, "Sync word at " << sw << ", bufferSize " << bufferSize_);
-            uint8_t * buf;
-            int remaining;
-            // we have found sync word, try decoding starting from the sync word
+        }
+
+        /** Finds next frame header and makes sure the whole frame is in the buffer. Returns the frame length, or 0 if there are no more frames.
+         */
+        uint32_t findFrame() {
             while (true) {
-                buf = buffer_ + sw;
-                remaining = bufferSize_ - sw;
-                LOG(LL_MP3, "Before: " << platform::hash(buffer_, bufferSize_));
-                err_ = MP3Decode(dec_, & buf,  & remaining, out, 0);
-                LOG(LL_MP3, "      : " << platform::hash(buffer_, bufferSize_));
-                LOG(LL_MP3, "Decoding: " << err_ << " buffer hash " << platform::hash(buffer_ + sw, bufferSize_ - sw - remaining) << ", output hash " << platform::hash((uint8_t *)out, 1152 * 4) << " remaining: " << remaining << ", sw: " << sw << ", bs: " << bufferSize_);
-                // input data underflow, read some more and try again - if refill buffer returns 0, we can't really refill thebufer and should terminate as there is no more data
-                // the same goes for free bitrate sync errors, just load more data so that the sync word can be found
-                switch (err_) {
-                    case ERR_MP3_NONE:
-                        ++frames_;
-                        // if there are data remaining, we must copy them to the beginning of the buffer 
-                        removeConsumedBytes(buf, remaining);
-                        refillBuffer();
-                        // and return the number of samples created
-                        MP3GetLastFrameInfo(dec_, &fInfo_);
-                        if (fInfo_.nChans == 1) {
-                            audio::convertToStereo(out, fInfo_.outputSamps);
-                            return fInfo_.outputSamps * 2;
-                        } else {
-                            return fInfo_.outputSamps;
-                        }
-                        break;
-                    case ERR_MP3_INDATA_UNDERFLOW:
-                        if (refillBuffer() > 0)
-                            continue;
-                        return 0;
-                    case ERR_MP3_FREE_BITRATE_SYNC:
-                        removeConsumedBytes(buf, remaining);
-                        refillBuffer();
-                        sw = MP3FindSyncWord(buffer_, bufferSize_);
-                        if (sw != -1)
-                            continue;
+                fill();
+                uint32_t avail = contiguous();
+                if (avail < 4)
+                    return 0;
+                int32_t sw = MP3FindSyncWord(window(), avail);
+                if (sw < 0) {
+                    // keep the last bytes as they may be the beginning of the sync word
+                    consume(avail - 3);
+                    if (eof_ && available() <= 3)
                         return 0;
-                    default:
-                        // on any other error, we should advance past the frame. 
-                        removeConsumedBytes(buf, remaining);
-                        refillBuffer();
-                        sw = MP3FindSyncWord(buffer_, bufferSize_);
-                        break;
+                    continue;
+                }
+                consume(sw);
+                fill();
+                if (contiguous() < 4)
+                    return 0;
+                uint32_t len = frameLength(window());
+                if (len == 0) {
+                    // false sync
+                    consume(1);
+                    continue;
+                }
+                // the ring has just been refilled so if the frame is not complete, we are at the end of the stream. Free format frames are decoded with whatever data we have
+                if (len > contiguous() && len != TAIL_SIZE)
+                    return 0;
+                return len;
+            }
+        }
+
+        /** Decodes next frame in the mp3 stream and returns the number of samples read. Returning 0 signifies eof, or an error.
+         */
+        uint32_t decodeNextFrame(int16_t * out) {
+            while (findFrame() > 0) {
+                indexFrame();
+                uint8_t * start = window();
+                uint8_t * buf = start;
+                int remaining = static_cast<int>(contiguous());
+                err_ = MP3Decode(dec_, & buf,  & remaining, out, 0);
+                LOG(LL_MP3, "Decoding: " << err_ << ", consumed " << static_cast<uint32_t>(buf - start) << ", remaining: " << remaining);
+                if (err_ == ERR_MP3_NONE) {
+                    ++frames_;
+                    ++frame_;
+                    consume(static_cast<uint32_t>(buf - start));
+                    MP3GetLastFrameInfo(dec_, &fInfo_);
+                    if (fInfo_.nChans == 1) {
+                        audio::convertToStereo(out, fInfo_.outputSamps);
+                        return fInfo_.outputSamps * 2;
+                    } else {
+                        return fInfo_.outputSamps;
+                    }
+                }
+                // the frame needs data from the bit reservoir, which is empty after seeking, output silence instead to keep the position
+                if (err_ == ERR_MP3_MAINDATA_UNDERFLOW) {
+                    ++frame_;
+                    consume(static_cast<uint32_t>(buf - start));
+                    memset(out, 0, samplesPerFrame_ * 4);
+                    return samplesPerFrame_ * 2;
                 }
+                // on error, skip past the frame (or at least the sync word) and try the next one
                 ++frameErrors_;
                 LOG(LL_MP3, "frame error: " << err_ << ", remaining " << remaining);
-                //return 0;
-                if (remaining == static_cast<int>(bufferSize_ - sw))
-                    remaining -= 3; // MP3 sync word length 
-                if (remaining < 0)
-                    remaining = 0;
-                // we have decoding error on our hands, hopefully this will be reflected in the samples
+                consume(std::max(static_cast<uint32_t>(buf - start), 1u));
             }
-            UNREACHABLE;
+            if (eof())
+                completeIndex();
             return 0;
         }
 
-        void removeConsumedBytes(uint8_t * buf, int remaining) {
-            if (remaining > 0)
-                memmove(buffer_, buf, remaining);
-            bufferSize_ = remaining;
-        }
+    private:
+
+        /** Seek point of the Xing/VBRI table of contents.
+         */
+        struct SeekPoint {
+            uint32_t frame;
+            uint32_t offset;
+        };
+
+        MP3DecoderStream(RandomReadStream * random, unique_ptr<ReadStream> input, uint32_t numBuffers);
+
+        /** Parses the Xing/VBRI header in the first frame, if present.
+         */
+        void parseVBRHeader(uint8_t const * frame, uint32_t length);
+
+        /** Parses the encoder delay and padding from the LAME tag that follows the Xing header, if present. Its ReplayGain is used when the ID3 tag has none.
+         */
+        void parseLAMETag(uint8_t const * tag, uint32_t frames, uint8_t const * end);
 
-        uint32_t refillBuffer() {
-            uint32_t max = MP3_BUFFER_SIZE - bufferSize_;
-            if (max > 512)
-                max = max - (max % 512);
-            uint32_t rd = in_->read(buffer_ + bufferSize_, max);
-            LOG(LL_MP3, "buffer refill " << rd << " bytes (max " << max << "), from index " << bufferSize_ << ", hash " << platform::hash(buffer_ + bufferSize_, rd));
-            if (rd == 0)
-                eof_ = true;
-            bufferSize_ += rd;
-            return rd;
+        /** Reads ReplayGain from the ID3v2 TXXX frame's contents, if it is one of the REPLAYGAIN_TRACK_GAIN or REPLAYGAIN_ALBUM_GAIN frames.
+         */
+        void parseTXXX(uint8_t const * data, uint32_t size);
+
+        /** Restarts reading the input at given offset. The reads stay block aligned, the bytes before the offset are skipped.
+         */
+        void reposition(uint32_t offset);
+
+        /** Adds the current frame to the frame index if it is the next one to be indexed.
+         */
+        void indexFrame() {
+            if (random_ == nullptr || ! toc_.empty() || indexComplete_ || ! frameExact_)
+                return;
+            if (frame_ % INDEX_INTERVAL == 0 && frame_ / INDEX_INTERVAL == index_.size())
+                index_.push_back(inputOffset_ + readPos_);
         }
 
+        /** Returns the estimated offset of the given frame, extrapolated from the average frame size of the indexed part, or from the bitrate of the first frame. Returns 0 if the frame is close enough to the indexed part to be scanned, or if there is not enough information for the estimate.
+         */
+        uint32_t estimateOffset(uint32_t frame) const;
+
+        /** Called when the end of stream is reached. If the frame index covers the whole stream, marks it complete and saves it next to the file, if any.
+         */
+        void completeIndex();
 
-    private:
-    
         unique_ptr<ReadStream> in_;
-        String name_;
+        // the input as random access stream if seekable, nullptr otherwise
+        RandomReadStream * random_;
 
-        static constexpr uint32_t MP3_BUFFER_SIZE = 2048;
         uint8_t * buffer_;
-        uint32_t bufferSize_ = 0;
+        // total bytes consumed by the decoder and read from the input since the last seek, their difference is the number of bytes in the ring
+        uint32_t readPos_ = 0;
+        uint32_t writePos_ = 0;
+        // offset of the beginning of the ring in the input, i.e. of readPos_ == 0
+        uint32_t inputOffset_ = 0;
+        uint32_t bytesRead_ = 0;
         HMP3Decoder dec_;
-        MP3FrameInfo fInfo_;       
+        MP3FrameInfo fInfo_;
 
-        int err_; 
+        int err_;
         uint32_t frameErrors_ = 0;
         uint32_t frames_ = 0;
         bool eof_ = false;
 
+        // index of the next frame to decode, the offset of the first frame, total number of frames (0 if not known) and samples per frame for the stream
+        uint32_t frame_ = 0;
+        uint32_t dataStart_ = 0;
+        uint32_t totalFrames_ = 0;
+        uint32_t samplesPerFrame_ = 1152;
+        // false when frame_ is only an estimate after seeking past the indexed part, in which case the frames are not indexed
+        bool frameExact_ = true;
+        // decoded samples (counted from the first frame) of the first and past the last sample to output, and the decoded sample before which the output is skipped (first sample, or the seek target)
+        uint32_t firstSample_ = 0;
+        uint32_t lastSample_ = 0xffffffff;
+        uint32_t skipUntil_ = 0;
+
+        std::vector<SeekPoint> toc_;
+        std::vector<uint32_t> index_;
+        bool indexComplete_ = false;
+        // where to save the complete frame index, empty if it should not be saved
+        String indexPath_;
+        fs::Drive indexDrive_ = fs::Drive::SD;
+
+        ReplayGain replayGain_;
+
     }; // rckid::audio::MP3DecodeStream
 
-} // namespace rckid::audio
\ No newline at end of file
+} // namespace rckid::audio
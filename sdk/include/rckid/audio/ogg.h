@@ -0,0 +1,116 @@
+#pragma once
+
+#include <rckid/rckid.h>
+#include <rckid/memory.h>
+#include <rckid/stream.h>
+
+namespace rckid::audio {
+
+    /** Minimal Ogg container reader. 
+     
+        Ogg splits a logical stream of packets into pages, each page starts with a 27 byte header followed by a segment table whose entries are the sizes of up to 255 byte segments of the page body. Packets are formed by consecutive segments, a segment shorter than 255 bytes ends the packet, packets may span multiple pages. 
+
+        The reader only supports a single logical stream (that of the first page), pages of other streams are skipped. Page checksums are not verified as the data come from local files. The page data is never buffered, packets are read from the stream directly into the buffer provided by the caller.
+     */
+    class OggReader {
+    public:
+
+        OggReader(ReadStream & in): in_{in} {}
+
+        /** Reads the next non-empty packet into the buffer and returns its size. Returns 0 at the end of the stream. Packets larger than the buffer are skipped with a warning.
+         */
+        uint32_t nextPacket(uint8_t * buffer, uint32_t bufferSize) { return readPacket(buffer, bufferSize, false); }
+
+        /** Reads the beginning of the next non-empty packet into the buffer, skips the rest of the packet and returns the size of the whole packet. Returns 0 at the end of the stream. 
+         
+            Useful for packets of which only the beginning is needed, such as the comment headers, which can be of any size (e.g. with embedded cover art).
+         */
+        uint32_t nextPacketStart(uint8_t * buffer, uint32_t bufferSize) { return readPacket(buffer, bufferSize, true); }
+
+        /** Granule position of the page on which the last returned packet ended. The meaning of the granule position depends on the codec, for Opus it is the number of 48kHz samples decoded at the end of the page.
+         */
+        uint64_t granulePosition() const { return granule_; }
+
+        /** Returns true if the last returned packet was on the last page of the stream.
+         */
+        bool lastPage() const { return (pageFlags_ & FLAG_EOS) != 0; }
+
+        uint32_t serial() const { return serial_; }
+
+        static constexpr uint8_t FLAG_CONTINUED = 1;
+        static constexpr uint8_t FLAG_BOS = 2;
+        static constexpr uint8_t FLAG_EOS = 4;
+
+    private:
+
+        uint32_t readPacket(uint8_t * buffer, uint32_t bufferSize, bool truncate);
+
+        /** Reads next page header and its segment table. If the page starts with continuation of a packet we are not reading, the continuation is skipped. 
+         */
+        bool readPage(bool inPacket);
+
+        void skip(uint32_t bytes) {
+            uint8_t tmp[64];
+            while (bytes > 0) {
+                uint32_t n = in_.read(tmp, std::min<uint32_t>(bytes, sizeof(tmp)));
+                if (n == 0)
+                    return;
+                bytes -= n;
+            }
+        }
+
+        ReadStream & in_;
+        uint8_t segments_[255];
+        uint32_t numSegments_ = 0;
+        uint32_t segment_ = 0;
+        uint64_t pageGranule_ = 0;
+        uint64_t granule_ = 0;
+        uint32_t serial_ = 0;
+        uint8_t pageFlags_ = 0;
+        bool firstPage_ = true;
+
+    }; // rckid::audio::OggReader
+
+    /** Minimal Ogg container writer. 
+     
+        Packets are collected into a page until the page body, or its segment table would overflow, at which point the page is written to the output stream. Packets can also be forced to start on a new page by calling flush() (such as the codec headers that must be on separate pages). Packets larger than the page body are not supported. 
+     */
+    class OggWriter {
+    public:
+
+        static constexpr uint32_t MAX_PAGE_BODY = 4096;
+
+        OggWriter(WriteStream & out, uint32_t serial): 
+            out_{out}, 
+            serial_{serial}, 
+            body_{new uint8_t[MAX_PAGE_BODY]} {
+        }
+
+        /** Appends the packet to the current page. The granule position is that of the stream after the packet (for Opus the number of 48kHz samples encoded so far).
+         */
+        void writePacket(uint8_t const * data, uint32_t size, uint64_t granule);
+
+        /** Writes the current page, if there are any packets. When eos is true, the page is marked as the last one (and is written even if empty).
+         */
+        void flush(bool eos = false);
+
+        /** Returns the number of bytes written so far. 
+         */
+        uint32_t bytesWritten() const { return bytesWritten_; }
+
+    private:
+
+        WriteStream & out_;
+        uint32_t serial_;
+        uint32_t sequence_ = 0;
+        unique_ptr<uint8_t> body_;
+        uint32_t bodySize_ = 0;
+        uint8_t segments_[255];
+        uint32_t numSegments_ = 0;
+        uint64_t granule_ = 0;
+        uint32_t bytesWritten_ = 0;
+        bool first_ = true;
+
+    }; // rckid::audio::OggWriter
+
+} // namespace rckid::audio
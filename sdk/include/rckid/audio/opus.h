@@ -0,0 +1,88 @@
+#pragma once
+
+#include <rckid/rckid.h>
+#include <rckid/memory.h>
+#include <rckid/stream.h>
+#include <rckid/audio/decoder_stream.h>
+#include <rckid/audio/ogg.h>
+
+struct OpusDecoder;
+
+namespace rckid::audio {
+
+    /** Decoder stream for Ogg Opus files (.opus). 
+     
+        Opus offers the same quality as MP3 at roughly half the bitrate, which halves the storage and SD card bandwidth required for long recordings, such as audiobooks and podcasts. Opus always decodes at 48kHz, mono streams are decoded to stereo directly by libopus. 
+
+        The Ogg pages are read by OggReader packet by packet into the packet buffer. Each refill decodes as many whole packets as fit in the playback buffer. A packet that does not fit stays in the packet buffer until the next refill. The pre-skip samples from the OpusHead header are dropped from the start of the stream, and the output gain from the header is applied by the decoder. Only mono and stereo streams (channel mapping family 0, or family 1 with at most 2 channels) are supported.
+
+        libopus is built in fixed-point mode. Memory budget of the stream:
+
+        - decoder state (stereo, fixed point) ~ 26kB, allocated from the heap (see decoderStateSize())
+        - packet buffer 4kB (MAX_PACKET_SIZE) 
+        - playback buffers 2880 stereo samples (60ms, 11.25kB) each, 4 by default, i.e. 45kB
+        - libopus stack usage during decoding is below 10kB
+
+        Compare with ~ 150kB playback buffers of the MP3 stream. Packets longer than 60ms (the largest Opus packets are 120ms) are skipped.
+     */
+    class OpusDecoderStream : public DecoderStream {
+    public:
+
+        static constexpr uint32_t SAMPLE_RATE = 48000;
+        static constexpr uint32_t MAX_PACKET_SIZE = 4096;
+        static constexpr uint32_t BUFFER_STEREO_SAMPLES = 2880;
+
+        OpusDecoderStream(unique_ptr<ReadStream> input, uint32_t numBuffers = 4);
+
+        OpusDecoderStream(OpusDecoderStream const &) = delete;
+
+        ~OpusDecoderStream() override;
+
+        uint32_t sampleRate() const override { return SAMPLE_RATE; }
+
+        /** Returns true if the stream header was valid and the decoder was created.
+         */
+        bool valid() const { return dec_ != nullptr; }
+
+        /** Number of channels in the stream (the output is always stereo).
+         */
+        uint32_t channels() const { return channels_; }
+
+        uint32_t preSkip() const { return preSkip_; }
+
+        uint32_t packets() const { return packets_; }
+
+        uint32_t packetErrors() const { return packetErrors_; }
+
+        int lastError() const { return err_; }
+
+        /** Returns the size of the libopus stereo decoder state in bytes.
+         */
+        static uint32_t decoderStateSize();
+
+    protected:
+
+        uint32_t refillSamples(int16_t * buffer, uint32_t numStereoSamples) override;
+
+    private:
+
+        bool readHeader();
+
+        unique_ptr<ReadStream> in_;
+        OggReader ogg_;
+        unique_ptr<uint8_t> packet_;
+        uint32_t packetSize_ = 0;
+        OpusDecoder * dec_ = nullptr;
+        uint32_t channels_ = 0;
+        uint32_t preSkip_ = 0;
+        // output gain from the header in Q7.8 dB
+        int16_t gain_ = 0;
+        // remaining samples to be skipped at the beginning of the stream
+        uint32_t skip_ = 0;
+        uint32_t packets_ = 0;
+        uint32_t packetErrors_ = 0;
+        int err_ = 0;
+
+    }; // rckid::audio::OpusDecoderStream
+
+} // namespace rckid::audio
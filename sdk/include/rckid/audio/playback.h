@@ -24,13 +24,20 @@ namespace rckid::audio {
 
     /** Audio playback task. 
      
+        Plays the streams from the playlist one after another. When the current stream has been decoded completely, the next stream is obtained from the playlist and its buffers are filled while the rest of the current stream is being played. If both streams have the same sample rate, the audio callback moves from the current stream to the next one as soon as the current one runs out of samples, without stopping the audio output, so that consecutive tracks play without gaps. Together with the encoder delay & padding trimming done by the decoders, this allows gapless albums. Streams with different sample rates still require restarting the audio output at the new rate.
+
+        The previous stream is kept until the audio output returns all of its buffers and is deleted in the task's onTick(), never from the audio callback.
+
+        The playback starts in the first onTick() after it has been created. The audio output is accessed through the virtual startOutput(), stopOutput() and outputPlaying() methods, so that the tests can play the streams by calling the audio callback themselves.
+
+        Optionally, the streams can be processed by a DSP chain (equalizer, ReplayGain and limiter, see setDSP()). Each stream gets the gain for its own ReplayGain, the filters are shared so that gapless transitions stay seamless.
      */
     class Playback : public Task {
     public:
-        Playback(Playlist * playlist): playlist_{playlist} {
-            currentStream_ = playlist_->next();
-            if (currentStream_ != nullptr)
-                play(currentStream_.get());
+        /** Creates the playback of the playlist, optionally processed by the given DSP chain (see setDSP()). The first stream is opened immediately and starts playing in the next onTick().
+         */
+        Playback(Playlist * playlist, DSP * dsp = nullptr): playlist_{playlist}, dsp_{dsp} {
+            current_ = playlist_->next();
         }
 
         ~Playback() override {
@@ -39,38 +46,204 @@ namespace rckid::audio {
         }
 
         bool next() {
-            audio::stop();
-            currentStream_ = playlist_->next();
-            if (currentStream_ == nullptr)
+            stopOutput();
+            reset();
+            // if the next stream has already been opened, the playlist is already at it
+            current_ = (next_ != nullptr) ? std::move(next_) : playlist_->next();
+            if (current_ == nullptr)
                 return false;
-            play(currentStream_.get());
+            start();
             return true;
         }
 
         bool prev() {
-            audio::stop();
-            currentStream_ = playlist_->prev();
-            if (currentStream_ == nullptr)
+            stopOutput();
+            reset();
+            // if the next stream has already been opened, the playlist has to move back from it first
+            if (next_ != nullptr) {
+                next_ = nullptr;
+                playlist_->prev();
+            }
+            current_ = playlist_->prev();
+            if (current_ == nullptr)
                 return false;
-            play(currentStream_.get());
+            start();
             return true;
         }
 
+        /** Seeks to the given position in the current stream (in milliseconds). 
+         
+            The playback is restarted at the new position, keeping the paused state. Seeking past the end of the stream moves to the next track. Returns false if the stream does not support seeking. 
+         */
+        bool seek(uint32_t ms) {
+            if (current_ == nullptr || ! current_->seekable())
+                return false;
+            uint32_t duration = current_->durationMs();
+            if (duration != 0 && ms >= duration)
+                return next();
+            bool paused = audio::isPaused();
+            stopOutput();
+            reset();
+            bool result = current_->seek(ms);
+            start();
+            if (paused)
+                audio::pause();
+            return result;
+        }
+
+        /** Returns the playback position in the current stream in milliseconds.
+         */
+        uint32_t positionMs() const {
+            return current_ == nullptr ? 0 : current_->positionMs();
+        }
+
+        /** Returns the duration of the current stream in milliseconds, or 0 if not known.
+         */
+        uint32_t durationMs() const {
+            return current_ == nullptr ? 0 : current_->durationMs();
+        }
+
+        DecoderStream * currentStream() { return current_.get(); }
+
+        DSP * dsp() const { return dsp_; }
+
+        /** Sets the DSP chain for the streams being played, nullptr disables the processing. The chain is not owned by the playback. Call again after changing the chain's ReplayGain mode or preamp so that the gains of the already opened streams are updated. The change is heard after the already decoded buffers are played.
+         */
+        void setDSP(DSP * dsp) {
+            dsp_ = dsp;
+            attachDSP(current_.get());
+            attachDSP(next_.get());
+        }
+
+        /** Statistics of the current stream over the last second.
+         */
+        StreamStats const & lastStats() const { return lastStats_; }
+
+        /** Total number of underruns since the playback started.
+         */
+        uint32_t underruns() const { return underruns_; }
+
     protected:
         void onTick() override {
-            if (currentStream_ != nullptr)
-                currentStream_->update();
-            // if we are done playing the current file, move to the next one, if we can
-            if (!audio::isPlaying())
+            // start playing the first stream
+            if (playing_ == nullptr && current_ != nullptr)
+                start();
+            // the audio callback has moved to the next stream, which becomes the current one and the stream after it can be opened
+            if (next_ != nullptr && playing_ == next_.get()) {
+                previous_ = std::move(current_);
+                current_ = std::move(next_);
+                nextOpened_ = false;
+            }
+            // delete the previous stream once all of its buffers have been played
+            if (previous_ != nullptr && previous_->inFlight() == 0) {
+                retired_ = nullptr;
+                previous_ = nullptr;
+            }
+            if (current_ != nullptr) {
+                current_->update();
+                // snapshot the statistics every second
+                uint64_t now = time::uptimeUs();
+                if (now >= nextStatsUs_) {
+                    nextStatsUs_ = now + 1000000;
+                    lastStats_ = current_->stats();
+                    current_->stats().reset();
+                    underruns_ += lastStats_.underruns();
+                    LOG(LL_AUDIO, lastStats_);
+                }
+                // when the current stream is decoded, open the next one and fill its buffers, so that it is ready when the current one runs out
+                if (current_->done() && ! nextOpened_ && previous_ == nullptr) {
+                    nextOpened_ = true;
+                    next_ = playlist_->next();
+                    attachDSP(next_.get());
+                    if (next_ != nullptr && next_->sampleRate() == current_->sampleRate()) {
+                        next_->update();
+                        queued_ = next_.get();
+                    }
+                }
+            }
+            // if we are done playing the current file (the next file has different sample rate, or the playback ran out of samples), move to the next one, if we can
+            if (! outputPlaying())
                 next();
         }
 
+        /** Starts the audio output at the given sample rate, with callback() supplying the buffers.
+         */
+        virtual void startOutput(uint32_t sampleRate) {
+            audio::play(sampleRate, [this](int16_t * & buffer, uint32_t & numStereoSamples) {
+                callback(buffer, numStereoSamples);
+            });
+        }
+
+        virtual void stopOutput() { audio::stop(); }
+
+        virtual bool outputPlaying() const { return audio::isPlaying(); }
+
+        /** The audio callback, moves to the queued stream when the playing one has been played completely.
+         */
+        void callback(int16_t * & buffer, uint32_t & numStereoSamples) {
+            DecoderStream * s = playing_;
+            if (buffer != nullptr) {
+                if (s->owns(buffer))
+                    s->release(buffer);
+                else
+                    retired_->release(buffer);
+            }
+            s->acquire(buffer, numStereoSamples);
+            if (buffer == nullptr && s->done() && queued_ != nullptr) {
+                retired_ = s;
+                s = queued_;
+                queued_ = nullptr;
+                playing_ = s;
+                s->acquire(buffer, numStereoSamples);
+            }
+        }
+
     private:
 
+        /** Starts playing the current stream.
+         */
+        void start() {
+            attachDSP(current_.get());
+            current_->update();
+            nextOpened_ = (next_ != nullptr);
+            if (next_ != nullptr && next_->sampleRate() == current_->sampleRate())
+                queued_ = next_.get();
+            playing_ = current_.get();
+            startOutput(current_->sampleRate());
+        }
+
+        void attachDSP(DecoderStream * stream) {
+            if (stream != nullptr)
+                stream->setDSP(dsp_, dsp_ == nullptr ? DSP::UNITY_GAIN : dsp_->gain(stream->replayGain()));
+        }
+
+        /** Forgets the streams used by the audio callback, must only be called when the playback is stopped.
+         */
+        void reset() {
+            previous_ = nullptr;
+            retired_ = nullptr;
+            queued_ = nullptr;
+            playing_ = nullptr;
+        }
+
         Playlist * playlist_ = nullptr;
 
-        unique_ptr<DecoderStream> currentStream_;
+        // the stream being played, the next stream when already opened and the previous stream while its buffers are still being played
+        unique_ptr<DecoderStream> current_;
+        unique_ptr<DecoderStream> next_;
+        unique_ptr<DecoderStream> previous_;
+        bool nextOpened_ = false;
+        DSP * dsp_ = nullptr;
+
+        StreamStats lastStats_;
+        uint32_t underruns_ = 0;
+        uint64_t nextStatsUs_ = 0;
+
+        // streams as seen by the audio callback, which switches from playing to queued stream without the main thread
+        DecoderStream * volatile playing_ = nullptr;
+        DecoderStream * volatile queued_ = nullptr;
+        DecoderStream * volatile retired_ = nullptr;
 
     }; // rckid::audio::Playback
 
-} // namespace rckid::audio
\ No newline at end of file
+} // namespace rckid::audio
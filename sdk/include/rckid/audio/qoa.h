@@ -0,0 +1,66 @@
+#pragma once
+
+#include <rckid/rckid.h>
+#include <rckid/memory.h>
+#include <rckid/stream.h>
+#include <rckid/audio/decoder_stream.h>
+
+namespace rckid::audio {
+
+    /** Decoder stream for QOA (Quite OK Audio) files, mono or stereo.
+
+        QOA compresses 16bit audio to 3.2 bits per sample with a simple adaptive predictor, so that decoding costs only a few multiplications per sample. The quality is close to MP3 at a much higher bitrate (~280kbps for 44.1kHz stereo), which is ideal for game music and sound effects that have to be decoded alongside a busy game.
+
+        The file is read one frame (up to 5120 samples per channel, ~4kB for stereo) at a time into the frame buffer and decoded slice by slice (20 samples per channel) directly into the playback buffers. The number of channels and sample rate are taken from the first frame and must not change.
+     */
+    class QOADecoderStream : public DecoderStream {
+    public:
+
+        static constexpr uint32_t SLICE_SAMPLES = 20;
+        static constexpr uint32_t MAX_FRAME_SLICES = 256;
+        static constexpr uint32_t BUFFER_STEREO_SAMPLES = 1280;
+
+        QOADecoderStream(unique_ptr<ReadStream> input, uint32_t numBuffers = 4);
+
+        QOADecoderStream(QOADecoderStream const &) = delete;
+
+        uint32_t sampleRate() const override { return sampleRate_; }
+
+        /** Returns true if the stream is a valid QOA file.
+         */
+        bool valid() const { return frame_ != nullptr; }
+
+        uint32_t channels() const { return channels_; }
+
+        /** Number of samples per channel in the file.
+         */
+        uint32_t samples() const { return samples_; }
+
+    protected:
+
+        uint32_t refillSamples(int16_t * buffer, uint32_t numStereoSamples) override;
+
+    private:
+
+        struct LMS {
+            int32_t history[4];
+            int32_t weights[4];
+        };
+
+        bool readFrame();
+
+        void decodeSlice(uint32_t channel, int16_t * buffer, uint32_t numSamples);
+
+        unique_ptr<ReadStream> in_;
+        unique_ptr<uint8_t> frame_;
+        uint32_t channels_ = 0;
+        uint32_t sampleRate_ = 0;
+        uint32_t samples_ = 0;
+        // samples per channel in the current frame, and the next sample to decode
+        uint32_t frameSamples_ = 0;
+        uint32_t frameSample_ = 0;
+        LMS lms_[2];
+
+    }; // rckid::audio::QOADecoderStream
+
+} // namespace rckid::audio
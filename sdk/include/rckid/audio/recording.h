@@ -0,0 +1,135 @@
+#pragma once
+
+#include <rckid/rckid.h>
+#include <rckid/task.h>
+#include <rckid/buffer.h>
+#include <rckid/audio/adpcm.h>
+
+namespace rckid::audio {
+
+    /** Audio recording task.
+
+        Records mono IMA-ADPCM WAV files. The audio callback only copies the left channel of the recorded samples into a ring buffer, the encoding and the writes to the output stream happen incrementally in the task's tick, outside of the interrupt. The ring buffer holds half a second of 8kHz audio, which is enough to cover the occasional slow SD card write. Samples that do not fit in the ring buffer are dropped and counted.
+
+        The recording does not start the audio itself unless start() is called, so that any other source of samples can be recorded via the feed() method as well.
+     */
+    class Recording : public Task {
+    public:
+
+        enum class Source {
+            Mic,
+            LineIn,
+        };
+
+        using SamplesEvent = std::function<void(int16_t const *, uint32_t)>;
+
+        static constexpr uint32_t RING_SIZE = 4096;
+        static constexpr uint32_t DMA_STEREO_SAMPLES = 256;
+
+        Recording(RandomWriteStream & out, uint32_t sampleRate = 8000):
+            encoder_{out, sampleRate},
+            ring_{new int16_t[RING_SIZE]} {
+        }
+
+        ~Recording() override {
+            finish();
+        }
+
+        /** Starts recording from the given source.
+         */
+        void start(Source source) {
+            auto cb = [this](int16_t * & samples, uint32_t & numSamples) {
+                // if we are given samples, store them, the DMA can then fill the same buffer again
+                if (samples != nullptr) {
+                    feed(samples, numSamples);
+                } else {
+                    samples = dma_.front().data();
+                    numSamples = DMA_STEREO_SAMPLES;
+                    dma_.swap();
+                }
+            };
+            if (source == Source::Mic)
+                audio::recordMic(encoder_.sampleRate(), cb);
+            else
+                audio::recordLineIn(encoder_.sampleRate(), cb);
+        }
+
+        /** Stops the recording, encodes any samples still in the ring buffer and finalizes the output.
+         */
+        void finish() {
+            if (finished_)
+                return;
+            if (audio::isRecording())
+                audio::stop();
+            drain();
+            encoder_.finish();
+            finished_ = true;
+        }
+
+        /** Adds stereo samples to the ring buffer. Called from the audio callback (in an interrupt), only the left channel is recorded.
+         */
+        void feed(int16_t const * stereoSamples, uint32_t numStereoSamples) {
+            uint32_t head = head_;
+            uint32_t tail = tail_;
+            for (uint32_t i = 0; i < numStereoSamples; ++i) {
+                if (head - tail == RING_SIZE) {
+                    dropped_ += numStereoSamples - i;
+                    break;
+                }
+                ring_.get()[head % RING_SIZE] = stereoSamples[i * 2];
+                ++head;
+            }
+            head_ = head;
+        }
+
+        /** Sets the event called with the recorded mono samples after they have been encoded, for visualizing the recording.
+         */
+        void setOnSamples(SamplesEvent handler) { onSamples_ = std::move(handler); }
+
+        uint32_t sampleRate() const { return encoder_.sampleRate(); }
+
+        /** Number of samples recorded so far.
+         */
+        uint32_t samples() const { return encoder_.samples(); }
+
+        /** Number of samples that had to be dropped because the ring buffer was full.
+         */
+        uint32_t droppedSamples() const { return dropped_; }
+
+        uint32_t bytesWritten() const { return encoder_.bytesWritten(); }
+
+        bool finished() const { return finished_; }
+
+    protected:
+
+        void onTick() override {
+            if (! finished_)
+                drain();
+        }
+
+        void drain() {
+            uint32_t head = head_;
+            while (tail_ != head) {
+                uint32_t start = tail_ % RING_SIZE;
+                uint32_t n = std::min(head - tail_, RING_SIZE - start);
+                encoder_.encode(ring_.get() + start, n);
+                if (onSamples_)
+                    onSamples_(ring_.get() + start, n);
+                tail_ += n;
+            }
+        }
+
+    private:
+        ADPCMEncoder encoder_;
+        unique_ptr<int16_t> ring_;
+        // ring buffer positions, head is only written from the audio interrupt, tail only from the task
+        volatile uint32_t head_ = 0;
+        volatile uint32_t tail_ = 0;
+        volatile uint32_t dropped_ = 0;
+        DoubleBuffer<int16_t> dma_{DMA_STEREO_SAMPLES * 2};
+        SamplesEvent onSamples_;
+        bool finished_ = false;
+
+    }; // rckid::audio::Recording
+
+} // namespace rckid::audio
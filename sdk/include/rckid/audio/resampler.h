@@ -0,0 +1,89 @@
+#pragma once
+
+#include <rckid/rckid.h>
+#include <rckid/memory.h>
+#include <rckid/audio/decoder_stream.h>
+
+namespace rckid::audio {
+
+    /** Stream adapter that converts another decoder stream to a different sample rate.
+
+        This allows streams of different rates (8kHz recordings, 44.1 or 48kHz music, etc.) to be played at a single output rate, e.g. by the mixer's voices, which then take its fast path without any resampling of their own, or by the playback task without restarting the audio output between tracks of different rates.
+
+        The conversion uses a polyphase FIR filter: a windowed sinc is precomputed for PHASES fractional positions between two input samples as 16bit fixed point coefficients and the coefficients of the closest phase are used for each output sample. The filter has TAPS taps, multiplied by the downsampling ratio (up to MAX_TAPS), so that it spans the same time in output samples regardless of the ratio. Each output sample therefore costs taps() multiply-accumulates per channel. The filter's cutoff is just below the lower of the two Nyquist frequencies so that downsampling does not alias and upsampling does not create images. The coefficients of each phase are normalized to unity gain at DC.
+
+        When both rates are the same, the samples are copied unchanged. The filter delays the stream by TAPS / 2 input samples, which are flushed at the end of the stream so that no samples are lost.
+     */
+    class ResamplingStream : public DecoderStream {
+    public:
+
+        static constexpr uint32_t TAPS = 16;
+        static constexpr uint32_t MAX_TAPS = 64;
+        static constexpr uint32_t PHASE_BITS = 6;
+        static constexpr uint32_t PHASES = 1 << PHASE_BITS;
+        static constexpr uint32_t BUFFER_STEREO_SAMPLES = 512;
+
+        ResamplingStream(unique_ptr<DecoderStream> source, uint32_t sampleRate, uint32_t numBuffers = 4);
+
+        ResamplingStream(ResamplingStream const &) = delete;
+
+        uint32_t sampleRate() const override { return sampleRate_; }
+
+        bool seekable() const override { return source_->seekable(); }
+
+        uint32_t durationMs() const override { return source_->durationMs(); }
+
+        ReplayGain replayGain() const override { return source_->replayGain(); }
+
+        DecoderStream * source() { return source_.get(); }
+
+        /** Number of filter taps, i.e. input samples used for each output sample.
+         */
+        uint32_t taps() const { return taps_; }
+
+        /** Returns the filter coefficients for the given phase, i.e. taps() values in 1/32768ths.
+         */
+        int16_t const * coefficients(uint32_t phase) const { return coeffs_.get() + phase * taps_; }
+
+    protected:
+
+        uint32_t refillSamples(int16_t * buffer, uint32_t numStereoSamples) override;
+
+        bool seekTo(uint32_t & sample) override;
+
+    private:
+
+        /** Size of the input window in stereo samples. Must be larger than the filter so that the input is compacted only once every few hundred samples.
+         */
+        static constexpr uint32_t INPUT_SIZE = MAX_TAPS + 256;
+
+        void initializeFilter();
+
+        /** Clears the input window so that the filter starts with silence before the first sample.
+         */
+        void resetInput();
+
+        /** Copies samples from the source to the input window, moving the unused samples to the front first. Returns false if there are no more samples, i.e. the source is done and its tail has been flushed.
+         */
+        bool pull();
+
+        unique_ptr<DecoderStream> source_;
+        uint32_t sampleRate_;
+        // input samples per output sample in 16.16 fixed point
+        uint32_t step_;
+        uint32_t taps_;
+        unique_ptr<int16_t> coeffs_;
+        // window of the input stereo samples, the next output sample is computed from samples [pos_, pos_ + taps_)
+        unique_ptr<int16_t> in_;
+        uint32_t inSize_ = 0;
+        uint32_t pos_ = 0;
+        uint32_t frac_ = 0;
+        // source buffer being copied to the input window
+        int16_t * srcBuffer_ = nullptr;
+        uint32_t srcSize_ = 0;
+        uint32_t srcPos_ = 0;
+        bool flushed_ = false;
+
+    }; // rckid::audio::ResamplingStream
+
+} // namespace rckid::audio
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <rckid/rckid.h>
+
+namespace rckid::audio {
+
+    /** Playback instrumentation of a single audio stream.
+
+        Tells apart the usual causes of audio stutter: the refill ran too late (high refill latency while decoding is fast), the buffers are too small (ready buffers drop to 0 although both the latency and decode time are well below the duration of the buffers), or decoding is too slow (decode time close to, or above the buffer duration).
+
+        - underruns are the buffers the audio output asked for, but which were not decoded yet
+        - the fill level is the number of decoded buffers left after the audio output took one, the minimum and average are kept
+        - the decode time is the time spent refilling a single buffer, including the DSP processing, if any
+        - the refill latency is the time from the audio output returning a buffer to the main loop starting to refill it, i.e. how late the task's onTick() got to the stream
+
+        The audio callback and the main loop each update their own counters so that no locking is necessary, the values read from the main loop may be off by one callback. To see how the values change over time, the playback takes a snapshot and resets the counters every second, see Playback::lastStats(). The main loop never writes the audio callback's counters, reset() only asks the callback to clear them the next time it updates them.
+     */
+    class StreamStats {
+    public:
+
+        uint32_t underruns() const { return resetRequested_ ? 0 : underruns_; }
+
+        /** Number of buffers handed to the audio output.
+         */
+        uint32_t buffers() const { return resetRequested_ ? 0 : buffers_; }
+
+        uint32_t minReady() const { return buffers() == 0 ? 0 : minReady_; }
+
+        /** Average number of ready buffers, in 1/100ths.
+         */
+        uint32_t avgReady100() const { return buffers() == 0 ? 0 : static_cast<uint32_t>(readySum_ * 100 / buffers_); }
+
+        /** Number of buffers refilled by the decoder.
+         */
+        uint32_t refills() const { return refills_; }
+
+        uint32_t avgDecodeUs() const { return refills_ == 0 ? 0 : static_cast<uint32_t>(decodeUs_ / refills_); }
+
+        uint32_t maxDecodeUs() const { return maxDecodeUs_; }
+
+        uint32_t avgLatencyUs() const { return latencies_ == 0 ? 0 : static_cast<uint32_t>(latencyUs_ / latencies_); }
+
+        uint32_t maxLatencyUs() const { return maxLatencyUs_; }
+
+        /** Called from the main loop to start a new measurement. The audio callback's counters read as reset from now on, but are only cleared by the callback itself.
+         */
+        void reset() {
+            resetRequested_ = true;
+            refills_ = 0;
+            decodeUs_ = 0;
+            maxDecodeUs_ = 0;
+            latencies_ = 0;
+            latencyUs_ = 0;
+            maxLatencyUs_ = 0;
+        }
+
+        /** Called from the audio callback when a buffer was handed to the audio output, with the number of ready buffers left.
+         */
+        void bufferAcquired(uint32_t ready) {
+            resetIfRequested();
+            ++buffers_;
+            readySum_ += ready;
+            if (ready < minReady_)
+                minReady_ = ready;
+        }
+
+        /** Called from the audio callback when there was no buffer ready for the audio output.
+         */
+        void bufferUnderrun() {
+            resetIfRequested();
+            ++underruns_;
+        }
+
+        /** Called from the audio callback when the audio output returns a buffer, starts the refill latency measurement unless already in progress.
+         */
+        void bufferReleased() {
+            if (releasedUs_ == 0)
+                releasedUs_ = static_cast<uint32_t>(time::uptimeUs()) | 1;
+        }
+
+        /** Called from the main loop before a buffer is refilled, returns the start time for refillFinished().
+         */
+        uint32_t refillStarted() {
+            uint32_t now = static_cast<uint32_t>(time::uptimeUs());
+            uint32_t released = releasedUs_;
+            if (released != 0) {
+                releasedUs_ = 0;
+                uint32_t latency = now - released;
+                ++latencies_;
+                latencyUs_ += latency;
+                if (latency > maxLatencyUs_)
+                    maxLatencyUs_ = latency;
+            }
+            return now;
+        }
+
+        void refillFinished(uint32_t startUs) {
+            uint32_t t = static_cast<uint32_t>(time::uptimeUs()) - startUs;
+            ++refills_;
+            decodeUs_ += t;
+            if (t > maxDecodeUs_)
+                maxDecodeUs_ = t;
+        }
+
+        friend void write(Writer & w, StreamStats const & s) {
+            w << "underruns " << s.underruns()
+              << ", ready min " << s.minReady() << " avg " << (s.avgReady100() / 100) << "." << (s.avgReady100() / 10 % 10)
+              << ", decode avg " << s.avgDecodeUs() << " max " << s.maxDecodeUs()
+              << "us, latency avg " << s.avgLatencyUs() << " max " << s.maxLatencyUs() << "us";
+        }
+
+    private:
+
+        void resetIfRequested() {
+            if (resetRequested_) {
+                underruns_ = 0;
+                buffers_ = 0;
+                readySum_ = 0;
+                minReady_ = UINT32_MAX;
+                resetRequested_ = false;
+            }
+        }
+
+        // set by the main loop, cleared by the audio callback once it has reset its counters
+        volatile bool resetRequested_ = false;
+        // updated from the audio callback
+        volatile uint32_t underruns_ = 0;
+        volatile uint32_t buffers_ = 0;
+        volatile uint32_t readySum_ = 0;
+        volatile uint32_t minReady_ = UINT32_MAX;
+        // time the first buffer since the last refill was returned (the lowest bit is always set so that 0 means none)
+        volatile uint32_t releasedUs_ = 0;
+        // updated from the main loop
+        uint32_t refills_ = 0;
+        uint64_t decodeUs_ = 0;
+        uint32_t maxDecodeUs_ = 0;
+        uint32_t latencies_ = 0;
+        uint64_t latencyUs_ = 0;
+        uint32_t maxLatencyUs_ = 0;
+
+    }; // rckid::audio::StreamStats
+
+} // namespace rckid::audio
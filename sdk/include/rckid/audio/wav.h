@@ -0,0 +1,78 @@
+#pragma once
+
+#include <rckid/rckid.h>
+#include <rckid/memory.h>
+#include <rckid/stream.h>
+#include <rckid/audio/decoder_stream.h>
+
+namespace rckid::audio {
+
+    /** Format of a WAV file, as read from its header.
+
+        Reading the header leaves the stream at the beginning of the data chunk so that the decoders can continue reading the samples.
+     */
+    struct WAVFormat {
+        static constexpr uint16_t PCM = 0x01;
+        static constexpr uint16_t IMA_ADPCM = 0x11;
+
+        uint16_t format = 0;
+        uint16_t channels = 0;
+        uint32_t sampleRate = 0;
+        uint16_t blockAlign = 0;
+        uint16_t bitsPerSample = 0;
+        // number of samples per channel, from the fact chunk if present
+        uint32_t samples = 0;
+        bool hasFact = false;
+        // size of the data chunk in bytes
+        uint32_t dataSize = 0;
+
+        /** Reads the RIFF header and all chunks up to the data chunk. Returns false if the stream is not a WAV file.
+         */
+        bool read(ReadStream & in);
+    }; // rckid::audio::WAVFormat
+
+    /** Decoder stream for uncompressed WAV files, 8bit unsigned or 16bit signed, mono or stereo.
+
+        The samples are read directly into the playback buffers and expanded to 16bit stereo in place, so apart from the playback buffers there is no extra memory and next to no CPU needed, which makes PCM WAVs ideal for short sound effects.
+     */
+    class WAVDecoderStream : public DecoderStream {
+    public:
+
+        static constexpr uint32_t BUFFER_STEREO_SAMPLES = 1024;
+
+        WAVDecoderStream(unique_ptr<ReadStream> input, uint32_t numBuffers = 4);
+
+        /** Creates the decoder for stream whose header has already been read.
+         */
+        WAVDecoderStream(unique_ptr<ReadStream> input, WAVFormat const & format, uint32_t numBuffers = 4);
+
+        uint32_t sampleRate() const override { return format_.sampleRate; }
+
+        /** Returns true if the stream is a supported PCM WAV file.
+         */
+        bool valid() const { return valid_; }
+
+        uint32_t channels() const { return format_.channels; }
+
+        uint32_t bitsPerSample() const { return format_.bitsPerSample; }
+
+        /** Number of samples per channel in the file.
+         */
+        uint32_t samples() const { return format_.dataSize / format_.blockAlign; }
+
+    protected:
+
+        uint32_t refillSamples(int16_t * buffer, uint32_t numStereoSamples) override;
+
+    private:
+
+        bool checkFormat();
+
+        unique_ptr<ReadStream> in_;
+        WAVFormat format_;
+        uint32_t dataRemaining_ = 0;
+        bool valid_ = false;
+
+    }; // rckid::audio::WAVDecoderStream
+
+} // namespace rckid::audio
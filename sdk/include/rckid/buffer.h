@@ -127,6 +127,34 @@ namespace rckid {
             return result;
         }
 
+        /** Returns the buffer to which given data belong. 
+         */
+        static Buffer<T> * fromData(T * data) { return & BufferInfo::fromData(data)->buffer; }
+
+        /** Returns true if the data belong to one of the buffers.
+         */
+        bool contains(T const * data) const {
+            for (uint32_t i = 0; i < numBuffers_; ++i)
+                if (buffers_[i]->buffer.data() == data)
+                    return true;
+            return false;
+        }
+
+        /** Returns all buffers to the free list, discarding any ready data. 
+         
+            Must not be called while the consumer still uses any of the buffers.
+         */
+        void reset() {
+            free_ = nullptr;
+            ready_ = nullptr;
+            readyEnd_ = nullptr;
+            for (uint32_t i = 0; i < numBuffers_; ++i) {
+                buffers_[i]->buffer.used_ = 0;
+                buffers_[i]->next = free_;
+                free_ = buffers_[i];
+            }
+        }
+
         /** Marks the buffer as free. 
          */
         void markFree(Buffer<T> * buffer) { markFree(buffer->data()); }
@@ -151,6 +151,92 @@ namespace rckid::fs {
         return readFolder(path, Drive::SD, callback);
     }
 
+    /** Lazily enumerated folder.
+
+        Unlike readFolder(), which visits all entries at once, the folder reader keeps the folder open and reads the entries one by one when asked for them, so that large folders, such as music libraries with hundreds of files, can be browsed without keeping all of their entries in memory. Nothing is read when the folder is opened, the number of entries is known once the folder has been read to its end (see size()). The entries are in the order of the underlying filesystem, i.e. not sorted.
+
+        Entries are accessed by their index. Reading the entry after the last one read is a single folder read. To make going back cheap as well, the reader saves the folder position every CHECKPOINT_INTERVAL entries as it reads them for the first time and going back restores the closest checkpoint before the entry and skips at most CHECKPOINT_INTERVAL - 1 entries from there. 
+     */
+    class FolderReader {
+    public:
+
+        static constexpr uint32_t CHECKPOINT_INTERVAL = 32;
+
+        virtual ~FolderReader() = default;
+
+        /** Returns the number of entries in the folder, reading the rest of the folder first if it has not been read to its end yet.
+         */
+        uint32_t size() {
+            while (! end_)
+                advance(nullptr);
+            return position_ > size_ ? position_ : size_;
+        }
+
+        /** Reads entry at given index. Returns false if the index is out of range, or the entry could not be read.
+         */
+        bool entryAt(uint32_t index, FolderEntry & entry) {
+            if (end_ && index >= size_)
+                return false;
+            if (index < position_) {
+                uint32_t checkpoint = index / CHECKPOINT_INTERVAL;
+                if (checkpoint == 0)
+                    rewind();
+                else
+                    restoreCheckpoint(checkpoint);
+                position_ = checkpoint * CHECKPOINT_INTERVAL;
+            }
+            while (position_ < index)
+                if (! advance(nullptr))
+                    return false;
+            return advance(& entry);
+        }
+
+    protected:
+
+        /** Moves back to the first entry of the folder.
+         */
+        virtual void rewind() = 0;
+
+        /** Reads the next entry of the folder into the given entry, or skips it if entry is nullptr. Returns false if there are no more entries.
+         */
+        virtual bool next(FolderEntry * entry) = 0;
+
+        /** Saves the current folder position as checkpoint with given index (starting from 1, checkpoint 0 is the beginning of the folder). The checkpoints are saved in order, each only once.
+         */
+        virtual void saveCheckpoint(uint32_t index) = 0;
+
+        /** Moves to the previously saved checkpoint.
+         */
+        virtual void restoreCheckpoint(uint32_t index) = 0;
+
+    private:
+
+        bool advance(FolderEntry * entry) {
+            if (position_ != 0 && position_ % CHECKPOINT_INTERVAL == 0 && position_ / CHECKPOINT_INTERVAL > checkpoints_) {
+                checkpoints_ = position_ / CHECKPOINT_INTERVAL;
+                saveCheckpoint(checkpoints_);
+            }
+            if (! next(entry)) {
+                end_ = true;
+                size_ = position_;
+                return false;
+            }
+            ++position_;
+            return true;
+        }
+
+        // number of entries, valid once end_ is true
+        uint32_t size_ = 0;
+        uint32_t position_ = 0;
+        uint32_t checkpoints_ = 0;
+        bool end_ = false;
+
+    }; // rckid::fs::FolderReader
+
+    /** Opens the given folder for lazy enumeration. Returns nullptr if the drive is not mounted, or the folder does not exist. 
+     */
+    unique_ptr<FolderReader> openFolder(String const & path, Drive dr = Drive::SD);
+
     
 
 
@@ -3,7 +3,9 @@
 #include <rckid/memory.h>
 #include <rckid/graphics/geometry.h>
 #include <rckid/graphics/color.h>
+#include <rckid/graphics/palette.h>
 #include <rckid/graphics/blit.h>
+#include <rckid/graphics/transform.h>
 #include <rckid/graphics/image_source.h>
 
 namespace rckid {
@@ -39,6 +41,7 @@ namespace rckid {
             colorRepresentation_{other.colorRepresentation_},
             pixels_{std::move(other.pixels_)},
             palette_{std::move(other.palette_)},
+            paletteOverride_{other.paletteOverride_},
             transparentColor_{other.transparentColor_}
         {
             other.w_ = 0;
@@ -53,6 +56,7 @@ namespace rckid {
             colorRepresentation_ = other.colorRepresentation_;
             pixels_ = std::move(other.pixels_);
             palette_ = std::move(other.palette_);
+            paletteOverride_ = other.paletteOverride_;
             transparentColor_ = other.transparentColor_;
             other.w_ = 0;
             other.h_ = 0;
@@ -69,12 +73,22 @@ namespace rckid {
 
         uint32_t bpp() const { return colorRepresentationBpp(colorRepresentation_); }
 
-        Color::RGB565 const * palette() const { return palette_.get(); }
+        /** Returns the palette used for rendering, i.e. the palette override if set, or the bitmap's own palette.
+         */
+        Color::RGB565 const * palette() const { return paletteOverride_ != nullptr ? paletteOverride_ : palette_.get(); }
 
         void setPalette(immutable_ptr<Color::RGB565> palette) {
             palette_ = std::move(palette);
         }
 
+        /** Sets palette override used for rendering instead of the bitmap's own palette. 
+         
+            The bitmap does not take ownership of the override, which must stay valid for as long as the bitmap is rendered with it. This is intended for animated palettes (see Palette), where the colors change every frame while the pixels stay the same. Passing nullptr reverts to the bitmap's own palette.
+         */
+        void setPaletteOverride(Color::RGB565 const * palette) { paletteOverride_ = palette; }
+
+        void setPaletteOverride(Palette const & palette) { paletteOverride_ = palette.colors(); }
+
         std::optional<uint32_t> transparentColor() const { 
             if (transparentColor_ == NO_TRANSPARENCY)
                 return std::nullopt;
@@ -103,7 +117,7 @@ namespace rckid {
             return pixels_.get() + mapIndexColumnFirst(column, 0, w_, h_) * bpp() / 8;
         }
 
-        void renderColumn(Coord column, Coord startRow,  Color::RGB565 * buffer, Coord numPixels) {
+        void renderColumn(Coord column, Coord startRow,  Color::RGB565 * buffer, Coord numPixels) const {
             ASSERT(column < width());
             ASSERT(startRow + numPixels <= height());
             // get source start pointer
@@ -115,9 +129,9 @@ namespace rckid {
                     case Color::Representation::RGB332:
                         return blit_rgb332(start, buffer, numPixels, transparentColor_);
                     case Color::Representation::Index256:
-                        return blit_index256(start, buffer, numPixels, palette_.get(), transparentColor_);
+                        return blit_index256(start, buffer, numPixels, palette(), transparentColor_);
                     case Color::Representation::Index16:
-                        return blit_index16(start, buffer, numPixels, palette_.get(), transparentColor_, startRow % 2);
+                        return blit_index16(start, buffer, numPixels, palette(), transparentColor_, startRow % 2);
                 }
             } else {
                 switch (colorRepresentation_) {
@@ -126,14 +140,22 @@ namespace rckid {
                     case Color::Representation::RGB332:
                         return blit_rgb332(start, buffer, numPixels);
                     case Color::Representation::Index256:
-                        return blit_index256(start, buffer, numPixels, palette_.get());
+                        return blit_index256(start, buffer, numPixels, palette());
                     case Color::Representation::Index16:
-                        return blit_index16(start, buffer, numPixels, palette_.get(), startRow % 2);
+                        return blit_index16(start, buffer, numPixels, palette(), startRow % 2);
                 }
             }
             UNREACHABLE;
         }
 
+        /** Renders column of the bitmap transformed by an affine transformation.
+
+            The inverse transformation maps the destination coordinates (column and rows) back to the bitmap, i.e. it is the inverse of the transformation that places the bitmap on the screen. Pixels that map outside of the bitmap, or that are transparent are not rendered, leaving the buffer contents intact.
+
+            Axis aligned transformations (scaling and flipping) have a faster path that converts each source pixel only once even when it spans multiple rows and when the vertical scale is 1:1, the regular column blitting is used.
+         */
+        void renderColumn(Coord column, Coord startRow, Color::RGB565 * buffer, Coord numPixels, Transform const & inverse, Filter filter = Filter::Nearest) const;
+
         /** Releases the pixel array and returns its pointer.
          
             TODO return immutable ptr
@@ -155,6 +177,7 @@ namespace rckid {
         Color::Representation colorRepresentation_ = Color::Representation::RGB565;
         immutable_ptr<uint8_t> pixels_;
         immutable_ptr<Color::RGB565> palette_;
+        Color::RGB565 const * paletteOverride_ = nullptr;
 
         static constexpr uint32_t NO_TRANSPARENCY = 0xFFFFFFFF;
         uint32_t transparentColor_ = 0;
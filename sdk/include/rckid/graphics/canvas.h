@@ -5,6 +5,8 @@
 #include <rckid/graphics/geometry.h>
 #include <rckid/graphics/color.h>
 #include <rckid/graphics/blit.h>
+#include <rckid/graphics/bitmap.h>
+#include <rckid/graphics/font.h>
 #include <rckid/graphics/image_source.h>
 
 namespace rckid {
@@ -14,6 +16,10 @@ namespace rckid {
     class Canvas {
     public:
 
+        /** Maximum number of points supported by fillPolygon().
+         */
+        static constexpr uint32_t MAX_POLYGON_POINTS = 32;
+
         Canvas(Coord width, Coord height, Color::Representation colorRepresentation = Color::Representation::RGB565):
             w_{width},
             h_{height},
@@ -59,83 +65,147 @@ namespace rckid {
 
         void setPixel(Point pos, uint16_t rawValue) { setPixel(pos.x, pos.y, rawValue); }
 
+        /** Converts the given color to raw pixel value in the canvas color representation. 
+         
+            For RGB formats this is simple conversion. For indexed formats, the palette entry closest to the color is returned, which is rather slow and should be done outside of any hot loops. If the canvas has no palette, black (index 0) is returned.
+         */
+        uint16_t rawColor(Color color) const;
+
+        /** \name Drawing primitives
+         
+            All primitives take the raw color value in the canvas color representation (see rawColor() for conversion) and are clipped to the canvas. As the pixels are stored column first, vertical spans are continuous in memory and the primitives are implemented using them wherever possible, while horizontal spans must be drawn pixel by pixel.
+         */
+        //@{
+
         /** Fills rectangle with given color. 
+         
+            Each column of the rectangle is a single memset. If the rectangle spans the whole canvas height, the entire rectangle is continuous in memory and is filled with single memset call. 
          */
-        void fill(Rect rect, uint16_t color) {
-            // default, very slow implementation
-            for (int x = rect.left(), xe = rect.right(); x < xe; ++x)
-                for (int y = rect.top(), ye = rect.bottom(); y < ye; ++y)
-                    setPixel(x, y, color);
-        }
+        void fill(Rect rect, uint16_t color);
 
-        void fill(uint16_t color) {
-            switch (colorRepresentation_) {
-                case Color::Representation::RGB565:
-                    memset16(reinterpret_cast<uint16_t *>(pixels_.get()), color, w_ * h_);
-                    break;
-                default:
-                    UNIMPLEMENTED;
-            }
+        /** Fills the entire canvas with given color. 
+         */
+        void fill(uint16_t color) { fill(Rect::WH(w_, h_), color); }
+
+        /** Draws horizontal line of given length starting at [x, y] to the right.
+         */
+        void hline(Coord x, Coord y, Coord length, uint16_t color);
+
+        /** Draws vertical line of given length starting at [x, y] downwards.
+         */
+        void vline(Coord x, Coord y, Coord length, uint16_t color);
+
+        /** Draws line between the two points (inclusive) using the Bresenham algorithm. 
+         
+            Consecutive pixels in the same column are merged into vertical spans so that steep lines are drawn with per-column memsets.
+         */
+        void drawLine(Point from, Point to, uint16_t color);
+
+        /** Draws one pixel wide outline of the given rectangle. 
+         */
+        void drawRect(Rect rect, uint16_t color);
+
+        /** Draws circle outline with given center and radius using the midpoint algorithm.
+         */
+        void drawCircle(Point center, Coord radius, uint16_t color);
+
+        /** Draws filled circle with given center and radius.
+         
+            The circle is drawn as vertical spans for each of its columns.
+         */
+        void fillCircle(Point center, Coord radius, uint16_t color);
+
+        /** Draws closed polygon outline through the given points. 
+         */
+        void drawPolygon(Point const * points, uint32_t numPoints, uint16_t color);
+
+        /** Fills polygon given by the points using the even-odd rule. 
+         
+            The polygon is filled column by column, intersecting each column with the polygon edges and filling the vertical spans between the intersections. At most MAX_POLYGON_POINTS are supported, larger polygons are not drawn.
+         */
+        void fillPolygon(Point const * points, uint32_t numPoints, uint16_t color);
+
+        /** Blits the given bitmap to the canvas at given position. 
+         
+            Uses the bitmap's transparent color, if any. 
+         */
+        void blit(Point where, Bitmap const & src) { 
+            blit(where, src, Rect::WH(src.width(), src.height()), src.transparentColor()); 
         }
 
+        /** Blits the selected part of the given bitmap to the canvas at given position. 
+         
+            The source rectangle is clipped to both the source bitmap and the canvas. If transparent color is specified, source pixels of that raw value are skipped. When the color representations of source and canvas are the same and there is no transparency, each column is a single memcpy. RGB565 canvases can accept any source representation via the blit_ functions, other conversions are done per pixel. Indexed sources are converted to RGB332 via their palette, RGB sources are mapped to the closest entry of an indexed canvas' palette (see rawColor()), which is slow. Indices are copied verbatim between indexed formats. 
+         */
+        void blit(Point where, Bitmap const & src, Rect srcRect, std::optional<uint32_t> transparentColor = std::nullopt);
+
+        /** Blits the selected part of another canvas to the canvas at given position. 
+         
+            See the bitmap version for details. 
+         */
+        void blit(Point where, Canvas const & src, Rect srcRect, std::optional<uint32_t> transparentColor = std::nullopt);
+
+        void blit(Point where, Canvas const & src) { blit(where, src, Rect::WH(src.width(), src.height())); }
+
+        //@}
+
         /** Writes text at given coordinates with specified font & color.
+
+            The text is expected to be UTF-8 encoded and kerning pairs of the font, if any, are applied. The color is raw value in the canvas color representation. For RGB565 and RGB332 canvases the font is antialiased using darker shades of the color, while for indexed canvases only the pixels with at least half coverage are drawn as palette indices cannot be blended.
          */
         Writer text(Coord x, Coord y, Font font, uint16_t color) {
-            switch (colorRepresentation_) {
-                case Color::Representation::RGB565: {
-                    Color::RGB565 palette[4];
-                    font->createFontPalette(palette, Color::RGB565{color});
-                    return Writer{[this, x, y, font, color, palette, startx = x](char c) mutable {
-                        if (c != '\n') {
-                            GlyphInfo const * gi = font->glyphInfoFor(c);
-                            putChar16(x, y, gi, font, palette);
-                            x += gi->advanceX;
-                        } else {
-                            y += font->size;
-                            x = startx;
-                        }
-                    }};
-                    break;
+            uint32_t palette[4];
+            createFontPalette(palette, color);
+            return Writer{[this, x, y, font, palette, startx = x, decoder = UTF8Decoder{}, prev = static_cast<GlyphInfo const *>(nullptr)](char c) mutable {
+                if (c != '\n') {
+                    uint32_t codepoint;
+                    if (! decoder.decode(c, codepoint))
+                        return;
+                    GlyphInfo const * gi = font->glyphInfoFor(codepoint);
+                    x += font->kerning(prev, gi);
+                    putChar(x, y, gi, font, palette);
+                    x += gi->advanceX;
+                    prev = gi;
+                } else {
+                    y += font->size;
+                    x = startx;
+                    prev = nullptr;
                 }
-                default:
-                    UNIMPLEMENTED;
-            }
+            }};
         }
 
         Writer text(Coord x, Coord y, Font font, Color color) {
-            switch (colorRepresentation_) {
-                case Color::Representation::RGB565:
-                    return text(x, y, font, static_cast<uint16_t>(Color::RGB565{color}));
-                default:
-                    UNIMPLEMENTED;
-            }
+            return text(x, y, font, rawColor(color));
         }
 
+        /** Writes text where each character's color is determined by the given function. 
+         
+            The function takes the index of the character and returns its raw color value in the canvas color representation. 
+         */
         Writer text(Coord x, Coord y, Font font, std::function<uint16_t(uint32_t)> color) {
-            switch (colorRepresentation_) {
-                case Color::Representation::RGB565: {
-                    return Writer{[this, x, y, font, color, startx = x, charIndex = 0](char c) mutable {
-                        if (c != '\n') {
-                            Color::RGB565 palette[4];
-                            font->createFontPalette(palette, Color::RGB565{color(charIndex++)});
-                            GlyphInfo const * gi = font->glyphInfoFor(c);
-                            putChar16(x, y, gi, font, palette);
-                            x += gi->advanceX;
-                        } else {
-                            y += font->size;
-                            x = startx;
-                        }
-                    }};
+            return Writer{[this, x, y, font, color, startx = x, charIndex = 0, decoder = UTF8Decoder{}, prev = static_cast<GlyphInfo const *>(nullptr)](char c) mutable {
+                if (c != '\n') {
+                    uint32_t codepoint;
+                    if (! decoder.decode(c, codepoint))
+                        return;
+                    uint32_t palette[4];
+                    createFontPalette(palette, color(charIndex++));
+                    GlyphInfo const * gi = font->glyphInfoFor(codepoint);
+                    x += font->kerning(prev, gi);
+                    putChar(x, y, gi, font, palette);
+                    x += gi->advanceX;
+                    prev = gi;
+                } else {
+                    y += font->size;
+                    x = startx;
+                    prev = nullptr;
                 }
-                default:
-                    UNIMPLEMENTED;
-            }
+            }};
         }
 
-
         Writer textRainbow(Coord x, Coord y, Font font, uint16_t hueStart, int16_t hueInc) {
-            auto getColor = [hueStart, hueInc](uint32_t) mutable {
-                return Color::RGB565{Color::HSV(hueStart += hueInc, 255, 255)};
+            auto getColor = [this, hueStart, hueInc](uint32_t) mutable {
+                return rawColor(Color::HSV(hueStart += hueInc, 255, 255));
             };
             return text(x, y, font, getColor);
         }
@@ -180,20 +250,26 @@ namespace rckid {
             return pixels_.get() + mapIndexColumnFirst(column, 0, w_, h_) * bpp() / 8;
         }
 
-        void putChar16(Coord x, Coord y, GlyphInfo const * gi, Font font, Color::RGB565 const * palette) {
-            for (Coord xx = x + gi->advanceX; xx >= x; --xx) {
-                if (xx < 0)
-                    break; // it won't be better
-                if (xx >= w_)
-                    continue;
-                Color::RGB565 * buffer = reinterpret_cast<Color::RGB565* >(pixels_.get()) + mapIndexColumnFirst(xx, 0, w_, h_);
-                if (y < 0)
-                    font->renderColumn(xx - x, -y, w_ + y, gi, buffer, palette);
-                else
-                    font->renderColumn(xx - x, 0, w_ - y, gi, buffer + y, palette);
-            }
+        // marks font palette entries that should not be drawn
+        static constexpr uint32_t NO_PIXEL = 0xffffffff;
+
+        /** Sets given pixel to the raw value, no bounds checking. 
+         */
+        void putPixel(Coord x, Coord y, uint16_t color) {
+            Color::setPixel(colorRepresentation_, pixels_.get(), w_, h_, x, y, color);
         }
 
+        /** Fills numPixels pixels of column x starting at row y with given color. No bounds checking.
+         */
+        void fillColumn(Coord x, Coord y, Coord numPixels, uint16_t color);
+
+        template<typename T>
+        void blitFrom(Point where, T const & src, uint8_t const * srcPixels, Rect srcRect, std::optional<uint32_t> transparentColor);
+
+        void createFontPalette(uint32_t * palette, uint16_t color) const;
+
+        void putChar(Coord x, Coord y, GlyphInfo const * gi, Font font, uint32_t const * palette);
+
         Coord w_ = 0;
         Coord h_ = 0;
         Color::Representation colorRepresentation_ = Color::Representation::RGB565;
@@ -202,59 +278,4 @@ namespace rckid {
 
     }; // rckid::Canvas
 
-    /** Application that renders its contents into a canvas. 
-     
-        One of the simplest application types, the canvas app is backed by a framebuffer canvas that can be updated at each loop iteration and is then sent to the display. This is super simple, retains state between frames, which can lead to faster draw times with only changes being updated at every frame. 
-     */
-    template<typename RESULT>
-    class CanvasApp : public ModalApp<RESULT> {
-    public:
-        explicit CanvasApp(Rect rect):
-            rect_{rect},
-            canvas_{rect.width(), rect.height()},
-            renderBuffer_{static_cast<uint32_t>(rect.height())} {
-        }
-
-        CanvasApp(): CanvasApp{Rect::WH(display::WIDTH, display::HEIGHT)} {}
-
-        Rect rect() const { return rect_; }
-
-        Coord width() const { return rect_.width(); }
-        Coord height() const { return rect_.height(); }
-    
-    protected:
-
-        Canvas & canvas() { return canvas_; }
-        
-        void onFocus() override {
-            ModalApp<RESULT>::onFocus();
-            display::enable(rect_, hal::display::RefreshDirection::ColumnFirst);
-            // deal with header
-        }
-
-        void render() override {
-            renderCol_ = width() - 1;
-            hal::display::update([this](Color::RGB565 * & buffer, uint32_t & bufferSize) {
-                if (renderCol_ < 0) {
-                    buffer = nullptr;
-                    return;
-                } else if (buffer == nullptr) {
-                    buffer = renderBuffer_.front().data();
-                    bufferSize = height();
-                    ASSERT(bufferSize <= renderBuffer_.size());
-                    renderBuffer_.swap();
-                }
-                canvas_.renderColumn(renderCol_--, 0, buffer, height());
-            });
-        }
-
-    private:
-        Rect rect_;
-        Canvas canvas_;
-
-        DoubleBuffer<Color::RGB565> renderBuffer_;
-        Coord renderCol_;
-    
-    }; // rckid::CanvasApp
-
 } // namespace rckid
\ No newline at end of file
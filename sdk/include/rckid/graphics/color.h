@@ -345,7 +345,7 @@ namespace rckid {
                 case Representation::RGB565:
                     return RGB565::getPixel(buffer, w, h, x, y);
                 case Representation::RGB332:
-                    return RGB332::getPixel(buffer, w, h, x, y);
+                    return static_cast<uint8_t>(RGB332::getPixel(buffer, w, h, x, y));
                 case Representation::Index256:
                     return Index256::getPixel(buffer, w, h, x, y);
                 case Representation::Index16:
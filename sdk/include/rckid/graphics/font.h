@@ -31,6 +31,45 @@ namespace rckid {
 
     static_assert(sizeof(GlyphInfo) == 8);
 
+    /** Range of consecutive codepoints in the font.
+     
+        Maps count codepoints starting at first to consecutive glyphs starting at glyph index. Fonts with glyphs outside of the printable ASCII range use a sorted array of ranges so that any codepoint can be found by binary search.
+     */
+    class GlyphRange {
+    public:
+        uint32_t const first;
+        uint16_t const count;
+        uint16_t const glyph;
+
+        constexpr GlyphRange(uint32_t first, uint16_t count, uint16_t glyph):
+            first{first}, count{count}, glyph{glyph} {}
+
+    } __attribute__((packed)); // rckid::GlyphRange
+
+    static_assert(sizeof(GlyphRange) == 8);
+
+    /** Kerning adjustment for a pair of glyphs.
+
+        Pairs are identified by the indices of the left and right glyphs in the font's glyph array and the adjustment is added to the advance of the left glyph when followed by the right glyph. Fonts store the pairs sorted by left and then right glyph so that they can be binary searched.
+     */
+    class KerningPair {
+    public:
+        uint16_t const left;
+        uint16_t const right;
+        int8_t const adjust;
+
+        constexpr KerningPair(uint16_t left, uint16_t right, int8_t adjust):
+            left{left}, right{right}, adjust{adjust} {}
+
+        constexpr uint32_t key() const { return (static_cast<uint32_t>(left) << 16) | right; }
+
+    private:
+
+        uint8_t const _padding = 0; // to ensure that size is 6
+
+    } __attribute__((packed)); // rckid::KerningPair
+
+    static_assert(sizeof(KerningPair) == 6);
    
     /** Font data
      
@@ -38,6 +77,10 @@ namespace rckid {
         
         The font itself (Font class) is just a pointer to the FontData. This is because fonts are usually immutable data in flash memory, making the immutable_ptr cheap to use and trivial to construct.
 
+        Fonts may optionally provide kerning pairs (see KerningPair) that adjust the spacing between specific glyphs. Kerning is applied by textWidth(), Canvas text rendering and the glyph runs used by labels (see GlyphRun).
+
+        Text is expected to be UTF-8 encoded. Fonts with only the printable ASCII characters simply index the glyphs by codepoint - 32. Fonts with more glyphs provide sorted codepoint ranges (see GlyphRange), where the first range is checked directly, so that ASCII text is still a single comparison, and the rest are binary searched. Codepoints not present in the font are rendered with the fallback glyph (question mark by default), except for the Latin-1 and Latin Extended-A letters, which fall back to their base letter without the diacritics (e.g. 'c' for 'č'), so that such text stays readable in fonts without them.
+
         NOTE that in order for the FontData to be able to stay in flash memory (rodata section), it cannot keep any smart pointers to its data. Therefore glyphs and pixels of the font *must* managed manually for dynamic fonts.
      */
     class FontData {
@@ -49,29 +92,106 @@ namespace rckid {
 
         uint8_t const * const pixels;
 
+        uint32_t const numRanges;
+
+        GlyphRange const * const ranges;
+
+        uint16_t const fallbackGlyph;
+
+        uint32_t const numKerningPairs;
+
+        KerningPair const * const kerningPairs;
+
+        /** Creates font with printable ASCII glyphs only, starting from space.
+         */
         constexpr FontData(int size, uint32_t numGlyphs, GlyphInfo const * glyphs, uint8_t const * pixels):
-            size{static_cast<Coord>(size)}, numGlyphs{numGlyphs}, glyphs{glyphs}, pixels{pixels} {}
+            size{static_cast<Coord>(size)}, numGlyphs{numGlyphs}, glyphs{glyphs}, pixels{pixels}, numRanges{0}, ranges{nullptr}, fallbackGlyph{'?' - 32}, numKerningPairs{0}, kerningPairs{nullptr} {}
+
+        /** Creates font with sparse glyphs described by the given sorted codepoint ranges.
+         */
+        constexpr FontData(int size, uint32_t numGlyphs, GlyphInfo const * glyphs, uint8_t const * pixels, uint32_t numRanges, GlyphRange const * ranges, uint16_t fallbackGlyph):
+            size{static_cast<Coord>(size)}, numGlyphs{numGlyphs}, glyphs{glyphs}, pixels{pixels}, numRanges{numRanges}, ranges{ranges}, fallbackGlyph{fallbackGlyph}, numKerningPairs{0}, kerningPairs{nullptr} {}
+
+        /** Creates font with sparse glyphs and kerning pairs sorted by their left and right glyph indices.
+         */
+        constexpr FontData(int size, uint32_t numGlyphs, GlyphInfo const * glyphs, uint8_t const * pixels, uint32_t numRanges, GlyphRange const * ranges, uint16_t fallbackGlyph, uint32_t numKerningPairs, KerningPair const * kerningPairs):
+            size{static_cast<Coord>(size)}, numGlyphs{numGlyphs}, glyphs{glyphs}, pixels{pixels}, numRanges{numRanges}, ranges{ranges}, fallbackGlyph{fallbackGlyph}, numKerningPairs{numKerningPairs}, kerningPairs{kerningPairs} {}
 
         Coord textWidth(char const * str) const {
             Coord result = 0;
-            while(*str != 0)
-                result += glyphs[static_cast<unsigned>(*str++) - 32].advanceX;
+            GlyphInfo const * prev = nullptr;
+            while(*str != 0) {
+                GlyphInfo const * gi = glyphInfoFor(decodeUTF8(str));
+                result += kerning(prev, gi) + gi->advanceX;
+                prev = gi;
+            }
             return result;
         }
 
         Coord textWidth(String const & str) const { return textWidth(str.c_str()); }
 
-        /** Returns glyph for given character. 
+        /** Returns glyph for given codepoint. 
          
-            The character is expected to be in the printable range, i.e numGlyphs characters from index 32, inclusive. If outside of the range, glyph infor for a question mark is returned instead. 
+            If the font does not contain the codepoint, the fallback glyph is returned instead, so the result is never nullptr. The lookup is O(1) for codepoints in the first range (printable ASCII for the fonts generated by font-converter) and O(log ranges) otherwise.
          */
-        GlyphInfo const * glyphInfoFor(char glyph) const { 
-            if (glyph < 32)
-                return & glyphs['?' - 32];
-            glyph -= 32;
-            if (static_cast<uint32_t>(glyph) >= numGlyphs)
-                return & glyphs['?' - 32];
-            return & glyphs[static_cast<uint32_t>(glyph)]; 
+        GlyphInfo const * glyphInfoFor(uint32_t codepoint) const { 
+            if (ranges == nullptr) {
+                if (codepoint - 32 >= numGlyphs)
+                    return missingGlyphFor(codepoint);
+                return & glyphs[codepoint - 32];
+            }
+            // fast path for the first range
+            if (codepoint - ranges[0].first < ranges[0].count)
+                return & glyphs[ranges[0].glyph + codepoint - ranges[0].first];
+            // binary search for the last range whose first codepoint is not greater than the codepoint
+            uint32_t lo = 1;
+            uint32_t hi = numRanges;
+            while (lo < hi) {
+                uint32_t mid = (lo + hi) / 2;
+                if (ranges[mid].first <= codepoint)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            if (lo > 1) {
+                GlyphRange const & r = ranges[lo - 1];
+                if (codepoint - r.first < r.count)
+                    return & glyphs[r.glyph + codepoint - r.first];
+            }
+            return missingGlyphFor(codepoint);
+        }
+
+        /** Returns the glyph used for codepoint the font does not have, i.e. the base letter for Latin-1 Supplement and Latin Extended-A letters (U+00C0 - U+017F), or the fallback glyph.
+         */
+        GlyphInfo const * missingGlyphFor(uint32_t codepoint) const {
+            static constexpr char LATIN_BASE[] = 
+                "AAAAAAACEEEEIIIIDNOOOOOxOUUUUYTsaaaaaaaceeeeiiiidnooooo?ouuuuyty"
+                "AaAaAaCcCcCcCcDdDdEeEeEeEeEeGgGgGgGgHhHhIiIiIiIiIiJjJjKkkLlLlLlL"
+                "lLlNnNnNnnNnOoOoOoOoRrRrRrSsSsSsSsTtTtTtUuUuUuUuUuUuWwYyYZzZzZzs";
+            if (codepoint - 0xc0 < sizeof(LATIN_BASE) - 1)
+                return glyphInfoFor(static_cast<uint8_t>(LATIN_BASE[codepoint - 0xc0]));
+            return & glyphs[fallbackGlyph];
+        }
+
+        /** Returns the kerning adjustment between the given glyphs, which is 0 if the left glyph is nullptr (start of text), or if the font has no kerning for the pair.
+         */
+        Coord kerning(GlyphInfo const * left, GlyphInfo const * right) const {
+            if (numKerningPairs == 0 || left == nullptr)
+                return 0;
+            uint32_t key = (static_cast<uint32_t>(left - glyphs) << 16) | static_cast<uint32_t>(right - glyphs);
+            uint32_t lo = 0;
+            uint32_t hi = numKerningPairs;
+            while (lo < hi) {
+                uint32_t mid = (lo + hi) / 2;
+                uint32_t k = kerningPairs[mid].key();
+                if (k == key)
+                    return kerningPairs[mid].adjust;
+                if (k < key)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            return 0;
         }
 
         /** Renders column of given glyph. 
@@ -174,14 +294,14 @@ namespace rckid {
 
         }
 
-        void createFontPalette(Color::RGB565 * palette, Color fg) const {
+        static void createFontPalette(Color::RGB565 * palette, Color fg) {
             palette[0] = fg.withBrightness(0);
             palette[1] = fg.withBrightness(85);
             palette[2] = fg.withBrightness(170);
             palette[3] = fg;
         }
 
-        void createFontPalette(Color::RGB565 * palette, Color fg, Color bg) const {
+        static void createFontPalette(Color::RGB565 * palette, Color fg, Color bg) {
             palette[0] = fg;
             palette[1] = Color::blend(fg, bg, 85);
             palette[2] = Color::blend(fg, bg, 170);
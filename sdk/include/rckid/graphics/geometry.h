@@ -127,6 +127,9 @@ namespace rckid {
 
         constexpr bool empty() const { return w <= 0 || h <= 0; }
 
+        constexpr bool operator == (Rect const & other) const { return x == other.x && y == other.y && w == other.w && h == other.h; }
+        constexpr bool operator != (Rect const & other) const { return ! (*this == other); }
+
         constexpr Rect withHeight(Coord height) const { return Rect{x, y, w, height}; }
         constexpr Rect withWidth(Coord width) const { return Rect{x, y, width, h}; }
 
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+
+#include <rckid/string.h>
+#include <rckid/graphics/font.h>
+
+namespace rckid {
+
+    /** Shaped run of glyphs.
+
+        Holds the glyphs of a single line of UTF-8 text together with their horizontal offsets (with kerning applied) and the total width of the text. The run is calculated once when the text or font changes so that rendering does not have to decode the text, look up the glyphs and sum their advances for every column.
+
+        Each glyph owns the columns from its offset up to the offset of the next glyph (or the text width for the last one). Glyph pixels may extend past this cell, such as when kerning pulls the next glyph closer, so the renderers should check the neighboring glyphs as well.
+     */
+    class GlyphRun {
+    public:
+
+        GlyphRun() = default;
+
+        GlyphRun(Font font, char const * text) { shape(font, text); }
+
+        GlyphRun(Font font, String const & text) { shape(font, text.c_str()); }
+
+        /** Recalculates the run for given text and font.
+         */
+        void shape(Font font, char const * text) {
+            glyphs_.clear();
+            width_ = 0;
+            GlyphInfo const * prev = nullptr;
+            while (*text != 0) {
+                GlyphInfo const * gi = font->glyphInfoFor(decodeUTF8(text));
+                width_ += font->kerning(prev, gi);
+                glyphs_.push_back(Glyph{gi, width_});
+                width_ += gi->advanceX;
+                prev = gi;
+            }
+        }
+
+        void clear() {
+            glyphs_.clear();
+            width_ = 0;
+        }
+
+        bool empty() const { return glyphs_.empty(); }
+
+        uint32_t size() const { return static_cast<uint32_t>(glyphs_.size()); }
+
+        /** Total width of the text in pixels.
+         */
+        Coord width() const { return width_; }
+
+        GlyphInfo const * glyph(uint32_t index) const {
+            ASSERT(index < glyphs_.size());
+            return glyphs_[index].gi;
+        }
+
+        /** Returns the offset of the glyph's cell from the start of the text.
+         */
+        Coord x(uint32_t index) const {
+            ASSERT(index < glyphs_.size());
+            return glyphs_[index].x;
+        }
+
+        /** Returns the column just after the glyph's cell, i.e. the next glyph's offset or the text width.
+         */
+        Coord right(uint32_t index) const {
+            ASSERT(index < glyphs_.size());
+            return (index + 1 < glyphs_.size()) ? glyphs_[index + 1].x : width_;
+        }
+
+        /** Returns index of the glyph whose cell contains the given column, or size() if the column is outside of the text.
+         */
+        uint32_t indexAt(Coord column) const {
+            if (column < 0 || column >= width_)
+                return size();
+            // find the last glyph starting at or before the column
+            uint32_t lo = 0;
+            uint32_t hi = size();
+            while (lo < hi) {
+                uint32_t mid = (lo + hi) / 2;
+                if (glyphs_[mid].x <= column)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            return lo - 1;
+        }
+
+    private:
+
+        struct Glyph {
+            GlyphInfo const * gi;
+            Coord x;
+        };
+
+        std::vector<Glyph> glyphs_;
+        Coord width_ = 0;
+
+    }; // rckid::GlyphRun
+
+} // namespace rckid
@@ -17,6 +17,18 @@ namespace rckid {
         virtual Coord height() const = 0;
         virtual Color::Representation colorRepresentation() const = 0;
         virtual Bitmap decode() = 0;
+
+        /** Decodes the image incrementally, at most given number of rows at a time. 
+         
+            The bitmap must be empty for the first call, which creates it, and the same bitmap must be passed to all subsequent calls. Returns true when the whole image has been decoded. This allows spreading the decoding of larger images over multiple frames, such as when preparing the next carousel item in the background.
+
+            The default implementation ignores the row limit and decodes the whole image in the first call. Decoders that can decode row by row override it, currently only the QOI decoder does. The PNG decoder uses the default, because its library inflates the whole image in a single call that cannot be suspended. 
+         */
+        virtual bool decodeRows(Bitmap & into, [[maybe_unused]] Coord maxRows) {
+            if (into.empty())
+                into = decode();
+            return true;
+        }
     }; 
 
     /** Simple & resource efficient raw bitmap image decoder.
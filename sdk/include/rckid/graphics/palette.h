@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+
+#include <rckid/error.h>
+#include <rckid/graphics/color.h>
+
+namespace rckid {
+
+    /** Animatable palette for indexed bitmaps.
+
+        Palette keeps two sets of colors - the base colors and the current colors that are used for rendering. Effects such as fades and per-index overrides only change the current colors and are always calculated from the base colors, so they do not accumulate rounding errors and can be undone by reset(). Palette rotation (color cycling) changes the base colors as well so that it can be combined with fades.
+
+        All effects cost O(palette size) per frame, regardless of the number of pixels using the palette. To render a bitmap with the palette, set it as the bitmap's palette override, or pass the current colors to the blit functions directly. The current colors pointer is stable for the lifetime of the palette.
+
+        Rotations can be used for water, fire and other color cycling effects, fades for screen transitions and flashing and overrides (or a second palette with the same base colors) for things like team colors of sprites sharing the same bitmap.
+     */
+    class Palette {
+    public:
+
+        /** Creates palette of given size (16 or 256 colors for the Index16 and Index256 bitmaps respectively) with all colors black.
+         */
+        explicit Palette(uint32_t size = 256):
+            size_{size},
+            base_{new Color::RGB565[size]},
+            colors_{new Color::RGB565[size]} {
+            std::fill(base_, base_ + size_, Color::RGB565{0});
+            std::fill(colors_, colors_ + size_, Color::RGB565{0});
+        }
+
+        /** Creates palette with the given base colors, such as palette of a bitmap.
+         */
+        Palette(Color::RGB565 const * colors, uint32_t size):
+            size_{size},
+            base_{new Color::RGB565[size]},
+            colors_{new Color::RGB565[size]} {
+            memcpy(base_, colors, size_ * sizeof(Color::RGB565));
+            memcpy(colors_, colors, size_ * sizeof(Color::RGB565));
+        }
+
+        Palette(Palette const &) = delete;
+        Palette & operator = (Palette const &) = delete;
+
+        Palette(Palette && other) noexcept:
+            size_{other.size_},
+            base_{other.base_},
+            colors_{other.colors_} {
+            other.size_ = 0;
+            other.base_ = nullptr;
+            other.colors_ = nullptr;
+        }
+
+        Palette & operator = (Palette && other) noexcept {
+            if (this == & other)
+                return *this;
+            delete [] base_;
+            delete [] colors_;
+            size_ = other.size_;
+            base_ = other.base_;
+            colors_ = other.colors_;
+            other.size_ = 0;
+            other.base_ = nullptr;
+            other.colors_ = nullptr;
+            return *this;
+        }
+
+        ~Palette() {
+            delete [] base_;
+            delete [] colors_;
+        }
+
+        uint32_t size() const { return size_; }
+
+        /** Returns the current colors that should be used for rendering.
+         */
+        Color::RGB565 const * colors() const { return colors_; }
+
+        Color::RGB565 operator [] (uint32_t index) const {
+            ASSERT(index < size_);
+            return colors_[index];
+        }
+
+        Color::RGB565 base(uint32_t index) const {
+            ASSERT(index < size_);
+            return base_[index];
+        }
+
+        /** Sets both base and current color at given index.
+         */
+        void setColor(uint32_t index, Color::RGB565 color) {
+            ASSERT(index < size_);
+            base_[index] = color;
+            colors_[index] = color;
+        }
+
+        /** Overrides the current color at given index, leaving the base color intact.
+         */
+        void setOverride(uint32_t index, Color::RGB565 color) {
+            ASSERT(index < size_);
+            colors_[index] = color;
+        }
+
+        /** Resets the current colors to the base colors, removing all fades and overrides.
+         */
+        void reset() {
+            memcpy(colors_, base_, size_ * sizeof(Color::RGB565));
+        }
+
+        /** Rotates count colors starting at first by given number of steps. Positive steps move the colors towards higher indices, i.e. color at first becomes color at first + steps.
+         */
+        void rotate(uint32_t first, uint32_t count, int32_t steps = 1) {
+            ASSERT(first + count <= size_);
+            if (count < 2)
+                return;
+            steps %= static_cast<int32_t>(count);
+            if (steps == 0)
+                return;
+            uint32_t middle = count - ((steps > 0) ? steps : count + steps);
+            std::rotate(base_ + first, base_ + first + middle, base_ + first + count);
+            std::rotate(colors_ + first, colors_ + first + middle, colors_ + first + count);
+        }
+
+        /** Fades the current colors of the whole palette from their base colors towards the target. Amount of 0 leaves the base colors, 255 is the target color.
+         */
+        void fade(Color target, uint8_t amount) { fade(0, size_, target, amount); }
+
+        void fade(uint32_t first, uint32_t count, Color target, uint8_t amount) {
+            ASSERT(first + count <= size_);
+            for (uint32_t i = first, e = first + count; i < e; ++i)
+                colors_[i] = Color::blend(Color{base_[i]}, target, amount).toRGB565();
+        }
+
+        /** Fades the current colors from the base colors towards the current colors of another palette. This can be used for transitions between two palettes, such as day and night.
+         */
+        void fade(Palette const & target, uint8_t amount) {
+            uint32_t n = std::min(size_, target.size_);
+            for (uint32_t i = 0; i < n; ++i)
+                colors_[i] = Color::blend(Color{base_[i]}, Color{target.colors_[i]}, amount).toRGB565();
+        }
+
+    private:
+        uint32_t size_;
+        Color::RGB565 * base_;
+        Color::RGB565 * colors_;
+
+    }; // rckid::Palette
+
+} // namespace rckid
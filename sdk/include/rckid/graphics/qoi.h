@@ -0,0 +1,96 @@
+#pragma once
+
+#include <rckid/graphics/image_decoder.h>
+#include <rckid/graphics/qoi_encoder.h>
+
+namespace rckid {
+
+    /** QOI image decoder.
+
+        Decodes the image directly into the column-major pixel array of the bitmap while reading the stream in small chunks, so that apart from the bitmap itself, the memory requirements are minimal. The image can be decoded into any color representation. For RGB565 and RGB332 the colors are simply converted, for indexed representations the palette is built from the colors encountered in the image. If there are more colors than palette entries, the extra colors are mapped to the closest palette entries.
+
+        Pixels with alpha below 50% are decoded as black, which is the default transparent color of the bitmaps, same as with the PNG decoder.
+
+        Streams with invalid header, or images larger than MAX_SIZE in either dimension are rejected. Such decoder is not good() and decodes into an empty bitmap.
+     */
+    class QOIImageDecoder : public ImageDecoder {
+    public:
+
+        static constexpr uint32_t MAX_SIZE = 4096;
+
+        QOIImageDecoder(ImageSource && src, Color::Representation colorRep = Color::Representation::RGB565):
+            QOIImageDecoder(src.toStream(), colorRep) {
+        }
+
+        QOIImageDecoder(unique_ptr<RandomReadStream> && stream, Color::Representation colorRep = Color::Representation::RGB565);
+
+        Coord width() const override { return w_; }
+
+        Coord height() const override { return h_; }
+
+        Color::Representation colorRepresentation() const override { return colorRep_; }
+
+        Bitmap decode() override;
+
+        /** Decodes the image row by row, keeping the decoder state between the calls. If the bitmap passed to subsequent calls does not match the image, nothing is decoded and true is returned.
+         */
+        bool decodeRows(Bitmap & into, Coord maxRows) override;
+
+        /** Returns true if the stream contained valid QOI header.
+         */
+        bool good() const { return w_ > 0 && h_ > 0; }
+
+    private:
+
+        template<Color::Representation R, typename T>
+        void decodePixels(uint8_t * pixels, Coord endRow, T toRaw);
+
+        static uint16_t toRGB565(uint8_t r, uint8_t g, uint8_t b) {
+            return static_cast<uint16_t>(Color::RGB(r, g, b).toRGB565());
+        }
+
+        static uint16_t toRGB332(uint8_t r, uint8_t g, uint8_t b) {
+            return static_cast<uint16_t>(static_cast<uint8_t>(Color::RGB(r, g, b).toRGB332()));
+        }
+
+        /** Returns the palette index for given color, adding the color to the palette if there is space.
+         */
+        uint16_t toIndex(uint8_t r, uint8_t g, uint8_t b);
+
+        uint16_t toRaw(uint8_t r, uint8_t g, uint8_t b);
+
+        uint32_t maxPaletteColors() const { return colorRep_ == Color::Representation::Index256 ? 256 : 16; }
+
+        uint8_t nextByte() {
+            if (bufferPos_ == bufferSize_) {
+                bufferSize_ = stream_->read(buffer_, sizeof(buffer_));
+                bufferPos_ = 0;
+                if (bufferSize_ == 0)
+                    return 0;
+            }
+            return buffer_[bufferPos_++];
+        }
+
+        unique_ptr<RandomReadStream> stream_;
+        Coord w_ = 0;
+        Coord h_ = 0;
+        Color::Representation colorRep_;
+        uint8_t buffer_[256];
+        uint32_t bufferSize_ = 0;
+        uint32_t bufferPos_ = 0;
+        // decoding state, kept between the decodeRows() calls. The QOI index table is stored together with the raw values of the indexed colors so that they do not have to be converted again
+        Coord row_ = 0;
+        uint32_t index_[64];
+        uint16_t indexRaw_[64];
+        uint8_t r_ = 0;
+        uint8_t g_ = 0;
+        uint8_t b_ = 0;
+        uint8_t a_ = 255;
+        uint16_t raw_ = 0;
+        uint32_t run_ = 0;
+        // palette of the decoded bitmap for indexed color representations (owned by the bitmap)
+        Color::RGB565 * palette_ = nullptr;
+        uint32_t numColors_ = 0;
+    }; // rckid::QOIImageDecoder
+
+} // namespace rckid
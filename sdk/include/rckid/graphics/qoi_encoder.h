@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstring>
+#include <functional>
+
+#include <rckid/graphics/color.h>
+
+namespace rckid {
+
+    class Bitmap;
+    class WriteStream;
+
+    /** QOI (Quite OK Image) format encoder.
+
+        QOI is a very simple lossless image format that compresses reasonably well and decodes several times faster than PNG with virtually no memory overhead (64 colors index). This makes it ideal for wallpapers, icons and screenshots stored on the SD card. See https://qoiformat.org for the specification.
+
+        As the format is row-major, the pixels must be pushed row by row, left to right. The encoded bytes are passed to the write callback, so that the encoder can be used with streams in the SDK as well as by the asset tools. The encoder is header only and does not depend on the rest of the SDK for the same reason.
+     */
+    class QOIEncoder {
+    public:
+
+        using WriteCallback = std::function<void(uint8_t const * data, uint32_t size)>;
+
+        /** Creates the encoder and immediately writes the image header.
+         */
+        QOIEncoder(Coord width, Coord height, WriteCallback write, uint8_t channels = 3):
+            write_{std::move(write)} {
+            uint8_t header[14] = {
+                'q', 'o', 'i', 'f',
+                static_cast<uint8_t>(width >> 24), static_cast<uint8_t>(width >> 16), static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width),
+                static_cast<uint8_t>(height >> 24), static_cast<uint8_t>(height >> 16), static_cast<uint8_t>(height >> 8), static_cast<uint8_t>(height),
+                channels,
+                0, // sRGB with linear alpha
+            };
+            write_(header, sizeof(header));
+            memset(index_, 0, sizeof(index_));
+        }
+
+        /** Encodes a Bitmap of any color representation into the given stream. Transparent pixels are stored with zero alpha.
+         */
+        static void encode(Bitmap const & bmp, WriteStream & s);
+
+        void push(Color c) { push(c.r, c.g, c.b, 255); }
+
+        void push(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+            uint32_t px = pack(r, g, b, a);
+            if (px == last_) {
+                ++run_;
+                // runs are limited to 62 pixels as the remaining values are used by the RGB and RGBA tags
+                if (run_ == 62)
+                    flushRun();
+                return;
+            }
+            flushRun();
+            uint8_t h = hash(r, g, b, a);
+            if (index_[h] == px) {
+                emit(OP_INDEX | h);
+            } else {
+                index_[h] = px;
+                uint8_t la = static_cast<uint8_t>(last_);
+                if (a == la) {
+                    int8_t dr = static_cast<int8_t>(r - static_cast<uint8_t>(last_ >> 24));
+                    int8_t dg = static_cast<int8_t>(g - static_cast<uint8_t>(last_ >> 16));
+                    int8_t db = static_cast<int8_t>(b - static_cast<uint8_t>(last_ >> 8));
+                    int8_t drg = static_cast<int8_t>(dr - dg);
+                    int8_t dbg = static_cast<int8_t>(db - dg);
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        emit(OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+                    } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                        emit(OP_LUMA | (dg + 32));
+                        emit(((drg + 8) << 4) | (dbg + 8));
+                    } else {
+                        emit(OP_RGB);
+                        emit(r);
+                        emit(g);
+                        emit(b);
+                    }
+                } else {
+                    emit(OP_RGBA);
+                    emit(r);
+                    emit(g);
+                    emit(b);
+                    emit(a);
+                }
+            }
+            last_ = px;
+        }
+
+        /** Finishes the image by flushing any pending run and writing the end marker. All width * height pixels must have been pushed by now.
+         */
+        void finish() {
+            flushRun();
+            for (uint32_t i = 0; i < 7; ++i)
+                emit(0);
+            emit(1);
+            flush();
+        }
+
+        static constexpr uint8_t OP_INDEX = 0x00;
+        static constexpr uint8_t OP_DIFF = 0x40;
+        static constexpr uint8_t OP_LUMA = 0x80;
+        static constexpr uint8_t OP_RUN = 0xc0;
+        static constexpr uint8_t OP_RGB = 0xfe;
+        static constexpr uint8_t OP_RGBA = 0xff;
+        static constexpr uint8_t OP_MASK = 0xc0;
+
+        static constexpr uint8_t hash(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+            return static_cast<uint8_t>((r * 3 + g * 5 + b * 7 + a * 11) % 64);
+        }
+
+    private:
+
+        static constexpr uint32_t pack(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+            return (static_cast<uint32_t>(r) << 24) | (static_cast<uint32_t>(g) << 16) | (static_cast<uint32_t>(b) << 8) | a;
+        }
+
+        void flushRun() {
+            if (run_ > 0) {
+                emit(OP_RUN | (run_ - 1));
+                run_ = 0;
+            }
+        }
+
+        void emit(uint32_t byte) {
+            buffer_[bufferSize_++] = static_cast<uint8_t>(byte);
+            if (bufferSize_ == sizeof(buffer_))
+                flush();
+        }
+
+        void flush() {
+            if (bufferSize_ > 0)
+                write_(buffer_, bufferSize_);
+            bufferSize_ = 0;
+        }
+
+        WriteCallback write_;
+        uint32_t last_ = pack(0, 0, 0, 255);
+        uint32_t index_[64];
+        uint32_t run_ = 0;
+        uint8_t buffer_[64];
+        uint32_t bufferSize_ = 0;
+    }; // rckid::QOIEncoder
+
+} // namespace rckid
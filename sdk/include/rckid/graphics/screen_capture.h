@@ -0,0 +1,89 @@
+#pragma once
+
+#include <rckid/rckid.h>
+#include <rckid/task.h>
+#include <rckid/stream.h>
+#include <rckid/graphics/qoi_encoder.h>
+
+namespace rckid {
+
+    /** Background screen capture.
+
+        Captures the frames rendered through display::update() and stores them as QOI image in the given stream. Keeping the whole 320x240 frame would require 150KB of RAM, which is more than most apps can spare. Instead the capture is spread over multiple frames: from each frame only a strip of STRIP_ROWS rows is copied from the column stream as it is being sent to the display, and then encoded in the task's onTick() before the next frame starts. So that all strips come from the same frame, the app is held while the capture is in progress (see holdsFrame()): its loop() is not called and UI widgets do not advance their animations, the app just renders the same frame again for the fraction of a second the capture takes.
+
+        Frames rendered to a different display area than the one the capture started with (such as when some component temporarily re-enables the display with its own rect) are skipped. If the original area does not come back within MAX_SKIPPED_FRAMES frames, the capture fails.
+
+        QOI is used over PNG because it can be encoded in a single pass with minimal state and no seeking, which is what we need when streaming to files on the SD card. The output is deterministic, so the fantasy console produces identical files that can be used for golden tests.
+
+        The capture is a task that deletes itself when done, optionally calling the completion callback with the result first. Only one capture can be active at a time.
+     */
+    class ScreenCapture : public Task {
+    public:
+
+        static constexpr Coord STRIP_ROWS = 16;
+        static constexpr uint32_t MAX_SKIPPED_FRAMES = 30;
+
+        using DoneCallback = std::function<void(bool)>;
+
+        /** Starts capturing the current display area into the given stream. Returns false if there already is a capture in progress, in which case the done callback is not called.
+         */
+        static bool start(unique_ptr<WriteStream> stream, DoneCallback onDone = nullptr);
+
+        /** Returns the active screen capture, or nullptr if none.
+         */
+        static ScreenCapture * active() { return active_; }
+
+        /** Returns true if the app should not update its contents so that the next frame is the same as the previous one, i.e. when there is screen capture in progress. 
+         */
+        static bool holdsFrame() { return active_ != nullptr && active_->state_ != State::Failed; }
+
+        ~ScreenCapture() override;
+
+        /** Called by display::update() when a new frame is about to be rendered in given rectangle and direction. Returns true if the frame's pixels should be passed to the capture() method.
+         */
+        bool beginFrame(Rect rect, display::RefreshDirection direction);
+
+        /** Captures the next pixels from the frame. Must be called with all pixels of the frame, in the order in which they are sent to the display. Can be called from the display update interrupt.
+         */
+        void capture(Color::RGB565 const * pixels, uint32_t numPixels);
+
+    protected:
+
+        void onTick() override;
+
+        void releaseResources() override { finish(false); }
+
+    private:
+
+        enum class State {
+            Waiting,
+            Capturing,
+            Captured,
+            Failed,
+        };
+
+        ScreenCapture(unique_ptr<WriteStream> stream, DoneCallback onDone, Rect rect, display::RefreshDirection direction);
+
+        void finish(bool success);
+
+        unique_ptr<WriteStream> stream_;
+        DoneCallback onDone_;
+        Rect rect_;
+        display::RefreshDirection direction_;
+        QOIEncoder encoder_;
+        // row-major strip of the image that is captured from the current frame
+        Color::RGB565 * strip_ = nullptr;
+        Coord stripStart_ = 0;
+        Coord stripRows_ = 0;
+        // position of the next captured pixel in the frame
+        Coord x_ = 0;
+        Coord y_ = 0;
+        uint32_t remaining_ = 0;
+        uint32_t skippedFrames_ = 0;
+        volatile State state_ = State::Waiting;
+
+        static inline ScreenCapture * active_ = nullptr;
+
+    }; // rckid::ScreenCapture
+
+} // namespace rckid
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <rckid/rckid.h>
 #include <rckid/memory.h>
 #include <rckid/graphics/color.h>
 #include <rckid/graphics/tile.h>
@@ -51,6 +52,10 @@ namespace rckid {
     /** Tile grid is a more primitive counterpart to a tilemap.
      
         It provides a single tile layer for a tiles of fixed size (8x16 pixels), which is just enough for a readable fornt on RCKid. Its purpose is to provide cheap and efficient rendering of larger-ish text-like features, such as multi-line labels, headers, etc. 
+
+        Rows are stored as a ring buffer so that scrolling the grid by a line (see newline()) only moves the first row index and clears the new bottom row instead of moving all of the tiles in memory. 
+
+        The grid also keeps track of the on-screen tiles that have changed since the last clearDamage() call, so that its users (such as the header) only have to redraw those. Only actual changes are tracked: writing a tile that is the same as before (see set()) does not damage it and scrolling only damages the tiles whose contents differ from the tile that was displayed there before, which for text is mostly the lines, not the spaces around them. Tiles modified directly via the non-const at() method are not tracked, use markDamaged() for them.
      */
     class TileGrid {
     public:
@@ -105,6 +110,10 @@ namespace rckid {
                 flags_ = TRANSPARENT_MASK;
                 return *this;
             }
+
+            bool operator == (TileInfo const & other) const { return tile_ == other.tile_ && paletteOffset_ == other.paletteOffset_ && flags_ == other.flags_; }
+            bool operator != (TileInfo const & other) const { return ! (*this == other); }
+
         private:
             static constexpr uint8_t TRANSPARENT_MASK = 0x02;
             static constexpr uint8_t ALT_TILESET_MASK = 0x01;
@@ -121,12 +130,17 @@ namespace rckid {
             cols_{cols}, 
             rows_{rows}, 
             grid_{new TileInfo[cols * rows]},
+            damage_{new uint8_t[(cols * rows + 7) / 8]},
             palette_{palette} {
+            damageAll();
         }
 
         Color::RGB565 const * palette() const { return palette_; }
 
-        void setPalette(Color::RGB565 const * value) { palette_ = value; }
+        void setPalette(Color::RGB565 const * value) {
+            palette_ = value;
+            damageAll();
+        }
 
         Coord cols() const { return cols_; }
         Coord rows() const { return rows_; }
@@ -136,12 +150,88 @@ namespace rckid {
 
         TileInfo const & at(Coord x, Coord y) const {
             ASSERT(x < cols_ && y < rows_);
-            return grid_.get()[mapIndexColumnFirst(x, y, cols_, rows_)];
+            return grid_.get()[tileIndex(x, y)];
         }
 
+        /** Returns the tile at given coordinates for modification. The changes are not tracked, use set() instead, or markDamaged() after the change.
+         */
         TileInfo & at(Coord x, Coord y) {
             ASSERT(x < cols_ && y < rows_);
-            return grid_.get()[mapIndexColumnFirst(x, y, cols_, rows_)];
+            return grid_.get()[tileIndex(x, y)];
+        }
+
+        /** Sets the tile at given coordinates, damaging it if it differs from the current tile.
+         */
+        void set(Coord x, Coord y, TileInfo const & tile) {
+            ASSERT(x < cols_ && y < rows_);
+            TileInfo & t = grid_.get()[tileIndex(x, y)];
+            if (t == tile)
+                return;
+            t = tile;
+            markDamaged(x, y);
+        }
+
+        void markDamaged(Coord x, Coord y) {
+            ASSERT(x < cols_ && y < rows_);
+            uint32_t index = damageIndex(x, y);
+            damage_.get()[index / 8] |= 1 << (index % 8);
+        }
+
+        /** Returns the physical row where the first (top) row of the grid is stored. Increments by one with every newline(), wrapping around at the number of rows.
+         */
+        Coord scrollOffset() const { return top_; }
+
+        /** Returns true if the tile at given coordinates has changed since the last clearDamage() call.
+         */
+        bool damaged(Coord x, Coord y) const {
+            ASSERT(x < cols_ && y < rows_);
+            uint32_t index = damageIndex(x, y);
+            return damage_.get()[index / 8] & (1 << (index % 8));
+        }
+
+        /** Returns true if any tile in given tile column has been damaged. Thanks to the column-first layout the column's tiles are stored together.
+         */
+        bool columnDamaged(Coord x) const {
+            ASSERT(x < cols_);
+            uint32_t index = damageIndex(x, 0);
+            for (uint32_t i = index, e = index + rows_; i < e; ++i)
+                if (damage_.get()[i / 8] & (1 << (i % 8)))
+                    return true;
+            return false;
+        }
+
+        /** Returns the bounding rectangle of all damaged tiles in pixels, which is empty if there is no damage.
+         */
+        Rect damage() const {
+            Coord left = cols_;
+            Coord right = -1;
+            Coord top = rows_;
+            Coord bottom = -1;
+            for (Coord x = 0; x < cols_; ++x) {
+                if (! columnDamaged(x))
+                    continue;
+                left = std::min(left, x);
+                right = x;
+                for (Coord y = 0; y < rows_; ++y) {
+                    if (damaged(x, y)) {
+                        top = std::min(top, y);
+                        bottom = std::max(bottom, y);
+                    }
+                }
+            }
+            if (right < 0)
+                return Rect{};
+            return Rect::XYWH(left * Tile::width(), top * Tile::height(), (right - left + 1) * Tile::width(), (bottom - top + 1) * Tile::height());
+        }
+
+        /** Marks the whole grid as damaged, such as when the palette changes, or the grid has to be redrawn for other reasons.
+         */
+        void damageAll() {
+            memset(damage_.get(), 0xff, (cols_ * rows_ + 7) / 8);
+        }
+
+        void clearDamage() {
+            memset(damage_.get(), 0, (cols_ * rows_ + 7) / 8);
         }
 
         /** Returns writer for outputting text to the tilemap. 
@@ -169,24 +259,39 @@ namespace rckid {
                 }
                 where.x = 0;
             }
-            if (c != '\n')
-                at(where.x++, where.y).setAltTileset(false).setPaletteOffset(paletteIndex) = c;
+            if (c != '\n') {
+                TileInfo t = static_cast<TileGrid const *>(this)->at(where.x, where.y);
+                t.setAltTileset(false).setPaletteOffset(paletteIndex) = c;
+                set(where.x++, where.y, t);
+            }
             return where;
         }
 
-        /** Adds new line at the bottom of the grid, moving all the contents above
+        /** Adds new line at the bottom of the grid, scrolling all the contents above one line up.
+         
+            The rows are a ring buffer, so this only moves the top row index and clears the new bottom row. Only the tiles whose new contents differ from the tile displayed above them are damaged.
          */
         void newline() {
-            for (Coord y = 0; y < rows_ - 1; ++y)
-                for (Coord x = 0; x < cols_; ++x)
-                    at(x, y) = at(x, y + 1);
+            TileInfo empty;
+            for (Coord x = 0; x < cols_; ++x) {
+                for (Coord y = 0; y < rows_; ++y) {
+                    TileInfo const & next = (y + 1 < rows_) ? grid_.get()[tileIndex(x, y + 1)] : empty;
+                    if (grid_.get()[tileIndex(x, y)] != next)
+                        markDamaged(x, y);
+                }
+            }
+            top_ = (top_ + 1 == rows_) ? 0 : top_ + 1;
             for (Coord x = 0; x < cols_; ++x)
-                at(x, rows_ - 1).clear();
+                grid_.get()[tileIndex(x, rows_ - 1)].clear();
         }
 
         void clear(char c = ' ') {
-            for (Coord i = 0, e = cols_ * rows_; i != e; ++i)
-                grid_.get()[i].clear() = c;
+            TileInfo t;
+            t.clear() = c;
+            for (Coord x = 0; x < cols_; ++x)
+                for (Coord y = 0; y < rows_; ++y)
+                    set(x, y, t);
+            top_ = 0;
         }
 
         /** Displays the given icon at the selected coordinates. 
@@ -196,10 +301,12 @@ namespace rckid {
         bool setTileIcon(Coord x, Coord y, TileIcon icon, uint8_t paletteOffset = 0, bool altTileset = true) {
             bool changed = false;
             for (uint8_t i = 0, e = icon.size(); i != e; ++i) {
-                auto & t = at(x + i, y);
-                changed = (t.altTileset() != altTileset) || (t.paletteOffset() != paletteOffset) || (t.tile() != icon.raw_[i]) || changed;
-                if (changed)
-                    t.setAltTileset(altTileset).setPaletteOffset(paletteOffset) = icon.raw_[i];
+                TileInfo t = static_cast<TileGrid const *>(this)->at(x + i, y);
+                t.setAltTileset(altTileset).setPaletteOffset(paletteOffset) = icon.raw_[i];
+                if (t != static_cast<TileGrid const *>(this)->at(x + i, y)) {
+                    set(x + i, y, t);
+                    changed = true;
+                }
             }
             return changed;
         }
@@ -209,12 +316,13 @@ namespace rckid {
             if (col < 0 || col >= cols_)
                 return;
             Coord tileCol = column % Tile::width();
-            TileInfo const * ti = grid_.get() + mapIndexColumnFirst(col, 0, cols_, rows_);
-            // skip any tiles we do not want to render
-            if (startRow >= Tile::height()) {
-                ti += startRow / Tile::height() * cols_;
-                startRow %= Tile::height();
-            }
+            // tiles of the column are stored together, rows of the column are a ring buffer starting at top_
+            TileInfo const * colTiles = grid_.get() + mapIndexColumnFirst(col, 0, cols_, rows_);
+            Coord row = top_ + startRow / Tile::height();
+            if (row >= rows_)
+                row -= rows_;
+            startRow %= Tile::height();
+            TileInfo const * ti = colTiles + row;
             while (numPixels > 0) {
                 Tile const * tileset = ti->altTileset() ? assets::System16Tiles : assets::Iosevka16Tiles;
                 Coord drawPixels = std::min(numPixels, Tile::height() - startRow);
@@ -225,7 +333,12 @@ namespace rckid {
                 numPixels -= drawPixels;
                 startRow = 0;
                 buffer += drawPixels;
-                ++ti;
+                if (++row == rows_) {
+                    row = 0;
+                    ti = colTiles;
+                } else {
+                    ++ti;
+                }
             }
         }
 
@@ -238,10 +351,30 @@ namespace rckid {
         }
 
     private:
+
+        /** Returns the index of the tile at given logical coordinates, taking the scroll offset into account.
+         */
+        uint32_t tileIndex(Coord x, Coord y) const {
+            y += top_;
+            if (y >= rows_)
+                y -= rows_;
+            return mapIndexColumnFirst(x, y, cols_, rows_);
+        }
+
+        /** Returns the index of the damage bit for given logical coordinates. Unlike the tiles, the damage is tracked in screen coordinates so that it is not affected by scrolling.
+         */
+        uint32_t damageIndex(Coord x, Coord y) const {
+            return mapIndexColumnFirst(x, y, cols_, rows_);
+        }
+
         Coord cols_;
         Coord rows_;
         unique_ptr<TileInfo> grid_;
+        // one bit per tile, in the same order as the tiles
+        unique_ptr<uint8_t> damage_;
         Color::RGB565 const * palette_;
+        // physical row of the top row of the grid
+        Coord top_ = 0;
 
     }; // rckid::TileGrid
 
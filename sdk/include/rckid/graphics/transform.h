@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cmath>
+
+#include <rckid/error.h>
+#include <rckid/graphics/geometry.h>
+
+namespace rckid {
+
+    /** Filtering used when rendering transformed images.
+
+        Nearest is the fastest and simply picks the source pixel the destination pixel maps to. Box interpolates between the 2x2 source pixels whose centers surround the mapped position, weighted by their distance from it (i.e. bilinear filtering), which gives smoother results for rotations and scaling at roughly four times the cost per pixel. Identity and other pixel-aligned transformations are rendered exactly.
+     */
+    enum class Filter {
+        Nearest,
+        Box,
+    };
+
+    /** 2D affine transformation in fixed point arithmetics.
+
+        The transformation maps point (x, y) to (a * x + b * y + tx, c * x + d * y + ty). All coefficients are stored as 16.16 fixed point numbers so that rendering only requires integer additions per pixel. The factory methods take floats for convenience, which is fine as they are only used during setup, not in the rendering loops.
+
+        Transformations can be composed with the multiplication operator, where `A * B` first applies B and then A, as is usual with matrices.
+     */
+    class Transform {
+    public:
+        static constexpr uint32_t FRACTION_BITS = 16;
+        static constexpr int32_t ONE = 1 << FRACTION_BITS;
+
+        constexpr Transform() = default;
+
+        static constexpr Transform Identity() { return Transform{ONE, 0, 0, ONE, 0, 0}; }
+
+        static constexpr Transform Translate(Coord dx, Coord dy) {
+            return Transform{ONE, 0, 0, ONE, dx * ONE, dy * ONE};
+        }
+
+        static Transform Scale(float s) { return Scale(s, s); }
+
+        static Transform Scale(float sx, float sy) {
+            return Transform{toFixed(sx), 0, 0, toFixed(sy), 0, 0};
+        }
+
+        /** Rotation by given angle in degrees around the origin. Positive angles rotate clockwise on the screen as the y axis points down.
+         */
+        static Transform Rotate(float degrees) {
+            float rad = degrees * 3.14159265f / 180.0f;
+            int32_t s = toFixed(std::sin(rad));
+            int32_t c = toFixed(std::cos(rad));
+            return Transform{c, -s, s, c, 0, 0};
+        }
+
+        /** Rotation and uniform scaling around the given center point, the most common transformation for sprites and images.
+         */
+        static Transform RotateScale(float degrees, float scale, Point center) {
+            return Translate(center.x, center.y) * Rotate(degrees) * Scale(scale) * Translate(-center.x, -center.y);
+        }
+
+        constexpr int32_t a() const { return a_; }
+        constexpr int32_t b() const { return b_; }
+        constexpr int32_t c() const { return c_; }
+        constexpr int32_t d() const { return d_; }
+        constexpr int32_t tx() const { return tx_; }
+        constexpr int32_t ty() const { return ty_; }
+
+        /** Returns true if the transformation has no rotation or skew component, i.e. rows and columns stay rows and columns.
+         */
+        constexpr bool isAxisAligned() const { return b_ == 0 && c_ == 0; }
+
+        constexpr bool isIdentity() const { return a_ == ONE && d_ == ONE && b_ == 0 && c_ == 0 && tx_ == 0 && ty_ == 0; }
+
+        constexpr Transform operator * (Transform const & other) const {
+            return Transform{
+                mul(a_, other.a_) + mul(b_, other.c_),
+                mul(a_, other.b_) + mul(b_, other.d_),
+                mul(c_, other.a_) + mul(d_, other.c_),
+                mul(c_, other.b_) + mul(d_, other.d_),
+                mul(a_, other.tx_) + mul(b_, other.ty_) + tx_,
+                mul(c_, other.tx_) + mul(d_, other.ty_) + ty_,
+            };
+        }
+
+        /** Returns the inverse transformation. The transformation must not be degenerate (i.e. scale to zero).
+         */
+        Transform inverse() const {
+            int64_t det = static_cast<int64_t>(a_) * d_ - static_cast<int64_t>(b_) * c_;
+            ASSERT(det != 0);
+            // det is in 32.32, so shifting the coefficients by 32 bits gives 16.16 results
+            int32_t ia = static_cast<int32_t>((static_cast<int64_t>(d_) << 32) / det);
+            int32_t ib = static_cast<int32_t>((static_cast<int64_t>(-b_) << 32) / det);
+            int32_t ic = static_cast<int32_t>((static_cast<int64_t>(-c_) << 32) / det);
+            int32_t id = static_cast<int32_t>((static_cast<int64_t>(a_) << 32) / det);
+            return Transform{
+                ia, ib, ic, id,
+                -(mul(ia, tx_) + mul(ib, ty_)),
+                -(mul(ic, tx_) + mul(id, ty_)),
+            };
+        }
+
+        /** Maps given point, rounding the result to nearest integer coordinates.
+         */
+        constexpr Point map(Point p) const {
+            return Point{
+                round(a_ * p.x + b_ * p.y + tx_),
+                round(c_ * p.x + d_ * p.y + ty_),
+            };
+        }
+
+        /** Returns the bounding box of a w x h rectangle at origin after the transformation.
+         */
+        Rect mapRect(Coord w, Coord h) const {
+            Point p[] = { map(Point{0, 0}), map(Point{w, 0}), map(Point{0, h}), map(Point{w, h}) };
+            Coord l = p[0].x, r = p[0].x, t = p[0].y, b = p[0].y;
+            for (Point const & x : p) {
+                l = std::min(l, x.x);
+                r = std::max(r, x.x);
+                t = std::min(t, x.y);
+                b = std::max(b, x.y);
+            }
+            return Rect::XYWH(l, t, r - l, b - t);
+        }
+
+    private:
+
+        constexpr Transform(int32_t a, int32_t b, int32_t c, int32_t d, int32_t tx, int32_t ty):
+            a_{a}, b_{b}, c_{c}, d_{d}, tx_{tx}, ty_{ty} {
+        }
+
+        static int32_t toFixed(float x) { return static_cast<int32_t>(std::lround(x * ONE)); }
+
+        static constexpr int32_t mul(int32_t x, int32_t y) {
+            return static_cast<int32_t>((static_cast<int64_t>(x) * y) >> FRACTION_BITS);
+        }
+
+        static constexpr Coord round(int32_t x) { return (x + (ONE / 2)) >> FRACTION_BITS; }
+
+        int32_t a_ = ONE;
+        int32_t b_ = 0;
+        int32_t c_ = 0;
+        int32_t d_ = ONE;
+        int32_t tx_ = 0;
+        int32_t ty_ = 0;
+
+    }; // rckid::Transform
+
+} // namespace rckid
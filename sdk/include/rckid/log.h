@@ -61,6 +61,14 @@
 #define LL_FPS 0
 #endif
 
+/** Audio playback statistics.
+
+    When enabled, the playback task outputs every second the underruns, buffer fill level, decode time and refill latency of the stream being played (see audio::StreamStats). Useful to size the audio buffers, especially on the fantasy console, where the audio callback is driven by raylib's audio thread.
+ */
+#ifndef LL_AUDIO
+#define LL_AUDIO 0
+#endif
+
 
 #ifndef LL_I2C
 #define LL_I2C 1
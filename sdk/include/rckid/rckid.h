@@ -181,6 +181,18 @@ namespace rckid {
 
         void enable(Rect rect, RefreshDirection  direction);
 
+        /** Returns the display area and refresh direction set by the last enable() call.
+         */
+        Rect rect();
+
+        RefreshDirection refreshDirection();
+
+        /** Updates the display area with pixels provided by the callback.
+         
+            Wrapper over hal::display::update() that should be used by the SDK and apps instead of the HAL function as it also feeds the rendered pixels to the active screen capture, if any.
+         */
+        void update(Callback callback);
+
         uint8_t brightness();
 
         void setBrightness(uint8_t value);
@@ -31,6 +31,19 @@ namespace rckid {
          */
         virtual bool eof() const = 0;
 
+        /** Reads exactly size bytes unless the stream ends first, i.e. repeats read() until it returns 0. Returns the actual number of bytes read.
+         */
+        uint32_t readFully(uint8_t * buffer, uint32_t size) {
+            uint32_t result = 0;
+            while (result < size) {
+                uint32_t n = read(buffer + result, size - result);
+                if (n == 0)
+                    break;
+                result += n;
+            }
+            return result;
+        }
+
         /** Reads single byte from the stream. 
          
             Returns std::nullopt if the stream is at its end (eof() == true).
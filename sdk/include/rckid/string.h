@@ -248,9 +248,9 @@ namespace rckid {
             return immutable_ptr<uint8_t>{ptr, size};
         }
 
-        /** Returns true if the given character is word separator.
+        /** Returns true if the given character, or unicode codepoint, is word separator. Codepoints outside of ASCII are mostly letters and never separate words.
          */
-        static bool isWordSeparator(char c) {
+        static bool isWordSeparator(uint32_t c) {
             if (c >= 'a' && c <= 'z')
                 return false;
             if (c >= 'A' && c <= 'Z')
@@ -259,6 +259,8 @@ namespace rckid {
                 return false;
             if (c == '_')
                 return false;
+            if (c >= 0x80)
+                return false;
             return true;
         }
 
@@ -373,6 +375,97 @@ namespace rckid {
         str = String{std::move(buffer), size + 1};
     }
 
+    // UTF-8
+
+    /** Codepoint used for invalid UTF-8 sequences. 
+     */
+    static constexpr uint32_t UTF8_REPLACEMENT_CHAR = 0xfffd;
+
+    /** Decodes single UTF-8 encoded codepoint from the string and advances the pointer past it. 
+     
+        Invalid sequences are decoded as the replacement character one byte at a time so that the decoding always makes progress. ASCII characters take the first branch only so that ASCII heavy text is not slowed down by the decoding. 
+     */
+    inline uint32_t decodeUTF8(char const * & str) {
+        uint8_t c = static_cast<uint8_t>(*str++);
+        if (c < 0x80)
+            return c;
+        uint32_t result;
+        uint32_t len;
+        if ((c & 0xe0) == 0xc0) {
+            result = c & 0x1f;
+            len = 1;
+        } else if ((c & 0xf0) == 0xe0) {
+            result = c & 0x0f;
+            len = 2;
+        } else if ((c & 0xf8) == 0xf0) {
+            result = c & 0x07;
+            len = 3;
+        } else {
+            return UTF8_REPLACEMENT_CHAR;
+        }
+        while (len-- > 0) {
+            uint8_t next = static_cast<uint8_t>(*str);
+            // this also stops at the terminating zero
+            if ((next & 0xc0) != 0x80)
+                return UTF8_REPLACEMENT_CHAR;
+            result = (result << 6) | (next & 0x3f);
+            ++str;
+        }
+        return result;
+    }
+
+    /** Returns the offset of the codepoint preceding the given byte offset in the UTF-8 encoded string. The offset must be greater than 0.
+     */
+    inline uint32_t prevUTF8Offset(char const * str, uint32_t offset) {
+        ASSERT(offset > 0);
+        --offset;
+        while (offset > 0 && (static_cast<uint8_t>(str[offset]) & 0xc0) == 0x80)
+            --offset;
+        return offset;
+    }
+
+    /** Incremental UTF-8 decoder for places where the text arrives one byte at a time, such as writers. 
+     */
+    class UTF8Decoder {
+    public:
+
+        /** Feeds next byte to the decoder. Returns true and sets the codepoint if the byte completes a codepoint, false if more bytes are needed. 
+         */
+        bool decode(char c, uint32_t & codepoint) {
+            uint8_t b = static_cast<uint8_t>(c);
+            if (remaining_ > 0 && (b & 0xc0) == 0x80) {
+                cp_ = (cp_ << 6) | (b & 0x3f);
+                if (--remaining_ != 0)
+                    return false;
+                codepoint = cp_;
+                return true;
+            }
+            // any unfinished sequence is silently dropped
+            remaining_ = 0;
+            if (b < 0x80) {
+                codepoint = b;
+                return true;
+            } else if ((b & 0xe0) == 0xc0) {
+                cp_ = b & 0x1f;
+                remaining_ = 1;
+            } else if ((b & 0xf0) == 0xe0) {
+                cp_ = b & 0x0f;
+                remaining_ = 2;
+            } else if ((b & 0xf8) == 0xf0) {
+                cp_ = b & 0x07;
+                remaining_ = 3;
+            } else {
+                codepoint = UTF8_REPLACEMENT_CHAR;
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        uint32_t cp_ = 0;
+        uint32_t remaining_ = 0;
+    }; // rckid::UTF8Decoder
+
     // extra formatters
 
     template<typename T>
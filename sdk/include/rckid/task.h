@@ -46,8 +46,10 @@ namespace rckid {
         static void runAll() {
             Task * current = top_;
             while (current != nullptr) {
-                current->onTick();
+                // tasks may delete themselves when done so we need to get ptr to next first
+                Task * x = current;
                 current = current->next_;
+                x->onTick();
             }
         }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <rckid/task.h>
+#include <rckid/graphics/image_decoder.h>
 #include <rckid/ui/widget.h>
 #include <rckid/ui/image.h>
 #include <rckid/ui/label.h>
@@ -63,6 +65,16 @@ namespace rckid::ui {
         }
 
         void set(String text, ImageSource icon) {
+            set(std::move(text), Bitmap{std::move(icon)});
+        }
+
+        void set(String text, ImageSource icon, Direction dir) {
+            set(std::move(text), Bitmap{std::move(icon)}, dir);
+        }
+
+        /** Sets the current item with already decoded icon. 
+         */
+        void set(String text, Bitmap icon) {
             setCurrent(std::move(text), std::move(icon));
             with(bImg_)
                 << SetVisibility(false);
@@ -70,7 +82,7 @@ namespace rckid::ui {
                 << SetVisibility(false);
         }
 
-        void set(String text, ImageSource icon, Direction dir) {
+        void set(String text, Bitmap icon, Direction dir) {
             setCurrent(std::move(text), std::move(icon));
             // start the appropriate animation
             startAnimation(dir);
@@ -95,7 +107,7 @@ namespace rckid::ui {
                 << SetVisibility(false);
         }
 
-        void setCurrent(String text, ImageSource icon) {
+        void setCurrent(String text, Bitmap bmp) {
             if (!idle())
                 cancelAnimations();
             std::swap(aImg_, bImg_);
@@ -104,7 +116,6 @@ namespace rckid::ui {
             aImg_->clearChildren();
             aText_->clearChildren();
             // first set up the widgets so that we can calculate their size
-            Bitmap bmp{std::move(icon)};
             with(aText_)
                 << SetText(std::move(text));
             Coord iconWidth = bmp.width();
@@ -182,6 +193,132 @@ namespace rckid::ui {
 
     }; // rckid::ui::Carousel
 
+    /** Background decoder of carousel icons. 
+     
+        Keeps the icons of up to two menu items (the neighbors of the current carousel item) and decodes them in the background, a limited number of rows every tick, so that when the carousel moves to either of them, the already decoded icon can be used and the transition starts immediately, even if the icon has to be read from the SD card. The first of the prefetched items is decoded first. 
+     */
+    class CarouselPrefetcher : public Task {
+    public:
+
+        Coord rowsPerTick() const { return rowsPerTick_; }
+
+        void setRowsPerTick(Coord value) { 
+            ASSERT(value > 0);
+            rowsPerTick_ = value; 
+        }
+
+        /** Forgets all prefetched icons. Must be called when the menu changes.
+         */
+        void reset() {
+            for (auto & slot : slots_)
+                slot = Slot{};
+        }
+
+        /** Starts prefetching icons of the two given items. 
+         
+            Icons of items that are already being prefetched are kept, other prefetched icons are discarded. If both items are the same, only one slot is used.
+         */
+        void prefetch(Menu & menu, uint32_t first, uint32_t second) {
+            Slot * a = find(first);
+            Slot * b = (second == first) ? a : find(second);
+            for (auto & slot : slots_) {
+                if (& slot == a || & slot == b)
+                    continue;
+                if (a == nullptr) {
+                    start(slot, menu, first);
+                    a = & slot;
+                    // in a two item menu both neighbors are the same item, which only needs one slot
+                    if (second == first)
+                        b = a;
+                } else if (b == nullptr) {
+                    start(slot, menu, second);
+                    b = & slot;
+                } else {
+                    slot = Slot{};
+                }
+            }
+            first_ = first;
+        }
+
+        /** Returns true if the icon of given item has been fully decoded.
+         */
+        bool ready(uint32_t index) {
+            Slot * slot = find(index);
+            return slot != nullptr && slot->done;
+        }
+
+        /** Returns the icon of given menu item.
+         
+            If the icon has been prefetched, the decoded bitmap is returned, finishing its decoding first if necessary. Otherwise the icon is decoded from the item.
+         */
+        Bitmap take(Menu & menu, uint32_t index) {
+            Slot * slot = find(index);
+            if (slot == nullptr)
+                return Bitmap{ImageSource{menu[index].icon}};
+            while (! slot->done)
+                decode(*slot, std::numeric_limits<Coord>::max());
+            Bitmap result{std::move(slot->bmp)};
+            *slot = Slot{};
+            return result;
+        }
+
+    protected:
+
+        void onTick() override {
+            Slot * slot = find(first_);
+            if (slot == nullptr || slot->done)
+                slot = slots_[0].done ? & slots_[1] : & slots_[0];
+            if (! slot->done)
+                decode(*slot, rowsPerTick_);
+        }
+
+        void releaseResources() override {
+            reset();
+        }
+
+    private:
+
+        static constexpr uint32_t NO_INDEX = 0xffffffff;
+
+        struct Slot {
+            uint32_t index = NO_INDEX;
+            unique_ptr<ImageDecoder> decoder;
+            Bitmap bmp;
+            // empty slots are done
+            bool done = true;
+        }; 
+
+        Slot * find(uint32_t index) {
+            for (auto & slot : slots_)
+                if (slot.index == index)
+                    return & slot;
+            return nullptr;
+        }
+
+        void start(Slot & slot, Menu & menu, uint32_t index) {
+            slot = Slot{};
+            slot.index = index;
+            ImageSource src{menu[index].icon};
+            if (! src.empty())
+                slot.decoder = src.toDecoder();
+            slot.done = (slot.decoder == nullptr);
+        }
+
+        void decode(Slot & slot, Coord maxRows) {
+            ASSERT(slot.decoder != nullptr);
+            if (slot.decoder->decodeRows(slot.bmp, maxRows)) {
+                // release the decoder (and its stream) as soon as we are done
+                slot.decoder = nullptr;
+                slot.done = true;
+            }
+        }
+
+        Slot slots_[2];
+        uint32_t first_ = NO_INDEX;
+        Coord rowsPerTick_ = 8;
+
+    }; // rckid::ui::CarouselPrefetcher
+
     /** Carousel augmented specifically for menu hierarchies.
      
         Provides handling of left/right key press to cycle through the menu, up or A to select submenu and B or down to return from the submenu. All other presses (i.e. A or up on item and B on root) are not cleared so that they can be processed by the application. 
@@ -228,6 +365,12 @@ namespace rckid::ui {
 
         Context const * context() const { return context_; }
 
+        /** Number of icon rows of the neighboring items decoded in the background every tick.
+         */
+        Coord prefetchRows() const { return prefetcher_.rowsPerTick(); }
+
+        void setPrefetchRows(Coord value) { prefetcher_.setRowsPerTick(value); }
+
         bool empty() const { return menu_ == nullptr || menu_->size() == 0; }
 
         MenuItem * currentItem() const { return empty() ? nullptr : & menu_->at(index_); }
@@ -238,10 +381,12 @@ namespace rckid::ui {
             if (menu_ == nullptr || index >= menu_->size())
                 return;
             index_ = index;
+            Bitmap icon = prefetcher_.take(*menu_, index_);
             MenuItem & m = menu_->at(index_);
-            set(m.text, m.icon);
+            set(m.text, std::move(icon));
             if (m.decorator() != nullptr)
                 m.decorator()(m, currentImage(), currentLabel());
+            prefetchNeighbors();
         }
 
         void resetMenu(MenuItem::GeneratorEvent generator) {
@@ -398,6 +543,7 @@ namespace rckid::ui {
         }
 
         void setMenu(unique_ptr<Menu> menu, uint32_t index, Direction dir) {
+            prefetcher_.reset();
             menu_ = std::move(menu);
             index_ = index;
             if (menu_ == nullptr || menu_->empty()) {
@@ -415,10 +561,19 @@ namespace rckid::ui {
             if (index >= menu_->size())
                 index = menu_->size() - 1;
             index_ = index;
+            Bitmap icon = prefetcher_.take(*menu_, index_);
             MenuItem & m = menu_->at(index_);
-            set(m.text, m.icon, dir);
+            set(m.text, std::move(icon), dir);
             if (m.decorator() != nullptr)
                 m.decorator()(m, currentImage(), currentLabel());
+            prefetchNeighbors();
+        }
+
+        /** Starts decoding icons of the items the carousel can move to next, right first, as that is the more common direction. 
+         */
+        void prefetchNeighbors() {
+            if (menu_->size() > 1)
+                prefetcher_.prefetch(*menu_, nextIndex(), prevIndex());
         }
 
         void onIdle() override {
@@ -445,6 +600,7 @@ namespace rckid::ui {
         unique_ptr<Menu> menu_;
         uint32_t index_ = 0;
         Context * context_ = nullptr;
+        CarouselPrefetcher prefetcher_;
 
         Widget * subWidget_ = nullptr;
         bool subWidgetFlyOut_ = false;
@@ -9,6 +9,8 @@ namespace rckid::ui {
         Displays notifications about the system state. Supports both column & row based rendering so that it can be used also in non UI-based applications. As the header is tiny, it is internally a singleton object to which the applications do not have direct access. 
 
         The header can either be always visible, or only show up when there is some change. 
+
+        As the header is rendered every frame, but its contents only change about once a second, it uses the tile grid's cache (see ui::TileGrid::enableCache()), which for the header is a small pixel strip. The strip is released when the header hides.
      */
     class Header : public TileGrid {
     public:
@@ -83,11 +85,16 @@ namespace rckid::ui {
             contents().renderRow(ownRow, startCol, buffer, numPixels);
         }
 
+        /** Takes the header palette from the style. 
+         */
+        void applyStyle(Style const & style) override;
+
     protected:
 
 
         /** When rendering, determine if we should  */
         void onRender() override {
+            TileGrid::onRender();
             if (visibility_ == Visibility::OnChange)
                 if ((remainingTicks_ > 0) && (--remainingTicks_ == 0))
                     hide();
@@ -96,18 +103,21 @@ namespace rckid::ui {
         void onIdle() override {
             if (remainingTicks_ == 0) {
                 Widget::setVisibility(false);
+                releaseCache();
                 setRect(Rect::XYWH(0, - TileGrid::tileHeight(), width(), height()));
             }
         }
 
     private:
 
+        static constexpr Coord COLS = display::WIDTH / TileGrid::tileWidth();
+
         Header():
-            TileGrid{display::WIDTH / TileGrid::tileWidth(), 1, nullptr},
-            palette_{defaultPalette()}
+            TileGrid{COLS, 1, nullptr}
         {
             ASSERT(instance_ == nullptr);
-            contents().setPalette(palette_.get());
+            contents().setPalette(palette_);
+            enableCache(32);
             instance_ = this;
             setRect(Rect::XYWH(0, - TileGrid::tileHeight(), display::WIDTH, TileGrid::tileHeight()));
             Widget::setVisibility(false);
@@ -178,36 +188,12 @@ namespace rckid::ui {
             remainingTicks_ = 0;
         }
 
-        static immutable_ptr<Color::RGB565> defaultPalette() {
-            Color::RGB565 * p = new Color::RGB565[32];
-            Color textFg = Style::defaultStyle().defaultFg();
-            for (uint8_t i = 0; i < 16; ++i)
-                p[i] = textFg.withBrightness(i << 4 | i).toRGB565();
-            // green (testFg before that used for index 1, offset 14)
-            p[16] = Color::RGB(0, 255, 0).toRGB565();
-            // red (offset 16)
-            p[17] = textFg.toRGB565();
-            p[18] = Color::RGB(255, 0, 0).toRGB565();
-            // blue (offset 18)
-            p[19] = textFg.toRGB565();
-            p[20] = Color::RGB(0, 0, 255).toRGB565();
-            // cyan (offset 20) 
-            p[21] = textFg.toRGB565();
-            p[22] = Color::RGB(0, 255, 255).toRGB565();
-            // violet (ioffset 22) 
-            p[23] = textFg.toRGB565();
-            p[24] = Color::RGB(255, 0, 255).toRGB565();
-           
-            return immutable_ptr<Color::RGB565>{p, 32};
-        }
-
-
         /** Ticks remaining for the header to be shown. 
         
          */
         uint32_t remainingTicks_ = 0;
 
-        immutable_ptr<Color::RGB565> palette_;
+        Color::RGB565 palette_[32];
         
         static inline Visibility visibility_ = Visibility::Always;
 
@@ -8,8 +8,62 @@
 namespace rckid::ui {
 
     /** Image widget is simply a wrapper widget around a bitmap.
+
+        In addition to the wrapper functionality, the image can be rendered with an affine transformation (rotation, scaling, flipping) applied to the bitmap. The transformation maps the bitmap coordinates to the contents position in the widget, i.e. it is applied after the alignment and offset. When no transformation is set, the image is rendered via the regular column blitting.
      */
-    using Image = Wrapper<Bitmap>;
+    class Image : public Wrapper<Bitmap> {
+    public:
+
+        Image() = default;
+        Image(Bitmap contents): Wrapper<Bitmap>{std::move(contents)} {}
+
+        std::optional<Transform> const & transform() const { return transform_; }
+
+        void setTransform(std::optional<Transform> value) {
+            transform_ = value;
+            updateInverseTransform();
+        }
+
+        /** Rotates and scales the image around its center. Rotation by 0 and scale of 1 removes the transformation altogether so that the fast default rendering is used.
+         */
+        void setRotationScale(float degrees, float scale) {
+            if (degrees == 0 && scale == 1)
+                setTransform(std::nullopt);
+            else
+                setTransform(Transform::RotateScale(degrees, scale, Point{contents_.width() / 2, contents_.height() / 2}));
+        }
+
+        Filter filter() const { return filter_; }
+
+        void setFilter(Filter value) { filter_ = value; }
+
+        void renderColumn(Coord column, Coord starty, Color::RGB565 * buffer, Coord numPixels) override {
+            if (! transform_.has_value())
+                return Wrapper<Bitmap>::renderColumn(column, starty, buffer, numPixels);
+            Widget::renderColumn(column, starty, buffer, numPixels);
+            if (contents_.empty())
+                return;
+            contents_.renderColumn(column, starty, buffer, numPixels, inverse_, filter_);
+        }
+
+    protected:
+
+        void onChange() override {
+            Wrapper<Bitmap>::onChange();
+            updateInverseTransform();
+        }
+
+    private:
+
+        void updateInverseTransform() {
+            if (transform_.has_value())
+                inverse_ = (Transform::Translate(contentsOffset_.x, contentsOffset_.y) * transform_.value()).inverse();
+        }
+
+        std::optional<Transform> transform_;
+        Transform inverse_;
+        Filter filter_ = Filter::Nearest;
+    }; // rckid::ui::Image
 
     /** Custom fluent bitmap setter for Image. 
      */
@@ -33,4 +87,16 @@ namespace rckid::ui {
             w->setRect(Rect::XYWH(w->position(), w->contents().width(), w->contents().height()));
         return w;
     }
+
+    struct SetTransform {
+        std::optional<Transform> transform;
+        Filter filter;
+        SetTransform(std::optional<Transform> transform, Filter filter = Filter::Nearest): transform{transform}, filter{filter} {}
+    };
+
+    inline with<Image> operator << (with<Image> w, SetTransform st) {
+        w->setFilter(st.filter);
+        w->setTransform(st.transform);
+        return w;
+    }
 } // namespace rckid::ui
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <rckid/string.h>
 #include <rckid/graphics/font.h>
+#include <rckid/graphics/glyph_run.h>
 #include <rckid/ui/widget.h>
 
 #include <assets/Iosevka16.h>
@@ -16,22 +17,28 @@ namespace rckid::ui {
         void setText(String value) {
             text_ = std::move(value);
             onChange();
+            invalidateLayout();
         }
 
         /** Takes up to a line from the given string and returns the rest.
          */
         String setTextLine(String const & value) {
+            char const * str = value.c_str();
             uint32_t end = 0; // end of the text that fits
             uint32_t endSep = 0;
             Coord w = 0;
+            GlyphInfo const * prev = nullptr;
             while (end < value.size()) {
-                char c = value[end];
+                char const * next = str + end;
+                uint32_t c = decodeUTF8(next);
                 GlyphInfo const * gi = font_->glyphInfoFor(c);
                 ASSERT(gi != nullptr);
-                if (w + gi->advanceX > width())
+                Coord advance = font_->kerning(prev, gi) + gi->advanceX;
+                if (w + advance > width())
                     break;
-                w += gi->advanceX;
-                ++end;
+                w += advance;
+                prev = gi;
+                end = static_cast<uint32_t>(next - str);
                 if (String::isWordSeparator(c))
                     endSep = end;
                 if (c == '\n')
@@ -40,11 +47,14 @@ namespace rckid::ui {
             // if no whole word made it, we'll break at where we got. If we got nowehere, take at least one char off.
             if (endSep == 0)
                 endSep = end;
-            if (endSep == 0)
-                endSep = 1;
+            if (endSep == 0) {
+                char const * next = str;
+                decodeUTF8(next);
+                endSep = static_cast<uint32_t>(next - str);
+            }
             uint32_t start; // start of the remainder
             if ((endSep > 0) && (end < value.size() - 1)) {
-                end = endSep - 1;
+                end = prevUTF8Offset(str, endSep);
                 start = endSep;
             } else {
                 start = end;
@@ -61,6 +71,7 @@ namespace rckid::ui {
             ASSERT(value != nullptr);
             font_ = std::move(value);
             onChange();
+            invalidateLayout();
         }
 
         HAlign hAlign() const { return textHAlign_; }
@@ -81,6 +92,7 @@ namespace rckid::ui {
 
         void setFg(Color value, Color bg = Color::Black()) {
             textColor_ = value;
+            styleFg_ = false;
             font_->createFontPalette(textPalette_, bg, textColor_);
         }
 
@@ -92,6 +104,7 @@ namespace rckid::ui {
          */
         void setFgGradient(Color fg, Color bg) {
             textColor_ = fg;
+            styleFg_ = false;
             font_->createFontPalette(textPalette_, bg, textColor_);
         }
 
@@ -114,36 +127,44 @@ namespace rckid::ui {
 
         Coord textWidth() const { return textWidth_; }
 
+        /** Labels measure to their text. 
+         */
+        Point measure() const override { return Point{textWidth_, font_->size}; }
+
         void renderColumn(Coord column, Coord starty, Color::RGB565 * buffer, Coord numPixels) override {
             Widget::renderColumn(column, starty, buffer, numPixels);
             adjustRenderParams(textOffset_, column, starty, buffer, numPixels);
-            // move to previous hint if needed
-            if (column < currentHint_.leftColumn) {
-                if (currentHint_.charOffset == 0) // no more characters left
-                    return;
-                GlyphInfo const * gi = font_->glyphInfoFor(text_[currentHint_.charOffset - 1]);
-                currentHint_ = Hint{currentHint_.leftColumn, gi, currentHint_.charOffset - 1};
-            }
-            // don't render if we are too far
-            if (column >= currentHint_.rightColumn)
+            // recalculate column relative to the text position
+            column -= textLeft_;
+            if (column < 0 || column >= run_.width())
                 return;
-            // recalculate column & starty relative to the text position
-            column -= currentHint_.leftColumn;
-            if (!useAlpha_)
-                font_->renderColumn(column, starty, numPixels, currentHint_.gi, buffer, textPalette_);
-            else 
-                font_->renderColumnAlpha(column, starty, numPixels, currentHint_.gi, buffer, textColor_);
+            // columns are rendered right to left so the glyph is usually the current one, or the one before it
+            if (column >= run_.right(cursor_))
+                cursor_ = run_.indexAt(column);
+            else
+                while (column < run_.x(cursor_))
+                    --cursor_;
+            renderGlyphColumn(cursor_, column, starty, buffer, numPixels);
+            // kerning and glyphs wider than their advance may put pixels of the neighbors into the column as well
+            if (cursor_ > 0)
+                renderGlyphColumn(cursor_ - 1, column, starty, buffer, numPixels);
+            if (cursor_ + 1 < run_.size())
+                renderGlyphColumn(cursor_ + 1, column, starty, buffer, numPixels);
         }
 
         void applyStyle(Style const & style) override {
             Widget::applyStyle(style);
-            setFg(style.defaultFg());
+            if (! styleFg_)
+                return;
+            // the palette for the default color is precomputed by the style
+            textColor_ = style.defaultFg();
+            memcpy(textPalette_, style.colors().defaultText, sizeof(textPalette_));
         }
 
         protected:
         void onRender() override {
-            // reset the rendering hint to the rightmost character
-            currentHint_ = rightmostHint_;
+            // reset the cursor to the rightmost glyph, which is rendered first
+            cursor_ = run_.empty() ? 0 : run_.size() - 1;
             Widget::onRender();
         }
 
@@ -151,38 +172,20 @@ namespace rckid::ui {
 
         friend class MultiLabel;
 
-        struct Hint {
-            Coord leftColumn = -1;
-            Coord rightColumn = -1;
-            GlyphInfo const * gi = nullptr;
-            uint32_t charOffset = 0;
-
-            Hint(Coord rightColumn, GlyphInfo const * gi, uint32_t charOffset):
-                leftColumn{rightColumn - gi->advanceX}, 
-                rightColumn{rightColumn}, 
-                gi{gi},
-                charOffset{charOffset} {
-            }
-
-            Hint() = default;
-        };
-
         void onChange() override {
-            if (text_.empty()) {
-                textWidth_ = 0;
-                rightmostHint_ = Hint{};
-            } else {
-                textWidth_ = font_->textWidth(text_);
-                GlyphInfo const * gi = font_->glyphInfoFor(text_[text_.size() - 1]);
+            run_.shape(font_, text_.c_str());
+            cursor_ = run_.empty() ? 0 : run_.size() - 1;
+            textWidth_ = run_.width();
+            if (! text_.empty()) {
                 switch (textHAlign_) {
                     case HAlign::Left:
-                        rightmostHint_ = Hint{textWidth_, gi, text_.size() - 1};
+                        textLeft_ = 0;
                         break;
                     case HAlign::Center:
-                        rightmostHint_ = Hint{(width() - (width() - textWidth_) / 2), gi, text_.size() - 1};
+                        textLeft_ = (width() - textWidth_) - (width() - textWidth_) / 2;
                         break;
                     case HAlign::Right:
-                        rightmostHint_ = Hint{width(), gi, text_.size() - 1};
+                        textLeft_ = width() - textWidth_;
                         break;
                     case HAlign::Manual: // do not change
                         break;
@@ -207,6 +210,14 @@ namespace rckid::ui {
             }
         }
 
+        void renderGlyphColumn(uint32_t index, Coord column, Coord starty, Color::RGB565 * buffer, Coord numPixels) {
+            column -= run_.x(index);
+            if (!useAlpha_)
+                font_->renderColumn(column, starty, numPixels, run_.glyph(index), buffer, textPalette_);
+            else 
+                font_->renderColumnAlpha(column, starty, numPixels, run_.glyph(index), buffer, textColor_);
+        }
+
         String text_; 
         Coord textWidth_ = 0;
         Font font_{assets::Iosevka16};
@@ -219,10 +230,14 @@ namespace rckid::ui {
             Color::White().withBrightness(170).toRGB565(),
             Color::White().toRGB565()
         };
-        // current character rendering hint
-        Hint currentHint_;
-        // this is where we store the rightmost character hint (the first one to be rendered due to right to left top to bottom rendering)
-        Hint rightmostHint_;
+        // false once the color is set explicitly, so that applying a style keeps it
+        bool styleFg_ = true;
+        // glyphs of the text with their offsets, calculated when the text or font changes
+        GlyphRun run_;
+        // offset of the text start within the label (before the text offset is applied)
+        Coord textLeft_ = 0;
+        // glyph containing the last rendered column
+        uint32_t cursor_ = 0;
         // whether to use slower per pixel blending when rendering the characters
         bool useAlpha_ = false;
         Point textOffset_{0,0};
@@ -346,7 +361,7 @@ namespace rckid::ui {
         }
 
         void onRender() override {
-            // reset the rendering hint to the rightmost character
+            // reset the rendering cursors to the rightmost glyphs
             for (auto & line : lines_)
                  line->onRender();
             Widget::onRender();
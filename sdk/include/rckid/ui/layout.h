@@ -0,0 +1,163 @@
+#pragma once
+
+#include <rckid/ui/widget.h>
+
+namespace rckid::ui {
+
+    /** Stack layout. 
+     
+        Arranges its visible children in a row, or in a column, so that apps do not have to calculate the children's rectangles by hand. Each child gets its measured size (see Widget::measure()), the children are placed one after another, separated by the spacing, and the whole run is aligned within the stack minus its padding. In the other direction, each child is aligned on its own. For a column, the horizontal alignment applies to the individual children and vertical alignment to the whole column, for a row it is the other way round. Manual alignment is the same as left or top.
+
+        The layout is not calculated when rendering. Instead, when children are added, hidden or shown, or when their measured size changes (they call invalidateLayout()), the stack is arranged once before the next frame and the resulting rectangles are simply stored in the children, which are then rendered as if positioned manually. Stacks can be nested, the measured size of a stack is the size of its arranged children plus padding. 
+     */
+    class Stack : public Widget {
+    public:
+
+        enum class Orientation {
+            Row, 
+            Column,
+        }; 
+
+        Stack(Orientation orientation = Orientation::Column): orientation_{orientation} {}
+
+        Orientation orientation() const { return orientation_; }
+
+        void setOrientation(Orientation value) {
+            orientation_ = value;
+            invalidateLayout();
+        }
+
+        Coord spacing() const { return spacing_; }
+
+        void setSpacing(Coord value) {
+            spacing_ = value;
+            invalidateLayout();
+        }
+
+        Coord padding() const { return padding_; }
+
+        void setPadding(Coord value) {
+            padding_ = value;
+            invalidateLayout();
+        }
+
+        HAlign hAlign() const { return hAlign_; }
+
+        void setHAlign(HAlign value) {
+            hAlign_ = value;
+            invalidateLayout();
+        }
+
+        VAlign vAlign() const { return vAlign_; }
+
+        void setVAlign(VAlign value) {
+            vAlign_ = value;
+            invalidateLayout();
+        }
+
+        Point measure() const override {
+            Point result = measureChildren();
+            return Point{result.x + padding_ * 2, result.y + padding_ * 2};
+        }
+
+        /** Arranges the children. This happens automatically before rendering when the layout is invalidated, but can be called explicitly to have the children positions available immediately.
+         */
+        void arrange() {
+            layoutDirty_ = false;
+            arrangedSize_ = Point{width(), height()};
+            Point content = measureChildren();
+            bool row = orientation_ == Orientation::Row;
+            // position of the first child along the main axis
+            Coord pos = row 
+                ? align(hAlign_ == HAlign::Center, hAlign_ == HAlign::Right, width(), content.x) 
+                : align(vAlign_ == VAlign::Center, vAlign_ == VAlign::Bottom, height(), content.y);
+            for (auto & child : children_) {
+                if (! child->visible())
+                    continue;
+                Point size = child->measure();
+                Rect r = row 
+                    ? Rect::XYWH(pos, align(vAlign_ == VAlign::Center, vAlign_ == VAlign::Bottom, height(), size.y), size.x, size.y)
+                    : Rect::XYWH(align(hAlign_ == HAlign::Center, hAlign_ == HAlign::Right, width(), size.x), pos, size.x, size.y);
+                // only update the rectangle if it changes so that the children do not recalculate their appearance needlessly
+                if (r != child->rect())
+                    child->setRect(r);
+                pos += (row ? size.x : size.y) + spacing_;
+            }
+        }
+
+    protected:
+
+        void onRender() override {
+            if (layoutDirty_)
+                arrange();
+            Widget::onRender();
+        }
+
+        void onChange() override {
+            Widget::onChange();
+            // only resizing requires new arrangement, moving the stack does not
+            if (arrangedSize_.x != width() || arrangedSize_.y != height())
+                layoutDirty_ = true;
+        }
+
+    private:
+
+        /** Returns the size of the children when arranged (without padding). 
+         */
+        Point measureChildren() const {
+            Point result;
+            uint32_t n = 0;
+            for (auto & child : children_) {
+                if (! child->visible())
+                    continue;
+                Point size = child->measure();
+                if (orientation_ == Orientation::Row) {
+                    result.x += size.x;
+                    result.y = std::max(result.y, size.y);
+                } else {
+                    result.x = std::max(result.x, size.x);
+                    result.y += size.y;
+                }
+                ++n;
+            }
+            if (n > 1) {
+                if (orientation_ == Orientation::Row)
+                    result.x += spacing_ * (n - 1);
+                else
+                    result.y += spacing_ * (n - 1);
+            }
+            return result;
+        }
+
+        /** Returns the start of an item of given size within the available space minus padding.
+         */
+        Coord align(bool center, bool end, Coord available, Coord size) const {
+            if (center)
+                return (available - size) / 2;
+            if (end)
+                return available - padding_ - size;
+            return padding_;
+        }
+
+        Orientation orientation_;
+        Coord spacing_ = 0;
+        Coord padding_ = 0;
+        HAlign hAlign_ = HAlign::Center;
+        VAlign vAlign_ = VAlign::Center;
+        // size of the stack when it was last arranged
+        Point arrangedSize_{-1, -1};
+
+    }; // rckid::ui::Stack
+
+    struct SetSpacing {
+        Coord value;
+        SetSpacing(Coord value): value{value} {}
+    };
+
+    template<typename T>
+    inline with<T> operator << (with<T> w, SetSpacing s) {
+        w->setSpacing(s.value);
+        return w;
+    }
+
+} // namespace rckid::ui
@@ -11,11 +11,12 @@
 namespace rckid::ui {
 
     class Label;
+    class Menu;
 
     class MenuItem {
     public:
         using ActionEvent = std::function<void()>;
-        using GeneratorEvent = std::function<unique_ptr<std::vector<MenuItem>>()>;
+        using GeneratorEvent = std::function<unique_ptr<Menu>()>;
         using DecoratorEvent = std::function<void(MenuItem &, Image *, Label *)>;
 
         String text;
@@ -48,12 +49,17 @@ namespace rckid::ui {
                 text = std::move(other.text);
                 icon = std::move(other.icon);
                 payload = other.payload;
-                isAction_ = other.isAction_;
                 decorator_ = std::move(other.decorator_);
+                // the union member may change, destroy the old one and construct the new one
                 if (isAction_)
-                    action_ = std::move(other.action_);
+                    action_.~ActionEvent();
                 else
-                    generator_ = std::move(other.generator_);
+                    generator_.~GeneratorEvent();
+                isAction_ = other.isAction_;
+                if (isAction_)
+                    new (&action_) ActionEvent(std::move(other.action_));
+                else
+                    new (&generator_) GeneratorEvent(std::move(other.generator_));
             }
             return *this;
         }
@@ -113,7 +119,130 @@ namespace rckid::ui {
         DecoratorEvent decorator_;
     }; // rckid::ui::MenuItem
 
-    using Menu = std::vector<MenuItem>;
+    /** Menu, i.e. a list of menu items. 
+     
+        Most menus are small and simply store their items. Menus over large collections, such as folders with hundreds of files, can instead be virtual - backed by a Menu::Source that provides the number of items and creates the item at given index on demand. Virtual menus only keep the few most recently used items (enough for the current item and its neighbors the carousel and popup menus work with), so their memory does not depend on the number of items.
+
+        The reference returned by at() for a virtual menu stays valid until CACHE_SIZE other items are requested. Items of virtual menus cannot be added, removed, or iterated over. 
+     */
+    class Menu {
+    public:
+
+        /** Data source for virtual menus.
+         */
+        class Source {
+        public:
+            virtual ~Source() = default;
+
+            /** Returns the number of items. Called once, when the menu is created.
+             */
+            virtual uint32_t size() = 0;
+
+            /** Creates the item at given index.
+             */
+            virtual MenuItem itemAt(uint32_t index) = 0;
+        }; // rckid::ui::Menu::Source
+
+        static constexpr uint32_t CACHE_SIZE = 4;
+
+        Menu() = default;
+
+        /** Creates virtual menu with the given source.
+         */
+        explicit Menu(unique_ptr<Source> source):
+            source_{std::move(source)},
+            size_{source_->size()} {
+            cache_.reserve(CACHE_SIZE);
+        }
+
+        bool isVirtual() const { return source_ != nullptr; }
+
+        uint32_t size() const { return isVirtual() ? size_ : static_cast<uint32_t>(items_.size()); }
+
+        bool empty() const { return size() == 0; }
+
+        MenuItem & at(uint32_t index) {
+            ASSERT(index < size());
+            if (! isVirtual())
+                return items_[index];
+            ++useCounter_;
+            CachedItem * lru = nullptr;
+            for (auto & c : cache_) {
+                if (c.index == index) {
+                    c.lastUse = useCounter_;
+                    return c.item;
+                }
+                if (lru == nullptr || c.lastUse < lru->lastUse)
+                    lru = & c;
+            }
+            // not cached, create the item, either in a new cache slot, or replacing the least recently used one
+            if (cache_.size() < CACHE_SIZE) {
+                cache_.push_back(CachedItem{index, useCounter_, source_->itemAt(index)});
+                return cache_.back().item;
+            }
+            lru->index = index;
+            lru->lastUse = useCounter_;
+            lru->item = source_->itemAt(index);
+            return lru->item;
+        }
+
+        MenuItem & operator [] (uint32_t index) { return at(index); }
+
+        /** Item management, only available for non-virtual menus.
+         */
+        //@{
+        void reserve(uint32_t size) { 
+            ASSERT(! isVirtual());
+            items_.reserve(size); 
+        }
+
+        void push_back(MenuItem item) {
+            ASSERT(! isVirtual());
+            items_.push_back(std::move(item));
+        }
+
+        template<typename... ARGS>
+        MenuItem & emplace_back(ARGS &&... args) {
+            ASSERT(! isVirtual());
+            return items_.emplace_back(std::forward<ARGS>(args)...);
+        }
+
+        std::vector<MenuItem>::iterator begin() { 
+            ASSERT(! isVirtual());
+            return items_.begin(); 
+        }
+
+        std::vector<MenuItem>::iterator end() { 
+            ASSERT(! isVirtual());
+            return items_.end(); 
+        }
+
+        std::vector<MenuItem>::iterator insert(std::vector<MenuItem>::iterator pos, MenuItem item) {
+            ASSERT(! isVirtual());
+            return items_.insert(pos, std::move(item));
+        }
+
+        std::vector<MenuItem>::iterator erase(std::vector<MenuItem>::iterator pos) {
+            ASSERT(! isVirtual());
+            return items_.erase(pos);
+        }
+        //@}
+
+    private:
+
+        struct CachedItem {
+            uint32_t index;
+            uint32_t lastUse;
+            MenuItem item;
+        }; 
+
+        std::vector<MenuItem> items_;
+        unique_ptr<Source> source_;
+        uint32_t size_ = 0;
+        std::vector<CachedItem> cache_;
+        uint32_t useCounter_ = 0;
+
+    }; // rckid::ui::Menu
 
     using MenuExtender = std::function<unique_ptr<Menu>(unique_ptr<Menu>)>;
 
@@ -10,21 +10,32 @@ namespace rckid::ui {
 
         Color bg() const { return bg_; }
 
-        void setBg(Color value) { bg_ = value; }
+        void setBg(Color value) { 
+            bg_ = value; 
+            bgRaw_ = value.toRGB565();
+            styleBg_ = false;
+        }
 
         void renderColumn(Coord column, Coord startRow, Color::RGB565 * buffer, Coord numPixels) override {
-            memset16(reinterpret_cast<uint16_t*>(buffer), bg_.toRGB565(), numPixels);
+            memset16(reinterpret_cast<uint16_t*>(buffer), bgRaw_, numPixels);
             Widget::renderColumn(column, startRow, buffer, numPixels);
         }
 
         void applyStyle(Style const & style) override {
             Widget::applyStyle(style);
+            if (! styleBg_)
+                return;
             bg_ = style.accentBg();
+            bgRaw_ = style.colors().accentBg;
         }
 
     protected:
 
         Color bg_ = Color::RGB(0, 0, 0);
+        // background color in the native format so that it does not have to be converted for every column
+        Color::RGB565 bgRaw_ = 0;
+        // false once the color is set explicitly, so that applying a style keeps it
+        bool styleBg_ = true;
 
     }; // ui::Panel
 
@@ -14,8 +14,8 @@ namespace rckid::ui {
         int32_t max() const { return max_; }
         int32_t value() const { return value_; };
 
-        void setFg(Color color) { fg_ = color; }
-        void setBg(Color color) { bg_ = color; }
+        void setFg(Color color) { fg_ = color; fgRaw_ = color.toRGB565(); styleFg_ = false; }
+        void setBg(Color color) { bg_ = color; bgRaw_ = color.toRGB565(); styleBg_ = false; }
         void setMin(int32_t min) { min_ = min; }
         void setMax(int32_t max) { max_ = max; }
         void setValue(int32_t value) { value_ = value; }
@@ -41,11 +41,11 @@ namespace rckid::ui {
 
         void renderColumn(Coord column, Coord startRow, Color::RGB565 * buffer, Coord numPixels) override {
             // determine the column at which we are switching from the barto background color
-            Color::RGB565 c{bg_.toRGB565()};
+            Color::RGB565 c = bgRaw_;
             if (max_ > min_) {
                 Coord threshold = width() * (value_ - min_) / (max_ - min_);
                 if (column < threshold)
-                    c = Color::RGB565{fg_.toRGB565()};
+                    c = fgRaw_;
             }
             // draw the progress bar
             memset16(reinterpret_cast<uint16_t*>(buffer), c, numPixels);
@@ -55,8 +55,14 @@ namespace rckid::ui {
 
         void applyStyle(Style const & style) override {
             Widget::applyStyle(style);
-            fg_ = style.accentFg();
-            bg_ = style.accentBg();
+            if (styleFg_) {
+                fg_ = style.accentFg();
+                fgRaw_ = style.colors().accentFg;
+            }
+            if (styleBg_) {
+                bg_ = style.accentBg();
+                bgRaw_ = style.colors().accentBg;
+            }
         }
 
     protected:
@@ -65,6 +71,11 @@ namespace rckid::ui {
 
         Color fg_;
         Color bg_;
+        Color::RGB565 fgRaw_ = 0;
+        Color::RGB565 bgRaw_ = 0;
+        // false once the colors are set explicitly, so that applying a style keeps them
+        bool styleFg_ = true;
+        bool styleBg_ = true;
         int32_t min_ = 0;
         int32_t max_ = 100;
         int32_t value_ = 50;
@@ -13,7 +13,8 @@ namespace rckid::ui {
         RootWidget();
 
         RootWidget(Rect rect): 
-            renderBuffer_{static_cast<uint32_t>(rect.height())}
+            renderBuffer_{static_cast<uint32_t>(rect.height())},
+            styleVersion_{Style::defaultStyle().version()}
         {
             setRect(rect);
         }
@@ -35,15 +36,23 @@ namespace rckid::ui {
 
         void initializeDisplay();
 
+        /** Renders the widget tree. 
+         
+            If the default style has changed since the last frame (such as when a new theme was loaded), the style is first re-applied to the whole widget tree, the header and the background image, so that the change is visible in the very next frame. Note that this replaces any colors set explicitly for the widgets. 
+         */
         void render();
 
+        /** Folder on the SD card where the decoded background images are cached. 
+         */
+        static constexpr char const * BACKGROUND_CACHE_FOLDER = "/cache";
+
         void setBackgroundImage(Style const & style) {
             if (style.backgroundImage().empty()) {
                 background_ = nullptr;
             } else {
                 background_.reset(new Image());
                 with(background_.get())
-                    << SetBitmap(style.backgroundImage()).withoutTransparency()
+                    << SetBitmap(loadBackgroundImage(style.backgroundImage())).withoutTransparency()
                     << SetRect(Rect::XYWH(0, 0, hal::display::WIDTH, hal::display::HEIGHT))
                     << SetHAlign(HAlign::Center)
                     << SetVAlign(VAlign::Center)
@@ -79,7 +88,7 @@ namespace rckid::ui {
             if (useBackgroundImage_ && background_ != nullptr) {
                 renderChildColumn(background_.get(), column, startRow, buffer, numPixels);
             } else {
-                memset16(reinterpret_cast<uint16_t*>(buffer), bg_.toRGB565(), numPixels);
+                memset16(reinterpret_cast<uint16_t*>(buffer), bgRaw_, numPixels);
             }
 
             Widget::renderColumn(column, startRow, buffer, numPixels);
@@ -88,6 +97,14 @@ namespace rckid::ui {
                 renderChildColumn(Header::instance(), column, startRow, buffer, numPixels);
         }
 
+        /** Loads the background image. 
+         
+            Decoding a compressed full screen image takes a noticeable time, which would be spent on every boot and every time the background is reloaded after its resources were released. The first time an image is decoded, the decoded bitmap (its native column-major pixel array and palette for indexed images) is therefore stored in the cache folder on the SD card. Next time the cached file is simply read into memory instead. The cached file name is derived from a hash of the image source (the data for images in memory, path and contents for image files, so that a replaced image is decoded again), only the most recent background is kept in the cache. 
+
+            Raw bitmaps, which do not need decoding, are not cached. If the SD card is not available, the image is simply decoded.  
+         */
+        static Bitmap loadBackgroundImage(ImageSource const & src);
+
         /** Releases the resources helpd by the root widget.
          */
         static void releaseResources() {
@@ -99,6 +116,8 @@ namespace rckid::ui {
         DoubleBuffer<Color::RGB565> renderBuffer_;
 
         bool useBackgroundImage_ = true;
+        // version of the default style last applied to the widget tree
+        uint32_t styleVersion_;
         Header::Visibility useHeader_ = ui::Header::Visibility::Always;
 
         /** Background image (wallpaper)
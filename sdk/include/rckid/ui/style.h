@@ -1,6 +1,9 @@
 #pragma once
 
+#include <optional>
+
 #include <rckid/graphics/color.h>
+#include <rckid/graphics/font.h>
 #include <rckid/graphics/image_source.h>
 #include <rckid/ini.h>
 
@@ -12,31 +15,100 @@ namespace rckid::ui {
      
         Styles are object that define general widget visualization properties, such as colors, accents, fonts, etc. Widgets then support applying styles to themselves. The styling is simple, as the style merely holds the properties and the widgets determines what properties from the style to apply and how. 
 
-        There is no connection between styles and widgets, i.e. applying style to a widget, then changing the style does not change the widget. Applying a style to a widget is always explicit. 
+        There is no connection between styles and widgets, i.e. applying style to a widget, then changing the style does not change the widget. Applying a style to a widget is always explicit. The only exception is the default style, which acts as the system theme: every change to the default style increments its version() and root widgets that see a new version re-apply the style to their whole widget tree (see RootWidget::render()) so that a theme switch repaints everything in the next frame. Colors that the app has set on a widget explicitly (such as Label::setFg()) are kept, applying a style only changes the colors that still come from a style.
+
+        Colors are stored in the RGB format for easy manipulation, but whenever the style changes, all colors the widgets need are converted to the native RGB565 format once, including the font and header palettes, so that widgets simply copy them from the colors() table instead of converting colors themselves. 
+
+        Themes are INI files with the same format as the saved style settings:
+
+            [default]
+            fg=...
+            bg=...
+            [accent]
+            fg=...
+            bg=...
+            [header]
+            fg=...
+            green=...
+            red=...
+            blue=...
+            cyan=...
+            violet=...
+            [animation]
+            speed=...
+            [background]
+            image=...
+
+        Missing fields keep their current values so that themes can only change some of the colors. Unless set, the header foreground follows the default foreground.
      */
     class Style {
     public:
 
+        /** Precomputed RGB565 colors of the style.
+         */
+        struct Colors {
+            Color::RGB565 defaultFg;
+            Color::RGB565 defaultBg;
+            Color::RGB565 accentFg;
+            Color::RGB565 accentBg;
+            /** Font palettes (black to foreground gradient), as used by labels.
+             */
+            Color::RGB565 defaultText[4];
+            Color::RGB565 accentText[4];
+            /** Palette of the header, 16 shades of the header foreground followed by the icon colors at the Header::PaletteOffsetXXX offsets.
+             */
+            Color::RGB565 header[32];
+        }; // rckid::ui::Style::Colors
+
+        Style() { update(); }
+
         static Style & defaultStyle();
 
         static void saveDefaultStyle();
 
+        /** Loads theme from given INI file into the default style. Returns false if the file cannot be opened, in which case the default style is not changed.
+         */
+        static bool loadTheme(String const & path);
+
         void load(ini::Reader & reader);
 
         void save(ini::Writer & writer);
 
+        /** Returns the version of the style, which is incremented on every change.
+         */
+        uint32_t version() const { return version_; }
+
+        Colors const & colors() const { return colors_; }
+
         Color defaultFg() const { return defaultFg_; }
         Color defaultBg() const { return defaultBg_; }
 
-        void setDefaultFg(Color value) { defaultFg_ = value; }
-        void setDefaultBg(Color value) { defaultBg_ = value; }
+        void setDefaultFg(Color value) { defaultFg_ = value; update(); }
+        void setDefaultBg(Color value) { defaultBg_ = value; update(); }
 
         Color accentFg() const { return accentFg_; }
         Color accentBg() const { return accentBg_; }
 
-        void setAccentFg(Color value) { accentFg_ = value; }
-        void setAccentBg(Color value) { accentBg_ = value; }
-
+        void setAccentFg(Color value) { accentFg_ = value; update(); }
+        void setAccentBg(Color value) { accentBg_ = value; update(); }
+
+        /** Header colors. The header foreground is used for text and the default icons, the other colors for the state icons (battery, volume, etc.).
+         */
+        //@{
+        Color headerFg() const { return headerFg_.value_or(defaultFg_); }
+        Color headerGreen() const { return headerGreen_; }
+        Color headerRed() const { return headerRed_; }
+        Color headerBlue() const { return headerBlue_; }
+        Color headerCyan() const { return headerCyan_; }
+        Color headerViolet() const { return headerViolet_; }
+
+        void setHeaderFg(Color value) { headerFg_ = value; update(); }
+        void setHeaderGreen(Color value) { headerGreen_ = value; update(); }
+        void setHeaderRed(Color value) { headerRed_ = value; update(); }
+        void setHeaderBlue(Color value) { headerBlue_ = value; update(); }
+        void setHeaderCyan(Color value) { headerCyan_ = value; update(); }
+        void setHeaderViolet(Color value) { headerViolet_ = value; update(); }
+        //@}
 
         uint32_t animationSpeed() const { return animationSpeed_; }
 
@@ -44,6 +116,7 @@ namespace rckid::ui {
 
         void setBackgroundImage(ImageSource img) {
             backgroundImage_ = std::move(img);
+            update();
         }
 
         // TODO a hack
@@ -55,16 +128,34 @@ namespace rckid::ui {
     private:
         static constexpr char const * STYLE_SETTINGS_FILE = "style2.ini";
 
+        /** Recalculates the color tables and increments the version.
+         */
+        void update();
+
         Color defaultFg_ = Color::White();
         Color defaultBg_ = Color::Black();
         
         Color accentFg_ = Color::White();
         Color accentBg_ = Color::RGB(32, 32, 32);
+
+        // the default foreground unless set
+        std::optional<Color> headerFg_;
+        Color headerGreen_ = Color::RGB(0, 255, 0);
+        Color headerRed_ = Color::RGB(255, 0, 0);
+        Color headerBlue_ = Color::RGB(0, 0, 255);
+        Color headerCyan_ = Color::RGB(0, 255, 255);
+        Color headerViolet_ = Color::RGB(255, 0, 255);
         
         uint32_t animationSpeed_ = RCKID_DEFAULT_ANIMATION_DURATION_MS;
 
         ImageSource backgroundImage_{assets::images::logo};
 
+        Colors colors_;
+        uint32_t version_ = 0;
+
+        // versions are unique across all styles so that a new default style is never mistaken for the old one
+        static inline uint32_t lastVersion_ = 0;
+
         static inline Style * defaultStyle_ = nullptr;
 
     }; // rckid::ui::Style
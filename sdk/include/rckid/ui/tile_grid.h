@@ -5,7 +5,10 @@
 
 namespace rckid::ui {
 
+    /** Tile grid widget.
 
+        Optionally (see enableCache()), the rendered tiles are cached in a pixel buffer of the grid's size, which is only redrawn for the tile columns damaged since the last frame (see rckid::TileGrid::columnDamaged()) before the widget is rendered, after which the damage is cleared. Rendering the grid then amounts to copying the cached column (or skipping it altogether if the column is fully transparent), which is much cheaper than rendering the tiles themselves and makes terminal-like screens, where only a few characters change per frame, almost free to render. The cache costs 2 bytes per pixel, i.e. 150KB for a full screen grid.
+     */
     class TileGrid : public Wrapper<rckid::TileGrid> {
     public:
 
@@ -17,6 +20,93 @@ namespace rckid::ui {
         {
 
         }
-    };
+
+        /** Enables the cache of rendered tiles. The palette size is the number of palette colors the tiles use, so that a color the palette does not use can be found to mark the transparent pixels in the cache. The cache is allocated when the widget is rendered next.
+         */
+        void enableCache(uint32_t paletteSize = 256) {
+            cacheEnabled_ = true;
+            paletteSize_ = paletteSize;
+            updateTransparentKey();
+            invalidateCache();
+        }
+
+        /** Disables the cache and releases its memory.
+         */
+        void disableCache() {
+            cacheEnabled_ = false;
+            releaseCache();
+        }
+
+        bool cacheEnabled() const { return cacheEnabled_; }
+
+        /** Marks the whole cache as stale.
+
+            Only needs to be called when the palette changes, or the tiles are changed via the non-const at() method, which does not damage them.
+         */
+        void invalidateCache() { contents_.damageAll(); }
+
+        /** Returns true if the cached tile column is up to date.
+         */
+        bool cached(Coord tileColumn) const {
+            return cache_ != nullptr && ! contents_.columnDamaged(tileColumn);
+        }
+
+    protected:
+
+        /** Redraws the damaged tile columns in the cache, if enabled.
+         */
+        void onRender() override {
+            Wrapper::onRender();
+            if (cacheEnabled_)
+                refreshCache();
+        }
+
+        /** Renders the column from the cache. Columns whose cached contents are not up to date (such as before the first onRender() call, or when the cache is disabled) are rendered from the tiles directly.
+         */
+        void renderContentsColumn(Coord column, Coord starty, Color::RGB565 * buffer, Coord numPixels) override;
+
+        /** Releases the cache memory, e.g. when the widget is hidden. The cache, if enabled, is allocated again when the widget is rendered next.
+         */
+        void releaseCache() {
+            cache_.reset();
+            columnKinds_.reset();
+        }
+
+        /** Finds a color that is not used by the palette to mark the transparent pixels in the cache. Must be called when the palette changes.
+         */
+        void updateTransparentKey();
+
+    private:
+
+        /** Contents of a cached pixel column, so that transparent columns can be skipped and opaque ones copied without checking the individual pixels.
+         */
+        enum class ColumnKind : uint8_t {
+            Transparent,
+            Opaque,
+            Mixed,
+        };
+
+        /** Renders the damaged tile columns into the cache, allocating it first if necessary and clears the damage.
+         */
+        void refreshCache();
+
+        ColumnKind columnKind(Coord column) const {
+            return static_cast<ColumnKind>((columnKinds_.get()[column / 4] >> (column % 4 * 2)) & 3);
+        }
+
+        void setColumnKind(Coord column, ColumnKind kind) {
+            uint8_t & x = columnKinds_.get()[column / 4];
+            x = static_cast<uint8_t>((x & ~(3 << (column % 4 * 2))) | (static_cast<uint8_t>(kind) << (column % 4 * 2)));
+        }
+
+        /** Rendered pixels, column by column, and the kind of each column (2 bits per column). Transparent pixels are stored as transparentKey_. The cached columns are up to date unless their tiles are damaged.
+         */
+        unique_ptr<Color::RGB565> cache_;
+        unique_ptr<uint8_t> columnKinds_;
+        uint16_t transparentKey_ = 0;
+        uint32_t paletteSize_ = 256;
+        bool cacheEnabled_ = false;
+
+    }; // rckid::ui::TileGrid
 
 } // namespace rckid::ui
@@ -0,0 +1,405 @@
+#pragma once
+
+#include <rckid/rckid.h>
+#include <rckid/fixedint.h>
+#include <rckid/ui/widget.h>
+#include <rckid/ui/animation.h>
+
+namespace rckid::ui {
+
+    /** Description of a single tween, i.e. an animation of a single coordinate from one value to another.
+
+        Tweens are lightweight alternative to Animation objects for the most common case of moving widgets around or animating a single value. Unlike animations, which are arbitrary callbacks, tweens only describe what value changes and how, so that the Tweens engine can store them in contiguous arrays and update all of them in a single loop without any allocations or indirect calls.
+
+        Tween descriptions are created by the static builder methods and adjusted by the with* methods, e.g.:
+
+            Tweens::start(Tween::X(w, 0, 100).withDuration(300).withEasing(Tween::Easing::Out));
+     */
+    class Tween {
+    public:
+
+        /** Easing functions supported by tweens.
+
+            Tweens are grouped by their easing functions so that the easing is known at compile time for each group.
+         */
+        enum class Easing : uint8_t {
+            Linear,
+            In,
+            Out,
+            InOut,
+            InOutIn,
+        };
+
+        static constexpr uint32_t NUM_EASINGS = 5;
+
+        /** The property of the target the tween animates.
+         */
+        enum class Property : uint8_t {
+            // widget's x coordinate
+            X,
+            // widget's y coordinate
+            Y,
+            // arbitrary Coord value
+            Value,
+        };
+
+        /** Moves widget horizontally.
+         */
+        static Tween X(Widget * target, Coord from, Coord to) {
+            ASSERT(target != nullptr);
+            return Tween{Property::X, target, nullptr, from, to, target->animationSpeed()};
+        }
+
+        /** Moves widget vertically.
+         */
+        static Tween Y(Widget * target, Coord from, Coord to) {
+            ASSERT(target != nullptr);
+            return Tween{Property::Y, target, nullptr, from, to, target->animationSpeed()};
+        }
+
+        /** Animates arbitrary value.
+
+            If the owner widget is specified, the tween is cancelled together with the widget's animations and counts as an active animation of the widget for its idle() state.
+         */
+        static Tween Value(Coord * target, Coord from, Coord to, uint32_t durationMs, Widget * owner = nullptr) {
+            ASSERT(target != nullptr);
+            return Tween{Property::Value, owner, target, from, to, durationMs};
+        }
+
+        Tween withDuration(uint32_t value) && {
+            durationMs = value;
+            return std::move(*this);
+        }
+
+        Tween withDelay(uint32_t value) && {
+            delayMs = value;
+            return std::move(*this);
+        }
+
+        Tween withEasing(Easing value) && {
+            easing = value;
+            return std::move(*this);
+        }
+
+        Tween withRepeat(bool value = true) && {
+            repeat = value;
+            return std::move(*this);
+        }
+
+        Property property;
+        Widget * widget;
+        Coord * value;
+        Coord from;
+        Coord to;
+        uint32_t durationMs;
+        uint32_t delayMs = 0;
+        Easing easing = Easing::InOut;
+        bool repeat = false;
+
+    private:
+        Tween(Property property, Widget * widget, Coord * value, Coord from, Coord to, uint32_t durationMs):
+            property{property}, widget{widget}, value{value}, from{from}, to{to}, durationMs{durationMs} {
+        }
+
+    }; // rckid::ui::Tween
+
+    /** Batched tween engine.
+
+        Active tweens are stored in fixed size arrays (structure of arrays), partitioned by their easing function. Every frame, each partition is updated in a single tight loop with its easing function inlined, calculating the new values, which are then written to their targets in a second pass. Finished tweens are removed by moving the last tween of the partition (and the last tweens of all following partitions) to the freed slot, so that the arrays stay contiguous.
+
+        Tweens are referred to by handles that stay valid while the tween is active. Handles of finished or cancelled tweens are detected as stale by a generation counter, so cancelling an already finished tween is safe. Tweens can be chained: a chained tween starts when its predecessor ends and is cancelled together with it. Neither starting, chaining or cancelling tweens allocates any memory.
+     */
+    class Tweens {
+    public:
+
+        /** Maximum number of simultaneously active tweens.
+         */
+        static constexpr uint32_t CAPACITY = 128;
+
+        using Handle = uint32_t;
+
+        /** Invalid handle, returned when the tween could not be started.
+         */
+        static constexpr Handle NONE = 0;
+
+        /** Starts the tween and returns its handle.
+
+            Sets the target to the tween's initial value immediately, even if the tween is delayed, same as animations do. If there are already CAPACITY active tweens, the target is set to its final value instead and NONE is returned.
+         */
+        static Handle start(Tween const & tween) {
+            apply(tween.property, tween.widget, tween.value, tween.from);
+            return add(tween, time::uptimeUs() + tween.delayMs * 1000);
+        }
+
+        /** Chains the tween after the given one, i.e. the tween starts (after its own delay) when the previous one ends.
+
+            The target is not changed until the tween starts. If the previous tween is no longer active, the chained tween starts immediately.
+         */
+        static Handle then(Handle previous, Tween const & tween) {
+            uint32_t pid = idOf(previous);
+            if (pid == NO_ID)
+                return start(tween);
+            uint32_t ps = idToSlot_[pid];
+            ASSERT(! repeat_[ps]);
+            ASSERT(next_[ps] == NO_ID);
+            Handle result = add(tween, startUs_[ps] + durationMs_[ps] * 1000 + tween.delayMs * 1000);
+            if (result != NONE)
+                next_[idToSlot_[pid]] = static_cast<uint8_t>(idOf(result));
+            return result;
+        }
+
+        /** Returns true if the tween is still active.
+         */
+        static bool active(Handle h) { return idOf(h) != NO_ID; }
+
+        /** Cancels the tween and all tweens chained after it.
+
+            The targets keep their current values. Does nothing if the tween is no longer active.
+         */
+        static void cancel(Handle h) {
+            uint32_t id = idOf(h);
+            while (id != NO_ID) {
+                uint32_t s = idToSlot_[id];
+                id = next_[s];
+                remove(s);
+            }
+            notifyIdle();
+        }
+
+        /** Cancels all tweens of given widget.
+         */
+        static void cancelFor(Widget * w) {
+            for (uint32_t s = size(); s > 0; --s)
+                if (widget_[s - 1] == w)
+                    remove(s - 1);
+            notifyIdle();
+        }
+
+        /** Returns the number of active tweens, including chained tweens that have not started yet.
+         */
+        static uint32_t size() { return groupEnd_[Tween::NUM_EASINGS - 1]; }
+
+        /** Updates all active tweens.
+
+            Called automatically by the UI before every frame, same as Animation::updateAll().
+         */
+        static void updateAll() {
+            updateAll(time::uptimeUs());
+        }
+
+        static void updateAll(uint32_t nowUs) {
+            if (size() == 0)
+                return;
+            updateGroup<easing::identity>(0, groupEnd_[0], nowUs);
+            updateGroup<easing::in>(groupEnd_[0], groupEnd_[1], nowUs);
+            updateGroup<easing::out>(groupEnd_[1], groupEnd_[2], nowUs);
+            updateGroup<easing::inOut>(groupEnd_[2], groupEnd_[3], nowUs);
+            updateGroup<easing::inOutIn>(groupEnd_[3], groupEnd_[4], nowUs);
+            // write the values to the targets
+            for (uint32_t s = 0, e = size(); s < e; ++s)
+                if (flags_[s] & FLAG_CHANGED)
+                    apply(property_[s], widget_[s], target_[s], value_[s]);
+            // remove finished tweens, going backwards so that the tweens moved to the freed slots have already been processed
+            for (uint32_t s = size(); s > 0; --s)
+                if (flags_[s - 1] & FLAG_FINISHED)
+                    remove(s - 1);
+            notifyIdle();
+        }
+
+    private:
+
+        static constexpr uint8_t NO_ID = 0xff;
+        static constexpr uint8_t FLAG_CHANGED = 1;
+        static constexpr uint8_t FLAG_FINISHED = 2;
+
+        static_assert(CAPACITY < NO_ID);
+
+        template<FixedRatio (*EASING)(FixedRatio)>
+        static void updateGroup(uint32_t begin, uint32_t end, uint32_t nowUs) {
+            for (uint32_t s = begin; s < end; ++s) {
+                int32_t elapsedUs = static_cast<int32_t>(nowUs - startUs_[s]);
+                // delayed, or chained tweens that have not started yet
+                if (elapsedUs < 0) {
+                    flags_[s] = 0;
+                    continue;
+                }
+                uint32_t elapsedMs = static_cast<uint32_t>(elapsedUs) / 1000;
+                uint32_t d = durationMs_[s];
+                FixedRatio progress;
+                if (elapsedMs < d) {
+                    progress = FixedRatio{elapsedMs, d};
+                    flags_[s] = FLAG_CHANGED;
+                } else if (repeat_[s] && d > 0) {
+                    // move the start so that the elapsed time stays small
+                    uint32_t periods = elapsedMs / d;
+                    startUs_[s] += periods * d * 1000;
+                    progress = FixedRatio{elapsedMs - periods * d, d};
+                    flags_[s] = FLAG_CHANGED;
+                } else {
+                    progress = FixedRatio::Full();
+                    flags_[s] = FLAG_CHANGED | FLAG_FINISHED;
+                }
+                value_[s] = from_[s] + EASING(progress).scale(to_[s] - from_[s]);
+            }
+        }
+
+        static void apply(Tween::Property property, Widget * w, Coord * target, Coord value) {
+            switch (property) {
+                case Tween::Property::X:
+                    w->setRect(Rect::XYWH(value, w->y(), w->width(), w->height()));
+                    break;
+                case Tween::Property::Y:
+                    w->setRect(Rect::XYWH(w->x(), value, w->width(), w->height()));
+                    break;
+                case Tween::Property::Value:
+                    *target = value;
+                    break;
+                default:
+                    UNREACHABLE;
+            }
+        }
+
+        static Handle add(Tween const & tween, uint32_t startUs) {
+            if (numFree_ == 0 && nextId_ == CAPACITY) {
+                LOG(LL_ERROR, "Too many tweens");
+                apply(tween.property, tween.widget, tween.value, tween.to);
+                return NONE;
+            }
+            uint32_t id = (numFree_ > 0) ? freeIds_[--numFree_] : nextId_++;
+            // generation 0 is never used so that no valid handle is equal to NONE
+            if (generation_[id] == 0)
+                generation_[id] = 1;
+            uint32_t s = insertSlot(static_cast<uint32_t>(tween.easing));
+            slotToId_[s] = static_cast<uint8_t>(id);
+            idToSlot_[id] = static_cast<uint8_t>(s);
+            startUs_[s] = startUs;
+            durationMs_[s] = tween.durationMs;
+            from_[s] = tween.from;
+            to_[s] = tween.to;
+            value_[s] = tween.from;
+            target_[s] = tween.value;
+            widget_[s] = tween.widget;
+            property_[s] = tween.property;
+            repeat_[s] = tween.repeat;
+            next_[s] = NO_ID;
+            flags_[s] = 0;
+            if (tween.widget != nullptr)
+                ++tween.widget->activeAnimations_;
+            return (generation_[id] << 8) | id;
+        }
+
+        /** Returns the id of the tween if the handle is valid, NO_ID otherwise.
+         */
+        static uint32_t idOf(Handle h) {
+            uint32_t id = h & 0xff;
+            if (h == NONE || id >= nextId_ || generation_[id] != (h >> 8) || idToSlot_[id] == NO_ID)
+                return NO_ID;
+            return id;
+        }
+
+        /** Makes space for a new tween at the end of given easing group and returns its slot.
+
+            Moves the first tween of every following group to its end.
+         */
+        static uint32_t insertSlot(uint32_t group) {
+            uint32_t hole = size();
+            for (uint32_t g = Tween::NUM_EASINGS - 1; g > group; --g) {
+                uint32_t first = groupEnd_[g - 1];
+                move(first, hole);
+                hole = first;
+                ++groupEnd_[g];
+            }
+            ++groupEnd_[group];
+            return hole;
+        }
+
+        /** Removes tween in given slot, moving the last tweens of its group and all following groups to fill the hole.
+         */
+        static void remove(uint32_t s) {
+            uint32_t id = slotToId_[s];
+            if (widget_[s] != nullptr) {
+                ASSERT(widget_[s]->activeAnimations_ > 0);
+                if (--widget_[s]->activeAnimations_ == 0 && numIdle_ < CAPACITY)
+                    idle_[numIdle_++] = widget_[s];
+            }
+            idToSlot_[id] = NO_ID;
+            // the id may be reused, so unchain the tween from its predecessor, if any
+            for (uint32_t i = 0, e = size(); i < e; ++i)
+                if (next_[i] == id)
+                    next_[i] = NO_ID;
+            // the handle of the removed tween becomes stale
+            if (++generation_[id] == 0)
+                generation_[id] = 1;
+            freeIds_[numFree_++] = static_cast<uint8_t>(id);
+            uint32_t group = 0;
+            while (groupEnd_[group] <= s)
+                ++group;
+            uint32_t hole = s;
+            for (uint32_t g = group; g < Tween::NUM_EASINGS; ++g) {
+                uint32_t last = groupEnd_[g] - 1;
+                move(last, hole);
+                hole = last;
+                --groupEnd_[g];
+            }
+        }
+
+        static void move(uint32_t from, uint32_t to) {
+            if (from == to)
+                return;
+            startUs_[to] = startUs_[from];
+            durationMs_[to] = durationMs_[from];
+            from_[to] = from_[from];
+            to_[to] = to_[from];
+            value_[to] = value_[from];
+            target_[to] = target_[from];
+            widget_[to] = widget_[from];
+            property_[to] = property_[from];
+            repeat_[to] = repeat_[from];
+            next_[to] = next_[from];
+            flags_[to] = flags_[from];
+            slotToId_[to] = slotToId_[from];
+            idToSlot_[slotToId_[to]] = static_cast<uint8_t>(to);
+        }
+
+        /** Calls onIdle() of widgets whose last tweens were removed.
+
+            This is deferred until the tweens are in consistent state as the widgets may start or cancel tweens from the event.
+         */
+        static void notifyIdle() {
+            while (numIdle_ > 0) {
+                Widget * w = idle_[--numIdle_];
+                if (w->activeAnimations_ == 0)
+                    w->onIdle();
+            }
+        }
+
+        // per slot data
+        static inline uint32_t startUs_[CAPACITY];
+        static inline uint32_t durationMs_[CAPACITY];
+        static inline Coord from_[CAPACITY];
+        static inline Coord to_[CAPACITY];
+        static inline Coord value_[CAPACITY];
+        static inline Coord * target_[CAPACITY];
+        static inline Widget * widget_[CAPACITY];
+        static inline Tween::Property property_[CAPACITY];
+        static inline bool repeat_[CAPACITY];
+        static inline uint8_t next_[CAPACITY];
+        static inline uint8_t flags_[CAPACITY];
+        static inline uint8_t slotToId_[CAPACITY];
+        // end of each easing group's slots (the groups are stored in order of the Easing enum)
+        static inline uint32_t groupEnd_[Tween::NUM_EASINGS] = {0};
+
+        // per id data
+        static inline uint8_t idToSlot_[CAPACITY];
+        static inline uint32_t generation_[CAPACITY];
+        static inline uint8_t freeIds_[CAPACITY];
+        static inline uint32_t numFree_ = 0;
+        static inline uint32_t nextId_ = 0;
+
+        // widgets that became idle and should be notified
+        static inline Widget * idle_[CAPACITY];
+        static inline uint32_t numIdle_ = 0;
+
+    }; // rckid::ui::Tweens
+
+} // namespace rckid::ui
@@ -14,6 +14,8 @@
 namespace rckid::ui {
 
     class Animation;
+    class Tweens;
+    class Stack;
 
     class Widget {
     public:
@@ -41,6 +43,14 @@ namespace rckid::ui {
             animationSpeed_ = style.animationSpeed();
         }
 
+        /** Applies the style to the widget and all its children. 
+         */
+        void applyStyleRecursive(Style const & style) {
+            applyStyle(style);
+            for (auto & child : children_)
+                child->applyStyleRecursive(style);
+        }
+
         Rect rect() const { return rect_; }
         Point position() const { return Point{rect_.x, rect_.y}; }
         Coord x() const { return rect_.x; }
@@ -79,6 +89,8 @@ namespace rckid::ui {
         bool visible() const { return visible_; }
 
         void setVisibility(bool value) { 
+            if (visible_ != value && parent_ != nullptr)
+                parent_->invalidateLayout();
             visible_ = value; 
         }
 
@@ -129,9 +141,29 @@ namespace rckid::ui {
             child->parent_ = this;       
             child->applyStyle(Style::defaultStyle());
             children_.push_back(unique_ptr<Widget>(child));
+            invalidateLayout();
             return with<T>(child);
         }
 
+        /** Returns the size the widget would like to have when arranged by a layout (see ui::Stack), width in x and height in y. 
+         
+            By default this is the current size of the widget, widgets whose size depends on their contents, such as labels, override the method.
+         */
+        virtual Point measure() const { return Point{width(), height()}; }
+
+        /** Tells the layouts containing the widget that its measured size or its children have changed and they have to be arranged again. 
+         
+            The layouts are arranged before the next frame is rendered, so calling this multiple times per frame is cheap. 
+         */
+        void invalidateLayout() {
+            for (Widget * w = this; w != nullptr; w = w->parent_)
+                w->layoutDirty_ = true;
+        }
+
+        /** Returns true if the widget's layout must be arranged again. 
+         */
+        bool layoutDirty() const { return layoutDirty_; }
+
         virtual bool idle() const { return activeAnimations_ == 0; }
 
         /** Returns animation builder for the current widget. 
@@ -186,7 +218,12 @@ namespace rckid::ui {
 
     protected:
 
+        /** Prepares the widget for rendering the next frame. 
+         
+            Plain widgets do not arrange their children, so their layout is up to date once rendered, layouts (see ui::Stack) arrange their children first. 
+         */
         virtual void onRender() {
+            layoutDirty_ = false;
             for (auto & child : children_)
                 if (child->visible())
                     child->onRender();
@@ -312,12 +349,15 @@ namespace rckid::ui {
         friend class App;
 
         friend class Animation;
+        friend class Tweens;
+        friend class Stack;
 
         uint32_t activeAnimations_ = 0;
 
         Rect rect_;
         Widget * parent_ = nullptr;
         bool visible_ = true;
+        bool layoutDirty_ = false;
         bool focused_ = false;
         uint32_t animationSpeed_ = RCKID_DEFAULT_ANIMATION_DURATION_MS;
 
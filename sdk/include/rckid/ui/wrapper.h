@@ -82,7 +82,7 @@ namespace rckid::ui {
             // render as many pixels as we have to by repeating the image (numPixels were updated accordingly if no repeat is required)
             while (numPixels > 0) {
                 Coord n = std::min(numPixels, contents_.height() - starty);
-                contents_.renderColumn(column, starty, buffer, n);
+                renderContentsColumn(column, starty, buffer, n);
                 numPixels -= n;
                 buffer += n;
                 starty = 0; // after the first iteration, we will always start at the
@@ -90,6 +90,13 @@ namespace rckid::ui {
         }
 
     protected:
+
+        /** Renders the given column of the contents, in contents coordinates. Wrappers that can render their contents faster than the contents themselves (e.g. from a cache) override this.
+         */
+        virtual void renderContentsColumn(Coord column, Coord starty, Color::RGB565 * buffer, Coord numPixels) {
+            contents_.renderColumn(column, starty, buffer, numPixels);
+        }
+
         void onChange() override {
             Widget::onChange();
             Coord x = contentsOffset_.x;
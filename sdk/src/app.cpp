@@ -2,6 +2,7 @@
 #include <rckid/apps/home_menu.h>
 #include <rckid/apps/dialogs/info_dialog.h>
 #include <rckid/task.h>
+#include <rckid/graphics/screen_capture.h>
 #include <rckid/app.h>
 
 namespace rckid {
@@ -28,6 +29,14 @@ namespace rckid {
         }
     }
 
+    void App::frame() {
+        if (ScreenCapture::holdsFrame())
+            display::waitUpdateDone();
+        else
+            loop();
+        render();
+    }
+
     unique_ptr<ui::Menu> App::homeMenu() {
         auto result = std::make_unique<ui::Menu>();
         Capabilities caps = capabilities();
@@ -58,7 +67,10 @@ namespace rckid {
             });
         }
         if (caps.canCaptureScreen) {
-            // TODO generate screenshot option
+            (*result) << ui::MenuItem("Screenshot", assets::icons_64::picture, [this]() {
+                TinyDateTime t = time::now();
+                captureScreen(STR(t.date.year() << fillLeft(t.date.month(), 2, '0') << fillLeft(t.date.day(), 2, '0') << "-" << fillLeft(t.time.hour(), 2, '0') << fillLeft(t.time.minute(), 2, '0') << fillLeft(t.time.second(), 2, '0') << ".qoi"));
+            });
         }
         return result;
     }
@@ -80,6 +92,17 @@ namespace rckid {
         saveState(*f);
     }
 
+    void App::captureScreen(String filename) {
+        filename = fs::join("screenshots", filename);
+        auto f = writeFile(filename);
+        if (f == nullptr)
+            return InfoDialog::error("Cannot capture screen", STR("Unable to open file " << filename));
+        if (captureScreen(*f))
+            return;
+        if (! ScreenCapture::start(std::move(f)))
+            InfoDialog::error("Cannot capture screen", "Screen capture already in progress");
+    }
+
     String App::homeFolder() const {
         return fs::join("/apps", name());
     }
@@ -141,13 +141,16 @@ namespace rckid {
                         if (path) {
                             ui::Style & style = ui::Style::defaultStyle();
                             style.setBackgroundImage(ImageSource{path.value()});
-                            // force repaint
-                            Launcher::updateStyle(style);
                             ui::Style::saveDefaultStyle();
                         }
                     }};
                 return result;
             })
+            << ui::MenuItem{"Theme", assets::icons_64::light, []() {
+                auto path = App::run<FileDialog>("/files/themes");
+                if (path && ui::Style::loadTheme(path.value()))
+                    ui::Style::saveDefaultStyle();
+            }}
             << ui::MenuItem::Generator("Colors", assets::icons_64::light, [](){
                 auto result = std::make_unique<ui::Menu>();
                 (*result)
@@ -156,7 +159,6 @@ namespace rckid {
                         auto color = App::run<ColorDialog>(style.defaultFg());
                         if (color) {
                             style.setDefaultFg(color.value());
-                            Launcher::updateStyle(style);
                             ui::Style::saveDefaultStyle();
                         }
                     }}
@@ -165,7 +167,6 @@ namespace rckid {
                         auto color = App::run<ColorDialog>(style.defaultBg());
                         if (color) {
                             style.setDefaultBg(color.value());
-                            Launcher::updateStyle(style);
                             ui::Style::saveDefaultStyle();
                         }
                     }}
@@ -174,7 +175,6 @@ namespace rckid {
                         auto color = App::run<ColorDialog>(style.accentFg());
                         if (color) {
                             style.setAccentFg(color.value());
-                            Launcher::updateStyle(style);
                             ui::Style::saveDefaultStyle();
                         }
                     }}
@@ -183,7 +183,6 @@ namespace rckid {
                         auto color = App::run<ColorDialog>(style.accentBg());
                         if (color) {
                             style.setAccentBg(color.value());
-                            Launcher::updateStyle(style);
                             ui::Style::saveDefaultStyle();
                         }
                     }};
@@ -291,11 +290,4 @@ namespace rckid {
     }
 
 
-    void Launcher::updateStyle(ui::Style & style) {
-        // only expected to be called from the launcher
-        if (instance_ == nullptr)
-            return;
-        instance_->root_.setBackgroundImage(style);
-    }
-
 } // namespace rckid
\ No newline at end of file
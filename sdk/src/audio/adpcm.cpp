@@ -0,0 +1,232 @@
+#include <algorithm>
+
+#include <rckid/audio/adpcm.h>
+#include <rckid/audio/byte_order.h>
+
+namespace rckid::audio {
+
+    using namespace internal;
+
+    namespace {
+
+        constexpr int8_t indexTable[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+        constexpr int16_t stepTable[89] = {
+            7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+            50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+            337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+            2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+            15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+        };
+    }
+
+    // ADPCMState
+
+    uint8_t ADPCMState::encode(int16_t sample) {
+        int32_t step = stepTable[stepIndex];
+        int32_t diff = sample - predictor;
+        uint8_t nibble = 0;
+        if (diff < 0) {
+            nibble = 8;
+            diff = -diff;
+        }
+        if (diff >= step) {
+            nibble |= 4;
+            diff -= step;
+        }
+        step >>= 1;
+        if (diff >= step) {
+            nibble |= 2;
+            diff -= step;
+        }
+        step >>= 1;
+        if (diff >= step)
+            nibble |= 1;
+        // update the predictor exactly as the decoder will
+        decode(nibble);
+        return nibble;
+    }
+
+    int16_t ADPCMState::decode(uint8_t nibble) {
+        int32_t step = stepTable[stepIndex];
+        int32_t diff = step >> 3;
+        if (nibble & 4)
+            diff += step;
+        if (nibble & 2)
+            diff += step >> 1;
+        if (nibble & 1)
+            diff += step >> 2;
+        int32_t p = (nibble & 8) ? predictor - diff : predictor + diff;
+        predictor = static_cast<int16_t>(std::clamp(p, static_cast<int32_t>(-32768), static_cast<int32_t>(32767)));
+        stepIndex = static_cast<uint8_t>(std::clamp(stepIndex + indexTable[nibble & 7], 0, 88));
+        return predictor;
+    }
+
+    // ADPCMEncoder
+
+    ADPCMEncoder::ADPCMEncoder(RandomWriteStream & out, uint32_t sampleRate):
+        out_{out},
+        sampleRate_{sampleRate},
+        buffer_{new uint8_t[WRITE_BUFFER_SIZE]} {
+        writeHeader();
+    }
+
+    void ADPCMEncoder::encode(int16_t const * samples, uint32_t numSamples) {
+        ASSERT(! finished_);
+        uint8_t * buffer = buffer_.get();
+        for (uint32_t i = 0; i < numSamples; ++i) {
+            int16_t sample = samples[i];
+            if (blockSample_ == 0) {
+                // the first sample of each block is stored in the block header as the initial predictor
+                state_.predictor = sample;
+                setLe16(buffer + bufferSize_, static_cast<uint16_t>(sample));
+                buffer[bufferSize_ + 2] = state_.stepIndex;
+                buffer[bufferSize_ + 3] = 0;
+            } else {
+                uint32_t offset = bufferSize_ + 4 + (blockSample_ - 1) / 2;
+                uint8_t nibble = state_.encode(sample);
+                if (blockSample_ & 1)
+                    buffer[offset] = nibble;
+                else
+                    buffer[offset] |= nibble << 4;
+            }
+            ++samples_;
+            if (++blockSample_ == SAMPLES_PER_BLOCK) {
+                blockSample_ = 0;
+                bufferSize_ += BLOCK_SIZE;
+                if (bufferSize_ == WRITE_BUFFER_SIZE)
+                    flush();
+            }
+        }
+    }
+
+    void ADPCMEncoder::finish() {
+        if (finished_)
+            return;
+        finished_ = true;
+        if (blockSample_ > 0) {
+            // pad the last block with zero differences (and clear the high nibble of the last written byte if any)
+            uint32_t used = 4 + blockSample_ / 2;
+            memset(buffer_.get() + bufferSize_ + used, 0, BLOCK_SIZE - used);
+            bufferSize_ += BLOCK_SIZE;
+            blockSample_ = 0;
+        }
+        flush();
+        out_.seek(0);
+        writeHeader();
+        out_.seek(HEADER_SIZE + bytesWritten_);
+    }
+
+    void ADPCMEncoder::writeHeader() {
+        uint8_t h[HEADER_SIZE];
+        memcpy(h, "RIFF", 4);
+        setLe32(h + 4, HEADER_SIZE - 8 + bytesWritten_);
+        memcpy(h + 8, "WAVEfmt ", 8);
+        setLe32(h + 16, 20);
+        setLe16(h + 20, WAVFormat::IMA_ADPCM);
+        setLe16(h + 22, 1); // channels
+        setLe32(h + 24, sampleRate_);
+        setLe32(h + 28, sampleRate_ * BLOCK_SIZE / SAMPLES_PER_BLOCK); // bytes per second
+        setLe16(h + 32, BLOCK_SIZE);
+        setLe16(h + 34, 4); // bits per sample
+        setLe16(h + 36, 2); // size of the extra format bytes
+        setLe16(h + 38, SAMPLES_PER_BLOCK);
+        memcpy(h + 40, "fact", 4);
+        setLe32(h + 44, 4);
+        setLe32(h + 48, samples_);
+        memcpy(h + 52, "data", 4);
+        setLe32(h + 56, bytesWritten_);
+        out_.write(h, HEADER_SIZE);
+    }
+
+    void ADPCMEncoder::flush() {
+        if (bufferSize_ == 0)
+            return;
+        out_.write(buffer_.get(), bufferSize_);
+        bytesWritten_ += bufferSize_;
+        bufferSize_ = 0;
+    }
+
+    // ADPCMDecoderStream
+
+    ADPCMDecoderStream::ADPCMDecoderStream(unique_ptr<ReadStream> input, uint32_t numBuffers):
+        DecoderStream{BUFFER_STEREO_SAMPLES, numBuffers},
+        in_{std::move(input)} {
+        WAVFormat format;
+        if (! format.read(*in_) || ! initialize(format))
+            LOG(LL_ERROR, "Not an IMA-ADPCM WAV stream");
+    }
+
+    ADPCMDecoderStream::ADPCMDecoderStream(unique_ptr<ReadStream> input, WAVFormat const & format, uint32_t numBuffers):
+        DecoderStream{BUFFER_STEREO_SAMPLES, numBuffers},
+        in_{std::move(input)} {
+        if (! initialize(format))
+            LOG(LL_ERROR, "Unsupported IMA-ADPCM format");
+    }
+
+    uint32_t ADPCMDecoderStream::refillSamples(int16_t * buffer, uint32_t numStereoSamples) {
+        if (! valid())
+            return 0;
+        uint32_t i = 0;
+        while (i < numStereoSamples && remaining_ > 0) {
+            if (blockSample_ == blockSamples_ && ! readBlock())
+                break;
+            int16_t left = decodeSample(0);
+            buffer[i * 2] = left;
+            buffer[i * 2 + 1] = (channels_ == 2) ? decodeSample(1) : left;
+            ++blockSample_;
+            --remaining_;
+            ++i;
+        }
+        return i;
+    }
+
+    bool ADPCMDecoderStream::initialize(WAVFormat const & format) {
+        if (format.format != WAVFormat::IMA_ADPCM || format.bitsPerSample != 4)
+            return false;
+        channels_ = format.channels;
+        sampleRate_ = format.sampleRate;
+        blockAlign_ = format.blockAlign;
+        if (channels_ < 1 || channels_ > 2 || blockAlign_ <= 4 * channels_ || (blockAlign_ % (4 * channels_)) != 0)
+            return false;
+        dataRemaining_ = format.dataSize;
+        // without the fact chunk, assume all blocks are full
+        if (format.hasFact) {
+            samples_ = format.samples;
+        } else {
+            uint32_t samplesPerBlock = (blockAlign_ - 4 * channels_) * 2 / channels_ + 1;
+            samples_ = dataRemaining_ / blockAlign_ * samplesPerBlock;
+        }
+        remaining_ = samples_;
+        block_ = unique_ptr<uint8_t>{new uint8_t[blockAlign_]};
+        return true;
+    }
+
+    bool ADPCMDecoderStream::readBlock() {
+        uint32_t size = in_->readFully(block_.get(), std::min(blockAlign_, dataRemaining_));
+        dataRemaining_ -= size;
+        // the block must contain at least the headers and whole 4 byte groups for all channels
+        size -= size % (4 * channels_);
+        if (size < 4 * channels_)
+            return false;
+        uint8_t * b = block_.get();
+        for (uint32_t c = 0; c < channels_; ++c) {
+            state_[c].predictor = static_cast<int16_t>(le16(b + c * 4));
+            state_[c].stepIndex = std::min(b[c * 4 + 2], static_cast<uint8_t>(88));
+        }
+        blockSample_ = 0;
+        blockSamples_ = (size - 4 * channels_) * 2 / channels_ + 1;
+        return true;
+    }
+
+    int16_t ADPCMDecoderStream::decodeSample(uint32_t channel) {
+        if (blockSample_ == 0)
+            return state_[channel].predictor;
+        // the data after the headers are interleaved 4 byte groups of 8 samples for each channel
+        uint32_t k = blockSample_ - 1;
+        uint32_t offset = 4 * channels_ + (k / 8) * 4 * channels_ + channel * 4 + (k % 8) / 2;
+        uint8_t byte = block_.get()[offset];
+        return state_[channel].decode((k & 1) ? (byte >> 4) : (byte & 0xf));
+    }
+
+} // namespace rckid::audio
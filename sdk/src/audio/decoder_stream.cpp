@@ -1,17 +1,102 @@
 #include <rckid/audio/decoder_stream.h>
 #include <rckid/audio/mp3.h>
+#include <rckid/audio/opus.h>
+#include <rckid/audio/adpcm.h>
+#include <rckid/audio/wav.h>
+#include <rckid/audio/qoa.h>
 
 namespace rckid::audio {
 
+    namespace {
+
+        struct DecoderInfo {
+            char const * extension;
+            char const * magic;
+            uint32_t magicOffset;
+            DecoderStream::Factory factory;
+        };
+
+        /** Returns the decoder if the it is valid, nullptr otherwise.
+         */
+        template<typename T>
+        unique_ptr<DecoderStream> ifValid(unique_ptr<T> decoder) {
+            if (! decoder->valid())
+                return nullptr;
+            return decoder;
+        }
+
+        /** Both PCM and IMA-ADPCM WAV files share the same header, the decoder is selected by the format.
+         */
+        unique_ptr<DecoderStream> createWAV(unique_ptr<RandomReadStream> input) {
+            WAVFormat format;
+            if (! format.read(*input))
+                return nullptr;
+            if (format.format == WAVFormat::IMA_ADPCM)
+                return ifValid(std::make_unique<ADPCMDecoderStream>(std::move(input), format));
+            return ifValid(std::make_unique<WAVDecoderStream>(std::move(input), format));
+        }
+
+        unique_ptr<DecoderStream> createQOA(unique_ptr<RandomReadStream> input) {
+            return ifValid(std::make_unique<QOADecoderStream>(std::move(input))); 
+        }
+
+        unique_ptr<DecoderStream> createOpus(unique_ptr<RandomReadStream> input) {
+            return ifValid(std::make_unique<OpusDecoderStream>(std::move(input))); 
+        }
+
+        unique_ptr<DecoderStream> createMP3(unique_ptr<RandomReadStream> input) {
+            return std::make_unique<MP3DecoderStream>(std::move(input)); 
+        }
+
+        // the registry is a static array so that it does not occupy the heap
+        constexpr uint32_t MAX_DECODERS = 16;
+
+        DecoderInfo decoders[MAX_DECODERS] = {
+            {".wav", "WAVE", 8, createWAV},
+            {".qoa", "qoaf", 0, createQOA},
+            // the Opus identification header is the only packet of the first Ogg page, right after its 27 byte header and single byte segment table
+            {".opus", "OpusHead", 28, createOpus},
+            // MP3 files without ID3 tags start directly with a frame, which has no fixed magic bytes
+            {".mp3", "ID3", 0, createMP3},
+        };
+
+        uint32_t numDecoders = 4;
+    }
+
+    void DecoderStream::registerDecoder(char const * extension, char const * magic, uint32_t magicOffset, Factory factory) {
+        ASSERT(magic == nullptr || strlen(magic) + magicOffset <= MAX_MAGIC_END);
+        if (numDecoders == MAX_DECODERS)
+            FATAL_ERROR("Too many audio decoders", numDecoders);
+        decoders[numDecoders++] = DecoderInfo{extension, magic, magicOffset, factory};
+    }
+
     unique_ptr<DecoderStream> DecoderStream::fromFile(String const & path, fs::Drive drive) {
         auto f = fs::readFile(path, drive); 
         if (f == nullptr)
             return nullptr;
-        // TODO maybe some registry of decoders based on file extension or something like that
-        if (path.endsWith(".mp3"))
-            return std::make_unique<MP3DecoderStream>(std::move(f));
+        unique_ptr<DecoderStream> result = fromStream(std::move(f), path);
+        if (result != nullptr)
+            result->attachFile(path, drive);
+        return result;
+    }
+
+    unique_ptr<DecoderStream> DecoderStream::fromStream(unique_ptr<RandomReadStream> input, String const & path) {
+        uint8_t header[MAX_MAGIC_END];
+        uint32_t headerSize = input->read(header, sizeof(header));
+        input->seek(0);
+        // the most recently registered decoders first
+        for (uint32_t i = numDecoders; i-- > 0; ) {
+            DecoderInfo & d = decoders[i];
+            if (d.magic == nullptr)
+                continue;
+            uint32_t len = static_cast<uint32_t>(strlen(d.magic));
+            if (d.magicOffset + len <= headerSize && memcmp(header + d.magicOffset, d.magic, len) == 0)
+                return d.factory(std::move(input));
+        }
+        for (uint32_t i = numDecoders; i-- > 0; )
+            if (path.endsWith(decoders[i].extension))
+                return decoders[i].factory(std::move(input));
         return nullptr;
     }
     
 } // namespace rckid::audio
-
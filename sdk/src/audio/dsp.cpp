@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <cmath>
+
+#include <rckid/audio/dsp.h>
+
+namespace rckid::audio {
+
+    namespace {
+
+        constexpr float PI = 3.14159265358979f;
+
+        /** Extra fractional bits of the samples inside the chain.
+         */
+        constexpr uint32_t SAMPLE_BITS = 8;
+
+        int32_t toFixed(float x) {
+            return static_cast<int32_t>(lroundf(x * (1 << Biquad::COEFF_BITS)));
+        }
+
+        int16_t saturate(int32_t x) {
+            return static_cast<int16_t>(std::clamp(x, static_cast<int32_t>(-32768), static_cast<int32_t>(32767)));
+        }
+    }
+
+    void Biquad::configure(Type type, uint32_t sampleRate, float frequency, float gainDb, float q) {
+        // keep the frequency below the Nyquist frequency where the formulas still hold
+        frequency = std::clamp(frequency, 10.0f, sampleRate * 0.45f);
+        float a = powf(10, gainDb / 40);
+        float w0 = 2 * PI * frequency / sampleRate;
+        float cosw = cosf(w0);
+        float alpha = sinf(w0) / (2 * q);
+        float b0, b1, b2, a0, a1, a2;
+        switch (type) {
+            case Type::LowShelf: {
+                float s = 2 * sqrtf(a) * alpha;
+                b0 = a * ((a + 1) - (a - 1) * cosw + s);
+                b1 = 2 * a * ((a - 1) - (a + 1) * cosw);
+                b2 = a * ((a + 1) - (a - 1) * cosw - s);
+                a0 = (a + 1) + (a - 1) * cosw + s;
+                a1 = -2 * ((a - 1) + (a + 1) * cosw);
+                a2 = (a + 1) + (a - 1) * cosw - s;
+                break;
+            }
+            case Type::HighShelf: {
+                float s = 2 * sqrtf(a) * alpha;
+                b0 = a * ((a + 1) + (a - 1) * cosw + s);
+                b1 = -2 * a * ((a - 1) + (a + 1) * cosw);
+                b2 = a * ((a + 1) + (a - 1) * cosw - s);
+                a0 = (a + 1) - (a - 1) * cosw + s;
+                a1 = 2 * ((a - 1) - (a + 1) * cosw);
+                a2 = (a + 1) - (a - 1) * cosw - s;
+                break;
+            }
+            case Type::Peaking:
+                b0 = 1 + alpha * a;
+                b1 = -2 * cosw;
+                b2 = 1 - alpha * a;
+                a0 = 1 + alpha / a;
+                a1 = -2 * cosw;
+                a2 = 1 - alpha / a;
+                break;
+            default:
+                UNREACHABLE;
+        }
+        b0_ = toFixed(b0 / a0);
+        b1_ = toFixed(b1 / a0);
+        b2_ = toFixed(b2 / a0);
+        a1_ = toFixed(a1 / a0);
+        a2_ = toFixed(a2 / a0);
+    }
+
+    void DSP::setBand(uint32_t index, Biquad::Type type, float frequency, float gainDb, float q) {
+        ASSERT(index < MAX_BANDS && index <= numBands_);
+        ASSERT(frequency > 0 && q > 0);
+        bands_[index] = Band{type, frequency, std::clamp(gainDb, -MAX_BAND_GAIN_DB, MAX_BAND_GAIN_DB), q};
+        if (index == numBands_) {
+            ++numBands_;
+            filters_[index].reset();
+        }
+        // the other filters keep their state so that adjusting the equalizer during playback does not click
+        numActive_ = 0;
+        for (uint32_t i = 0; i < numBands_; ++i) {
+            if (bands_[i].gainDb == 0)
+                continue;
+            active_[numActive_++] = i;
+            if (i == index && sampleRate_ != 0)
+                filters_[i].configure(bands_[i].type, sampleRate_, bands_[i].frequency, bands_[i].gainDb, bands_[i].q);
+        }
+    }
+
+    int32_t DSP::gain(ReplayGain const & replayGain) const {
+        float db = preampDb_;
+        if (mode_ == ReplayGainMode::Track)
+            db += replayGain.track.value_or(replayGain.album.value_or(0));
+        else if (mode_ == ReplayGainMode::Album)
+            db += replayGain.album.value_or(replayGain.track.value_or(0));
+        db = std::clamp(db, MIN_GAIN_DB, MAX_GAIN_DB);
+        return static_cast<int32_t>(lroundf(powf(10, db / 20) * UNITY_GAIN));
+    }
+
+    void DSP::process(int16_t * buffer, uint32_t numStereoSamples, uint32_t sampleRate, int32_t gain) {
+        if (sampleRate != sampleRate_) {
+            sampleRate_ = sampleRate;
+            configure();
+        }
+        if (gain == UNITY_GAIN && numActive_ == 0)
+            return;
+        for (uint32_t ch = 0; ch < 2; ++ch) {
+            int16_t * x = buffer + ch;
+            for (uint32_t i = 0; i < numStereoSamples; ++i, x += 2) {
+                // the gain is in 1/4096ths, the result keeps SAMPLE_BITS fractional bits
+                int32_t y = (*x * gain) >> (12 - SAMPLE_BITS);
+                for (uint32_t b = 0; b < numActive_; ++b)
+                    y = filters_[active_[b]].process(y, ch);
+                y = (y + (1 << (SAMPLE_BITS - 1))) >> SAMPLE_BITS;
+                *x = limiter_ ? limit(y) : saturate(y);
+            }
+        }
+    }
+
+    void DSP::configure() {
+        for (uint32_t i = 0; i < numActive_; ++i) {
+            Band const & b = bands_[active_[i]];
+            filters_[active_[i]].configure(b.type, sampleRate_, b.frequency, b.gainDb, b.q);
+        }
+        reset();
+    }
+
+} // namespace rckid::audio
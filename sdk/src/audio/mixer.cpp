@@ -0,0 +1,235 @@
+#include <algorithm>
+
+#include <rckid/audio/mixer.h>
+
+namespace rckid::audio {
+
+    namespace {
+
+        constexpr uint32_t STEP_ONE = 1 << 16;
+
+        /** Linear interpolation between two samples, the fraction is in 1/65536ths. The fraction is halved first so that the product fits in 32 bits.
+         */
+        int32_t lerp(int32_t a, int32_t b, uint32_t frac) {
+            return a + (((b - a) * static_cast<int32_t>(frac >> 1)) >> 15);
+        }
+    }
+
+    Mixer::Mixer(uint32_t sampleRate, uint32_t numVoices, uint32_t numBuffers):
+        DecoderStream{BUFFER_STEREO_SAMPLES, numBuffers},
+        sampleRate_{sampleRate},
+        voices_(numVoices),
+        acc_{new int32_t[BUFFER_STEREO_SAMPLES * 2]} {
+        ASSERT(sampleRate > 0);
+    }
+
+    void Mixer::play(uint32_t voice, unique_ptr<DecoderStream> stream) {
+        ASSERT(voice < voices_.size());
+        Voice & v = voices_[voice];
+        finish(v);
+        if (stream == nullptr)
+            return;
+        uint32_t rate = stream->sampleRate();
+        v.stream = std::move(stream);
+        v.data = nullptr;
+        v.length = 0;
+        v.stereo = true;
+        v.loop = false;
+        start(v, rate);
+    }
+
+    void Mixer::play(uint32_t voice, Sample const & sample, bool loop) {
+        ASSERT(voice < voices_.size());
+        Voice & v = voices_[voice];
+        finish(v);
+        if (sample.data == nullptr || sample.length == 0)
+            return;
+        v.sample = sample;
+        v.data = sample.data;
+        v.length = sample.length;
+        v.stereo = sample.stereo;
+        v.loop = loop;
+        start(v, sample.sampleRate);
+    }
+
+    void Mixer::stop(uint32_t voice) {
+        ASSERT(voice < voices_.size());
+        finish(voices_[voice]);
+    }
+
+    bool Mixer::isPlaying(uint32_t voice) const {
+        ASSERT(voice < voices_.size());
+        return voices_[voice].active;
+    }
+
+    uint32_t Mixer::freeVoice() const {
+        for (uint32_t i = 0; i < voices_.size(); ++i)
+            if (! voices_[i].active)
+                return i;
+        return numVoices();
+    }
+
+    void Mixer::setVolume(uint32_t voice, uint32_t volume) {
+        ASSERT(voice < voices_.size());
+        voices_[voice].volume = std::min(volume, VOLUME_FULL * 4);
+        updateGain(voices_[voice]);
+    }
+
+    void Mixer::setPan(uint32_t voice, int8_t pan) {
+        ASSERT(voice < voices_.size());
+        voices_[voice].pan = pan;
+        updateGain(voices_[voice]);
+    }
+
+    uint32_t Mixer::refillSamples(int16_t * buffer, uint32_t numStereoSamples) {
+        int32_t * acc = acc_.get();
+        memset(acc, 0, numStereoSamples * 2 * sizeof(int32_t));
+        for (Voice & v : voices_) {
+            if (! v.active)
+                continue;
+            // decode the stream's buffers before mixing them, the stream is only ever accessed from here
+            if (v.stream != nullptr)
+                v.stream->update();
+            mixVoice(v, acc, numStereoSamples);
+        }
+        // the gains are in 1/256ths, saturate the mix to 16 bits
+        for (uint32_t i = 0, e = numStereoSamples * 2; i < e; ++i)
+            buffer[i] = static_cast<int16_t>(std::clamp(acc[i] >> 8, static_cast<int32_t>(-32768), static_cast<int32_t>(32767)));
+        // the mixer never ends, when there are no voices it simply plays silence
+        return numStereoSamples;
+    }
+
+    void Mixer::start(Voice & v, uint32_t sourceRate) {
+        v.pos = 0;
+        v.frac = 0;
+        v.lastLeft = 0;
+        v.lastRight = 0;
+        v.step = static_cast<uint32_t>((static_cast<uint64_t>(sourceRate) << 16) / sampleRate_);
+        v.active = v.step != 0;
+        if (! v.active)
+            finish(v);
+    }
+
+    void Mixer::finish(Voice & v) {
+        if (v.buffer != nullptr)
+            v.stream->release(v.buffer);
+        v.buffer = nullptr;
+        v.stream = nullptr;
+        v.data = nullptr;
+        v.length = 0;
+        v.active = false;
+    }
+
+    bool Mixer::nextChunk(Voice & v) {
+        // remember the last sample of the chunk for the interpolation, before the stream buffer is returned
+        if (v.length > 0) {
+            if (v.stereo) {
+                v.lastLeft = v.data[v.length * 2 - 2];
+                v.lastRight = v.data[v.length * 2 - 1];
+            } else {
+                v.lastLeft = v.data[v.length - 1];
+                v.lastRight = v.lastLeft;
+            }
+        }
+        v.pos -= v.length;
+        v.data = nullptr;
+        v.length = 0;
+        if (v.stream != nullptr) {
+            if (v.buffer != nullptr)
+                v.stream->release(v.buffer);
+            uint32_t n = 0;
+            v.stream->acquire(v.buffer, n);
+            if (v.buffer == nullptr) {
+                // the stream is not ready yet, the voice is silent for the rest of the buffer, unless the stream has ended
+                if (v.stream->done())
+                    finish(v);
+                return false;
+            }
+            v.data = v.buffer;
+            v.length = n;
+            return true;
+        }
+        if (! v.loop) {
+            finish(v);
+            return false;
+        }
+        v.data = v.sample.data;
+        v.length = v.sample.length;
+        return true;
+    }
+
+    void Mixer::updateGain(Voice & v) {
+        int32_t volume = static_cast<int32_t>(v.volume);
+        v.gainLeft = v.pan > 0 ? volume * (127 - v.pan) / 127 : volume;
+        v.gainRight = v.pan < 0 ? volume * (128 + v.pan) / 128 : volume;
+    }
+
+    void Mixer::mixVoice(Voice & v, int32_t * acc, uint32_t n) {
+        int32_t gl = v.gainLeft;
+        int32_t gr = v.gainRight;
+        uint32_t i = 0;
+        while (i < n) {
+            if (v.pos >= v.length) {
+                if (! nextChunk(v))
+                    return;
+                continue;
+            }
+            int16_t const * s = v.data;
+            if (v.step == STEP_ONE) {
+                // same sample rate, just add the samples
+                uint32_t k = std::min(n - i, v.length - v.pos);
+                int32_t * a = acc + i * 2;
+                if (v.stereo) {
+                    s += v.pos * 2;
+                    for (uint32_t j = 0; j < k; ++j) {
+                        a[j * 2] += s[j * 2] * gl;
+                        a[j * 2 + 1] += s[j * 2 + 1] * gr;
+                    }
+                } else {
+                    s += v.pos;
+                    for (uint32_t j = 0; j < k; ++j) {
+                        a[j * 2] += s[j] * gl;
+                        a[j * 2 + 1] += s[j] * gr;
+                    }
+                }
+                i += k;
+                v.pos += k;
+            } else if (interpolation_) {
+                // interpolate between the previous and the current sample, which delays the voice by one source sample, but works across chunk boundaries
+                for (; i < n && v.pos < v.length; ++i) {
+                    int32_t l0, r0, l1, r1;
+                    if (v.stereo) {
+                        l1 = s[v.pos * 2];
+                        r1 = s[v.pos * 2 + 1];
+                        l0 = v.pos == 0 ? v.lastLeft : s[v.pos * 2 - 2];
+                        r0 = v.pos == 0 ? v.lastRight : s[v.pos * 2 - 1];
+                    } else {
+                        l1 = s[v.pos];
+                        r1 = l1;
+                        l0 = v.pos == 0 ? v.lastLeft : s[v.pos - 1];
+                        r0 = l0;
+                    }
+                    acc[i * 2] += lerp(l0, l1, v.frac) * gl;
+                    acc[i * 2 + 1] += lerp(r0, r1, v.frac) * gr;
+                    v.frac += v.step;
+                    v.pos += v.frac >> 16;
+                    v.frac &= 0xffff;
+                }
+            } else {
+                for (; i < n && v.pos < v.length; ++i) {
+                    if (v.stereo) {
+                        acc[i * 2] += s[v.pos * 2] * gl;
+                        acc[i * 2 + 1] += s[v.pos * 2 + 1] * gr;
+                    } else {
+                        acc[i * 2] += s[v.pos] * gl;
+                        acc[i * 2 + 1] += s[v.pos] * gr;
+                    }
+                    v.frac += v.step;
+                    v.pos += v.frac >> 16;
+                    v.frac &= 0xffff;
+                }
+            }
+        }
+    }
+
+} // namespace rckid::audio
@@ -0,0 +1,398 @@
+#include <algorithm>
+
+#include <rckid/audio/mp3.h>
+#include <rckid/audio/byte_order.h>
+
+namespace rckid::audio {
+
+    using namespace internal;
+
+    namespace {
+
+        /** ID3v2 "synchsafe" integer, which only uses the lower 7 bits of each byte.
+         */
+        uint32_t synchsafe(uint8_t const * x) {
+            return (static_cast<uint32_t>(x[0] & 0x7f) << 21) | (static_cast<uint32_t>(x[1] & 0x7f) << 14) | (static_cast<uint32_t>(x[2] & 0x7f) << 7) | static_cast<uint32_t>(x[3] & 0x7f);
+        }
+
+        /** Compares ASCII text of given length with the name, ignoring case.
+         */
+        bool equalsIgnoreCase(uint8_t const * text, uint32_t length, char const * name) {
+            for (uint32_t i = 0; i < length; ++i, ++name) {
+                char c = static_cast<char>(text[i]);
+                if (c >= 'a' && c <= 'z')
+                    c = static_cast<char>(c - 'a' + 'A');
+                if (c != *name)
+                    return false;
+            }
+            return *name == 0;
+        }
+
+        /** Parses ReplayGain value such as "-6.54 dB". Anything after the number is ignored.
+         */
+        std::optional<float> parseGain(uint8_t const * text, uint32_t length) {
+            uint32_t i = 0;
+            while (i < length && text[i] == ' ')
+                ++i;
+            bool negative = false;
+            if (i < length && (text[i] == '-' || text[i] == '+'))
+                negative = (text[i++] == '-');
+            float result = 0;
+            float scale = 0;
+            bool digits = false;
+            for (; i < length; ++i) {
+                if (text[i] >= '0' && text[i] <= '9') {
+                    digits = true;
+                    if (scale == 0) {
+                        result = result * 10 + (text[i] - '0');
+                    } else {
+                        result += (text[i] - '0') * scale;
+                        scale /= 10;
+                    }
+                } else if (text[i] == '.' && scale == 0) {
+                    scale = 0.1f;
+                } else {
+                    break;
+                }
+            }
+            if (! digits)
+                return std::nullopt;
+            return negative ? -result : result;
+        }
+
+        // "MP3I"
+        constexpr uint32_t INDEX_MAGIC = 0x4933504d;
+
+        /** Header of the saved frame index, followed by the offsets.
+         */
+        struct IndexHeader {
+            uint32_t magic;
+            uint32_t fileSize;
+            uint32_t interval;
+            uint32_t frames;
+            uint32_t entries;
+        };
+    }
+
+    MP3DecoderStream::MP3DecoderStream(RandomReadStream * random, unique_ptr<ReadStream> input, uint32_t numBuffers):
+        DecoderStream{1152 * 4, numBuffers},
+        in_{std::move(input)},
+        random_{random},
+        buffer_{new uint8_t[RING_SIZE + TAIL_SIZE]},
+        dec_{MP3InitDecoder()} {
+        // initially fill the buffer
+        fill();
+        // and skip the ID3 tag, if any - this is necessary for the decoder to work properly
+        skipID3v2Tags();
+        // get next frame info for sample rate
+        uint32_t len = findFrame();
+        if (len > 0) {
+            err_ = MP3GetNextFrameInfo(dec_, &fInfo_, window());
+            dataStart_ = readPos_;
+            parseVBRHeader(window(), len);
+            // the first frame is always indexed so that we can seek before decoding
+            if (random_ != nullptr && toc_.empty())
+                index_.push_back(dataStart_);
+        } else {
+            err_ = ERR_MP3_INDATA_UNDERFLOW;
+        }
+    }
+
+    uint32_t MP3DecoderStream::durationMs() const {
+        if (fInfo_.samprate == 0)
+            return 0;
+        if (totalFrames_ != 0)
+            return static_cast<uint32_t>(static_cast<uint64_t>(std::min(totalFrames_ * samplesPerFrame_, lastSample_) - firstSample_) * 1000 / fInfo_.samprate);
+        // estimate from the bitrate of the first frame, which is exact for constant bitrate files
+        if (random_ != nullptr && fInfo_.bitrate != 0)
+            return static_cast<uint32_t>(static_cast<uint64_t>(random_->size() - dataStart_) * 8000 / fInfo_.bitrate);
+        return 0;
+    }
+
+    void MP3DecoderStream::attachFile(String const & path, fs::Drive drive) {
+        if (random_ == nullptr || ! toc_.empty())
+            return;
+        String indexPath = STR(path << ".idx");
+        auto f = fs::readFile(indexPath, drive);
+        if (f != nullptr && loadIndex(*f))
+            return;
+        indexPath_ = std::move(indexPath);
+        indexDrive_ = drive;
+    }
+
+    bool MP3DecoderStream::loadIndex(ReadStream & from) {
+        if (random_ == nullptr)
+            return false;
+        IndexHeader h;
+        if (from.read(reinterpret_cast<uint8_t *>(& h), sizeof(h)) != sizeof(h))
+            return false;
+        if (h.magic != INDEX_MAGIC || h.fileSize != random_->size() || h.interval != INDEX_INTERVAL || h.entries != (h.frames + INDEX_INTERVAL - 1) / INDEX_INTERVAL || h.entries == 0)
+            return false;
+        std::vector<uint32_t> index(h.entries);
+        uint32_t size = h.entries * sizeof(uint32_t);
+        if (from.read(reinterpret_cast<uint8_t *>(index.data()), size) != size || index[0] != dataStart_)
+            return false;
+        index_ = std::move(index);
+        totalFrames_ = h.frames;
+        indexComplete_ = true;
+        return true;
+    }
+
+    void MP3DecoderStream::saveIndex(WriteStream & into) const {
+        ASSERT(indexComplete_);
+        IndexHeader h{INDEX_MAGIC, random_->size(), INDEX_INTERVAL, totalFrames_, static_cast<uint32_t>(index_.size())};
+        into.write(reinterpret_cast<uint8_t const *>(& h), sizeof(h));
+        into.write(reinterpret_cast<uint8_t const *>(index_.data()), static_cast<uint32_t>(index_.size() * sizeof(uint32_t)));
+    }
+
+    bool MP3DecoderStream::seekTo(uint32_t & sample) {
+        // the stream must be seekable and have at least one valid frame
+        if (random_ == nullptr || (toc_.empty() && index_.empty()))
+            return false;
+        // the position in decoded samples
+        uint32_t target = sample + firstSample_;
+        uint32_t frame = target / samplesPerFrame_;
+        if (! toc_.empty()) {
+            // interpolate between the two closest table of contents entries, the position is approximate
+            frame = std::min(frame, totalFrames_);
+            auto i = std::upper_bound(toc_.begin(), toc_.end(), frame, [](uint32_t f, SeekPoint const & p) { return f < p.frame; });
+            SeekPoint const & a = *(i - 1);
+            uint32_t offset = a.offset;
+            if (i != toc_.end() && i->frame > a.frame)
+                offset += static_cast<uint32_t>(static_cast<uint64_t>(i->offset - a.offset) * (frame - a.frame) / (i->frame - a.frame));
+            reposition(offset);
+            frame_ = frame;
+        } else if (uint32_t offset = estimateOffset(frame); offset != 0) {
+            // too far past the indexed part to scan, jump to the estimated offset, the decoder resynchronizes on the next frame
+            reposition(std::min(offset, random_->size()));
+            frame_ = frame;
+            frameExact_ = false;
+        } else {
+            // jump to the closest indexed frame and skip the rest by reading the frame headers only, which also extends the index if the frame is not indexed yet
+            uint32_t i = std::min(frame / INDEX_INTERVAL, static_cast<uint32_t>(index_.size() - 1));
+            reposition(index_[i]);
+            frame_ = i * INDEX_INTERVAL;
+            frameExact_ = true;
+            while (frame_ < frame) {
+                uint32_t len = findFrame();
+                if (len == 0) {
+                    completeIndex();
+                    break;
+                }
+                indexFrame();
+                consume(len);
+                ++frame_;
+            }
+        }
+        // skip the decoded samples before the target, unless we have reached the end of the stream before it
+        skipUntil_ = std::max(frame_ == frame ? target : frame_ * samplesPerFrame_, firstSample_);
+        sample = skipUntil_ - firstSample_;
+        return true;
+    }
+
+    void MP3DecoderStream::parseVBRHeader(uint8_t const * frame, uint32_t length) {
+        uint32_t version = (frame[1] >> 3) & 3;
+        bool mono = (frame[3] >> 6) == 3;
+        samplesPerFrame_ = (version == 3) ? 1152 : 576;
+        // the Xing header follows the side information
+        uint32_t xing = 4 + (version == 3 ? (mono ? 17 : 32) : (mono ? 9 : 17));
+        if (xing + 8 <= length && (memcmp(frame + xing, "Xing", 4) == 0 || memcmp(frame + xing, "Info", 4) == 0)) {
+            uint32_t flags = be32(frame + xing + 4);
+            uint8_t const * p = frame + xing + 8;
+            uint32_t frames = 0;
+            uint32_t bytes = 0;
+            if (flags & 1) {
+                frames = be32(p);
+                p += 4;
+            }
+            if (flags & 2) {
+                bytes = be32(p);
+                p += 4;
+            }
+            if (frames == 0)
+                return;
+            // the frame count does not include the Xing frame itself, which is not played
+            totalFrames_ = frames + 1;
+            firstSample_ = samplesPerFrame_;
+            skipUntil_ = firstSample_;
+            parseLAMETag(p + ((flags & 4) ? 100 : 0) + ((flags & 8) ? 4 : 0), frames, frame + length);
+            if (random_ == nullptr || (flags & 4) == 0 || p + 100 > frame + length)
+                return;
+            if (bytes == 0)
+                bytes = random_->size() - dataStart_;
+            // the table of contents has the offsets of each percent of the duration in 1/256ths of the stream size
+            toc_.reserve(101);
+            for (uint32_t i = 0; i < 100; ++i)
+                toc_.push_back(SeekPoint{totalFrames_ * i / 100, dataStart_ + static_cast<uint32_t>(static_cast<uint64_t>(p[i]) * bytes / 256)});
+            toc_.push_back(SeekPoint{totalFrames_, dataStart_ + bytes});
+            LOG(LL_MP3, "Xing header, frames " << totalFrames_ << ", bytes " << bytes);
+            return;
+        }
+        // the VBRI header is always 32 bytes after the frame header
+        if (36 + 26 <= length && memcmp(frame + 36, "VBRI", 4) == 0) {
+            uint8_t const * p = frame + 36;
+            uint32_t frames = be32(p + 14);
+            uint32_t entries = be16(p + 18);
+            uint32_t scale = be16(p + 20);
+            uint32_t entrySize = be16(p + 22);
+            uint32_t framesPerEntry = be16(p + 24);
+            if (frames == 0)
+                return;
+            totalFrames_ = frames + 1;
+            firstSample_ = samplesPerFrame_;
+            skipUntil_ = firstSample_;
+            if (random_ == nullptr || entrySize == 0 || entrySize > 4 || framesPerEntry == 0 || 36 + 26 + entries * entrySize > length)
+                return;
+            // the table has the sizes of each framesPerEntry frames, starting after the VBRI frame
+            toc_.reserve(entries + 2);
+            toc_.push_back(SeekPoint{0, dataStart_});
+            uint32_t offset = dataStart_ + length;
+            p += 26;
+            for (uint32_t i = 0; i <= entries; ++i) {
+                toc_.push_back(SeekPoint{std::min(1 + i * framesPerEntry, totalFrames_), offset});
+                if (i == entries)
+                    break;
+                uint32_t size = 0;
+                for (uint32_t j = 0; j < entrySize; ++j)
+                    size = (size << 8) | *p++;
+                offset += size * scale;
+            }
+            LOG(LL_MP3, "VBRI header, frames " << totalFrames_ << ", entries " << entries);
+        }
+    }
+
+    void MP3DecoderStream::skipID3v2Tags() {
+        // check for ID3v2 tag at the beginning of the stream
+        uint8_t const * h = window();
+        if (contiguous() < 10 || h[0] != 'I' || h[1] != 'D' || h[2] != '3')
+            return;
+        uint32_t version = h[3];
+        uint32_t flags = h[5];
+        // size is stored in bytes 6-9 as "synchsafe integers" and does not include the header, nor the footer in 2.4
+        uint32_t tagSize = synchsafe(h + 6);
+        if (version == 4 && (flags & 0x10))
+            tagSize += 10;
+        LOG(LL_MP3, "ID3v2." << version << " tag detected, size " << tagSize + 10);
+        consume(10);
+        // only the frames of 2.3 and 2.4 tags without unsynchronisation are read, the extended header is skipped (its size is synchsafe in 2.4 and does not include the size itself in 2.3)
+        bool frames = (version == 3 || version == 4) && (flags & 0x80) == 0;
+        if (frames && (flags & 0x40)) {
+            fill();
+            uint32_t size = (contiguous() < 4) ? tagSize : (version == 4 ? synchsafe(window()) : be32(window()) + 4);
+            frames = size < tagSize;
+            if (frames) {
+                skip(size);
+                tagSize -= size;
+            }
+        }
+        while (frames && tagSize >= 10) {
+            fill();
+            if (contiguous() < 10)
+                break;
+            uint8_t const * f = window();
+            // padding after the last frame
+            if (f[0] == 0)
+                break;
+            uint32_t size = (version == 4 ? synchsafe(f + 4) : be32(f + 4)) + 10;
+            if (size > tagSize)
+                break;
+            // compressed, encrypted and otherwise encoded frames are skipped, so are frames too large for the tail window
+            if (memcmp(f, "TXXX", 4) == 0 && f[9] == 0 && size <= contiguous())
+                parseTXXX(f + 10, size - 10);
+            skip(size);
+            tagSize -= size;
+        }
+        skip(tagSize);
+    }
+
+    void MP3DecoderStream::parseTXXX(uint8_t const * data, uint32_t size) {
+        // only ISO-8859-1 and UTF-8 encodings, in which the ReplayGain texts are plain ASCII
+        if (size < 2 || (data[0] != 0 && data[0] != 3))
+            return;
+        uint8_t const * end = data + size;
+        uint8_t const * description = data + 1;
+        uint8_t const * value = std::find(description, end, 0);
+        if (value == end)
+            return;
+        uint32_t length = static_cast<uint32_t>(value - description);
+        ++value;
+        uint32_t valueLength = static_cast<uint32_t>(std::find(value, end, 0) - value);
+        if (equalsIgnoreCase(description, length, "REPLAYGAIN_TRACK_GAIN"))
+            replayGain_.track = parseGain(value, valueLength);
+        else if (equalsIgnoreCase(description, length, "REPLAYGAIN_ALBUM_GAIN"))
+            replayGain_.album = parseGain(value, valueLength);
+        else
+            return;
+        LOG(LL_MP3, "ReplayGain track " << static_cast<int32_t>(replayGain_.track.value_or(0) * 100) << ", album " << static_cast<int32_t>(replayGain_.album.value_or(0) * 100) << " (1/100 dB)");
+    }
+
+    void MP3DecoderStream::parseLAMETag(uint8_t const * tag, uint32_t frames, uint8_t const * end) {
+        if (tag + 24 > end || (memcmp(tag, "LAME", 4) != 0 && memcmp(tag, "Lavc", 4) != 0))
+            return;
+        // radio (track) and audiophile (album) ReplayGain, each 3 bits name, 3 bits originator, sign and 9 bits of the gain in 1/10th dB, the name tells them apart
+        for (uint8_t const * rg = tag + 15; rg < tag + 19; rg += 2) {
+            uint32_t name = rg[0] >> 5;
+            uint32_t value = ((rg[0] & 1) << 8) | rg[1];
+            if (value == 0 && (rg[0] & 2) == 0)
+                continue;
+            float gain = ((rg[0] & 2) ? -0.1f : 0.1f) * value;
+            if (name == 1 && ! replayGain_.track.has_value())
+                replayGain_.track = gain;
+            else if (name == 2 && ! replayGain_.album.has_value())
+                replayGain_.album = gain;
+        }
+        // 12 bits each, right after the encoder version, lowpass, replay gain and flags
+        uint32_t delay = (tag[21] << 4) | (tag[22] >> 4);
+        uint32_t padding = ((tag[22] & 0xf) << 8) | tag[23];
+        if (frames * samplesPerFrame_ <= delay + padding)
+            return;
+        firstSample_ += delay + DECODER_DELAY;
+        skipUntil_ = firstSample_;
+        lastSample_ = firstSample_ + frames * samplesPerFrame_ - delay - padding;
+        LOG(LL_MP3, "LAME tag, delay " << delay << ", padding " << padding);
+    }
+
+    void MP3DecoderStream::reposition(uint32_t offset) {
+        uint32_t aligned = offset - offset % BLOCK_SIZE;
+        random_->seek(aligned);
+        inputOffset_ = aligned;
+        readPos_ = 0;
+        writePos_ = 0;
+        eof_ = false;
+        // the bit reservoir and overlap buffers of the decoder belong to the previous position
+        MP3FreeDecoder(dec_);
+        dec_ = MP3InitDecoder();
+        fill();
+        consume(std::min(offset - aligned, available()));
+    }
+
+    uint32_t MP3DecoderStream::estimateOffset(uint32_t frame) const {
+        uint32_t last = static_cast<uint32_t>(index_.size() - 1);
+        uint32_t lastFrame = last * INDEX_INTERVAL;
+        if (indexComplete_ || frame < lastFrame + MAX_SCAN_FRAMES)
+            return 0;
+        if (last > 0)
+            return index_[last] + static_cast<uint32_t>(static_cast<uint64_t>(index_[last] - index_[0]) * (frame - lastFrame) / lastFrame);
+        if (fInfo_.bitrate == 0 || fInfo_.samprate == 0)
+            return 0;
+        return index_[0] + static_cast<uint32_t>(static_cast<uint64_t>(fInfo_.bitrate) * samplesPerFrame_ * frame / (8 * static_cast<uint64_t>(fInfo_.samprate)));
+    }
+
+    void MP3DecoderStream::completeIndex() {
+        if (random_ == nullptr || ! toc_.empty() || indexComplete_ || ! frameExact_)
+            return;
+        // the index is only complete if all frames up to the end of the stream have been seen
+        if (index_.size() != (frame_ + INDEX_INTERVAL - 1) / INDEX_INTERVAL)
+            return;
+        indexComplete_ = true;
+        totalFrames_ = frame_;
+        if (indexPath_.empty())
+            return;
+        auto f = fs::writeFile(indexPath_, indexDrive_);
+        if (f != nullptr)
+            saveIndex(*f);
+        else
+            LOG(LL_WARN, "Cannot save MP3 index " << indexPath_);
+    }
+
+} // namespace rckid::audio
@@ -0,0 +1,158 @@
+#include <rckid/audio/ogg.h>
+#include <rckid/audio/byte_order.h>
+
+namespace rckid::audio {
+
+    using namespace internal;
+
+    namespace {
+
+        /** Lookup table for the Ogg page checksum (CRC-32 with polynomial 0x04c11db7, no reflection, zero initial value).
+         */
+        struct OggCrcTable {
+            uint32_t t[256];
+
+            constexpr OggCrcTable(): t{} {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    uint32_t r = i << 24;
+                    for (uint32_t j = 0; j < 8; ++j)
+                        r = (r & 0x80000000) ? (r << 1) ^ 0x04c11db7 : (r << 1);
+                    t[i] = r;
+                }
+            }
+        }; 
+
+        constexpr OggCrcTable oggCrcTable;
+
+        uint32_t oggCrc(uint32_t crc, uint8_t const * data, uint32_t size) {
+            for (uint32_t i = 0; i < size; ++i)
+                crc = (crc << 8) ^ oggCrcTable.t[((crc >> 24) ^ data[i]) & 0xff];
+            return crc;
+        }
+    }
+
+    uint32_t OggReader::readPacket(uint8_t * buffer, uint32_t bufferSize, bool truncate) {
+        uint32_t size = 0;
+        bool overflow = false;
+        bool inPacket = false;
+        while (true) {
+            if (segment_ == numSegments_) {
+                if (! readPage(inPacket))
+                    return 0;
+                continue;
+            }
+            uint32_t len = segments_[segment_++];
+            inPacket = true;
+            if (! overflow && size + len <= bufferSize) {
+                if (in_.readFully(buffer + size, len) != len)
+                    return 0;
+            } else {
+                overflow = true;
+                // when truncating, the part that still fits the buffer is kept
+                uint32_t n = (truncate && size < bufferSize) ? bufferSize - size : 0;
+                if (n > 0 && in_.readFully(buffer + size, n) != n)
+                    return 0;
+                skip(len - n);
+            }
+            size += len;
+            // segment shorter than 255 bytes terminates the packet
+            if (len < 255) {
+                if (overflow && ! truncate) {
+                    LOG(LL_WARN, "Ogg packet too large: " << size);
+                } else if (size > 0) {
+                    granule_ = pageGranule_;
+                    return size;
+                }
+                size = 0;
+                overflow = false;
+                inPacket = false;
+            }
+        }
+    }
+
+    bool OggReader::readPage(bool inPacket) {
+        uint8_t h[27];
+        while (true) {
+            if (in_.readFully(h, sizeof(h)) != sizeof(h))
+                return false;
+            // if the page does not start where expected, resynchronize on the next capture pattern
+            while (h[0] != 'O' || h[1] != 'g' || h[2] != 'g' || h[3] != 'S') {
+                memmove(h, h + 1, sizeof(h) - 1);
+                if (in_.readFully(h + sizeof(h) - 1, 1) != 1)
+                    return false;
+            }
+            uint8_t flags = h[5];
+            uint64_t granule = le32(h + 6) | (static_cast<uint64_t>(le32(h + 10)) << 32);
+            uint32_t serial = le32(h + 14);
+            uint32_t n = h[26];
+            if (in_.readFully(segments_, n) != n)
+                return false;
+            if (firstPage_) {
+                serial_ = serial;
+                firstPage_ = false;
+            }
+            if (serial != serial_) {
+                for (uint32_t i = 0; i < n; ++i)
+                    skip(segments_[i]);
+                continue;
+            }
+            numSegments_ = n;
+            segment_ = 0;
+            pageGranule_ = granule;
+            pageFlags_ = flags;
+            // skip the rest of a packet whose beginning we did not see
+            if ((flags & FLAG_CONTINUED) && ! inPacket) {
+                while (segment_ < numSegments_) {
+                    uint8_t len = segments_[segment_++];
+                    skip(len);
+                    if (len < 255)
+                        break;
+                }
+            }
+            return true;
+        }
+    }
+
+    void OggWriter::writePacket(uint8_t const * data, uint32_t size, uint64_t granule) {
+        ASSERT(size <= MAX_PAGE_BODY);
+        uint32_t segments = size / 255 + 1;
+        if (bodySize_ + size > MAX_PAGE_BODY || numSegments_ + segments > 255)
+            flush();
+        memcpy(body_.get() + bodySize_, data, size);
+        bodySize_ += size;
+        for (uint32_t i = 1; i < segments; ++i)
+            segments_[numSegments_++] = 255;
+        segments_[numSegments_++] = static_cast<uint8_t>(size % 255);
+        granule_ = granule;
+    }
+
+    void OggWriter::flush(bool eos) {
+        if (numSegments_ == 0 && ! eos)
+            return;
+        uint8_t h[27 + 255];
+        h[0] = 'O';
+        h[1] = 'g';
+        h[2] = 'g';
+        h[3] = 'S';
+        h[4] = 0; // version
+        h[5] = (first_ ? OggReader::FLAG_BOS : 0) | (eos ? OggReader::FLAG_EOS : 0);
+        setLe32(h + 6, static_cast<uint32_t>(granule_));
+        setLe32(h + 10, static_cast<uint32_t>(granule_ >> 32));
+        setLe32(h + 14, serial_);
+        setLe32(h + 18, sequence_++);
+        setLe32(h + 22, 0);
+        h[26] = static_cast<uint8_t>(numSegments_);
+        memcpy(h + 27, segments_, numSegments_);
+        uint32_t headerSize = 27 + numSegments_;
+        uint32_t crc = oggCrc(0, h, headerSize);
+        crc = oggCrc(crc, body_.get(), bodySize_);
+        setLe32(h + 22, crc);
+        out_.write(h, headerSize);
+        out_.write(body_.get(), bodySize_);
+        bytesWritten_ += headerSize + bodySize_;
+        first_ = false;
+        bodySize_ = 0;
+        numSegments_ = 0;
+    }
+
+} // namespace rckid::audio
@@ -0,0 +1,104 @@
+#include <libopus/include/opus.h>
+
+#include <rckid/audio/opus.h>
+#include <rckid/audio/byte_order.h>
+
+namespace rckid::audio {
+
+    using namespace internal;
+
+    OpusDecoderStream::OpusDecoderStream(unique_ptr<ReadStream> input, uint32_t numBuffers):
+        DecoderStream{BUFFER_STEREO_SAMPLES, numBuffers},
+        in_{std::move(input)},
+        ogg_{*in_},
+        packet_{new uint8_t[MAX_PACKET_SIZE]} {
+        if (! readHeader())
+            return;
+        // the decoder always outputs stereo, mono streams are upmixed by libopus
+        dec_ = reinterpret_cast<OpusDecoder *>(new uint8_t[decoderStateSize()]);
+        err_ = opus_decoder_init(dec_, SAMPLE_RATE, 2);
+        if (err_ != OPUS_OK) {
+            LOG(LL_ERROR, "Opus decoder init failed: " << err_);
+            delete [] reinterpret_cast<uint8_t *>(dec_);
+            dec_ = nullptr;
+            return;
+        }
+        opus_decoder_ctl(dec_, OPUS_SET_GAIN(gain_));
+    }
+
+    OpusDecoderStream::~OpusDecoderStream() {
+        delete [] reinterpret_cast<uint8_t *>(dec_);
+    }
+
+    uint32_t OpusDecoderStream::decoderStateSize() {
+        return static_cast<uint32_t>(opus_decoder_get_size(2));
+    }
+
+    bool OpusDecoderStream::readHeader() {
+        // OpusHead: magic, version, channels, pre-skip, input sample rate, output gain, channel mapping family
+        uint32_t size = ogg_.nextPacket(packet_.get(), MAX_PACKET_SIZE);
+        uint8_t const * h = packet_.get();
+        if (size < 19 || memcmp(h, "OpusHead", 8) != 0 || (h[8] >> 4) != 0) {
+            LOG(LL_ERROR, "Not an Ogg Opus stream");
+            return false;
+        }
+        channels_ = h[9];
+        preSkip_ = le16(h + 10);
+        int16_t gain = static_cast<int16_t>(le16(h + 16));
+        uint8_t family = h[18];
+        if (channels_ == 0 || channels_ > 2 || family > 1) {
+            LOG(LL_ERROR, "Unsupported Opus channels: " << channels_ << ", mapping family " << family);
+            return false;
+        }
+        skip_ = preSkip_;
+        // OpusTags, which we do not use, so only its magic is read (the tags may contain large cover art images)
+        size = ogg_.nextPacketStart(packet_.get(), 8);
+        if (size < 8 || memcmp(packet_.get(), "OpusTags", 8) != 0) {
+            LOG(LL_ERROR, "Missing OpusTags");
+            return false;
+        }
+        gain_ = gain;
+        return true;
+    }
+
+    uint32_t OpusDecoderStream::refillSamples(int16_t * buffer, uint32_t numStereoSamples) {
+        if (dec_ == nullptr)
+            return 0;
+        uint32_t written = 0;
+        while (true) {
+            if (packetSize_ == 0) {
+                packetSize_ = ogg_.nextPacket(packet_.get(), MAX_PACKET_SIZE);
+                if (packetSize_ == 0)
+                    break;
+            }
+            int n = opus_packet_get_nb_samples(packet_.get(), packetSize_, SAMPLE_RATE);
+            if (n <= 0 || static_cast<uint32_t>(n) > BUFFER_STEREO_SAMPLES) {
+                LOG(LL_WARN, "Invalid Opus packet: " << n);
+                ++packetErrors_;
+                packetSize_ = 0;
+                continue;
+            }
+            // keep the packet for next refill if it does not fit
+            if (written + n > numStereoSamples)
+                break;
+            int16_t * out = buffer + written * 2;
+            int decoded = opus_decode(dec_, packet_.get(), packetSize_, out, n, 0);
+            packetSize_ = 0;
+            if (decoded < 0) {
+                err_ = decoded;
+                ++packetErrors_;
+                continue;
+            }
+            ++packets_;
+            if (skip_ > 0) {
+                uint32_t s = std::min(skip_, static_cast<uint32_t>(decoded));
+                memmove(out, out + s * 2, (decoded - s) * 2 * sizeof(int16_t));
+                skip_ -= s;
+                decoded -= s;
+            }
+            written += decoded;
+        }
+        return written;
+    }
+
+} // namespace rckid::audio
@@ -0,0 +1,129 @@
+#include <algorithm>
+
+#include <rckid/audio/qoa.h>
+#include <rckid/audio/byte_order.h>
+
+namespace rckid::audio {
+
+    using namespace internal;
+
+    namespace {
+
+        /** Dequantization table, i.e. the residual for each scale factor and quantized value.
+
+            The residuals are the scale factor multiplied by 0.75, 2.5, 4.5 and 7 (positive and negative), rounded away from zero. To avoid floats the multipliers are kept in quarters.
+         */
+        struct QOADequantTable {
+            int32_t t[16][8];
+
+            constexpr QOADequantTable(): t{} {
+                constexpr int32_t scaleFactors[16] = { 1, 7, 21, 45, 84, 138, 211, 304, 421, 562, 731, 928, 1157, 1419, 1715, 2048 };
+                constexpr int32_t quarters[4] = { 3, 10, 18, 28 };
+                for (uint32_t s = 0; s < 16; ++s) {
+                    for (uint32_t q = 0; q < 4; ++q) {
+                        int32_t x = (scaleFactors[s] * quarters[q] + 2) / 4;
+                        t[s][q * 2] = x;
+                        t[s][q * 2 + 1] = -x;
+                    }
+                }
+            }
+        };
+
+        constexpr QOADequantTable dequantTable;
+
+        uint32_t frameSize(uint32_t channels, uint32_t samples) {
+            return 8 + channels * 16 + (samples + QOADecoderStream::SLICE_SAMPLES - 1) / QOADecoderStream::SLICE_SAMPLES * channels * 8;
+        }
+    }
+
+    QOADecoderStream::QOADecoderStream(unique_ptr<ReadStream> input, uint32_t numBuffers):
+        DecoderStream{BUFFER_STEREO_SAMPLES, numBuffers},
+        in_{std::move(input)} {
+        uint8_t h[8];
+        if (in_->readFully(h, 8) == 8 && memcmp(h, "qoaf", 4) == 0) {
+            samples_ = be32(h + 4);
+            // the frame buffer is large enough for the largest stereo frame (without the frame header)
+            frame_ = unique_ptr<uint8_t>{new uint8_t[frameSize(2, MAX_FRAME_SLICES * SLICE_SAMPLES) - 8]};
+            if (! readFrame())
+                frame_ = nullptr;
+        }
+        if (! valid())
+            LOG(LL_ERROR, "Not a QOA stream");
+    }
+
+    uint32_t QOADecoderStream::refillSamples(int16_t * buffer, uint32_t numStereoSamples) {
+        if (! valid())
+            return 0;
+        uint32_t i = 0;
+        while (i + SLICE_SAMPLES <= numStereoSamples) {
+            if (frameSample_ == frameSamples_ && ! readFrame())
+                break;
+            uint32_t n = std::min(SLICE_SAMPLES, frameSamples_ - frameSample_);
+            for (uint32_t c = 0; c < channels_; ++c)
+                decodeSlice(c, buffer + i * 2 + c, n);
+            if (channels_ == 1)
+                for (uint32_t k = 0; k < n; ++k)
+                    buffer[(i + k) * 2 + 1] = buffer[(i + k) * 2];
+            frameSample_ += n;
+            i += n;
+        }
+        return i;
+    }
+
+    bool QOADecoderStream::readFrame() {
+        uint8_t h[8];
+        if (in_->readFully(h, 8) != 8)
+            return false;
+        uint32_t channels = h[0];
+        uint32_t sampleRate = (static_cast<uint32_t>(h[1]) << 16) | (h[2] << 8) | h[3];
+        uint32_t samples = be16(h + 4);
+        uint32_t size = be16(h + 6);
+        if (channels_ == 0) {
+            if (channels < 1 || channels > 2)
+                return false;
+            channels_ = channels;
+            sampleRate_ = sampleRate;
+        } else if (channels != channels_ || sampleRate != sampleRate_) {
+            LOG(LL_WARN, "QOA format changed mid-stream");
+            return false;
+        }
+        if (samples == 0 || samples > MAX_FRAME_SLICES * SLICE_SAMPLES || size != frameSize(channels, samples))
+            return false;
+        if (in_->readFully(frame_.get(), size - 8) != size - 8)
+            return false;
+        for (uint32_t c = 0; c < channels_; ++c) {
+            uint8_t const * p = frame_.get() + c * 16;
+            for (uint32_t i = 0; i < 4; ++i) {
+                lms_[c].history[i] = static_cast<int16_t>(be16(p + i * 2));
+                lms_[c].weights[i] = static_cast<int16_t>(be16(p + 8 + i * 2));
+            }
+        }
+        frameSamples_ = samples;
+        frameSample_ = 0;
+        return true;
+    }
+
+    void QOADecoderStream::decodeSlice(uint32_t channel, int16_t * buffer, uint32_t numSamples) {
+        uint8_t const * p = frame_.get() + channels_ * 16 + ((frameSample_ / SLICE_SAMPLES) * channels_ + channel) * 8;
+        uint64_t slice = be64(p);
+        int32_t const * dequant = dequantTable.t[slice >> 60];
+        slice <<= 4;
+        LMS & lms = lms_[channel];
+        for (uint32_t i = 0; i < numSamples; ++i) {
+            int32_t predicted = (lms.history[0] * lms.weights[0] + lms.history[1] * lms.weights[1] + lms.history[2] * lms.weights[2] + lms.history[3] * lms.weights[3]) >> 13;
+            int32_t residual = dequant[slice >> 61];
+            slice <<= 3;
+            int32_t sample = std::clamp(predicted + residual, static_cast<int32_t>(-32768), static_cast<int32_t>(32767));
+            buffer[i * 2] = static_cast<int16_t>(sample);
+            // adapt the weights and shift the history
+            int32_t delta = residual >> 4;
+            for (uint32_t j = 0; j < 4; ++j)
+                lms.weights[j] += lms.history[j] < 0 ? -delta : delta;
+            lms.history[0] = lms.history[1];
+            lms.history[1] = lms.history[2];
+            lms.history[2] = lms.history[3];
+            lms.history[3] = sample;
+        }
+    }
+
+} // namespace rckid::audio
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cmath>
+
+#include <rckid/audio/resampler.h>
+
+namespace rckid::audio {
+
+    namespace {
+
+        constexpr float PI = 3.14159265358979f;
+
+        /** Fraction of the lower Nyquist frequency passed by the filter, the rest is the transition band.
+         */
+        constexpr float CUTOFF = 0.9f;
+    }
+
+    ResamplingStream::ResamplingStream(unique_ptr<DecoderStream> source, uint32_t sampleRate, uint32_t numBuffers):
+        DecoderStream{BUFFER_STEREO_SAMPLES, numBuffers},
+        source_{std::move(source)},
+        sampleRate_{sampleRate},
+        step_{static_cast<uint32_t>((static_cast<uint64_t>(source_->sampleRate()) << 16) / sampleRate)},
+        taps_{std::min(TAPS * ((step_ + 0xffff) >> 16), MAX_TAPS)},
+        coeffs_{new int16_t[PHASES * taps_]},
+        in_{new int16_t[INPUT_SIZE * 2]} {
+        ASSERT(sampleRate > 0);
+        initializeFilter();
+        resetInput();
+    }
+
+    uint32_t ResamplingStream::refillSamples(int16_t * buffer, uint32_t numStereoSamples) {
+        int16_t const * in = in_.get();
+        uint32_t i = 0;
+        while (i < numStereoSamples) {
+            if (pos_ + taps_ > inSize_) {
+                if (! pull())
+                    break;
+                continue;
+            }
+            // compute as many output samples as the input window allows
+            if (step_ == (1 << 16)) {
+                uint32_t n = std::min(numStereoSamples - i, inSize_ - taps_ + 1 - pos_);
+                memcpy(buffer + i * 2, in + (pos_ + taps_ / 2 - 1) * 2, n * 2 * sizeof(int16_t));
+                i += n;
+                pos_ += n;
+                continue;
+            }
+            for (; i < numStereoSamples && pos_ + taps_ <= inSize_; ++i) {
+                int16_t const * c = coefficients(frac_ >> (16 - PHASE_BITS));
+                int16_t const * x = in + pos_ * 2;
+                int32_t left = 0;
+                int32_t right = 0;
+                for (uint32_t t = 0; t < taps_; ++t) {
+                    left += x[t * 2] * c[t];
+                    right += x[t * 2 + 1] * c[t];
+                }
+                buffer[i * 2] = static_cast<int16_t>(std::clamp(left >> 15, static_cast<int32_t>(-32768), static_cast<int32_t>(32767)));
+                buffer[i * 2 + 1] = static_cast<int16_t>(std::clamp(right >> 15, static_cast<int32_t>(-32768), static_cast<int32_t>(32767)));
+                frac_ += step_;
+                pos_ += frac_ >> 16;
+                frac_ &= 0xffff;
+            }
+        }
+        return i;
+    }
+
+    bool ResamplingStream::seekTo(uint32_t & sample) {
+        // the source's buffers are all discarded by its seek, including the one being copied
+        srcBuffer_ = nullptr;
+        bool result = source_->seek(static_cast<uint32_t>(static_cast<uint64_t>(sample) * 1000 / sampleRate_));
+        resetInput();
+        sample = static_cast<uint32_t>(static_cast<uint64_t>(source_->positionMs()) * sampleRate_ / 1000);
+        return result;
+    }
+
+    void ResamplingStream::initializeFilter() {
+        // the cutoff is relative to the input Nyquist frequency, lowered when downsampling
+        float cutoff = CUTOFF * std::min(1.0f, static_cast<float>(sampleRate_) / static_cast<float>(source_->sampleRate()));
+        for (uint32_t p = 0; p < PHASES; ++p) {
+            float f = static_cast<float>(p) / PHASES;
+            float h[MAX_TAPS];
+            float sum = 0;
+            for (uint32_t t = 0; t < taps_; ++t) {
+                // distance of the tap from the output sample, which lies f after the tap taps_ / 2 - 1
+                float x = static_cast<float>(t) - (taps_ / 2 - 1) - f;
+                float sinc = (x == 0) ? 1.0f : sinf(PI * cutoff * x) / (PI * cutoff * x);
+                // Blackman window
+                float u = (x + taps_ / 2) / taps_;
+                float w = 0.42f - 0.5f * cosf(2 * PI * u) + 0.08f * cosf(4 * PI * u);
+                h[t] = sinc * w;
+                sum += h[t];
+            }
+            for (uint32_t t = 0; t < taps_; ++t)
+                coeffs_.get()[p * taps_ + t] = static_cast<int16_t>(lroundf(h[t] / sum * 32768.0f));
+        }
+    }
+
+    void ResamplingStream::resetInput() {
+        // the first output sample is centered at the first input sample
+        inSize_ = taps_ / 2 - 1;
+        memset(in_.get(), 0, inSize_ * 2 * sizeof(int16_t));
+        pos_ = 0;
+        frac_ = 0;
+        srcSize_ = 0;
+        srcPos_ = 0;
+        flushed_ = false;
+    }
+
+    bool ResamplingStream::pull() {
+        int16_t * in = in_.get();
+        if (pos_ > 0) {
+            // when downsampling, the position may already be past the end of the window
+            uint32_t keep = pos_ < inSize_ ? inSize_ - pos_ : 0;
+            if (keep > 0)
+                memmove(in, in + pos_ * 2, keep * 2 * sizeof(int16_t));
+            pos_ -= inSize_ - keep;
+            inSize_ = keep;
+        }
+        if (srcPos_ == srcSize_) {
+            if (srcBuffer_ != nullptr)
+                source_->release(srcBuffer_);
+            // the source decodes synchronously, so no buffer after the update means the source is done
+            source_->update();
+            source_->acquire(srcBuffer_, srcSize_);
+            srcPos_ = 0;
+            if (srcBuffer_ == nullptr) {
+                if (flushed_)
+                    return false;
+                // pad the input with silence so that the filter reaches the last sample
+                uint32_t n = taps_ / 2;
+                memset(in + inSize_ * 2, 0, n * 2 * sizeof(int16_t));
+                inSize_ += n;
+                flushed_ = true;
+                return true;
+            }
+        }
+        uint32_t n = std::min(INPUT_SIZE - inSize_, srcSize_ - srcPos_);
+        memcpy(in + inSize_ * 2, srcBuffer_ + srcPos_ * 2, n * 2 * sizeof(int16_t));
+        inSize_ += n;
+        srcPos_ += n;
+        return true;
+    }
+
+} // namespace rckid::audio
@@ -0,0 +1,114 @@
+#include <algorithm>
+
+#include <rckid/audio/wav.h>
+#include <rckid/audio/byte_order.h>
+
+namespace rckid::audio {
+
+    using namespace internal;
+
+    namespace {
+
+        bool skip(ReadStream & in, uint32_t size) {
+            uint8_t buffer[64];
+            while (size > 0) {
+                uint32_t n = in.readFully(buffer, std::min(size, static_cast<uint32_t>(sizeof(buffer))));
+                if (n == 0)
+                    return false;
+                size -= n;
+            }
+            return true;
+        }
+    }
+
+    // WAVFormat
+
+    bool WAVFormat::read(ReadStream & in) {
+        uint8_t h[16];
+        if (in.readFully(h, 12) != 12 || memcmp(h, "RIFF", 4) != 0 || memcmp(h + 8, "WAVE", 4) != 0)
+            return false;
+        bool hasFmt = false;
+        while (true) {
+            if (in.readFully(h, 8) != 8)
+                return false;
+            uint32_t size = le32(h + 4);
+            // chunks are padded to even sizes
+            uint32_t padded = size + (size & 1);
+            if (memcmp(h, "fmt ", 4) == 0) {
+                if (size < 16 || in.readFully(h, 16) != 16 || ! skip(in, padded - 16))
+                    return false;
+                format = le16(h);
+                channels = le16(h + 2);
+                sampleRate = le32(h + 4);
+                blockAlign = le16(h + 12);
+                bitsPerSample = le16(h + 14);
+                hasFmt = true;
+            } else if (memcmp(h, "fact", 4) == 0) {
+                if (size < 4 || in.readFully(h, 4) != 4 || ! skip(in, padded - 4))
+                    return false;
+                samples = le32(h);
+                hasFact = true;
+            } else if (memcmp(h, "data", 4) == 0) {
+                dataSize = size;
+                return hasFmt && blockAlign != 0;
+            } else if (! skip(in, padded)) {
+                return false;
+            }
+        }
+    }
+
+    // WAVDecoderStream
+
+    WAVDecoderStream::WAVDecoderStream(unique_ptr<ReadStream> input, uint32_t numBuffers):
+        DecoderStream{BUFFER_STEREO_SAMPLES, numBuffers},
+        in_{std::move(input)} {
+        valid_ = format_.read(*in_) && checkFormat();
+        if (! valid_)
+            LOG(LL_ERROR, "Not a PCM WAV stream");
+    }
+
+    WAVDecoderStream::WAVDecoderStream(unique_ptr<ReadStream> input, WAVFormat const & format, uint32_t numBuffers):
+        DecoderStream{BUFFER_STEREO_SAMPLES, numBuffers},
+        in_{std::move(input)},
+        format_{format} {
+        valid_ = checkFormat();
+        if (! valid_)
+            LOG(LL_ERROR, "Unsupported PCM WAV format");
+    }
+
+    bool WAVDecoderStream::checkFormat() {
+        if (format_.format != WAVFormat::PCM || format_.channels < 1 || format_.channels > 2)
+            return false;
+        if (format_.bitsPerSample != 8 && format_.bitsPerSample != 16)
+            return false;
+        if (format_.blockAlign != format_.channels * format_.bitsPerSample / 8)
+            return false;
+        dataRemaining_ = format_.dataSize;
+        return true;
+    }
+
+    uint32_t WAVDecoderStream::refillSamples(int16_t * buffer, uint32_t numStereoSamples) {
+        if (! valid_)
+            return 0;
+        // read the samples to the end of the buffer so that they can be expanded in place
+        uint32_t toRead = std::min(numStereoSamples * format_.blockAlign, dataRemaining_);
+        toRead -= toRead % format_.blockAlign;
+        uint8_t * raw = reinterpret_cast<uint8_t *>(buffer) + numStereoSamples * 4 - toRead;
+        uint32_t bytes = in_->readFully(raw, toRead);
+        dataRemaining_ -= bytes;
+        uint32_t n = bytes / format_.blockAlign;
+        if (format_.bitsPerSample == 8) {
+            // 8bit samples are unsigned
+            uint32_t values = n * format_.channels;
+            for (uint32_t i = 0; i < values; ++i)
+                buffer[i] = static_cast<int16_t>((raw[i] - 128) << 8);
+        } else {
+            // 16bit samples are little endian, same as the platform
+            memmove(buffer, raw, n * format_.blockAlign);
+        }
+        if (format_.channels == 1)
+            convertToStereo(buffer, n);
+        return n;
+    }
+
+} // namespace rckid::audio
@@ -1,3 +1,5 @@
+#include <vector>
+
 #include <FatFS/ff.h>
 #include <FatFS/diskio.h>
 
@@ -256,6 +258,89 @@ namespace rckid::fs {
 
     }; // LittleFSFileWriter
 
+    class FatFSFolderReader : public FolderReader {
+    public:
+        ~FatFSFolderReader() override {
+            f_closedir(& dir_);
+        }
+
+    protected:
+
+        void rewind() override {
+            f_rewinddir(& dir_);
+        }
+
+        bool next(FolderEntry * entry) override {
+            FILINFO fno;
+            if (f_readdir(& dir_, & fno) != FR_OK || fno.fname[0] == 0)
+                return false;
+            if (entry != nullptr) {
+                entry->name = String{fno.fname};
+                entry->isFolder = (fno.fattrib & AM_DIR) != 0;
+                entry->size = static_cast<uint32_t>(fno.fsize);
+            }
+            return true;
+        }
+
+        void saveCheckpoint(uint32_t index) override {
+            ASSERT(index == checkpoints_.size() + 1);
+            checkpoints_.push_back(dir_);
+        }
+
+        void restoreCheckpoint(uint32_t index) override {
+            // the directory object only holds the read position, so a copy of it reads from the same entry
+            dir_ = checkpoints_[index - 1];
+        }
+
+    private:
+
+        friend unique_ptr<FolderReader> openFolder(String const & path, Drive dr);
+
+        DIR dir_;
+        std::vector<DIR> checkpoints_;
+    }; // fs::FatFSFolderReader
+
+    class LittleFSFolderReader : public FolderReader {
+    public:
+        ~LittleFSFolderReader() override {
+            lfs_dir_close(& lfs_, & dir_);
+        }
+
+    protected:
+
+        void rewind() override {
+            lfs_dir_rewind(& lfs_, & dir_);
+        }
+
+        bool next(FolderEntry * entry) override {
+            lfs_info info;
+            if (lfs_dir_read(& lfs_, & dir_, & info) <= 0)
+                return false;
+            if (entry != nullptr) {
+                entry->name = String{info.name};
+                entry->isFolder = (info.type & LFS_TYPE_DIR) != 0;
+                entry->size = static_cast<uint32_t>(info.size);
+            }
+            return true;
+        }
+
+        void saveCheckpoint(uint32_t index) override {
+            ASSERT(index == checkpoints_.size() + 1);
+            checkpoints_.push_back(lfs_dir_tell(& lfs_, & dir_));
+        }
+
+        void restoreCheckpoint(uint32_t index) override {
+            lfs_dir_seek(& lfs_, & dir_, static_cast<lfs_off_t>(checkpoints_[index - 1]));
+        }
+
+    private:
+
+        friend unique_ptr<FolderReader> openFolder(String const & path, Drive dr);
+
+        lfs_dir_t dir_;
+        std::vector<lfs_soff_t> checkpoints_;
+    }; // fs::LittleFSFolderReader
+
 #endif
 
     // path manipulation functions
@@ -715,5 +800,27 @@ namespace rckid::fs {
         return count;
     }
 
+    unique_ptr<FolderReader> openFolder(String const & path, Drive dr) {
+        if (! isMounted(dr))
+            return nullptr;
+        switch (dr) {
+            case Drive::SD: {
+                auto result = new FatFSFolderReader();
+                if (f_opendir(& result->dir_, path.c_str()) == FR_OK)
+                    return unique_ptr<FolderReader>{result};
+                delete result;
+                return nullptr;
+            }
+            case Drive::Cartridge: {
+                auto result = new LittleFSFolderReader();
+                if (lfs_dir_open(& lfs_, & result->dir_, path.c_str()) == 0)
+                    return unique_ptr<FolderReader>{result};
+                delete result;
+                return nullptr;
+            }
+        }
+        UNREACHABLE;
+    }
+
 #endif // RCKID_CUSTOM_FILESYSTEM
 }
\ No newline at end of file
@@ -3,6 +3,147 @@
 
 namespace rckid {
 
+    namespace {
+
+        /** Sum of the weights of the 2x2 box filter, the weights are products of 8bit fractions.
+         */
+        constexpr uint32_t BOX_WEIGHT = 1 << 16;
+
+        /** Raw pixel access and conversion to RGB565 specialized for the color representations so that the transformed rendering loops do not have to switch per pixel.
+         */
+        template<Color::Representation R>
+        struct PixelReader;
+
+        template<>
+        struct PixelReader<Color::Representation::RGB565> {
+            static uint16_t raw(uint8_t const * pixels, uint32_t offset) { return reinterpret_cast<uint16_t const *>(pixels)[offset]; }
+            static uint16_t color(uint16_t raw, Color::RGB565 const *) { return raw; }
+        };
+
+        template<>
+        struct PixelReader<Color::Representation::RGB332> {
+            static uint16_t raw(uint8_t const * pixels, uint32_t offset) { return pixels[offset]; }
+            static uint16_t color(uint16_t raw, Color::RGB565 const *) { return Color::RGB332{raw}; }
+        };
+
+        template<>
+        struct PixelReader<Color::Representation::Index256> {
+            static uint16_t raw(uint8_t const * pixels, uint32_t offset) { return pixels[offset]; }
+            static uint16_t color(uint16_t raw, Color::RGB565 const * palette) { return palette[raw]; }
+        };
+
+        template<>
+        struct PixelReader<Color::Representation::Index16> {
+            static uint16_t raw(uint8_t const * pixels, uint32_t offset) { return (pixels[offset >> 1] >> ((offset & 1) * 4)) & 0xf; }
+            static uint16_t color(uint16_t raw, Color::RGB565 const * palette) { return palette[raw]; }
+        };
+
+        /** Weighted average of the RGB565 colors, only pixels with the corresponding bit in mask set are used. The weights of the used pixels must add up to total.
+         */
+        inline uint16_t average(uint16_t const * colors, uint32_t const * weights, uint32_t mask, uint32_t total) {
+            uint32_t r = 0, g = 0, b = 0;
+            for (uint32_t i = 0; i < 4; ++i) {
+                if (! (mask & (1 << i)))
+                    continue;
+                r += (colors[i] >> 11) * weights[i];
+                g += ((colors[i] >> 5) & 0x3f) * weights[i];
+                b += (colors[i] & 0x1f) * weights[i];
+            }
+            if (total == BOX_WEIGHT)
+                return static_cast<uint16_t>(((r >> 16) << 11) | ((g >> 16) << 5) | (b >> 16));
+            return static_cast<uint16_t>(((r / total) << 11) | ((g / total) << 5) | (b / total));
+        }
+
+        template<Color::Representation R>
+        void renderTransformed(uint8_t const * pixels, Color::RGB565 const * palette, Coord w, Coord h, uint32_t transparentColor, Coord column, Coord startRow, Color::RGB565 * buffer, Coord numPixels, Transform const & inv, Filter filter) {
+            using Reader = PixelReader<R>;
+            // source coordinates of the destination pixel centers, in 64 bits as extreme downscaling overflows 16.16 fixed point
+            int64_t u = static_cast<int64_t>(inv.a()) * column + static_cast<int64_t>(inv.b()) * startRow + inv.tx() + (static_cast<int64_t>(inv.a()) + inv.b()) / 2;
+            int64_t v = static_cast<int64_t>(inv.c()) * column + static_cast<int64_t>(inv.d()) * startRow + inv.ty() + (static_cast<int64_t>(inv.c()) + inv.d()) / 2;
+            int64_t du = inv.b();
+            int64_t dv = inv.d();
+            uint16_t * dst = reinterpret_cast<uint16_t *>(buffer);
+            if (filter == Filter::Nearest) {
+                if (du == 0) {
+                    // the whole column maps to a single source column, so only the row changes
+                    int64_t sx = u >> Transform::FRACTION_BITS;
+                    if (sx < 0 || sx >= w)
+                        return;
+                    uint32_t colOffset = mapIndexColumnFirst(static_cast<Coord>(sx), 0, w, h);
+                    int64_t lastRow = -1;
+                    uint16_t lastRaw = 0;
+                    uint16_t lastColor = 0;
+                    for (Coord i = 0; i < numPixels; ++i, v += dv) {
+                        int64_t sy = v >> Transform::FRACTION_BITS;
+                        if (sy < 0 || sy >= h)
+                            continue;
+                        // when upscaling, the source pixel is converted only once for all rows it covers
+                        if (sy != lastRow) {
+                            lastRow = sy;
+                            lastRaw = Reader::raw(pixels, colOffset + static_cast<uint32_t>(sy));
+                            lastColor = Reader::color(lastRaw, palette);
+                        }
+                        if (lastRaw != transparentColor)
+                            dst[i] = lastColor;
+                    }
+                } else {
+                    for (Coord i = 0; i < numPixels; ++i, u += du, v += dv) {
+                        int64_t sx = u >> Transform::FRACTION_BITS;
+                        int64_t sy = v >> Transform::FRACTION_BITS;
+                        if (sx < 0 || sx >= w || sy < 0 || sy >= h)
+                            continue;
+                        uint16_t raw = Reader::raw(pixels, mapIndexColumnFirst(static_cast<Coord>(sx), static_cast<Coord>(sy), w, h));
+                        if (raw != transparentColor)
+                            dst[i] = Reader::color(raw, palette);
+                    }
+                }
+            } else {
+                // the 2x2 box is formed by the source pixels whose centers surround the mapped position, weighted by their distance from it, so that when the position is at a pixel center (e.g. identity), only that pixel is used
+                u -= Transform::ONE / 2;
+                v -= Transform::ONE / 2;
+                for (Coord i = 0; i < numPixels; ++i, u += du, v += dv) {
+                    int64_t ux = u >> Transform::FRACTION_BITS;
+                    int64_t vy = v >> Transform::FRACTION_BITS;
+                    if (ux < -1 || ux >= w || vy < -1 || vy >= h)
+                        continue;
+                    Coord sx = static_cast<Coord>(ux);
+                    Coord sy = static_cast<Coord>(vy);
+                    uint32_t fx = static_cast<uint32_t>(u >> (Transform::FRACTION_BITS - 8)) & 0xff;
+                    uint32_t fy = static_cast<uint32_t>(v >> (Transform::FRACTION_BITS - 8)) & 0xff;
+                    Coord x0 = std::max(sx, 0);
+                    Coord x1 = std::min(sx + 1, w - 1);
+                    Coord y0 = std::max(sy, 0);
+                    Coord y1 = std::min(sy + 1, h - 1);
+                    uint16_t raw[4] = {
+                        Reader::raw(pixels, mapIndexColumnFirst(x0, y0, w, h)),
+                        Reader::raw(pixels, mapIndexColumnFirst(x1, y0, w, h)),
+                        Reader::raw(pixels, mapIndexColumnFirst(x0, y1, w, h)),
+                        Reader::raw(pixels, mapIndexColumnFirst(x1, y1, w, h)),
+                    };
+                    uint32_t weights[4] = {
+                        (256 - fx) * (256 - fy),
+                        fx * (256 - fy),
+                        (256 - fx) * fy,
+                        fx * fy,
+                    };
+                    uint16_t colors[4];
+                    uint32_t mask = 0;
+                    uint32_t total = 0;
+                    for (uint32_t j = 0; j < 4; ++j) {
+                        if (raw[j] != transparentColor && weights[j] != 0) {
+                            colors[j] = Reader::color(raw[j], palette);
+                            mask |= 1 << j;
+                            total += weights[j];
+                        }
+                    }
+                    // only draw pixels that are at least half opaque
+                    if (total >= BOX_WEIGHT / 2)
+                        dst[i] = average(colors, weights, mask, total);
+                }
+            }
+        }
+    } // anonymous namespace
+
     Bitmap::Bitmap(ImageSource && src) {
         // if the source is empty, do nothing
         if (src.empty())
@@ -12,4 +153,33 @@ namespace rckid {
             *this = decoder->decode();
     }
 
-} // namespace rckid
\ No newline at end of file
+    void Bitmap::renderColumn(Coord column, Coord startRow, Color::RGB565 * buffer, Coord numPixels, Transform const & inverse, Filter filter) const {
+        if (numPixels <= 0)
+            return;
+        // 1:1 vertical mapping (translation and horizontal scaling) can use the regular column blitting on the source column
+        if (filter == Filter::Nearest && inverse.isAxisAligned() && inverse.d() == Transform::ONE) {
+            int64_t u = (static_cast<int64_t>(inverse.a()) * column + inverse.tx() + inverse.a() / 2) >> Transform::FRACTION_BITS;
+            if (u < 0 || u >= w_)
+                return;
+            Coord sx = static_cast<Coord>(u);
+            Coord sy = (startRow * Transform::ONE + inverse.ty() + Transform::ONE / 2) >> Transform::FRACTION_BITS;
+            Coord first = std::max(0, -sy);
+            Coord last = std::min(numPixels, h_ - sy);
+            if (first < last)
+                renderColumn(sx, sy + first, buffer + first, last - first);
+            return;
+        }
+        switch (colorRepresentation_) {
+            case Color::Representation::RGB565:
+                return renderTransformed<Color::Representation::RGB565>(pixels_.get(), palette(), w_, h_, transparentColor_, column, startRow, buffer, numPixels, inverse, filter);
+            case Color::Representation::RGB332:
+                return renderTransformed<Color::Representation::RGB332>(pixels_.get(), palette(), w_, h_, transparentColor_, column, startRow, buffer, numPixels, inverse, filter);
+            case Color::Representation::Index256:
+                return renderTransformed<Color::Representation::Index256>(pixels_.get(), palette(), w_, h_, transparentColor_, column, startRow, buffer, numPixels, inverse, filter);
+            case Color::Representation::Index16:
+                return renderTransformed<Color::Representation::Index16>(pixels_.get(), palette(), w_, h_, transparentColor_, column, startRow, buffer, numPixels, inverse, filter);
+        }
+        UNREACHABLE;
+    }
+
+} // namespace rckid
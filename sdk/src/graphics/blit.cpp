@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include <rckid/graphics/blit.h>
 
 namespace rckid {
@@ -6,10 +8,8 @@ namespace rckid {
 
     __attribute__((weak))
     void blit_rgb565(uint8_t const * src, Color::RGB565 * dst, uint32_t numPixels) {
-        uint16_t const * source = reinterpret_cast<uint16_t const *>(src);
-        uint16_t * destination = reinterpret_cast<uint16_t *>(dst);
-        for (uint32_t i = 0; i < numPixels; ++i)
-            destination[i] = source[i];
+        // source and destination have the same format, so this is a straight copy
+        memcpy(dst, src, numPixels * sizeof(Color::RGB565));
     }
 
     __attribute__((weak))
@@ -0,0 +1,412 @@
+#include <rckid/graphics/canvas.h>
+
+namespace rckid {
+
+    uint16_t Canvas::rawColor(Color color) const {
+        switch (colorRepresentation_) {
+            case Color::Representation::RGB565:
+                return color.toRGB565();
+            case Color::Representation::RGB332:
+                return static_cast<uint8_t>(color.toRGB332());
+            case Color::Representation::Index256:
+            case Color::Representation::Index16: {
+                if (palette_ == nullptr)
+                    return 0;
+                uint32_t numColors = colorRepresentation_ == Color::Representation::Index256 ? 256 : 16;
+                uint16_t result = 0;
+                uint32_t bestDistance = 0xffffffff;
+                for (uint32_t i = 0; i < numColors; ++i) {
+                    Color c{palette_.get()[i]};
+                    int32_t dr = c.r - color.r;
+                    int32_t dg = c.g - color.g;
+                    int32_t db = c.b - color.b;
+                    uint32_t d = static_cast<uint32_t>(dr * dr + dg * dg + db * db);
+                    if (d < bestDistance) {
+                        bestDistance = d;
+                        result = static_cast<uint16_t>(i);
+                    }
+                }
+                return result;
+            }
+        }
+        UNREACHABLE;
+    }
+
+    void Canvas::fillColumn(Coord x, Coord y, Coord numPixels, uint16_t color) {
+        if (numPixels <= 0)
+            return;
+        uint32_t offset = mapIndexColumnFirst(x, y, w_, h_);
+        switch (colorRepresentation_) {
+            case Color::Representation::RGB565:
+                memset16(reinterpret_cast<uint16_t *>(pixels_.get()) + offset, color, numPixels);
+                return;
+            case Color::Representation::RGB332:
+            case Color::Representation::Index256:
+                memset8(pixels_.get() + offset, static_cast<uint8_t>(color), numPixels);
+                return;
+            case Color::Representation::Index16: {
+                // even offsets are stored in the lower nibble, odd offsets in the upper nibble of each byte
+                uint8_t * p = pixels_.get() + offset / 2;
+                uint8_t c = color & 0x0f;
+                if (offset & 1) {
+                    *p = (*p & 0x0f) | static_cast<uint8_t>(c << 4);
+                    ++p;
+                    --numPixels;
+                }
+                memset8(p, static_cast<uint8_t>(c | (c << 4)), numPixels / 2);
+                if (numPixels & 1) {
+                    p += numPixels / 2;
+                    *p = (*p & 0xf0) | c;
+                }
+                return;
+            }
+        }
+        UNREACHABLE;
+    }
+
+    void Canvas::fill(Rect rect, uint16_t color) {
+        rect = rect.intersectWith(Rect::WH(w_, h_));
+        if (rect.empty())
+            return;
+        // full height rectangles are continuous in memory, starting with the rightmost column
+        if (rect.h == h_) {
+            fillColumn(rect.right() - 1, 0, rect.w * h_, color);
+            return;
+        }
+        for (Coord x = rect.left(), xe = rect.right(); x < xe; ++x)
+            fillColumn(x, rect.top(), rect.h, color);
+    }
+
+    void Canvas::hline(Coord x, Coord y, Coord length, uint16_t color) {
+        if (y < 0 || y >= h_)
+            return;
+        Coord xe = std::min(x + length, w_);
+        for (x = std::max(x, 0); x < xe; ++x)
+            putPixel(x, y, color);
+    }
+
+    void Canvas::vline(Coord x, Coord y, Coord length, uint16_t color) {
+        if (x < 0 || x >= w_)
+            return;
+        Coord ye = std::min(y + length, h_);
+        y = std::max(y, 0);
+        fillColumn(x, y, ye - y, color);
+    }
+
+    void Canvas::drawLine(Point from, Point to, uint16_t color) {
+        if (from.x == to.x) {
+            vline(from.x, std::min(from.y, to.y), std::abs(to.y - from.y) + 1, color);
+            return;
+        }
+        if (from.y == to.y) {
+            hline(std::min(from.x, to.x), from.y, std::abs(to.x - from.x) + 1, color);
+            return;
+        }
+        Coord dx = std::abs(to.x - from.x);
+        Coord dy = - std::abs(to.y - from.y);
+        Coord sx = from.x < to.x ? 1 : -1;
+        Coord sy = from.y < to.y ? 1 : -1;
+        Coord err = dx + dy;
+        Coord x = from.x;
+        Coord y = from.y;
+        // vertical run of pixels in the current column
+        Coord runX = x;
+        Coord runStart = y;
+        Coord runEnd = y;
+        while (x != to.x || y != to.y) {
+            Coord e2 = err * 2;
+            if (e2 >= dy) {
+                err += dy;
+                x += sx;
+            }
+            if (e2 <= dx) {
+                err += dx;
+                y += sy;
+            }
+            if (x == runX) {
+                runStart = std::min(runStart, y);
+                runEnd = std::max(runEnd, y);
+            } else {
+                vline(runX, runStart, runEnd - runStart + 1, color);
+                runX = x;
+                runStart = y;
+                runEnd = y;
+            }
+        }
+        vline(runX, runStart, runEnd - runStart + 1, color);
+    }
+
+    void Canvas::drawRect(Rect rect, uint16_t color) {
+        if (rect.empty())
+            return;
+        vline(rect.left(), rect.top(), rect.h, color);
+        if (rect.w > 1)
+            vline(rect.right() - 1, rect.top(), rect.h, color);
+        hline(rect.left() + 1, rect.top(), rect.w - 2, color);
+        if (rect.h > 1)
+            hline(rect.left() + 1, rect.bottom() - 1, rect.w - 2, color);
+    }
+
+    void Canvas::drawCircle(Point center, Coord radius, uint16_t color) {
+        Coord x = radius;
+        Coord y = 0;
+        Coord err = 1 - radius;
+        while (x >= y) {
+            setPixel(center.x + x, center.y + y, color);
+            setPixel(center.x + y, center.y + x, color);
+            setPixel(center.x - y, center.y + x, color);
+            setPixel(center.x - x, center.y + y, color);
+            setPixel(center.x - x, center.y - y, color);
+            setPixel(center.x - y, center.y - x, color);
+            setPixel(center.x + y, center.y - x, color);
+            setPixel(center.x + x, center.y - y, color);
+            ++y;
+            if (err < 0) {
+                err += 2 * y + 1;
+            } else {
+                --x;
+                err += 2 * (y - x) + 1;
+            }
+        }
+    }
+
+    void Canvas::fillCircle(Point center, Coord radius, uint16_t color) {
+        Coord x = radius;
+        Coord y = 0;
+        Coord err = 1 - radius;
+        while (x >= y) {
+            vline(center.x + x, center.y - y, 2 * y + 1, color);
+            vline(center.x - x, center.y - y, 2 * y + 1, color);
+            vline(center.x + y, center.y - x, 2 * x + 1, color);
+            vline(center.x - y, center.y - x, 2 * x + 1, color);
+            ++y;
+            if (err < 0) {
+                err += 2 * y + 1;
+            } else {
+                --x;
+                err += 2 * (y - x) + 1;
+            }
+        }
+    }
+
+    void Canvas::drawPolygon(Point const * points, uint32_t numPoints, uint16_t color) {
+        if (numPoints == 0)
+            return;
+        for (uint32_t i = 1; i < numPoints; ++i)
+            drawLine(points[i - 1], points[i], color);
+        drawLine(points[numPoints - 1], points[0], color);
+    }
+
+    void Canvas::fillPolygon(Point const * points, uint32_t numPoints, uint16_t color) {
+        // the crossings of a column are stored in a fixed array, so larger polygons are not drawn at all
+        if (numPoints < 3 || numPoints > MAX_POLYGON_POINTS)
+            return;
+        Coord minX = points[0].x;
+        Coord maxX = points[0].x;
+        for (uint32_t i = 1; i < numPoints; ++i) {
+            minX = std::min(minX, points[i].x);
+            maxX = std::max(maxX, points[i].x);
+        }
+        minX = std::max(minX, 0);
+        maxX = std::min(maxX, w_ - 1);
+        Coord crossings[MAX_POLYGON_POINTS];
+        for (Coord x = minX; x <= maxX; ++x) {
+            uint32_t n = 0;
+            for (uint32_t i = 0, j = numPoints - 1; i < numPoints; j = i++) {
+                Point a = points[i];
+                Point b = points[j];
+                // half open interval so that vertices shared by two edges are only counted once
+                if ((a.x <= x && x < b.x) || (b.x <= x && x < a.x)) {
+                    Coord y = a.y + (x - a.x) * (b.y - a.y) / (b.x - a.x);
+                    // insertion sort as we go
+                    uint32_t k = n++;
+                    while (k > 0 && crossings[k - 1] > y) {
+                        crossings[k] = crossings[k - 1];
+                        --k;
+                    }
+                    crossings[k] = y;
+                }
+            }
+            for (uint32_t i = 0; i + 1 < n; i += 2)
+                vline(x, crossings[i], crossings[i + 1] - crossings[i] + 1, color);
+        }
+    }
+
+    void Canvas::blit(Point where, Bitmap const & src, Rect srcRect, std::optional<uint32_t> transparentColor) {
+        blitFrom(where, src, src.pixelArray(), srcRect, transparentColor);
+    }
+
+    void Canvas::blit(Point where, Canvas const & src, Rect srcRect, std::optional<uint32_t> transparentColor) {
+        blitFrom(where, src, src.pixels_.get(), srcRect, transparentColor);
+    }
+
+    template<typename T>
+    void Canvas::blitFrom(Point where, T const & src, uint8_t const * srcPixels, Rect srcRect, std::optional<uint32_t> transparentColor) {
+        // clip the source rectangle to the source image first and then to the canvas
+        Rect clipped = srcRect.intersectWith(Rect::WH(src.width(), src.height()));
+        where = where + (clipped.topLeft() - srcRect.topLeft());
+        Rect dst = Rect::XYWH(where, clipped.w, clipped.h).intersectWith(Rect::WH(w_, h_));
+        if (dst.empty())
+            return;
+        clipped = Rect::XYWH(clipped.topLeft() + (dst.topLeft() - where), dst.w, dst.h);
+        Color::Representation srcRep = src.colorRepresentation();
+        Coord srcW = src.width();
+        Coord srcH = src.height();
+        for (Coord x = 0; x < dst.w; ++x) {
+            uint32_t srcOffset = mapIndexColumnFirst(clipped.x + x, clipped.y, srcW, srcH);
+            uint32_t dstOffset = mapIndexColumnFirst(dst.x + x, dst.y, w_, h_);
+            // same representation and no transparency is a simple memcpy (if the nibbles are aligned for Index16)
+            if (srcRep == colorRepresentation_ && ! transparentColor.has_value()) {
+                switch (colorRepresentation_) {
+                    case Color::Representation::RGB565:
+                        memcpy(pixels_.get() + dstOffset * 2, srcPixels + srcOffset * 2, dst.h * 2);
+                        continue;
+                    case Color::Representation::RGB332:
+                    case Color::Representation::Index256:
+                        memcpy(pixels_.get() + dstOffset, srcPixels + srcOffset, dst.h);
+                        continue;
+                    case Color::Representation::Index16:
+                        if ((srcOffset & 1) == (dstOffset & 1) && dst.h > 2) {
+                            uint8_t const * s = srcPixels + srcOffset / 2;
+                            uint8_t * d = pixels_.get() + dstOffset / 2;
+                            Coord n = dst.h;
+                            if (dstOffset & 1) {
+                                *d = (*d & 0x0f) | (*s & 0xf0);
+                                ++d;
+                                ++s;
+                                --n;
+                            }
+                            memcpy(d, s, n / 2);
+                            if (n & 1)
+                                d[n / 2] = (d[n / 2] & 0xf0) | (s[n / 2] & 0x0f);
+                            continue;
+                        }
+                        break;
+                }
+            }
+            // RGB565 canvas can use the blitting functions for any source
+            if (colorRepresentation_ == Color::Representation::RGB565) {
+                Color::RGB565 * d = reinterpret_cast<Color::RGB565 *>(pixels_.get()) + dstOffset;
+                if (transparentColor.has_value()) {
+                    uint32_t t = transparentColor.value();
+                    switch (srcRep) {
+                        case Color::Representation::RGB565:
+                            blit_rgb565(srcPixels + srcOffset * 2, d, dst.h, t);
+                            continue;
+                        case Color::Representation::RGB332:
+                            blit_rgb332(srcPixels + srcOffset, d, dst.h, t);
+                            continue;
+                        case Color::Representation::Index256:
+                            blit_index256(srcPixels + srcOffset, d, dst.h, src.palette(), t);
+                            continue;
+                        case Color::Representation::Index16:
+                            blit_index16(srcPixels + srcOffset / 2, d, dst.h, src.palette(), t, srcOffset & 1);
+                            continue;
+                    }
+                } else {
+                    switch (srcRep) {
+                        case Color::Representation::RGB565:
+                            UNREACHABLE; // handled by memcpy above
+                        case Color::Representation::RGB332:
+                            blit_rgb332(srcPixels + srcOffset, d, dst.h);
+                            continue;
+                        case Color::Representation::Index256:
+                            blit_index256(srcPixels + srcOffset, d, dst.h, src.palette());
+                            continue;
+                        case Color::Representation::Index16:
+                            blit_index16(srcPixels + srcOffset / 2, d, dst.h, src.palette(), srcOffset & 1);
+                            continue;
+                    }
+                }
+            }
+            // everything else is converted pixel by pixel
+            std::optional<uint16_t> lastRaw;
+            uint16_t lastIndex = 0;
+            for (Coord y = 0; y < dst.h; ++y) {
+                uint16_t raw = src.getPixel(clipped.x + x, clipped.y + y);
+                if (transparentColor.has_value() && raw == transparentColor.value())
+                    continue;
+                if (srcRep != colorRepresentation_) {
+                    switch (colorRepresentation_) {
+                        case Color::Representation::RGB332: {
+                            Color c = (srcRep == Color::Representation::RGB565) ? Color{Color::RGB565{raw}} : Color{src.palette()[raw]};
+                            raw = static_cast<uint8_t>(c.toRGB332());
+                            break;
+                        }
+                        case Color::Representation::Index256:
+                        case Color::Representation::Index16:
+                            // indices are copied verbatim between indexed formats, the palettes are assumed to be compatible, RGB colors are mapped to the closest palette entry (remembering the last one as images tend to have runs of the same color)
+                            if (! Color::requiresPalette(srcRep)) {
+                                if (! lastRaw.has_value() || lastRaw.value() != raw) {
+                                    lastRaw = raw;
+                                    Color c = (srcRep == Color::Representation::RGB565) ? Color{Color::RGB565{raw}} : Color{Color::RGB332{raw}};
+                                    lastIndex = rawColor(c);
+                                }
+                                raw = lastIndex;
+                            }
+                            break;
+                        default:
+                            UNREACHABLE;
+                    }
+                }
+                putPixel(dst.x + x, dst.y + y, raw);
+            }
+        }
+    }
+
+    void Canvas::createFontPalette(uint32_t * palette, uint16_t color) const {
+        palette[0] = NO_PIXEL;
+        switch (colorRepresentation_) {
+            case Color::Representation::RGB565: {
+                Color fg{Color::RGB565{color}};
+                palette[1] = fg.withBrightness(85).toRGB565();
+                palette[2] = fg.withBrightness(170).toRGB565();
+                palette[3] = color;
+                return;
+            }
+            case Color::Representation::RGB332: {
+                Color fg{Color::RGB332{color}};
+                palette[1] = static_cast<uint8_t>(fg.withBrightness(85).toRGB332());
+                palette[2] = static_cast<uint8_t>(fg.withBrightness(170).toRGB332());
+                palette[3] = color;
+                return;
+            }
+            case Color::Representation::Index256:
+            case Color::Representation::Index16:
+                palette[1] = NO_PIXEL;
+                palette[2] = color;
+                palette[3] = color;
+                return;
+        }
+        UNREACHABLE;
+    }
+
+    void Canvas::putChar(Coord x, Coord y, GlyphInfo const * gi, Font font, uint32_t const * palette) {
+        // glyph pixels are relative to the top left corner of the character cell
+        x += gi->x;
+        y += gi->y;
+        // each glyph column is padded to whole bytes (4 pixels)
+        Coord colBytes = (gi->height + 3) / 4;
+        uint8_t const * glyphPixels = font->pixels + gi->index;
+        Coord ys = std::max(0, -y);
+        Coord ye = std::min(static_cast<Coord>(gi->height), h_ - y);
+        for (Coord gx = 0; gx < gi->width; ++gx, glyphPixels += colBytes) {
+            Coord cx = x + gx;
+            if (cx < 0)
+                continue;
+            if (cx >= w_)
+                break;
+            uint8_t const * src = glyphPixels + ys / 4;
+            uint32_t val = *src++ << (2 * (ys % 4));
+            for (Coord gy = ys; gy < ye; ++gy) {
+                if (gy != ys && (gy % 4) == 0)
+                    val = *src++;
+                uint32_t raw = palette[(val >> 6) & 3];
+                val <<= 2;
+                if (raw != NO_PIXEL)
+                    putPixel(cx, y + gy, static_cast<uint16_t>(raw));
+            }
+        }
+    }
+
+} // namespace rckid
@@ -1,6 +1,7 @@
 #include <rckid/graphics/image_source.h>
 #include <rckid/graphics/image_decoder.h>
 #include <rckid/graphics/png.h>
+#include <rckid/graphics/qoi.h>
 
 namespace rckid {
 
@@ -32,8 +33,9 @@ namespace rckid {
             case ImageType::PNG:
                 return std::make_unique<PNGImageDecoder>(std::move(*this));
                 break;
-            case ImageType::JPG:
             case ImageType::QOI:
+                return std::make_unique<QOIImageDecoder>(std::move(*this));
+            case ImageType::JPG:
                 UNIMPLEMENTED;
                 break;
             case ImageType::RawMemory:
@@ -66,7 +68,7 @@ namespace rckid {
                 return ImageType::PNG;
             if (ext == "jpg" || ext == "jpeg")
                 return ImageType::JPG;
-            if (ext == "qoi")
+            if (ext == "qoi" || ext == "QOI")
                 return ImageType::QOI;
             if (ext == "raw")
                 return ImageType::RawMemory;
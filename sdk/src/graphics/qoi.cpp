@@ -0,0 +1,235 @@
+#include <algorithm>
+
+#include <rckid/graphics/qoi.h>
+
+namespace rckid {
+
+    void QOIEncoder::encode(Bitmap const & bmp, WriteStream & s) {
+        std::optional<uint32_t> transparent = bmp.transparentColor();
+        uint8_t channels = transparent.has_value() ? 4 : 3;
+        QOIEncoder enc{bmp.width(), bmp.height(), [&s](uint8_t const * data, uint32_t size) { s.write(data, size); }, channels};
+        Color::RGB565 const * palette = bmp.palette();
+        for (Coord y = 0; y < bmp.height(); ++y) {
+            for (Coord x = 0; x < bmp.width(); ++x) {
+                uint16_t raw = bmp.getPixel(x, y);
+                if (transparent.has_value() && raw == transparent.value()) {
+                    enc.push(0, 0, 0, 0);
+                    continue;
+                }
+                switch (bmp.colorRepresentation()) {
+                    case Color::Representation::RGB565:
+                        enc.push(Color{Color::RGB565{raw}});
+                        break;
+                    case Color::Representation::RGB332:
+                        enc.push(Color{Color::RGB332{raw}});
+                        break;
+                    case Color::Representation::Index256:
+                    case Color::Representation::Index16:
+                        ASSERT(palette != nullptr);
+                        enc.push(Color{palette[raw]});
+                        break;
+                }
+            }
+        }
+        enc.finish();
+    }
+
+    QOIImageDecoder::QOIImageDecoder(unique_ptr<RandomReadStream> && stream, Color::Representation colorRep):
+        stream_{std::move(stream)},
+        colorRep_{colorRep} {
+        uint8_t header[14];
+        if (stream_->read(header, sizeof(header)) != sizeof(header))
+            return;
+        if (header[0] != 'q' || header[1] != 'o' || header[2] != 'i' || header[3] != 'f') {
+            LOG(LL_ERROR, "Invalid QOI header");
+            return;
+        }
+        uint32_t w = (static_cast<uint32_t>(header[4]) << 24) | (header[5] << 16) | (header[6] << 8) | header[7];
+        uint32_t h = (static_cast<uint32_t>(header[8]) << 24) | (header[9] << 16) | (header[10] << 8) | header[11];
+        if (w == 0 || h == 0 || w > MAX_SIZE || h > MAX_SIZE) {
+            LOG(LL_ERROR, "Invalid QOI image size " << w << "x" << h);
+            return;
+        }
+        w_ = static_cast<Coord>(w);
+        h_ = static_cast<Coord>(h);
+    }
+
+    Bitmap QOIImageDecoder::decode() {
+        Bitmap result;
+        decodeRows(result, h_);
+        return result;
+    }
+
+    bool QOIImageDecoder::decodeRows(Bitmap & into, Coord maxRows) {
+        // nothing to decode, the bitmap stays empty
+        if (! good())
+            return true;
+        if (! into.empty() && (into.width() != w_ || into.height() != h_ || into.colorRepresentation() != colorRep_)) {
+            LOG(LL_ERROR, "QOI image " << w_ << "x" << h_ << " does not match the bitmap " << into.width() << "x" << into.height());
+            return true;
+        }
+        if (into.empty()) {
+            into = Bitmap{w_, h_, colorRep_};
+            row_ = 0;
+            run_ = 0;
+            r_ = 0;
+            g_ = 0;
+            b_ = 0;
+            a_ = 255;
+            memset(index_, 0, sizeof(index_));
+            memset(indexRaw_, 0, sizeof(indexRaw_));
+            numColors_ = 0;
+            palette_ = nullptr;
+            if (colorRep_ == Color::Representation::Index256 || colorRep_ == Color::Representation::Index16) {
+                uint32_t maxColors = maxPaletteColors();
+                palette_ = new Color::RGB565[maxColors];
+                std::fill_n(palette_, maxColors, Color::RGB565{});
+                into.setPalette(immutable_ptr<Color::RGB565>{palette_, maxColors});
+            }
+            raw_ = toRaw(0, 0, 0);
+        }
+        Coord end = (maxRows >= h_ - row_) ? h_ : row_ + maxRows;
+        // the bitmap is still owned solely by us so we can write to its pixels directly
+        uint8_t * pixels = const_cast<uint8_t *>(into.pixelArray());
+        switch (colorRep_) {
+            case Color::Representation::RGB565:
+                decodePixels<Color::Representation::RGB565>(pixels, end, toRGB565);
+                break;
+            case Color::Representation::RGB332:
+                decodePixels<Color::Representation::RGB332>(pixels, end, toRGB332);
+                break;
+            case Color::Representation::Index256:
+                decodePixels<Color::Representation::Index256>(pixels, end, [this](uint8_t r, uint8_t g, uint8_t b) { return toIndex(r, g, b); });
+                break;
+            case Color::Representation::Index16:
+                decodePixels<Color::Representation::Index16>(pixels, end, [this](uint8_t r, uint8_t g, uint8_t b) { return toIndex(r, g, b); });
+                break;
+        }
+        return row_ == h_;
+    }
+
+    uint16_t QOIImageDecoder::toRaw(uint8_t r, uint8_t g, uint8_t b) {
+        switch (colorRep_) {
+            case Color::Representation::RGB565:
+                return toRGB565(r, g, b);
+            case Color::Representation::RGB332:
+                return toRGB332(r, g, b);
+            default:
+                return toIndex(r, g, b);
+        }
+    }
+
+    uint16_t QOIImageDecoder::toIndex(uint8_t r, uint8_t g, uint8_t b) {
+        ASSERT(palette_ != nullptr);
+        Color::RGB565 c = Color::RGB(r, g, b).toRGB565();
+        for (uint32_t i = 0; i < numColors_; ++i)
+            if (palette_[i] == c)
+                return static_cast<uint16_t>(i);
+        if (numColors_ < maxPaletteColors()) {
+            palette_[numColors_] = c;
+            return static_cast<uint16_t>(numColors_++);
+        }
+        // out of palette entries, find the closest color instead
+        uint16_t best = 0;
+        uint32_t bestDistance = 0xffffffff;
+        for (uint32_t i = 0; i < numColors_; ++i) {
+            int32_t dr = palette_[i].r() - r;
+            int32_t dg = palette_[i].g() - g;
+            int32_t db = palette_[i].b() - b;
+            uint32_t d = static_cast<uint32_t>(dr * dr + dg * dg + db * db);
+            if (d < bestDistance) {
+                bestDistance = d;
+                best = static_cast<uint16_t>(i);
+            }
+        }
+        return best;
+    }
+
+    template<Color::Representation R, typename T>
+    void QOIImageDecoder::decodePixels(uint8_t * pixels, Coord endRow, T toRaw) {
+        // work on local copies of the decoder state and store them back when done
+        uint8_t r = r_, g = g_, b = b_, a = a_;
+        uint16_t raw = raw_;
+        uint32_t run = run_;
+        uint32_t * index = index_;
+        uint16_t * indexRaw = indexRaw_;
+        for (Coord y = row_; y < endRow; ++y) {
+            // image is row major, so the consecutive pixels in the same row are one column (h_ pixels) apart, starting from the last column
+            uint32_t offset = mapIndexColumnFirst(0, y, w_, h_);
+            for (Coord x = 0; x < w_; ++x, offset -= h_) {
+                if (run > 0) {
+                    --run;
+                } else {
+                    uint8_t op = nextByte();
+                    bool changed = true;
+                    if (op == QOIEncoder::OP_RGB) {
+                        r = nextByte();
+                        g = nextByte();
+                        b = nextByte();
+                    } else if (op == QOIEncoder::OP_RGBA) {
+                        r = nextByte();
+                        g = nextByte();
+                        b = nextByte();
+                        a = nextByte();
+                    } else {
+                        switch (op & QOIEncoder::OP_MASK) {
+                            case QOIEncoder::OP_INDEX: {
+                                uint32_t px = index[op];
+                                r = static_cast<uint8_t>(px >> 24);
+                                g = static_cast<uint8_t>(px >> 16);
+                                b = static_cast<uint8_t>(px >> 8);
+                                a = static_cast<uint8_t>(px);
+                                // index entries that were never set are transparent black
+                                raw = px == 0 ? toRaw(0, 0, 0) : indexRaw[op];
+                                changed = false;
+                                break;
+                            }
+                            case QOIEncoder::OP_DIFF:
+                                r += ((op >> 4) & 0x03) - 2;
+                                g += ((op >> 2) & 0x03) - 2;
+                                b += (op & 0x03) - 2;
+                                break;
+                            case QOIEncoder::OP_LUMA: {
+                                uint8_t next = nextByte();
+                                int32_t dg = (op & 0x3f) - 32;
+                                r += dg - 8 + ((next >> 4) & 0x0f);
+                                g += dg;
+                                b += dg - 8 + (next & 0x0f);
+                                break;
+                            }
+                            case QOIEncoder::OP_RUN:
+                                run = op & 0x3f;
+                                changed = false;
+                                break;
+                        }
+                    }
+                    if (changed) {
+                        raw = a < 128 ? toRaw(0, 0, 0) : toRaw(r, g, b);
+                        uint8_t h = QOIEncoder::hash(r, g, b, a);
+                        index[h] = (static_cast<uint32_t>(r) << 24) | (static_cast<uint32_t>(g) << 16) | (static_cast<uint32_t>(b) << 8) | a;
+                        indexRaw[h] = raw;
+                    }
+                }
+                if constexpr (R == Color::Representation::RGB565) {
+                    reinterpret_cast<uint16_t *>(pixels)[offset] = raw;
+                } else if constexpr (R == Color::Representation::Index16) {
+                    uint8_t & byte = pixels[offset / 2];
+                    if (offset & 1)
+                        byte = static_cast<uint8_t>((byte & 0x0f) | (raw << 4));
+                    else
+                        byte = static_cast<uint8_t>((byte & 0xf0) | raw);
+                } else {
+                    pixels[offset] = static_cast<uint8_t>(raw);
+                }
+            }
+        }
+        row_ = endRow;
+        r_ = r;
+        g_ = g;
+        b_ = b;
+        a_ = a;
+        raw_ = raw;
+        run_ = run;
+    }
+
+} // namespace rckid
@@ -0,0 +1,120 @@
+#include <rckid/graphics/screen_capture.h>
+
+namespace rckid {
+
+    bool ScreenCapture::start(unique_ptr<WriteStream> stream, DoneCallback onDone) {
+        if (active_ != nullptr || stream == nullptr)
+            return false;
+        Rect rect = display::rect();
+        LOG(LL_INFO, "Screen capture started: " << rect.width() << "x" << rect.height());
+        active_ = new ScreenCapture{std::move(stream), std::move(onDone), rect, display::refreshDirection()};
+        return true;
+    }
+
+    ScreenCapture::ScreenCapture(unique_ptr<WriteStream> stream, DoneCallback onDone, Rect rect, display::RefreshDirection direction):
+        stream_{std::move(stream)},
+        onDone_{std::move(onDone)},
+        rect_{rect},
+        direction_{direction},
+        encoder_{rect.width(), rect.height(), [this](uint8_t const * data, uint32_t size) { stream_->write(data, size); }},
+        strip_{new Color::RGB565[rect.width() * STRIP_ROWS]},
+        stripRows_{std::min(STRIP_ROWS, rect.height())} {
+    }
+
+    ScreenCapture::~ScreenCapture() {
+        // make sure the display update that might be capturing the pixels is done before the strip is deleted
+        if (state_ == State::Capturing)
+            display::waitUpdateDone();
+        delete [] strip_;
+        if (active_ == this)
+            active_ = nullptr;
+    }
+
+    bool ScreenCapture::beginFrame(Rect rect, display::RefreshDirection direction) {
+        if (state_ != State::Waiting)
+            return false;
+        // frames rendered to other display area would not fit together with the strips captured so far, skip them and wait for the original area to come back
+        if (rect != rect_ || direction != direction_) {
+            if (++skippedFrames_ > MAX_SKIPPED_FRAMES)
+                state_ = State::Failed;
+            return false;
+        }
+        skippedFrames_ = 0;
+        x_ = (direction_ == display::RefreshDirection::ColumnFirst) ? rect_.width() - 1 : 0;
+        y_ = 0;
+        remaining_ = rect_.width() * rect_.height();
+        state_ = State::Capturing;
+        return true;
+    }
+
+    void ScreenCapture::capture(Color::RGB565 const * pixels, uint32_t numPixels) {
+        if (state_ != State::Capturing)
+            return;
+        numPixels = std::min(numPixels, remaining_);
+        remaining_ -= numPixels;
+        Coord w = rect_.width();
+        Coord h = rect_.height();
+        Coord stripEnd = stripStart_ + stripRows_;
+        if (direction_ == display::RefreshDirection::ColumnFirst) {
+            // columns go from right to left, each from top to bottom
+            while (numPixels > 0) {
+                Coord run = std::min(static_cast<Coord>(numPixels), h - y_);
+                Coord from = std::max(y_, stripStart_);
+                Coord to = std::min(y_ + run, stripEnd);
+                for (Coord y = from; y < to; ++y)
+                    strip_[(y - stripStart_) * w + x_] = pixels[y - y_];
+                pixels += run;
+                numPixels -= run;
+                y_ += run;
+                if (y_ == h) {
+                    y_ = 0;
+                    --x_;
+                }
+            }
+        } else {
+            // rows go from top to bottom, each from left to right
+            while (numPixels > 0) {
+                Coord run = std::min(static_cast<Coord>(numPixels), w - x_);
+                if (y_ >= stripStart_ && y_ < stripEnd)
+                    memcpy(strip_ + (y_ - stripStart_) * w + x_, pixels, run * sizeof(Color::RGB565));
+                pixels += run;
+                numPixels -= run;
+                x_ += run;
+                if (x_ == w) {
+                    x_ = 0;
+                    ++y_;
+                }
+            }
+        }
+        if (remaining_ == 0)
+            state_ = State::Captured;
+    }
+
+    void ScreenCapture::onTick() {
+        if (state_ == State::Failed) {
+            LOG(LL_ERROR, "Screen capture failed, display area changed");
+            return finish(false);
+        }
+        if (state_ != State::Captured)
+            return;
+        Coord w = rect_.width();
+        Color::RGB565 const * px = strip_;
+        for (Coord i = 0, e = w * stripRows_; i < e; ++i)
+            encoder_.push(Color{*px++});
+        stripStart_ += stripRows_;
+        if (stripStart_ >= rect_.height()) {
+            encoder_.finish();
+            LOG(LL_INFO, "Screen capture done");
+            return finish(true);
+        }
+        stripRows_ = std::min(STRIP_ROWS, rect_.height() - stripStart_);
+        state_ = State::Waiting;
+    }
+
+    void ScreenCapture::finish(bool success) {
+        if (onDone_)
+            onDone_(success);
+        delete this;
+    }
+
+} // namespace rckid
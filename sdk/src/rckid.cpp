@@ -6,6 +6,7 @@
 #include <rckid/audio/decoder_stream.h>
 #include <rckid/apps/dialogs/info_dialog.h>
 #include <rckid/graphics/tile_grid.h>
+#include <rckid/graphics/screen_capture.h>
 
 namespace rckid {
 
@@ -348,6 +349,21 @@ namespace rckid {
             refreshDirection_ = direction;
         }
 
+        Rect rect() { return rect_; }
+
+        RefreshDirection refreshDirection() { return refreshDirection_; }
+
+        void update(Callback callback) {
+            ScreenCapture * capture = ScreenCapture::active();
+            if (capture == nullptr || ! capture->beginFrame(rect_, refreshDirection_))
+                return hal::display::update(std::move(callback));
+            hal::display::update([callback = std::move(callback), capture](Color::RGB565 * & buffer, uint32_t & bufferSize) {
+                callback(buffer, bufferSize);
+                if (buffer != nullptr)
+                    capture->capture(buffer, bufferSize);
+            });
+        }
+
         uint8_t brightness() { return settings.display.brightness; }
 
         void setBrightness(uint8_t value) {
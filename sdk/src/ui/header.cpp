@@ -15,6 +15,8 @@ namespace rckid::ui {
         if (instance_ == nullptr)
             return;
 
+        // only the tiles that really change are damaged and redrawn in the cache
+        rckid::TileGrid const & grid = instance_->contents_;
         TinyDateTime now = time::now();
         bool update = false;
 
@@ -78,8 +80,11 @@ namespace rckid::ui {
         });
 
         // clear the remaining header with spaces
-        for (Coord i = 0; i < x; ++i)
-            instance_->contents_.at(i, 0).setAltTileset(false) = ' ';
+        for (Coord i = 0; i < x; ++i) {
+            rckid::TileGrid::TileInfo t = grid.at(i, 0);
+            t.setAltTileset(false) = ' ';
+            instance_->contents_.set(i, 0, t);
+        }
 
         uint32_t budget = pim::remainingBudget();
         if (budget != 0 && budget < 600) {
@@ -101,4 +106,12 @@ namespace rckid::ui {
             instance_->show();
     }
 
+    void Header::applyStyle(Style const & style) {
+        TileGrid::applyStyle(style);
+        memcpy(palette_, style.colors().header, sizeof(palette_));
+        contents_.setPalette(palette_);
+        updateTransparentKey();
+        invalidateCache();
+    }
+
 } // namespace rckid::ui
\ No newline at end of file
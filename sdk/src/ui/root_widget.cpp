@@ -1,4 +1,6 @@
 
+#include <rckid/filesystem.h>
+#include <rckid/graphics/screen_capture.h>
 #include <rckid/ui/animation.h>
 #include <rckid/ui/style.h>
 #include <rckid/ui/root_widget.h>
@@ -15,17 +17,153 @@ namespace rckid::ui {
             setBackgroundImage(Style::defaultStyle());
     }
 
+    namespace {
+
+        constexpr char const * BACKGROUND_CACHE_PREFIX = "background-";
+
+        /** FNV-1a hash, used to identify the cached background images.
+         */
+        uint32_t fnv1a(uint8_t const * data, uint32_t size, uint32_t hash = 2166136261u) {
+            for (uint32_t i = 0; i < size; ++i) {
+                hash ^= data[i];
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+
+        String backgroundCachePath(ImageSource const & src) {
+            uint32_t hash;
+            if (src.type() == ImageSource::Type::Memory) {
+                hash = fnv1a(src.data(), src.size());
+            } else {
+                // the file is hashed whole, so that an image replaced by another one of the same name and size is not taken from the cache. Reading the file is only a fraction of the decoding
+                fs::Drive drive = (src.type() == ImageSource::Type::SD) ? fs::Drive::SD : fs::Drive::Cartridge;
+                hash = fnv1a(reinterpret_cast<uint8_t const *>(src.path()), static_cast<uint32_t>(strlen(src.path())));
+                if (auto f = fs::readFile(src.path(), drive); f != nullptr) {
+                    uint8_t buffer[512];
+                    while (uint32_t n = f->read(buffer, sizeof(buffer)))
+                        hash = fnv1a(buffer, n, hash);
+                }
+                hash ^= static_cast<uint32_t>(drive);
+            }
+            return fs::join(RootWidget::BACKGROUND_CACHE_FOLDER, STR(BACKGROUND_CACHE_PREFIX << hex(hash, false) << ".bin"));
+        }
+
+        /** Header of the cached background image, followed by the palette (for indexed images) and the pixel array, both exactly as they are stored in memory.
+         */
+        struct BackgroundCacheHeader {
+            static constexpr uint32_t MAGIC = 0x31474272; // rBG1
+
+            uint32_t magic = MAGIC;
+            uint16_t width;
+            uint16_t height;
+            Color::Representation colorRep;
+            uint8_t padding[3] = {0, 0, 0};
+
+            uint32_t paletteSize() const {
+                switch (colorRep) {
+                    case Color::Representation::Index256:
+                        return 256;
+                    case Color::Representation::Index16:
+                        return 16;
+                    default:
+                        return 0;
+                }
+            }
+
+            uint32_t pixelArraySize() const { return Color::getPixelArraySize(colorRep, width, height); }
+        }; 
+
+        Bitmap readCachedBackground(RandomReadStream & f) {
+            BackgroundCacheHeader h;
+            if (f.read(reinterpret_cast<uint8_t *>(& h), sizeof(h)) != sizeof(h) || h.magic != BackgroundCacheHeader::MAGIC)
+                return Bitmap{};
+            uint32_t paletteSize = h.paletteSize();
+            uint32_t pixelsSize = h.pixelArraySize();
+            if (f.size() != sizeof(h) + paletteSize * sizeof(Color::RGB565) + pixelsSize)
+                return Bitmap{};
+            immutable_ptr<Color::RGB565> palette;
+            if (paletteSize > 0) {
+                Color::RGB565 * p = new Color::RGB565[paletteSize];
+                f.read(reinterpret_cast<uint8_t *>(p), paletteSize * sizeof(Color::RGB565));
+                palette = immutable_ptr<Color::RGB565>{p, paletteSize};
+            }
+            uint8_t * pixels = new uint8_t[pixelsSize];
+            f.read(pixels, pixelsSize);
+            return Bitmap{h.width, h.height, h.colorRep, immutable_ptr<uint8_t>{pixels, pixelsSize}, std::move(palette)};
+        }
+
+        /** Stores the bitmap in the cache, removing any previously cached backgrounds.
+         */
+        void cacheBackground(Bitmap const & bmp, String const & path) {
+            BackgroundCacheHeader h;
+            h.width = static_cast<uint16_t>(bmp.width());
+            h.height = static_cast<uint16_t>(bmp.height());
+            h.colorRep = bmp.colorRepresentation();
+            if (h.paletteSize() > 0 && bmp.palette() == nullptr)
+                return;
+            if (fs::isFolder(RootWidget::BACKGROUND_CACHE_FOLDER)) {
+                std::vector<String> old;
+                fs::readFolder(RootWidget::BACKGROUND_CACHE_FOLDER, [&](fs::FolderEntry const & entry) {
+                    if (! entry.isFolder && entry.name.startsWith(BACKGROUND_CACHE_PREFIX))
+                        old.push_back(fs::join(RootWidget::BACKGROUND_CACHE_FOLDER, entry.name));
+                });
+                for (auto & p : old)
+                    fs::eraseFile(p);
+            } else {
+                fs::createFolders(RootWidget::BACKGROUND_CACHE_FOLDER);
+            }
+            auto f = fs::writeFile(path);
+            if (f == nullptr) {
+                LOG(LL_ERROR, "Unable to cache background image to " << path);
+                return;
+            }
+            f->write(reinterpret_cast<uint8_t const *>(& h), sizeof(h));
+            if (h.paletteSize() > 0)
+                f->write(reinterpret_cast<uint8_t const *>(bmp.palette()), h.paletteSize() * sizeof(Color::RGB565));
+            f->write(bmp.pixelArray(), h.pixelArraySize());
+        }
+    }
+
+    Bitmap RootWidget::loadBackgroundImage(ImageSource const & src) {
+        ImageSource::ImageType type = src.getImageType();
+        if (type == ImageSource::ImageType::RawMemory || type == ImageSource::ImageType::Unknown || ! fs::isMounted())
+            return Bitmap{ImageSource{src}};
+        String path = backgroundCachePath(src);
+        if (auto f = fs::readFile(path); f != nullptr) {
+            Bitmap result = readCachedBackground(*f);
+            if (! result.empty())
+                return result;
+            LOG(LL_ERROR, "Invalid cached background image " << path);
+        }
+        Bitmap result{ImageSource{src}};
+        if (! result.empty())
+            cacheBackground(result, path);
+        return result;
+    }
+
     void RootWidget::render() {
         if (! visible())
             return;
-        // update all animations & render essentials
-        Widget::renderEssentials();
-        // tell the widgets that we are about to render
-        onRender();
+        // re-apply the default style if it has changed since the last frame
+        Style const & style = Style::defaultStyle();
+        if (styleVersion_ != style.version()) {
+            styleVersion_ = style.version();
+            applyStyleRecursive(style);
+            Header::instance()->applyStyle(style);
+            if (useBackgroundImage_)
+                setBackgroundImage(style);
+        }
+        // update all animations & render essentials, unless the frame is being captured and must stay the same
+        if (! ScreenCapture::holdsFrame()) {
+            Widget::renderEssentials();
+            // tell the widgets that we are about to render
+            onRender();
+        }
         // wait for next frame to keep steady FPS
         display::waitVSync();        
         // start rendering from rightmost column
-        hal::display::update([this, renderCol = width() - 1](Color::RGB565 * & buffer, uint32_t & bufferSize) mutable {
+        display::update([this, renderCol = width() - 1](Color::RGB565 * & buffer, uint32_t & bufferSize) mutable {
             ASSERT(renderCol >= 0);
             if (buffer == nullptr) {
                 buffer = renderBuffer_.front().data();
@@ -25,8 +25,20 @@ namespace rckid::ui {
         }
     }
 
+    bool Style::loadTheme(String const & path) {
+        auto f = fs::readFile(path);
+        if (f == nullptr)
+            return false;
+        ini::Reader reader{*f};
+        defaultStyle().load(reader);
+        return true;
+    }
+
     void Style::load(ini::Reader & reader) {
-        backgroundImage_ = ImageSource{assets::images::logo};
+        // the header foreground is only set when the theme changes it, so that it keeps following the default foreground otherwise
+        Color oldHeaderFg = headerFg();
+        Color headerFg = oldHeaderFg;
+        // the background image is only changed by themes that have the background section
         reader 
             >> ini::Section("default")
                 >> ini::Field("fg", defaultFg_)
@@ -34,10 +46,20 @@ namespace rckid::ui {
             >> ini::Section("accent")
                 >> ini::Field("fg", accentFg_)
                 >> ini::Field("bg", accentBg_)
+            >> ini::Section("header")
+                >> ini::Field("fg", headerFg)
+                >> ini::Field("green", headerGreen_)
+                >> ini::Field("red", headerRed_)
+                >> ini::Field("blue", headerBlue_)
+                >> ini::Field("cyan", headerCyan_)
+                >> ini::Field("violet", headerViolet_)
             >> ini::Section("animation")
                 >> ini::Field("speed", animationSpeed_)
             >> ini::Section("background")
                 >> ini::Field("image", backgroundImage_);
+        if (headerFg != oldHeaderFg)
+            headerFg_ = headerFg;
+        update();
     }
 
     void Style::save(ini::Writer & writer) {
@@ -48,11 +70,44 @@ namespace rckid::ui {
             << ini::Section("accent")
                 << ini::Field("fg", accentFg_)
                 << ini::Field("bg", accentBg_)
+            << ini::Section("header");
+        // the header foreground is only saved when set, so that it keeps following the default foreground otherwise
+        if (headerFg_.has_value())
+            writer << ini::Field("fg", headerFg_.value());
+        writer
+                << ini::Field("green", headerGreen_)
+                << ini::Field("red", headerRed_)
+                << ini::Field("blue", headerBlue_)
+                << ini::Field("cyan", headerCyan_)
+                << ini::Field("violet", headerViolet_)
             << ini::Section("animation")
                 << ini::Field("speed", animationSpeed_)
             << ini::Section("background")
                 << ini::Field("image", backgroundImage_);
     }
 
+    void Style::update() {
+        colors_.defaultFg = defaultFg_.toRGB565();
+        colors_.defaultBg = defaultBg_.toRGB565();
+        colors_.accentFg = accentFg_.toRGB565();
+        colors_.accentBg = accentBg_.toRGB565();
+        // same palettes as labels create for their colors
+        FontData::createFontPalette(colors_.defaultText, Color::Black(), defaultFg_);
+        FontData::createFontPalette(colors_.accentText, Color::Black(), accentFg_);
+        // the header icons use two colors, the first one is the header foreground and the second one the icon color
+        Color::RGB565 * p = colors_.header;
+        for (uint8_t i = 0; i < 16; ++i)
+            p[i] = headerFg().withBrightness(i << 4 | i).toRGB565();
+        Color::RGB565 fg = headerFg().toRGB565();
+        Color const icons[] = { headerGreen_, headerRed_, headerBlue_, headerCyan_, headerViolet_ };
+        for (uint32_t i = 0; i < 5; ++i) {
+            p[15 + i * 2] = fg;
+            p[16 + i * 2] = icons[i].toRGB565();
+        }
+        for (uint32_t i = 25; i < 32; ++i)
+            p[i] = Color::Black().toRGB565();
+        version_ = ++lastVersion_;
+    }
+
 
 } // namespace rckid::ui
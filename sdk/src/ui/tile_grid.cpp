@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cstring>
+
+#include <rckid/graphics/blit.h>
+#include <rckid/ui/tile_grid.h>
+
+namespace rckid::ui {
+
+    void TileGrid::renderContentsColumn(Coord column, Coord starty, Color::RGB565 * buffer, Coord numPixels) {
+        if (! cached(column / tileWidth())) {
+            contents_.renderColumn(column, starty, buffer, numPixels);
+            return;
+        }
+        Color::RGB565 const * src = cache_.get() + column * contents_.height() + starty;
+        switch (columnKind(column)) {
+            case ColumnKind::Transparent:
+                break;
+            case ColumnKind::Opaque:
+                memcpy(buffer, src, numPixels * sizeof(Color::RGB565));
+                break;
+            case ColumnKind::Mixed:
+                blit_rgb565(reinterpret_cast<uint8_t const *>(src), buffer, numPixels, transparentKey_);
+                break;
+            default:
+                UNREACHABLE;
+        }
+    }
+
+    void TileGrid::updateTransparentKey() {
+        Color::RGB565 const * palette = contents_.palette();
+        if (palette == nullptr)
+            return;
+        for (transparentKey_ = 1; ; ++transparentKey_) {
+            uint32_t i = 0;
+            while (i < paletteSize_ && static_cast<uint16_t>(palette[i]) != transparentKey_)
+                ++i;
+            if (i == paletteSize_)
+                break;
+        }
+    }
+
+    void TileGrid::refreshCache() {
+        Coord w = contents_.width();
+        Coord h = contents_.height();
+        if (cache_ == nullptr) {
+            cache_ = unique_ptr<Color::RGB565>{new Color::RGB565[w * h]};
+            columnKinds_ = unique_ptr<uint8_t>{new uint8_t[(w + 3) / 4]};
+            contents_.damageAll();
+        }
+        for (Coord col = 0, cols = contents_.cols(); col < cols; ++col) {
+            if (! contents_.columnDamaged(col))
+                continue;
+            for (Coord column = col * tileWidth(), e = column + tileWidth(); column < e; ++column) {
+                Color::RGB565 * c = cache_.get() + column * h;
+                uint16_t * raw = reinterpret_cast<uint16_t *>(c);
+                std::fill(raw, raw + h, transparentKey_);
+                contents_.renderColumn(column, 0, c, h);
+                Coord n = 0;
+                for (Coord y = 0; y < h; ++y)
+                    if (raw[y] == transparentKey_)
+                        ++n;
+                setColumnKind(column, (n == h) ? ColumnKind::Transparent : (n == 0) ? ColumnKind::Opaque : ColumnKind::Mixed);
+            }
+        }
+        contents_.clearDamage();
+    }
+
+} // namespace rckid::ui
@@ -1,5 +1,6 @@
 #include <rckid/ui/widget.h>
 #include <rckid/ui/animation.h>
+#include <rckid/ui/tween.h>
 #include <rckid/ui/header.h>
 
 namespace rckid::ui {
@@ -7,6 +8,8 @@ namespace rckid::ui {
     void Widget::cancelAnimations() {
         if (activeAnimations_ > 0)
             Animation::cancelAnimationsFor(this);
+        if (activeAnimations_ > 0)
+            Tweens::cancelFor(this);
         ASSERT(activeAnimations_ == 0);
     }
 
@@ -42,6 +45,7 @@ namespace rckid::ui {
 
     void Widget::renderEssentials() {
         Animation::updateAll();
+        Tweens::updateAll();
         if (Header::shouldRender())
             triggerOnRender(Header::instance());
     }
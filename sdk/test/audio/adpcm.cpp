@@ -0,0 +1,121 @@
+#include <cmath>
+
+#include <platform/tests.h>
+#include <rckid/audio/adpcm.h>
+#include <rckid/audio/recording.h>
+
+#include "helpers.h"
+
+using namespace rckid;
+using namespace rckid::audio;
+using namespace rckid::audio::tests;
+
+namespace {
+
+    int16_t sine(uint32_t i) {
+        return static_cast<int16_t>(std::sin(i * 2 * M_PI * 440 / 8000) * 10000);
+    }
+
+    /** Decodes the whole stream and returns the number of samples, checking that the decoded left channel is close to the sine wave and that both channels are the same.
+     */
+    uint32_t decodeSine(DecoderStream & d, double & errorRatio) {
+        uint32_t total = 0;
+        double err = 0;
+        double energy = 0;
+        int16_t * buffer = nullptr;
+        uint32_t n = 0;
+        while (true) {
+            d.update();
+            d.callback(buffer, n);
+            if (buffer == nullptr)
+                break;
+            for (uint32_t i = 0; i < n; ++i, ++total) {
+                if (buffer[i * 2] != buffer[i * 2 + 1])
+                    return 0;
+                double diff = buffer[i * 2] - sine(total);
+                err += diff * diff;
+                energy += static_cast<double>(sine(total)) * sine(total);
+            }
+        }
+        errorRatio = energy == 0 ? 0 : err / energy;
+        return total;
+    }
+}
+
+TEST(adpcm, codec) {
+    ADPCMState enc;
+    ADPCMState dec;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        uint8_t nibble = enc.encode(sine(i));
+        EXPECT(nibble < 16);
+        EXPECT(dec.decode(nibble) == enc.predictor);
+    }
+    EXPECT(std::abs(enc.predictor - sine(999)) < 500);
+}
+
+TEST(adpcm, roundTrip) {
+    MemoryStream s{MemoryStream::withCapacity(32 * 1024)};
+    ADPCMEncoder enc{s, 8000};
+    int16_t samples[1000];
+    // 3 seconds, in chunks that do not align with the blocks
+    for (uint32_t i = 0; i < 24; ++i) {
+        for (uint32_t j = 0; j < 1000; ++j)
+            samples[j] = sine(i * 1000 + j);
+        enc.encode(samples, 1000);
+    }
+    enc.finish();
+    EXPECT(enc.samples() == 24000);
+    // 24 blocks, each 512 bytes
+    EXPECT(enc.bytesWritten() == 24 * ADPCMEncoder::BLOCK_SIZE);
+    EXPECT(s.tell() == ADPCMEncoder::HEADER_SIZE + enc.bytesWritten());
+    ADPCMDecoderStream d{unique_ptr<ReadStream>{new MemoryStream{written(s)}}};
+    EXPECT(d.valid());
+    EXPECT(d.channels() == 1);
+    EXPECT(d.sampleRate() == 8000);
+    EXPECT(d.samples() == 24000);
+    double errorRatio = 1;
+    EXPECT(decodeSine(d, errorRatio) == 24000);
+    EXPECT(errorRatio < 0.01);
+}
+
+TEST(adpcm, recording) {
+    MemoryStream s{MemoryStream::withCapacity(32 * 1024)};
+    uint32_t seen = 0;
+    {
+        Recording r{s};
+        r.setOnSamples([&](int16_t const *, uint32_t n) { seen += n; });
+        // simulate the audio callback delivering 256 stereo samples buffers, with the task running after every other buffer
+        int16_t stereo[Recording::DMA_STEREO_SAMPLES * 2];
+        uint32_t i = 0;
+        for (uint32_t b = 0; b < 40; ++b) {
+            for (uint32_t j = 0; j < Recording::DMA_STEREO_SAMPLES; ++j, ++i) {
+                stereo[j * 2] = sine(i);
+                stereo[j * 2 + 1] = 0;
+            }
+            r.feed(stereo, Recording::DMA_STEREO_SAMPLES);
+            if (b & 1)
+                Task::runAll();
+        }
+        EXPECT(r.droppedSamples() == 0);
+        // without the task running, the ring buffer overflows
+        for (uint32_t b = 0; b < 20; ++b)
+            r.feed(stereo, Recording::DMA_STEREO_SAMPLES);
+        EXPECT(r.droppedSamples() == 20 * Recording::DMA_STEREO_SAMPLES - Recording::RING_SIZE);
+        r.finish();
+        EXPECT(r.samples() == 40 * Recording::DMA_STEREO_SAMPLES + Recording::RING_SIZE);
+    }
+    EXPECT(seen == 40 * Recording::DMA_STEREO_SAMPLES + Recording::RING_SIZE);
+    ADPCMDecoderStream d{unique_ptr<ReadStream>{new MemoryStream{written(s)}}};
+    EXPECT(d.samples() == 40 * Recording::DMA_STEREO_SAMPLES + Recording::RING_SIZE);
+}
+
+TEST(adpcm, invalidStream) {
+    uint8_t garbage[100] = { 'R', 'I', 'F', 'F' };
+    ADPCMDecoderStream d{unique_ptr<ReadStream>{new MemoryStream{MemoryStream::copyOf(garbage, sizeof(garbage))}}};
+    EXPECT(! d.valid());
+    int16_t * buffer = nullptr;
+    uint32_t n = 0;
+    d.update();
+    d.callback(buffer, n);
+    EXPECT(buffer == nullptr);
+}
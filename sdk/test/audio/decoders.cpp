@@ -0,0 +1,272 @@
+#include <platform/tests.h>
+#include <rckid/audio/decoder_stream.h>
+#include <rckid/audio/wav.h>
+#include <rckid/audio/qoa.h>
+
+#include "helpers.h"
+
+using namespace rckid;
+using namespace rckid::audio;
+using namespace rckid::audio::tests;
+
+namespace {
+
+    void le16(std::vector<uint8_t> & v, uint32_t x) {
+        v.push_back(static_cast<uint8_t>(x));
+        v.push_back(static_cast<uint8_t>(x >> 8));
+    }
+
+    void le32(std::vector<uint8_t> & v, uint32_t x) {
+        le16(v, x & 0xffff);
+        le16(v, x >> 16);
+    }
+
+    void be16(std::vector<uint8_t> & v, uint32_t x) {
+        v.push_back(static_cast<uint8_t>(x >> 8));
+        v.push_back(static_cast<uint8_t>(x));
+    }
+
+    void be64(std::vector<uint8_t> & v, uint64_t x) {
+        for (int i = 56; i >= 0; i -= 8)
+            v.push_back(static_cast<uint8_t>(x >> i));
+    }
+
+    /** Creates PCM WAV file with the given raw sample data. An extra unknown chunk is added before the data to check it is skipped.
+     */
+    std::vector<uint8_t> wav(uint32_t channels, uint32_t bits, std::vector<uint8_t> const & data) {
+        std::vector<uint8_t> v;
+        v.insert(v.end(), {'R', 'I', 'F', 'F'});
+        le32(v, 4 + 24 + 12 + 8 + static_cast<uint32_t>(data.size()));
+        v.insert(v.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+        le32(v, 16);
+        le16(v, 1);
+        le16(v, channels);
+        le32(v, 22050);
+        le32(v, 22050 * channels * bits / 8);
+        le16(v, channels * bits / 8);
+        le16(v, bits);
+        v.insert(v.end(), {'L', 'I', 'S', 'T'});
+        le32(v, 3);
+        v.insert(v.end(), {1, 2, 3, 0});
+        v.insert(v.end(), {'d', 'a', 't', 'a'});
+        le32(v, static_cast<uint32_t>(data.size()));
+        v.insert(v.end(), data.begin(), data.end());
+        return v;
+    }
+
+    unique_ptr<RandomReadStream> stream(std::vector<uint8_t> const & v) {
+        return unique_ptr<RandomReadStream>{new MemoryStream{MemoryStream::copyOf(v.data(), static_cast<uint32_t>(v.size()))}};
+    }
+
+    /** QOA slice with the given scale factor and 3bit quantized residuals.
+     */
+    uint64_t qoaSlice(uint32_t scaleFactor, std::vector<uint32_t> const & residuals) {
+        uint64_t result = static_cast<uint64_t>(scaleFactor) << 60;
+        for (uint32_t i = 0; i < residuals.size(); ++i)
+            result |= static_cast<uint64_t>(residuals[i]) << (57 - i * 3);
+        return result;
+    }
+
+    class TestDecoder : public DecoderStream {
+    public:
+        TestDecoder(): DecoderStream{16, 2} {}
+        uint32_t sampleRate() const override { return 1234; }
+    protected:
+        uint32_t refillSamples(int16_t *, uint32_t) override { return 0; }
+    };
+}
+
+TEST(decoders, wav16Stereo) {
+    std::vector<uint8_t> data;
+    for (uint32_t i = 0; i < 3000; ++i) {
+        le16(data, i);
+        le16(data, static_cast<uint16_t>(-static_cast<int32_t>(i)));
+    }
+    WAVDecoderStream d{stream(wav(2, 16, data))};
+    EXPECT(d.valid());
+    EXPECT(d.sampleRate() == 22050);
+    EXPECT(d.samples() == 3000);
+    std::vector<int16_t> s = decodeAll(d);
+    EXPECT(s.size() == 6000);
+    EXPECT(s[0] == 0 && s[1] == 0);
+    EXPECT(s[2 * 2999] == 2999 && s[2 * 2999 + 1] == -2999);
+    EXPECT(s[2 * 1500] == 1500 && s[2 * 1500 + 1] == -1500);
+}
+
+TEST(decoders, wav8Mono) {
+    std::vector<uint8_t> data;
+    for (uint32_t i = 0; i < 2500; ++i)
+        data.push_back(static_cast<uint8_t>(i));
+    WAVDecoderStream d{stream(wav(1, 8, data))};
+    EXPECT(d.valid());
+    std::vector<int16_t> s = decodeAll(d);
+    EXPECT(s.size() == 5000);
+    EXPECT(s[0] == -128 * 256 && s[1] == -128 * 256);
+    EXPECT(s[2 * 128] == 0 && s[2 * 128 + 1] == 0);
+    EXPECT(s[2 * 2499] == (2499 % 256 - 128) * 256);
+}
+
+TEST(decoders, qoa) {
+    std::vector<uint8_t> v{'q', 'o', 'a', 'f', 0, 0, 0, 30};
+    // single stereo frame of 30 samples at 8kHz, all LMS state zero
+    v.insert(v.end(), {2, 0x00, 0x1f, 0x40});
+    be16(v, 30);
+    be16(v, 8 + 2 * 16 + 2 * 2 * 8);
+    for (uint32_t i = 0; i < 2 * 16; ++i)
+        v.push_back(0);
+    // with zero weights and small positive residuals the weights do not change and the samples are the residuals
+    std::vector<uint32_t> left;
+    for (uint32_t i = 0; i < 20; ++i)
+        left.push_back((i % 4) * 2);
+    be64(v, qoaSlice(0, left));
+    be64(v, qoaSlice(0, std::vector<uint32_t>(20, 2)));
+    be64(v, qoaSlice(0, std::vector<uint32_t>(10, 6)));
+    be64(v, qoaSlice(0, std::vector<uint32_t>(10, 4)));
+    QOADecoderStream d{stream(v)};
+    EXPECT(d.valid());
+    EXPECT(d.channels() == 2);
+    EXPECT(d.sampleRate() == 8000);
+    EXPECT(d.samples() == 30);
+    std::vector<int16_t> s = decodeAll(d);
+    EXPECT(s.size() == 60);
+    int16_t expected[] = { 1, 3, 5, 7 };
+    for (uint32_t i = 0; i < 20; ++i) {
+        EXPECT(s[i * 2] == expected[i % 4]);
+        EXPECT(s[i * 2 + 1] == 3);
+    }
+    for (uint32_t i = 20; i < 30; ++i) {
+        EXPECT(s[i * 2] == 7);
+        EXPECT(s[i * 2 + 1] == 5);
+    }
+}
+
+TEST(decoders, qoaInvalidFrame) {
+    std::vector<uint8_t> v{'q', 'o', 'a', 'f', 0, 0, 0, 30};
+    v.insert(v.end(), {3, 0x00, 0x1f, 0x40, 0, 30, 0, 0});
+    QOADecoderStream d{stream(v)};
+    EXPECT(! d.valid());
+}
+
+TEST(decoders, acquireRelease) {
+    std::vector<uint8_t> data(3000, 128);
+    WAVDecoderStream d{stream(wav(1, 8, data))};
+    int16_t * a = nullptr;
+    int16_t * b = nullptr;
+    uint32_t n = 0;
+    d.update();
+    // the audio output may hold more than one buffer at a time
+    d.acquire(a, n);
+    EXPECT(a != nullptr && n == WAVDecoderStream::BUFFER_STEREO_SAMPLES);
+    d.acquire(b, n);
+    EXPECT(b != nullptr && b != a);
+    EXPECT(d.inFlight() == 2);
+    EXPECT(d.owns(a) && d.owns(b));
+    int16_t other[4];
+    EXPECT(! d.owns(other));
+    // the position only advances when the buffers are returned
+    EXPECT(d.positionMs() == 0);
+    d.release(a);
+    EXPECT(d.inFlight() == 1);
+    EXPECT(d.positionMs() == WAVDecoderStream::BUFFER_STEREO_SAMPLES * 1000 / 22050);
+    d.release(b);
+    EXPECT(d.inFlight() == 0);
+    d.update();
+    EXPECT(d.done());
+    d.acquire(a, n);
+    EXPECT(a != nullptr && n == 3000 - 2 * WAVDecoderStream::BUFFER_STEREO_SAMPLES);
+    d.release(a);
+    d.acquire(a, n);
+    EXPECT(a == nullptr);
+    EXPECT(d.positionMs() == 3000 * 1000 / 22050);
+}
+
+TEST(decoders, stats) {
+    std::vector<uint8_t> data(6000, 128);
+    WAVDecoderStream d{stream(wav(1, 8, data))};
+    int16_t * buffer = nullptr;
+    uint32_t n = 0;
+    // nothing decoded yet is an underrun
+    d.callback(buffer, n);
+    EXPECT(buffer == nullptr);
+    EXPECT(d.stats().underruns() == 1);
+    d.update();
+    EXPECT(d.stats().refills() == 4);
+    d.callback(buffer, n);
+    EXPECT(d.stats().minReady() == 3);
+    d.callback(buffer, n);
+    EXPECT(d.stats().minReady() == 2);
+    EXPECT(d.stats().buffers() == 2);
+    EXPECT(d.stats().avgReady100() == 250);
+    // the refill latency is measured from the first returned buffer
+    EXPECT(d.stats().maxLatencyUs() == 0);
+    d.update();
+    EXPECT(d.stats().refills() == 5);
+    EXPECT(d.stats().maxLatencyUs() >= d.stats().avgLatencyUs());
+    // the callback's counters read as reset immediately, but are cleared by the callback itself
+    d.stats().reset();
+    EXPECT(d.stats().underruns() == 0 && d.stats().buffers() == 0 && d.stats().minReady() == 0 && d.stats().refills() == 0);
+    d.callback(buffer, n);
+    EXPECT(d.stats().buffers() == 1);
+    EXPECT(d.stats().avgReady100() == d.stats().minReady() * 100);
+    while (buffer != nullptr) {
+        d.update();
+        d.callback(buffer, n);
+    }
+    // end of the stream is not an underrun
+    EXPECT(d.done());
+    EXPECT(d.stats().underruns() == 0);
+    EXPECT(d.stats().buffers() > 1);
+}
+
+TEST(decoders, dsp) {
+    std::vector<uint8_t> data;
+    for (uint32_t i = 0; i < 1000; ++i)
+        le16(data, 1000);
+    WAVDecoderStream d{stream(wav(1, 16, data))};
+    DSP dsp;
+    d.setDSP(& dsp, DSP::UNITY_GAIN / 2);
+    EXPECT(d.dsp() == & dsp);
+    std::vector<int16_t> s = decodeAll(d);
+    EXPECT(s.size() == 2000);
+    for (int16_t x : s)
+        EXPECT(x == 500);
+}
+
+TEST(decoders, registry) {
+    std::vector<uint8_t> data(400, 128);
+    // magic bytes take precedence over the extension
+    auto d = DecoderStream::fromStream(stream(wav(1, 8, data)), "/sounds/effect.mp3");
+    EXPECT(d != nullptr);
+    EXPECT(d->sampleRate() == 22050);
+    // unknown magic and extension
+    std::vector<uint8_t> unknown(100, 0);
+    EXPECT(DecoderStream::fromStream(stream(unknown), "/sounds/effect.xyz") == nullptr);
+    // invalid stream with known magic
+    std::vector<uint8_t> broken{'q', 'o', 'a', 'f', 0, 0, 0, 30};
+    EXPECT(DecoderStream::fromStream(stream(broken), "/sounds/effect.qoa") == nullptr);
+    // custom decoders by extension
+    DecoderStream::registerDecoder(".xyz", nullptr, 0, [](unique_ptr<RandomReadStream>) -> unique_ptr<DecoderStream> { 
+        return std::make_unique<TestDecoder>(); 
+    });
+    d = DecoderStream::fromStream(stream(unknown), "/sounds/effect.xyz");
+    EXPECT(d != nullptr);
+    EXPECT(d->sampleRate() == 1234);
+    // Ogg streams of other codecs are not taken by the Opus decoder
+    std::vector<uint8_t> vorbis(100, 0);
+    memcpy(vorbis.data(), "OggS", 4);
+    memcpy(vorbis.data() + 28, "\x01vorbis", 7);
+    EXPECT(DecoderStream::fromStream(stream(vorbis), "/sounds/effect.ogg") == nullptr);
+    DecoderStream::registerDecoder(".ogg", "\x01vorbis", 28, [](unique_ptr<RandomReadStream>) -> unique_ptr<DecoderStream> { 
+        return std::make_unique<TestDecoder>(); 
+    });
+    d = DecoderStream::fromStream(stream(vorbis), "/sounds/effect.ogg");
+    EXPECT(d != nullptr && d->sampleRate() == 1234);
+    // app decoders take precedence over the built-in ones (the magic also matches the built-in MP3 decoder's ID3 tag, but is specific enough not to affect other tests)
+    DecoderStream::registerDecoder(".mp3", "ID3\x7f", 0, [](unique_ptr<RandomReadStream>) -> unique_ptr<DecoderStream> { 
+        return std::make_unique<TestDecoder>(); 
+    });
+    std::vector<uint8_t> custom(100, 0);
+    memcpy(custom.data(), "ID3\x7f", 4);
+    d = DecoderStream::fromStream(stream(custom), "/sounds/effect.mp3");
+    EXPECT(d != nullptr && d->sampleRate() == 1234);
+}
@@ -0,0 +1,144 @@
+#include <cmath>
+
+#include <platform/tests.h>
+#include <rckid/audio/dsp.h>
+
+using namespace rckid;
+using namespace rckid::audio;
+
+namespace {
+
+    /** Processes one second of a sine wave by the DSP in buffers of 256 samples and returns its gain in dB, measured as RMS over the second half so that the filters have settled.
+     */
+    double gainDb(DSP & dsp, float frequency, int32_t gain = DSP::UNITY_GAIN, uint32_t sampleRate = 48000, int16_t amplitude = 4000) {
+        int16_t buffer[256 * 2];
+        double sum = 0;
+        double sumIn = 0;
+        for (uint32_t i = 0; i < sampleRate; i += 256) {
+            for (uint32_t j = 0; j < 256; ++j) {
+                buffer[j * 2] = static_cast<int16_t>(lround(sin(2 * M_PI * frequency * (i + j) / sampleRate) * amplitude));
+                buffer[j * 2 + 1] = static_cast<int16_t>(-buffer[j * 2]);
+            }
+            if (i >= sampleRate / 2)
+                for (uint32_t j = 0; j < 256; ++j)
+                    sumIn += static_cast<double>(buffer[j * 2]) * buffer[j * 2];
+            dsp.process(buffer, 256, sampleRate, gain);
+            if (i >= sampleRate / 2)
+                for (uint32_t j = 0; j < 256; ++j)
+                    sum += static_cast<double>(buffer[j * 2 + 1]) * buffer[j * 2 + 1];
+        }
+        return 10 * log10(sum / sumIn);
+    }
+
+    bool near(double x, double expected, double tolerance = 0.3) { return x > expected - tolerance && x < expected + tolerance; }
+}
+
+TEST(dsp, passthrough) {
+    DSP dsp;
+    int16_t buffer[] = { 0, 1, -1, 32767, -32768, 24576, 30000, -30000 };
+    int16_t expected[] = { 0, 1, -1, 32767, -32768, 24576, 30000, -30000 };
+    // nothing to do, the limiter does not touch the samples either
+    dsp.process(buffer, 4, 48000, DSP::UNITY_GAIN);
+    EXPECT(memcmp(buffer, expected, sizeof(buffer)) == 0);
+    // bands with no gain are skipped
+    dsp.setBand(0, Biquad::Type::Peaking, 1000, 0);
+    dsp.process(buffer, 4, 48000, DSP::UNITY_GAIN);
+    EXPECT(memcmp(buffer, expected, sizeof(buffer)) == 0);
+}
+
+TEST(dsp, replayGain) {
+    DSP dsp;
+    EXPECT(dsp.gain(ReplayGain{}) == DSP::UNITY_GAIN);
+    ReplayGain rg{-6.0206f, 2.5f};
+    EXPECT(dsp.gain(rg) == 2048);
+    dsp.setReplayGainMode(DSP::ReplayGainMode::Album);
+    EXPECT(dsp.gain(rg) == 5462);
+    // missing gain falls back to the other one
+    EXPECT(dsp.gain(ReplayGain{-6.0206f, std::nullopt}) == 2048);
+    dsp.setReplayGainMode(DSP::ReplayGainMode::Off);
+    EXPECT(dsp.gain(rg) == DSP::UNITY_GAIN);
+    dsp.setPreamp(6.0206f);
+    EXPECT(dsp.gain(rg) == 8192);
+    // the total gain is limited
+    dsp.setReplayGainMode(DSP::ReplayGainMode::Track);
+    EXPECT(dsp.gain(ReplayGain{20.0f, std::nullopt}) == 16306);
+    dsp.setPreamp(0);
+    EXPECT(dsp.gain(ReplayGain{-40.0f, std::nullopt}) == 258);
+    // the gain is applied to the samples
+    dsp.setLimiter(false);
+    int16_t buffer[] = { 1000, -1000, 3, 32767 };
+    dsp.process(buffer, 2, 44100, 2048);
+    EXPECT(buffer[0] == 500 && buffer[1] == -500 && buffer[2] == 2 && buffer[3] == 16384);
+    EXPECT(near(gainDb(dsp, 1000, dsp.gain(rg)), -6.02, 0.01));
+}
+
+TEST(dsp, limiter) {
+    // transparent below the threshold
+    for (int32_t x = -DSP::LIMITER_THRESHOLD; x <= DSP::LIMITER_THRESHOLD; x += 7)
+        EXPECT(DSP::limit(x) == x);
+    // smooth, symmetric and never reaching full scale
+    int16_t last = DSP::LIMITER_THRESHOLD;
+    for (int32_t x = DSP::LIMITER_THRESHOLD + 1; x < (1 << 23); x += 1 + x / 64) {
+        int16_t y = DSP::limit(x);
+        EXPECT(y >= last && y - last <= 1 + (x / 64) && y < 32767);
+        EXPECT(DSP::limit(-x) == -y);
+        last = y;
+    }
+    // boosted full scale samples do not clip
+    DSP dsp;
+    int16_t buffer[] = { 32767, -32768, 16384, -16384 };
+    dsp.process(buffer, 2, 48000, DSP::UNITY_GAIN * 4);
+    EXPECT(buffer[0] > 30000 && buffer[0] < 32767 && buffer[1] == -buffer[0]);
+    EXPECT(buffer[2] > DSP::LIMITER_THRESHOLD && buffer[2] < buffer[0] && buffer[3] == - buffer[2]);
+    dsp.setLimiter(false);
+    buffer[0] = 16384;
+    buffer[1] = -16384;
+    dsp.process(buffer, 1, 48000, DSP::UNITY_GAIN * 4);
+    EXPECT(buffer[0] == 32767 && buffer[1] == -32768);
+}
+
+/** Frequency response of the equalizer bands.
+ */
+TEST(dsp, equalizer) {
+    DSP dsp;
+    dsp.setLimiter(false);
+    dsp.setBand(0, Biquad::Type::LowShelf, 200, 6);
+    for (float f : { 30.0f, 50.0f, 200.0f, 1000.0f, 5000.0f, 15000.0f }) {
+        double g = gainDb(dsp, f);
+        if (f <= 50)
+            EXPECT(near(g, 6, 0.6));
+        else if (f == 200)
+            EXPECT(near(g, 3));
+        else
+            EXPECT(near(g, 0));
+    }
+    dsp.setBandGain(0, 0);
+    dsp.setBand(1, Biquad::Type::Peaking, 1000, -9, 2);
+    EXPECT(dsp.numBands() == 2);
+    EXPECT(near(gainDb(dsp, 1000), -9));
+    EXPECT(near(gainDb(dsp, 100), 0));
+    EXPECT(near(gainDb(dsp, 10000), 0));
+    dsp.clearBands();
+    dsp.setBand(0, Biquad::Type::HighShelf, 4000, 20);
+    EXPECT(dsp.bandGain(0) == DSP::MAX_BAND_GAIN_DB);
+    EXPECT(near(gainDb(dsp, 16000), 12, 0.6));
+    EXPECT(near(gainDb(dsp, 100), 0));
+    // the filter is recomputed for other sample rates
+    EXPECT(near(gainDb(dsp, 8000, DSP::UNITY_GAIN, 22050), 12, 1));
+    EXPECT(near(gainDb(dsp, 100, DSP::UNITY_GAIN, 22050), 0));
+}
+
+TEST(dsp, silence) {
+    // the strongest low frequency boost must not amplify the rounding errors, nor oscillate after the sound stops
+    DSP dsp;
+    dsp.setBand(0, Biquad::Type::LowShelf, 20, 12);
+    dsp.setBand(1, Biquad::Type::Peaking, 40, 12, 4);
+    gainDb(dsp, 30, DSP::UNITY_GAIN, 48000, 2000);
+    int16_t buffer[256 * 2];
+    for (uint32_t i = 0; i < 48000; i += 256) {
+        memset(buffer, 0, sizeof(buffer));
+        dsp.process(buffer, 256, 48000, DSP::UNITY_GAIN);
+    }
+    for (uint32_t i = 0; i < 256 * 2; ++i)
+        EXPECT(buffer[i] == 0);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+#include <rckid/stream.h>
+#include <rckid/audio/decoder_stream.h>
+
+/** Helpers shared by the audio tests.
+ */
+namespace rckid::audio::tests {
+
+    /** Copies the written part of the memory stream into a new stream for reading.
+     */
+    inline MemoryStream written(MemoryStream & s) {
+        std::vector<uint8_t> data(s.tell());
+        s.seek(0);
+        s.read(data.data(), static_cast<uint32_t>(data.size()));
+        return MemoryStream::copyOf(data.data(), static_cast<uint32_t>(data.size()));
+    }
+
+    /** Decodes the whole stream into interleaved stereo samples.
+     */
+    inline std::vector<int16_t> decodeAll(DecoderStream & d) {
+        std::vector<int16_t> result;
+        int16_t * buffer = nullptr;
+        uint32_t n = 0;
+        while (true) {
+            d.update();
+            d.callback(buffer, n);
+            if (buffer == nullptr)
+                break;
+            result.insert(result.end(), buffer, buffer + n * 2);
+        }
+        return result;
+    }
+
+} // namespace rckid::audio::tests
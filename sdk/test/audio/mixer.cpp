@@ -0,0 +1,167 @@
+#include <platform/tests.h>
+#include <rckid/audio/mixer.h>
+
+using namespace rckid;
+using namespace rckid::audio;
+
+namespace {
+
+    /** Stream of stereo samples whose left value is the sample index and right value its negation, decoded in small buffers so that the mixer has to move across buffer boundaries.
+     */
+    class RampStream : public DecoderStream {
+    public:
+        RampStream(uint32_t sampleRate, uint32_t samples): DecoderStream{100, 4}, sampleRate_{sampleRate}, samples_{samples} {}
+
+        uint32_t sampleRate() const override { return sampleRate_; }
+
+    protected:
+        uint32_t refillSamples(int16_t * buffer, uint32_t numStereoSamples) override {
+            uint32_t n = std::min(numStereoSamples, samples_ - next_);
+            for (uint32_t i = 0; i < n; ++i) {
+                buffer[i * 2] = static_cast<int16_t>(next_ + i);
+                buffer[i * 2 + 1] = static_cast<int16_t>(-static_cast<int32_t>(next_ + i));
+            }
+            next_ += n;
+            return n;
+        }
+
+    private:
+        uint32_t sampleRate_;
+        uint32_t samples_;
+        uint32_t next_ = 0;
+    };
+
+    /** Mixes the given number of buffers and returns their interleaved stereo samples.
+     */
+    std::vector<int16_t> mix(Mixer & m, uint32_t numBuffers) {
+        std::vector<int16_t> result;
+        int16_t * buffer = nullptr;
+        uint32_t n = 0;
+        for (uint32_t i = 0; i < numBuffers; ++i) {
+            m.update();
+            m.callback(buffer, n);
+            if (buffer == nullptr)
+                break;
+            result.insert(result.end(), buffer, buffer + n * 2);
+        }
+        if (buffer != nullptr)
+            m.release(buffer);
+        return result;
+    }
+
+    std::vector<int16_t> ramp(uint32_t length, int16_t step) {
+        std::vector<int16_t> result;
+        for (uint32_t i = 0; i < length; ++i)
+            result.push_back(static_cast<int16_t>(i * step));
+        return result;
+    }
+}
+
+TEST(mixer, silence) {
+    Mixer m{8000};
+    std::vector<int16_t> s = mix(m, 2);
+    EXPECT(s.size() == Mixer::BUFFER_STEREO_SAMPLES * 4);
+    for (int16_t x : s)
+        EXPECT(x == 0);
+    EXPECT(m.freeVoice() == 0);
+}
+
+TEST(mixer, sample) {
+    std::vector<int16_t> data = ramp(300, 10);
+    Mixer m{8000};
+    m.play(0, Sample{data.data(), 300, 8000, false});
+    EXPECT(m.isPlaying(0));
+    EXPECT(m.freeVoice() == 1);
+    std::vector<int16_t> s = mix(m, 2);
+    for (uint32_t i = 0; i < 300; ++i)
+        EXPECT(s[i * 2] == data[i] && s[i * 2 + 1] == data[i]);
+    for (uint32_t i = 300; i < Mixer::BUFFER_STEREO_SAMPLES * 2; ++i)
+        EXPECT(s[i * 2] == 0 && s[i * 2 + 1] == 0);
+    EXPECT(! m.isPlaying(0));
+}
+
+TEST(mixer, loop) {
+    std::vector<int16_t> data = ramp(100, 10);
+    Mixer m{8000};
+    m.play(3, Sample{data.data(), 100, 8000, false}, true);
+    std::vector<int16_t> s = mix(m, 2);
+    for (uint32_t i = 0; i < Mixer::BUFFER_STEREO_SAMPLES * 2; ++i)
+        EXPECT(s[i * 2] == data[i % 100]);
+    EXPECT(m.isPlaying(3));
+    m.stop(3);
+    EXPECT(! m.isPlaying(3));
+}
+
+TEST(mixer, volumeAndPan) {
+    std::vector<int16_t> data(10, 1000);
+    Mixer m{8000};
+    m.setVolume(0, Mixer::VOLUME_FULL / 2);
+    m.play(0, Sample{data.data(), 10, 8000, false});
+    m.setPan(1, 127);
+    m.play(1, Sample{data.data(), 10, 8000, false});
+    m.setPan(2, -128);
+    m.setVolume(2, Mixer::VOLUME_FULL * 2);
+    m.play(2, Sample{data.data(), 10, 8000, false});
+    std::vector<int16_t> s = mix(m, 1);
+    // 500 + 0 + 2000 on left, 500 + 1000 + 0 on right
+    EXPECT(s[0] == 2500);
+    EXPECT(s[1] == 1500);
+}
+
+TEST(mixer, saturation) {
+    std::vector<int16_t> high(10, 30000);
+    std::vector<int16_t> low(10, -30000);
+    Mixer m{8000};
+    m.play(0, Sample{high.data(), 5, 8000, false});
+    m.play(1, Sample{high.data(), 5, 8000, false});
+    m.play(2, Sample{low.data(), 10, 8000, false});
+    m.play(3, Sample{low.data(), 10, 8000, false});
+    m.play(4, Sample{low.data(), 10, 8000, false});
+    std::vector<int16_t> s = mix(m, 1);
+    // 2 * 30000 - 3 * 30000 and then - 3 * 30000 only
+    EXPECT(s[0] == -30000);
+    EXPECT(s[5 * 2] == -32768);
+    Mixer m2{8000};
+    m2.play(0, Sample{high.data(), 10, 8000, false});
+    m2.play(1, Sample{high.data(), 10, 8000, false});
+    s = mix(m2, 1);
+    EXPECT(s[0] == 32767);
+}
+
+TEST(mixer, resample) {
+    std::vector<int16_t> data = ramp(200, 100);
+    Mixer m{8000};
+    m.play(0, Sample{data.data(), 200, 4000, false});
+    std::vector<int16_t> s = mix(m, 2);
+    // linear interpolation, delayed by one source sample
+    for (uint32_t i = 2; i < 400; ++i)
+        EXPECT(s[i * 2] == static_cast<int16_t>((i - 2) * 50));
+    EXPECT(! m.isPlaying(0));
+    Mixer nearest{8000};
+    nearest.setInterpolation(false);
+    nearest.play(0, Sample{data.data(), 200, 4000, false});
+    s = mix(nearest, 2);
+    for (uint32_t i = 0; i < 400; ++i)
+        EXPECT(s[i * 2] == data[i / 2]);
+}
+
+TEST(mixer, stream) {
+    Mixer m{8000};
+    m.play(0, unique_ptr<DecoderStream>{new RampStream{8000, 1000}});
+    std::vector<int16_t> s = mix(m, 4);
+    for (uint32_t i = 0; i < 1000; ++i)
+        EXPECT(s[i * 2] == static_cast<int16_t>(i) && s[i * 2 + 1] == -static_cast<int16_t>(i));
+    EXPECT(s[1000 * 2] == 0);
+    EXPECT(! m.isPlaying(0));
+}
+
+TEST(mixer, streamResample) {
+    Mixer m{8000};
+    m.play(0, unique_ptr<DecoderStream>{new RampStream{4000, 500}});
+    std::vector<int16_t> s = mix(m, 4);
+    // no glitches at the stream buffer boundaries, the halfway samples are rounded down
+    for (uint32_t i = 1; i < 500; ++i) {
+        EXPECT(s[i * 4] == static_cast<int16_t>(i - 1));
+        EXPECT(s[i * 4 + 2] == static_cast<int16_t>(i - 1));
+    }
+}
@@ -0,0 +1,361 @@
+#include <cstdio>
+#include <string>
+
+#include <platform/tests.h>
+#include <rckid/audio/mp3.h>
+
+using namespace rckid;
+using namespace rckid::audio;
+
+namespace {
+
+    /** Reads a file from the repository via stdio, in chunks of the given size to exercise partial reads. Optionally hides the Xing/Info header of the file so that the frame index is used for seeking.
+     */
+    class FileStream : public RandomReadStream {
+    public:
+        FileStream(char const * path, uint32_t chunk = 0xffffffff, bool hideTOC = false): chunk_{chunk}, hideTOC_{hideTOC} {
+            std::string p{__FILE__};
+            p = p.substr(0, p.rfind("sdk/test/")) + path;
+            f_ = std::fopen(p.c_str(), "rb");
+            if (f_ != nullptr) {
+                std::fseek(f_, 0, SEEK_END);
+                size_ = static_cast<uint32_t>(std::ftell(f_));
+                std::fseek(f_, 0, SEEK_SET);
+            }
+        }
+
+        ~FileStream() override {
+            if (f_ != nullptr)
+                std::fclose(f_);
+        }
+
+        bool good() const { return f_ != nullptr; }
+
+        uint32_t read(uint8_t * buffer, uint32_t bufferSize) override {
+            uint32_t pos = tell();
+            uint32_t n = static_cast<uint32_t>(std::fread(buffer, 1, std::min(bufferSize, chunk_), f_));
+            // the Info tag of birthday.mp3 is at offset 79
+            for (uint32_t i = pos; hideTOC_ && i < pos + n; ++i)
+                if (i >= 79 && i < 83)
+                    buffer[i - pos] = 0;
+            return n;
+        }
+
+        bool eof() const override { return std::feof(f_); }
+
+        uint32_t size() const override { return size_; }
+
+        uint32_t seek(uint32_t position) override {
+            std::fseek(f_, position, SEEK_SET);
+            return tell();
+        }
+
+        uint32_t tell() const override { return static_cast<uint32_t>(std::ftell(f_)); }
+
+    private:
+        FILE * f_;
+        uint32_t size_ = 0;
+        uint32_t chunk_;
+        bool hideTOC_;
+    };
+
+    unique_ptr<RandomReadStream> birthday(bool hideTOC = false) {
+        return std::make_unique<FileStream>("cartridges/demo/sd/system/birthday.mp3", 0xffffffff, hideTOC);
+    }
+
+    /** Decodes up to maxFrames of the stream (from its current position) and returns hash of the first hashSamples decoded samples.
+     */
+    uint32_t decodeHash(MP3DecoderStream & d, uint32_t maxFrames, uint32_t & samples, uint32_t hashSamples = 0xffffffff) {
+        uint32_t hash = 2166136261u;
+        samples = 0;
+        int16_t * buffer = nullptr;
+        uint32_t n = 0;
+        while (samples < maxFrames * 1152) {
+            d.update();
+            d.callback(buffer, n);
+            if (buffer == nullptr)
+                break;
+            for (uint32_t i = 0, e = std::min(n, hashSamples - std::min(hashSamples, samples)) * 2; i < e; ++i)
+                hash = (hash ^ static_cast<uint16_t>(buffer[i])) * 16777619u;
+            samples += n;
+        }
+        return hash;
+    }
+
+    /** Skips the first skip samples of the stream and returns hash of the following count samples.
+     */
+    uint32_t hashRange(DecoderStream & d, uint32_t skip, uint32_t count) {
+        uint32_t hash = 2166136261u;
+        uint32_t pos = 0;
+        int16_t * buffer = nullptr;
+        uint32_t n = 0;
+        while (pos < skip + count) {
+            d.update();
+            d.callback(buffer, n);
+            if (buffer == nullptr)
+                break;
+            for (uint32_t i = std::max(pos, skip), e = std::min(pos + n, skip + count); i < e; ++i) {
+                hash = (hash ^ static_cast<uint16_t>(buffer[(i - pos) * 2])) * 16777619u;
+                hash = (hash ^ static_cast<uint16_t>(buffer[(i - pos) * 2 + 1])) * 16777619u;
+            }
+            pos += n;
+        }
+        return hash;
+    }
+
+    /** Returns the given part of birthday.mp3.
+     */
+    std::vector<uint8_t> birthdayData(uint32_t offset, uint32_t size) {
+        FileStream f{"cartridges/demo/sd/system/birthday.mp3"};
+        f.seek(offset);
+        std::vector<uint8_t> result(size);
+        result.resize(f.read(result.data(), size));
+        return result;
+    }
+
+    /** ID3v2 tag of the given version with the given frames (ID and contents), followed by some padding.
+     */
+    std::vector<uint8_t> id3(uint8_t version, std::vector<std::pair<char const *, std::vector<uint8_t>>> const & frames) {
+        auto size = [](std::vector<uint8_t> & v, uint32_t x, bool synchsafe) {
+            uint32_t bits = synchsafe ? 7 : 8;
+            for (int32_t i = 3; i >= 0; --i)
+                v.push_back(static_cast<uint8_t>((x >> (i * bits)) & ((1 << bits) - 1)));
+        };
+        std::vector<uint8_t> body;
+        for (auto & [id, contents] : frames) {
+            body.insert(body.end(), id, id + 4);
+            size(body, static_cast<uint32_t>(contents.size()), version == 4);
+            body.insert(body.end(), { 0, 0 });
+            body.insert(body.end(), contents.begin(), contents.end());
+        }
+        body.resize(body.size() + 100, 0);
+        std::vector<uint8_t> result{ 'I', 'D', '3', version, 0, 0 };
+        size(result, static_cast<uint32_t>(body.size()), true);
+        result.insert(result.end(), body.begin(), body.end());
+        return result;
+    }
+
+    std::vector<uint8_t> txxx(char const * description, char const * value, uint8_t encoding = 0) {
+        std::vector<uint8_t> result{ encoding };
+        result.insert(result.end(), description, description + strlen(description) + 1);
+        result.insert(result.end(), value, value + strlen(value));
+        return result;
+    }
+
+    /** First frames of birthday.mp3 with its own ID3 tag (43 bytes) replaced by the given one.
+     */
+    unique_ptr<RandomReadStream> withTag(std::vector<uint8_t> tag, uint32_t size = 20000) {
+        std::vector<uint8_t> data = birthdayData(43, size);
+        tag.insert(tag.end(), data.begin(), data.end());
+        return unique_ptr<RandomReadStream>{new MemoryStream{MemoryStream::copyOf(tag.data(), static_cast<uint32_t>(tag.size()))}};
+    }
+
+    bool near(std::optional<float> x, float expected) { return x.has_value() && *x > expected - 0.001f && *x < expected + 0.001f; }
+
+    // birthday.mp3 has LAME tag with encoder delay 576 and padding 1105, together with the Info frame and the decoder delay, the first 1152 + 576 + 529 samples are skipped
+    constexpr uint32_t BIRTHDAY_SKIP = 2257;
+    constexpr uint32_t BIRTHDAY_SAMPLES = 7553 * 1152 - 576 - 1105;
+}
+
+TEST(mp3, decode) {
+    auto f = std::make_unique<FileStream>("cartridges/demo/sd/system/birthday.mp3");
+    EXPECT(f->good());
+    MP3DecoderStream d{unique_ptr<RandomReadStream>{std::move(f)}, 2};
+    EXPECT(d.sampleRate() == 48000);
+    EXPECT(d.channels() == 2);
+    EXPECT(d.durationMs() == BIRTHDAY_SAMPLES / 48);
+    uint32_t hash = hashRange(d, 0, 300 * 1152);
+    EXPECT(d.frameErrors() == 0);
+    // without the LAME tag, nothing is trimmed and the samples are identical to those before the trimming was implemented
+    MP3DecoderStream untrimmed{birthday(true), 2};
+    uint32_t samples = 0;
+    EXPECT(decodeHash(untrimmed, 300, samples) == 2582252361u);
+    EXPECT(samples == 300 * 1152);
+    // the trimmed samples are the same, only shifted by the skipped samples
+    MP3DecoderStream untrimmed2{birthday(true), 2};
+    EXPECT(hashRange(untrimmed2, BIRTHDAY_SKIP, 300 * 1152) == hash);
+}
+
+/** Reads the file in chunks that are not block aligned so that the ring wraps at arbitrary positions and frames continue in the tail window.
+ */
+TEST(mp3, decodeUnalignedReads) {
+    MP3DecoderStream d{unique_ptr<ReadStream>{new FileStream{"cartridges/demo/sd/system/birthday.mp3", 700}}, 2};
+    EXPECT(! d.seekable());
+    uint32_t samples = 0;
+    // the last frames end right at the end of the stream, the padding at the end is trimmed
+    uint32_t hash = decodeHash(d, 1000000, samples);
+    EXPECT(samples == BIRTHDAY_SAMPLES);
+    EXPECT(d.frames() == 7554);
+    EXPECT(d.frameErrors() == 0);
+    EXPECT(d.eof());
+    EXPECT(d.bytesRead() == 2175595);
+    MP3DecoderStream aligned{birthday(), 2};
+    EXPECT(decodeHash(aligned, 1000000, samples) == hash);
+}
+
+TEST(mp3, frameLength) {
+    // MPEG 1, 128kbps, 44.1kHz, no padding & padding
+    uint8_t h[] = { 0xff, 0xfb, 0x90, 0x00 };
+    EXPECT(MP3DecoderStream::frameLength(h) == 417);
+    h[2] = 0x92;
+    EXPECT(MP3DecoderStream::frameLength(h) == 418);
+    // MPEG 1, 320kbps, 32kHz, the largest frame
+    h[2] = 0xe8;
+    EXPECT(MP3DecoderStream::frameLength(h) == 1440);
+    // MPEG 2, 64kbps, 22.05kHz
+    h[1] = 0xf3;
+    h[2] = 0x80;
+    EXPECT(MP3DecoderStream::frameLength(h) == 208);
+    // free format
+    h[2] = 0x00;
+    EXPECT(MP3DecoderStream::frameLength(h) == MP3DecoderStream::TAIL_SIZE);
+    // invalid bitrate, invalid sample rate, layer II, no sync
+    h[2] = 0xf0;
+    EXPECT(MP3DecoderStream::frameLength(h) == 0);
+    h[2] = 0x0c;
+    EXPECT(MP3DecoderStream::frameLength(h) == 0);
+    h[1] = 0xfd;
+    h[2] = 0x90;
+    EXPECT(MP3DecoderStream::frameLength(h) == 0);
+    h[0] = 0x00;
+    EXPECT(MP3DecoderStream::frameLength(h) == 0);
+}
+
+TEST(mp3, seekTOC) {
+    MP3DecoderStream d{birthday(), 2};
+    EXPECT(d.seekable());
+    EXPECT(d.hasTOC());
+    EXPECT(d.seek(90000));
+    EXPECT(d.positionMs() == 90000);
+    uint32_t samples = 0;
+    decodeHash(d, 1000000, samples);
+    EXPECT(d.frameErrors() == 0);
+    // the table of contents is only approximate, the offsets are stored in 1/256ths of the file (~30 frames here)
+    EXPECT(samples + 90 * 48000 >= BIRTHDAY_SAMPLES - 32 * 1152);
+    EXPECT(samples + 90 * 48000 <= BIRTHDAY_SAMPLES + 32 * 1152);
+    // the table of contents does not need an index
+    EXPECT(! d.indexComplete());
+}
+
+TEST(mp3, seekIndex) {
+    // reference samples of frames 2503..2512, 3 frames after the seek target so that the bit reservoir and the overlap buffers are filled again
+    uint32_t samples = 0;
+    uint32_t expected;
+    {
+        MP3DecoderStream d{birthday(true), 2};
+        EXPECT(! d.hasTOC());
+        decodeHash(d, 2503, samples);
+        expected = decodeHash(d, 2513, samples, 10 * 1152);
+    }
+    MP3DecoderStream d{birthday(true), 2};
+    // without the table of contents the duration is estimated from the bitrate
+    EXPECT(d.durationMs() / 1000 == 181);
+    // the index is built while decoding, seeking shortly past the indexed part scans the frame headers from its end
+    decodeHash(d, 2200, samples);
+    uint32_t bytesRead = d.bytesRead();
+    EXPECT(d.seek(60000));
+    EXPECT(d.positionMs() == 60000);
+    EXPECT(d.bytesRead() - bytesRead < 128 * 1024);
+    EXPECT(! d.indexComplete());
+    decodeHash(d, 3, samples);
+    EXPECT(samples == 3 * 1152);
+    EXPECT(decodeHash(d, 10, samples, 10 * 1152) == expected);
+    // seeking back uses the index
+    bytesRead = d.bytesRead();
+    EXPECT(d.seek(60000));
+    decodeHash(d, 3, samples);
+    EXPECT(decodeHash(d, 10, samples, 10 * 1152) == expected);
+    EXPECT(d.bytesRead() - bytesRead < 64 * 1024);
+    // seeking far past the indexed part jumps to the estimated offset instead of reading the stream up to it
+    bytesRead = d.bytesRead();
+    EXPECT(d.seek(150000));
+    EXPECT(d.positionMs() == 150000);
+    EXPECT(d.bytesRead() - bytesRead < 64 * 1024);
+    decodeHash(d, 1000000, samples);
+    EXPECT(d.frameErrors() == 0);
+    // birthday.mp3 has constant bitrate, so the estimate is exact up to the frame the decoder resynchronizes on
+    EXPECT(samples + 150 * 48000 >= 7554 * 1152 - 2 * 1152);
+    EXPECT(samples + 150 * 48000 <= 7554 * 1152 + 2 * 1152);
+    // the frames after the jump are not known exactly, so they do not complete the index
+    EXPECT(! d.indexComplete());
+    // decoding the rest of the stream from the indexed part does
+    EXPECT(d.seek(60000));
+    decodeHash(d, 1000000, samples);
+    EXPECT(d.indexComplete());
+    EXPECT(d.durationMs() == 7554 * 1152 / 48);
+    // once complete, seeking past the end is exact
+    EXPECT(d.seek(1000000));
+    EXPECT(d.positionMs() == 7554 * 1152 / 48);
+    decodeHash(d, 1000000, samples);
+    EXPECT(samples == 0);
+}
+
+TEST(mp3, saveIndex) {
+    MemoryStream index = MemoryStream::withCapacity(1024);
+    {
+        MP3DecoderStream d{birthday(true), 2};
+        uint32_t samples = 0;
+        decodeHash(d, 1000000, samples);
+        // decoding the whole stream builds the index as well
+        EXPECT(d.indexComplete());
+        d.saveIndex(index);
+    }
+    uint32_t size = index.tell();
+    EXPECT(size == 20 + (7554 + 127) / 128 * 4);
+    MP3DecoderStream d{birthday(true), 2};
+    index.seek(0);
+    EXPECT(d.loadIndex(index));
+    EXPECT(d.indexComplete());
+    EXPECT(d.durationMs() == 7554 * 1152 / 48);
+    uint32_t bytesRead = d.bytesRead();
+    EXPECT(d.seek(169920));
+    EXPECT(d.positionMs() == 169920);
+    EXPECT(d.bytesRead() - bytesRead < 64 * 1024);
+    // truncated index is rejected
+    MP3DecoderStream d2{birthday(true), 2};
+    index.seek(0);
+    auto truncated = MemoryStream::withCapacity(size - 4);
+    uint8_t buffer[size - 4];
+    index.read(buffer, size - 4);
+    truncated.write(buffer, size - 4);
+    truncated.seek(0);
+    EXPECT(! d2.loadIndex(truncated));
+    EXPECT(! d2.indexComplete());
+}
+
+TEST(mp3, replayGain) {
+    // the tag of birthday.mp3 has a TXXX frame, but no ReplayGain
+    MP3DecoderStream d{birthday(), 2};
+    EXPECT(! d.replayGain().track.has_value() && ! d.replayGain().album.has_value());
+    // cover art larger than the ring buffer before the ReplayGain frames
+    MP3DecoderStream d4{withTag(id3(4, {
+        { "APIC", std::vector<uint8_t>(6000, 0x55) },
+        { "TXXX", txxx("replaygain_track_gain", "-7.25 dB") },
+        { "TXXX", txxx("REPLAYGAIN_ALBUM_GAIN", "+1.5 dB", 3) },
+    })), 2};
+    EXPECT(d4.sampleRate() == 48000);
+    EXPECT(d4.durationMs() == BIRTHDAY_SAMPLES / 48);
+    EXPECT(near(d4.replayGain().track, -7.25f));
+    EXPECT(near(d4.replayGain().album, 1.5f));
+    // ID3v2.3 frame sizes are not synchsafe, UTF-16 texts are ignored
+    MP3DecoderStream d3{withTag(id3(3, {
+        { "TXXX", txxx("REPLAYGAIN_TRACK_GAIN", "-3 dB", 1) },
+        { "COMM", std::vector<uint8_t>(200, 0x80) },
+        { "TXXX", txxx("REPLAYGAIN_ALBUM_GAIN", "-0.5 dB") },
+    })), 2};
+    EXPECT(d3.durationMs() == BIRTHDAY_SAMPLES / 48);
+    EXPECT(! d3.replayGain().track.has_value());
+    EXPECT(near(d3.replayGain().album, -0.5f));
+    // tag with padding only
+    MP3DecoderStream empty{withTag(id3(3, {})), 2};
+    EXPECT(empty.durationMs() == BIRTHDAY_SAMPLES / 48);
+    EXPECT(! empty.replayGain().track.has_value());
+    // radio gain of -6.5dB (set by the user) in the LAME tag, which is at offset 199
+    auto data = birthdayData(0, 20000);
+    data[199 + 15] = 0x2e;
+    data[199 + 16] = 65;
+    MP3DecoderStream lame{unique_ptr<RandomReadStream>{new MemoryStream{MemoryStream::copyOf(data.data(), static_cast<uint32_t>(data.size()))}}, 2};
+    EXPECT(near(lame.replayGain().track, -6.5f));
+    EXPECT(! lame.replayGain().album.has_value());
+    EXPECT(lame.durationMs() == BIRTHDAY_SAMPLES / 48);
+}
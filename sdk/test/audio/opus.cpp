@@ -0,0 +1,182 @@
+#include <cmath>
+
+#include <libopus/include/opus.h>
+
+#include <platform/tests.h>
+#include <rckid/audio/ogg.h>
+#include <rckid/audio/opus.h>
+
+#include "helpers.h"
+
+using namespace rckid;
+using namespace rckid::audio;
+using namespace rckid::audio::tests;
+
+namespace {
+
+    /** Writes the packet directly as Ogg pages of up to 16 segments, so that it can be larger than the OggWriter's page (such as comment headers with cover art). Page checksums are not calculated as the reader does not verify them.
+     */
+    void writeLargePacket(WriteStream & s, uint32_t serial, uint8_t const * data, uint32_t size) {
+        uint32_t sequence = 100;
+        bool continued = false;
+        while (true) {
+            uint8_t h[27 + 16] = { 'O', 'g', 'g', 'S', 0, static_cast<uint8_t>(continued ? OggReader::FLAG_CONTINUED : 0) };
+            for (uint32_t i = 0; i < 4; ++i) {
+                h[14 + i] = static_cast<uint8_t>(serial >> (i * 8));
+                h[18 + i] = static_cast<uint8_t>(sequence >> (i * 8));
+            }
+            uint32_t n = 0;
+            uint32_t bodySize = 0;
+            while (n < 16) {
+                uint8_t len = static_cast<uint8_t>(std::min<uint32_t>(size - bodySize, 255));
+                h[27 + n++] = len;
+                bodySize += len;
+                if (len < 255)
+                    break;
+            }
+            h[26] = static_cast<uint8_t>(n);
+            s.write(h, 27 + n);
+            s.write(data, bodySize);
+            data += bodySize;
+            size -= bodySize;
+            // the packet ends with a segment shorter than 255 bytes
+            if (h[27 + n - 1] < 255)
+                return;
+            continued = true;
+            ++sequence;
+        }
+    }
+
+    /** Encodes numFrames 20ms frames of a 440Hz mono sine wave as Ogg Opus and returns the encoded stream with the encoder's pre-skip. 
+     */
+    MemoryStream encodeSine(uint32_t numFrames, uint32_t & preSkip, uint32_t tagsSize = 16) {
+        int err;
+        OpusEncoder * enc = opus_encoder_create(48000, 1, OPUS_APPLICATION_AUDIO, & err);
+        opus_int32 lookahead = 0;
+        opus_encoder_ctl(enc, OPUS_GET_LOOKAHEAD(& lookahead));
+        preSkip = static_cast<uint32_t>(lookahead);
+        MemoryStream s{MemoryStream::withCapacity(64 * 1024)};
+        OggWriter ogg{s, 1234};
+        uint8_t head[19] = { 'O', 'p', 'u', 's', 'H', 'e', 'a', 'd', 1, 1, static_cast<uint8_t>(preSkip), static_cast<uint8_t>(preSkip >> 8), 0x80, 0xbb, 0, 0, 0, 0, 0 };
+        ogg.writePacket(head, sizeof(head), 0);
+        ogg.flush();
+        std::vector<uint8_t> tags(tagsSize);
+        memcpy(tags.data(), "OpusTags", 8);
+        writeLargePacket(s, 1234, tags.data(), tagsSize);
+        int16_t pcm[960];
+        uint8_t packet[1275];
+        for (uint32_t f = 0; f < numFrames; ++f) {
+            for (uint32_t i = 0; i < 960; ++i)
+                pcm[i] = static_cast<int16_t>(std::sin((f * 960 + i) * 2 * M_PI * 440 / 48000) * 10000);
+            int n = opus_encode(enc, pcm, 960, packet, sizeof(packet));
+            ogg.writePacket(packet, static_cast<uint32_t>(n), (f + 1) * 960);
+        }
+        ogg.flush(true);
+        opus_encoder_destroy(enc);
+        return written(s);
+    }
+}
+
+TEST(ogg, packets) {
+    MemoryStream s{MemoryStream::withCapacity(32 * 1024)};
+    OggWriter w{s, 7};
+    uint32_t sizes[] = { 1, 254, 255, 256, 1000, 4000, 510, 3000, 2 };
+    uint8_t data[4096];
+    for (uint32_t i = 0; i < sizeof(sizes) / sizeof(uint32_t); ++i) {
+        memset(data, static_cast<uint8_t>(i), sizes[i]);
+        w.writePacket(data, sizes[i], i);
+    }
+    w.flush(true);
+    MemoryStream in{written(s)};
+    OggReader r{in};
+    for (uint32_t i = 0; i < sizeof(sizes) / sizeof(uint32_t); ++i) {
+        EXPECT(r.nextPacket(data, sizeof(data)) == sizes[i]);
+        EXPECT(data[0] == i && data[sizes[i] - 1] == i);
+    }
+    EXPECT(r.serial() == 7);
+    EXPECT(r.granulePosition() == 8);
+    EXPECT(r.lastPage());
+    EXPECT(r.nextPacket(data, sizeof(data)) == 0);
+}
+
+TEST(ogg, skipLargePackets) {
+    MemoryStream s{MemoryStream::withCapacity(32 * 1024)};
+    OggWriter w{s, 7};
+    uint8_t data[2048] = {};
+    w.writePacket(data, 2000, 1);
+    w.writePacket(data, 100, 2);
+    w.flush(true);
+    MemoryStream in{written(s)};
+    OggReader r{in};
+    EXPECT(r.nextPacket(data, 1000) == 100);
+    EXPECT(r.granulePosition() == 2);
+}
+
+TEST(opus, decode) {
+    uint32_t preSkip = 0;
+    OpusDecoderStream d{unique_ptr<ReadStream>{new MemoryStream{encodeSine(50, preSkip)}}};
+    EXPECT(d.valid());
+    EXPECT(d.channels() == 1);
+    EXPECT(d.preSkip() == preSkip);
+    EXPECT(d.sampleRate() == 48000);
+    // the mono stream is decoded to stereo and should still be close to the original sine wave (the decoded samples are compared one buffer at a time as there is not enough heap for the whole second)
+    uint32_t total = 0;
+    bool stereoMatch = true;
+    double err = 0;
+    double energy = 0;
+    int16_t * buffer = nullptr;
+    uint32_t n = 0;
+    while (true) {
+        d.update();
+        d.callback(buffer, n);
+        if (buffer == nullptr)
+            break;
+        for (uint32_t i = 0; i < n; ++i, ++total) {
+            stereoMatch = stereoMatch && (buffer[i * 2] == buffer[i * 2 + 1]);
+            if (total < 9600 || total >= 40000)
+                continue;
+            double expected = std::sin(total * 2 * M_PI * 440 / 48000) * 10000;
+            err += (buffer[i * 2] - expected) * (buffer[i * 2] - expected);
+            energy += expected * expected;
+        }
+    }
+    EXPECT(d.packets() == 50);
+    EXPECT(d.packetErrors() == 0);
+    // 1 second of audio minus the encoder delay
+    EXPECT(total == 50 * 960 - preSkip);
+    EXPECT(stereoMatch);
+    EXPECT(err < energy / 10);
+}
+
+TEST(ogg, packetStart) {
+    MemoryStream s{MemoryStream::withCapacity(32 * 1024)};
+    uint8_t data[10000];
+    for (uint32_t i = 0; i < sizeof(data); ++i)
+        data[i] = static_cast<uint8_t>(i);
+    writeLargePacket(s, 7, data, sizeof(data));
+    OggWriter w{s, 7};
+    w.writePacket(data, 100, 2);
+    w.flush(true);
+    MemoryStream in{written(s)};
+    OggReader r{in};
+    uint8_t buffer[16] = {};
+    EXPECT(r.nextPacketStart(buffer, sizeof(buffer)) == sizeof(data));
+    EXPECT(memcmp(buffer, data, sizeof(buffer)) == 0);
+    EXPECT(r.nextPacketStart(buffer, sizeof(buffer)) == 100);
+    EXPECT(r.granulePosition() == 2);
+}
+
+TEST(opus, largeTags) {
+    uint32_t preSkip = 0;
+    OpusDecoderStream d{unique_ptr<ReadStream>{new MemoryStream{encodeSine(5, preSkip, 10000)}}};
+    EXPECT(d.valid());
+    EXPECT(d.preSkip() == preSkip);
+    EXPECT(decodeAll(d).size() == (5 * 960 - preSkip) * 2);
+    EXPECT(d.packets() == 5);
+}
+
+TEST(opus, invalidStream) {
+    uint8_t garbage[100] = { 'O', 'g', 'g' };
+    OpusDecoderStream d{unique_ptr<ReadStream>{new MemoryStream{MemoryStream::copyOf(garbage, sizeof(garbage))}}};
+    EXPECT(! d.valid());
+}
@@ -0,0 +1,127 @@
+#include <vector>
+
+#include <platform/tests.h>
+#include <rckid/audio/playback.h>
+
+using namespace rckid;
+using namespace rckid::audio;
+
+namespace {
+
+    /** Stream of stereo samples whose left value is the track number and right value the sample index within the track, decoded in small buffers so that the tracks span many of them.
+     */
+    class TrackStream : public DecoderStream {
+    public:
+        TrackStream(int16_t track, uint32_t samples, uint32_t sampleRate = 48000): DecoderStream{100, 4}, track_{track}, samples_{samples}, sampleRate_{sampleRate} {}
+
+        uint32_t sampleRate() const override { return sampleRate_; }
+
+    protected:
+        uint32_t refillSamples(int16_t * buffer, uint32_t numStereoSamples) override {
+            uint32_t n = std::min(numStereoSamples, samples_ - next_);
+            for (uint32_t i = 0; i < n; ++i) {
+                buffer[i * 2] = track_;
+                buffer[i * 2 + 1] = static_cast<int16_t>(next_ + i);
+            }
+            next_ += n;
+            return n;
+        }
+
+    private:
+        int16_t track_;
+        uint32_t samples_;
+        uint32_t sampleRate_;
+        uint32_t next_ = 0;
+    };
+
+    /** Playlist of tracks with the given sample rates, each having 1050 samples.
+     */
+    class TestPlaylist : public Playlist {
+    public:
+        TestPlaylist(std::vector<uint32_t> sampleRates): sampleRates_{std::move(sampleRates)} {}
+
+        unique_ptr<DecoderStream> next() override {
+            if (next_ >= sampleRates_.size())
+                return nullptr;
+            ++next_;
+            return unique_ptr<DecoderStream>{new TrackStream{static_cast<int16_t>(next_), 1050, sampleRates_[next_ - 1]}};
+        }
+
+        unique_ptr<DecoderStream> prev() override { return nullptr; }
+
+    private:
+        std::vector<uint32_t> sampleRates_;
+        uint32_t next_ = 0;
+    };
+
+    /** Playback whose audio output is a single buffer taken from the callback every tick, recording the samples played and how many times the output has been started.
+     */
+    class TestPlayback : public Playback {
+    public:
+        TestPlayback(Playlist * playlist): Playback{playlist} {}
+
+        std::vector<int16_t> samples;
+        uint32_t starts = 0;
+
+        void run(uint32_t ticks) {
+            for (uint32_t i = 0; i < ticks; ++i) {
+                onTick();
+                if (! playing_)
+                    continue;
+                callback(buffer_, numStereoSamples_);
+                if (buffer_ == nullptr)
+                    playing_ = false;
+                else
+                    samples.insert(samples.end(), buffer_, buffer_ + numStereoSamples_ * 2);
+            }
+        }
+
+    protected:
+        void startOutput([[maybe_unused]] uint32_t sampleRate) override {
+            ++starts;
+            playing_ = true;
+            buffer_ = nullptr;
+        }
+
+        void stopOutput() override {
+            playing_ = false;
+            buffer_ = nullptr;
+        }
+
+        bool outputPlaying() const override { return playing_; }
+
+    private:
+        bool playing_ = false;
+        int16_t * buffer_ = nullptr;
+        uint32_t numStereoSamples_ = 0;
+    };
+
+    /** Checks that the samples are the given tracks played completely one after another.
+     */
+    bool playedInOrder(std::vector<int16_t> const & samples, uint32_t numTracks) {
+        if (samples.size() != numTracks * 1050 * 2)
+            return false;
+        for (uint32_t i = 0; i < samples.size(); i += 2)
+            if (samples[i] != static_cast<int16_t>(i / 2 / 1050 + 1) || samples[i + 1] != static_cast<int16_t>(i / 2 % 1050))
+                return false;
+        return true;
+    }
+}
+
+TEST(playback, gapless) {
+    // the output is started once and the tracks follow each other without being restarted at any of the boundaries
+    TestPlaylist playlist{{48000, 48000, 48000, 48000}};
+    TestPlayback p{&playlist};
+    p.run(1000);
+    EXPECT(p.starts == 1);
+    EXPECT(playedInOrder(p.samples, 4));
+}
+
+TEST(playback, sampleRateChange) {
+    // the output has to be restarted for the track with different sample rate, the tracks around it are still gapless
+    TestPlaylist playlist{{48000, 48000, 44100, 44100}};
+    TestPlayback p{&playlist};
+    p.run(1000);
+    EXPECT(p.starts == 2);
+    EXPECT(playedInOrder(p.samples, 4));
+}
@@ -0,0 +1,132 @@
+#include <cmath>
+
+#include <platform/tests.h>
+#include <rckid/audio/resampler.h>
+
+#include "helpers.h"
+
+using namespace rckid;
+using namespace rckid::audio;
+using namespace rckid::audio::tests;
+
+namespace {
+
+    /** Sine wave of the given frequency, the same on both channels unless the right channel is inverted.
+     */
+    class SineStream : public DecoderStream {
+    public:
+        SineStream(uint32_t sampleRate, float frequency, uint32_t samples, int16_t amplitude = 16000):
+            DecoderStream{300, 4}, sampleRate_{sampleRate}, frequency_{frequency}, samples_{samples}, amplitude_{amplitude} {}
+
+        uint32_t sampleRate() const override { return sampleRate_; }
+
+    protected:
+        uint32_t refillSamples(int16_t * buffer, uint32_t numStereoSamples) override {
+            uint32_t n = std::min(numStereoSamples, samples_ - next_);
+            for (uint32_t i = 0; i < n; ++i) {
+                double t = static_cast<double>(next_ + i) / sampleRate_;
+                int16_t x = static_cast<int16_t>(std::lround(sin(2 * M_PI * frequency_ * t) * amplitude_));
+                buffer[i * 2] = x;
+                buffer[i * 2 + 1] = static_cast<int16_t>(-x);
+            }
+            next_ += n;
+            return n;
+        }
+
+    private:
+        uint32_t sampleRate_;
+        float frequency_;
+        uint32_t samples_;
+        int16_t amplitude_;
+        uint32_t next_ = 0;
+    };
+
+    /** Resamples one second of a sine wave and returns the peak amplitude of the left channel relative to the input, measured as RMS over the middle of the output so that the filter's start and end do not matter. Aliases are included as they may be at any frequency.
+     */
+    double gain(uint32_t from, uint32_t to, float frequency) {
+        ResamplingStream r{unique_ptr<DecoderStream>{new SineStream{from, frequency, from}}, to};
+        double sum = 0;
+        uint32_t n = 0;
+        uint32_t i = 0;
+        int16_t * buffer = nullptr;
+        uint32_t size = 0;
+        while (true) {
+            r.update();
+            r.callback(buffer, size);
+            if (buffer == nullptr)
+                break;
+            for (uint32_t j = 0; j < size; ++j, ++i) {
+                if (i >= to / 4 && i < to * 3 / 4) {
+                    sum += static_cast<double>(buffer[j * 2]) * buffer[j * 2];
+                    ++n;
+                }
+            }
+        }
+        return sqrt(sum / n) * sqrt(2.0) / 16000;
+    }
+
+    uint32_t samples(DecoderStream & d) {
+        uint32_t result = 0;
+        int16_t * buffer = nullptr;
+        uint32_t n = 0;
+        while (true) {
+            d.update();
+            d.callback(buffer, n);
+            if (buffer == nullptr)
+                return result;
+            result += n;
+        }
+    }
+
+    double dB(double gain) { return 20 * log10(gain); }
+}
+
+TEST(resampler, passthrough) {
+    ResamplingStream r{unique_ptr<DecoderStream>{new SineStream{8000, 440, 1000}}, 8000};
+    SineStream ref{8000, 440, 1000};
+    std::vector<int16_t> s = decodeAll(r);
+    EXPECT(s == decodeAll(ref));
+}
+
+TEST(resampler, length) {
+    // the whole input is played, including the samples delayed by the filter
+    ResamplingStream up{unique_ptr<DecoderStream>{new SineStream{8000, 440, 8000}}, 44100};
+    EXPECT(up.taps() == ResamplingStream::TAPS);
+    uint32_t n = samples(up);
+    EXPECT(n >= 44100 && n <= 44100 + 44100 / 8000 * up.taps());
+    ResamplingStream down{unique_ptr<DecoderStream>{new SineStream{48000, 440, 48000}}, 8000};
+    EXPECT(down.taps() == ResamplingStream::MAX_TAPS);
+    n = samples(down);
+    EXPECT(n >= 8000 && n <= 8000 + down.taps() / 6);
+}
+
+TEST(resampler, dc) {
+    // every phase has unity gain at DC
+    for (uint32_t from : { 8000, 32768, 48000 }) {
+        ResamplingStream r{unique_ptr<DecoderStream>{new SineStream{from, 0, 1}}, 44100};
+        for (uint32_t p = 0; p < ResamplingStream::PHASES; ++p) {
+            int32_t sum = 0;
+            for (uint32_t t = 0; t < r.taps(); ++t)
+                sum += r.coefficients(p)[t];
+            EXPECT(sum >= 32768 - 16 && sum <= 32768 + 16);
+        }
+    }
+}
+
+/** Frequency response of the common conversions. The passband is flat up to ~70% of the lower Nyquist frequency and the frequencies above the output Nyquist frequency, which would alias, are attenuated.
+ */
+TEST(resampler, frequencyResponse) {
+    for (auto [from, to] : { std::pair<uint32_t, uint32_t>{8000, 44100}, {32768, 44100}, {44100, 48000}, {48000, 44100}, {48000, 8000}, {44100, 22050} }) {
+        uint32_t nyquist = std::min(from, to) / 2;
+        for (uint32_t f = nyquist / 10; f < nyquist * 7 / 10; f += nyquist / 10) {
+            double g = gain(from, to, static_cast<float>(f));
+            EXPECT(dB(g) > -1.0 && dB(g) < 0.5);
+        }
+        if (from > to) {
+            for (uint32_t f = nyquist * 13 / 10; f < from / 2; f += nyquist / 2) {
+                double g = gain(from, to, static_cast<float>(f));
+                EXPECT(dB(g) < -40);
+            }
+        }
+    }
+}
@@ -49,3 +49,70 @@ TEST(filesystem, pathRoot) {
     EXPECT(fs::root("/foo") == "/foo");
     EXPECT(fs::root("") == "");
 }
+
+namespace {
+
+    /** Folder reader over numbered entries that counts the entries read, or skipped, to check how much of the folder is read for each entry.
+     */
+    class CountingFolderReader : public rckid::fs::FolderReader {
+    public:
+        CountingFolderReader(uint32_t n): n_{n} {}
+
+        uint32_t reads = 0;
+        uint32_t checkpoints = 0;
+        bool checkpointsInPlace = true;
+
+    protected:
+
+        void rewind() override { i_ = 0; }
+
+        bool next(rckid::fs::FolderEntry * entry) override {
+            if (i_ >= n_)
+                return false;
+            ++reads;
+            if (entry != nullptr)
+                entry->size = i_;
+            ++i_;
+            return true;
+        }
+
+        void saveCheckpoint(uint32_t index) override {
+            ++checkpoints;
+            checkpointsInPlace = checkpointsInPlace && index == checkpoints && i_ == index * CHECKPOINT_INTERVAL;
+        }
+
+        void restoreCheckpoint(uint32_t index) override { i_ = index * CHECKPOINT_INTERVAL; }
+
+    private:
+        uint32_t n_;
+        uint32_t i_ = 0;
+    };
+}
+
+TEST(filesystem, folderReader) {
+    using namespace rckid;
+    Heap::UseAndReserveGuard g_;
+    CountingFolderReader reader{1000};
+    fs::FolderEntry entry;
+    // nothing is read until asked for
+    EXPECT(reader.reads == 0);
+    EXPECT(reader.entryAt(500, entry) && entry.size == 500);
+    EXPECT(reader.reads == 501);
+    EXPECT(reader.checkpoints == 500 / fs::FolderReader::CHECKPOINT_INTERVAL && reader.checkpointsInPlace);
+    // going back only reads from the closest checkpoint
+    for (uint32_t i = 499; i > 400; --i) {
+        reader.reads = 0;
+        EXPECT(reader.entryAt(i, entry) && entry.size == i);
+        EXPECT(reader.reads <= fs::FolderReader::CHECKPOINT_INTERVAL);
+    }
+    reader.reads = 0;
+    EXPECT(reader.entryAt(402, entry) && entry.size == 402);
+    EXPECT(reader.reads == 1);
+    EXPECT(reader.size() == 1000);
+    EXPECT(! reader.entryAt(1000, entry));
+    reader.reads = 0;
+    EXPECT(reader.entryAt(999, entry) && entry.size == 999);
+    EXPECT(reader.reads <= fs::FolderReader::CHECKPOINT_INTERVAL);
+    EXPECT(reader.entryAt(3, entry) && entry.size == 3);
+    EXPECT(reader.checkpoints == 999 / fs::FolderReader::CHECKPOINT_INTERVAL && reader.checkpointsInPlace);
+}
@@ -0,0 +1,177 @@
+#include <platform/tests.h>
+
+#include <rckid/graphics/canvas.h>
+#include <assets/Iosevka16.h>
+
+using namespace rckid;
+
+namespace {
+
+    uint32_t countPixels(Canvas const & c, uint16_t color) {
+        uint32_t result = 0;
+        for (Coord x = 0; x < c.width(); ++x)
+            for (Coord y = 0; y < c.height(); ++y)
+                if (c.getPixel(x, y) == color)
+                    ++result;
+        return result;
+    }
+
+    bool checkRect(Canvas const & c, Rect r, uint16_t inside, uint16_t outside) {
+        for (Coord x = 0; x < c.width(); ++x)
+            for (Coord y = 0; y < c.height(); ++y) {
+                bool in = x >= r.left() && x < r.right() && y >= r.top() && y < r.bottom();
+                if (c.getPixel(x, y) != (in ? inside : outside))
+                    return false;
+            }
+        return true;
+    }
+}
+
+TEST(canvas, fillRGB565) {
+    Canvas c{8, 6};
+    c.fill(0);
+    EXPECT(checkRect(c, Rect{}, 1, 0));
+    c.fill(Rect::XYWH(2, 1, 3, 4), 0xf800);
+    EXPECT(checkRect(c, Rect::XYWH(2, 1, 3, 4), 0xf800, 0));
+    c.fill(Rect::XYWH(-5, -5, 100, 100), 0x1234);
+    EXPECT(countPixels(c, 0x1234) == 48);
+}
+
+TEST(canvas, fillRGB332) {
+    Canvas c{5, 5, Color::Representation::RGB332};
+    c.fill(0);
+    c.fill(Rect::XYWH(1, 0, 2, 5), 0xe0);
+    EXPECT(checkRect(c, Rect::XYWH(1, 0, 2, 5), 0xe0, 0));
+}
+
+TEST(canvas, fillIndex16) {
+    // odd height so that columns start at both nibbles
+    Canvas c{4, 5, Color::Representation::Index16};
+    c.fill(0);
+    c.fill(Rect::XYWH(0, 1, 4, 3), 7);
+    EXPECT(checkRect(c, Rect::XYWH(0, 1, 4, 3), 7, 0));
+    c.fill(Rect::XYWH(1, 0, 2, 5), 3);
+    EXPECT(countPixels(c, 3) == 10);
+    EXPECT(countPixels(c, 7) == 6);
+    EXPECT(c.getPixel(0, 0) == 0);
+    EXPECT(c.getPixel(3, 4) == 0);
+}
+
+TEST(canvas, lines) {
+    Canvas c{10, 10, Color::Representation::Index256};
+    c.fill(0);
+    c.drawLine(Point{0, 0}, Point{9, 9}, 1);
+    EXPECT(countPixels(c, 1) == 10);
+    for (Coord i = 0; i < 10; ++i)
+        EXPECT(c.getPixel(i, i) == 1);
+    c.fill(0);
+    // steep line, merged into vertical spans
+    c.drawLine(Point{2, 0}, Point{4, 9}, 2);
+    EXPECT(countPixels(c, 2) == 10);
+    EXPECT(c.getPixel(2, 0) == 2);
+    EXPECT(c.getPixel(4, 9) == 2);
+    c.fill(0);
+    c.drawLine(Point{-5, 3}, Point{20, 3}, 3);
+    EXPECT(checkRect(c, Rect::XYWH(0, 3, 10, 1), 3, 0));
+}
+
+TEST(canvas, drawRect) {
+    Canvas c{10, 10, Color::Representation::Index256};
+    c.fill(0);
+    c.drawRect(Rect::XYWH(1, 1, 5, 4), 1);
+    EXPECT(countPixels(c, 1) == 14);
+    EXPECT(c.getPixel(1, 1) == 1);
+    EXPECT(c.getPixel(5, 4) == 1);
+    EXPECT(c.getPixel(2, 2) == 0);
+}
+
+TEST(canvas, circles) {
+    Canvas c{21, 21, Color::Representation::Index256};
+    c.fill(0);
+    c.fillCircle(Point{10, 10}, 5, 1);
+    EXPECT(c.getPixel(10, 10) == 1);
+    EXPECT(c.getPixel(15, 10) == 1);
+    EXPECT(c.getPixel(10, 5) == 1);
+    EXPECT(c.getPixel(16, 10) == 0);
+    EXPECT(c.getPixel(14, 14) == 0);
+    c.fill(0);
+    c.drawCircle(Point{10, 10}, 5, 2);
+    EXPECT(c.getPixel(15, 10) == 2);
+    EXPECT(c.getPixel(5, 10) == 2);
+    EXPECT(c.getPixel(10, 10) == 0);
+}
+
+TEST(canvas, fillPolygon) {
+    Canvas c{10, 10, Color::Representation::Index256};
+    c.fill(0);
+    Point square[] = { {2, 2}, {6, 2}, {6, 6}, {2, 6} };
+    c.fillPolygon(square, 4, 1);
+    EXPECT(checkRect(c, Rect::XYWH(2, 2, 4, 5), 1, 0));
+    c.fill(0);
+    Point triangle[] = { {0, 0}, {8, 0}, {0, 8} };
+    c.fillPolygon(triangle, 3, 1);
+    EXPECT(c.getPixel(0, 0) == 1);
+    EXPECT(c.getPixel(1, 6) == 1);
+    EXPECT(c.getPixel(7, 7) == 0);
+    // too many points are not drawn
+    Point many[Canvas::MAX_POLYGON_POINTS + 1];
+    for (uint32_t i = 0; i < Canvas::MAX_POLYGON_POINTS + 1; ++i)
+        many[i] = Point{static_cast<Coord>(i % 2 ? 9 : 0), static_cast<Coord>(i % 10)};
+    c.fill(0);
+    c.fillPolygon(many, Canvas::MAX_POLYGON_POINTS + 1, 1);
+    EXPECT(countPixels(c, 1) == 0);
+}
+
+TEST(canvas, blit) {
+    Canvas src{3, 3, Color::Representation::Index256};
+    src.fill(5);
+    src.setPixel(1, 1, 0);
+    Canvas c{6, 6, Color::Representation::Index256};
+    c.fill(1);
+    c.blit(Point{4, 4}, src);
+    EXPECT(countPixels(c, 5) == 3);
+    EXPECT(c.getPixel(5, 5) == 0);
+    c.fill(1);
+    c.blit(Point{1, 1}, src, Rect::WH(3, 3), 0);
+    EXPECT(countPixels(c, 5) == 8);
+    EXPECT(c.getPixel(2, 2) == 1);
+}
+
+TEST(canvas, blitIndex16Unaligned) {
+    Canvas src{2, 3, Color::Representation::Index16};
+    src.fill(0);
+    src.fill(Rect::XYWH(0, 0, 2, 3), 9);
+    Canvas c{4, 4, Color::Representation::Index16};
+    c.fill(2);
+    c.blit(Point{1, 1}, src);
+    EXPECT(checkRect(c, Rect::XYWH(1, 1, 2, 3), 9, 2));
+}
+
+TEST(canvas, blitRGBToIndexed) {
+    Canvas src{2, 2, Color::Representation::RGB565};
+    src.fill(Color::RGB(255, 0, 0).toRGB565());
+    src.setPixel(1, 1, Color::RGB(0, 250, 0).toRGB565());
+    Canvas c{4, 4, Color::Representation::Index256};
+    unique_ptr<Color::RGB565> palette{new Color::RGB565[256]};
+    for (uint32_t i = 0; i < 256; ++i)
+        palette.get()[i] = Color::RGB(0, 0, 0).toRGB565();
+    palette.get()[1] = Color::RGB(255, 0, 0).toRGB565();
+    palette.get()[2] = Color::RGB(0, 255, 0).toRGB565();
+    c.setPalette(std::move(palette));
+    c.fill(0);
+    c.blit(Point{1, 1}, src);
+    EXPECT(countPixels(c, 1) == 3);
+    EXPECT(c.getPixel(2, 2) == 2);
+}
+
+TEST(canvas, text) {
+    Canvas c{40, 20, Color::Representation::Index256};
+    c.fill(0);
+    c.text(0, 0, assets::Iosevka16, static_cast<uint16_t>(7)) << "A";
+    uint32_t n = countPixels(c, 7);
+    EXPECT(n > 0);
+    EXPECT(n + countPixels(c, 0) == 40 * 20);
+    // clipped text must not crash
+    c.text(35, 15, assets::Iosevka16, static_cast<uint16_t>(7)) << "Hello";
+    c.text(-10, -10, assets::Iosevka16, static_cast<uint16_t>(7)) << "Hello";
+}
@@ -0,0 +1,106 @@
+#include <platform/tests.h>
+
+#include <rckid/graphics/font.h>
+#include <rckid/graphics/glyph_run.h>
+#include <assets/Iosevka16.h>
+
+using namespace rckid;
+
+namespace {
+
+    /** Font without pixels where the advance of each glyph is its index + 1, so that the glyphs can be told apart. Covers ASCII digits, Czech letters with caron and the euro sign, question mark is the fallback.
+     */
+    constexpr GlyphInfo glyphs[] = {
+        GlyphInfo{0, 1, 0, 0, 0, 0}, // '0'
+        GlyphInfo{0, 2, 0, 0, 0, 0}, // '1'
+        GlyphInfo{0, 3, 0, 0, 0, 0}, // '?'
+        GlyphInfo{0, 4, 0, 0, 0, 0}, // U+010C
+        GlyphInfo{0, 5, 0, 0, 0, 0}, // U+010D
+        GlyphInfo{0, 6, 0, 0, 0, 0}, // U+017E
+        GlyphInfo{0, 7, 0, 0, 0, 0}, // U+20AC
+    };
+
+    constexpr GlyphRange ranges[] = {
+        GlyphRange{'0', 2, 0},
+        GlyphRange{'?', 1, 2},
+        GlyphRange{0x10c, 2, 3},
+        GlyphRange{0x17e, 1, 5},
+        GlyphRange{0x20ac, 1, 6},
+    };
+
+    constexpr FontData sparse{8, 7, glyphs, nullptr, 5, ranges, 2};
+
+    /** Kerning pairs for the sparse font, sorted by the glyph indices: "01" is tighter, "1?" and "1€" are looser.
+     */
+    constexpr KerningPair kerning[] = {
+        KerningPair{0, 1, -1},
+        KerningPair{1, 2, 2},
+        KerningPair{1, 6, 1},
+    };
+
+    constexpr FontData kerned{8, 7, glyphs, nullptr, 5, ranges, 2, 3, kerning};
+}
+
+TEST(font, sparseGlyphs) {
+    EXPECT(sparse.glyphInfoFor('0')->advanceX == 1);
+    EXPECT(sparse.glyphInfoFor('1')->advanceX == 2);
+    EXPECT(sparse.glyphInfoFor('?')->advanceX == 3);
+    EXPECT(sparse.glyphInfoFor(0x10c)->advanceX == 4);
+    EXPECT(sparse.glyphInfoFor(0x10d)->advanceX == 5);
+    EXPECT(sparse.glyphInfoFor(0x17e)->advanceX == 6);
+    EXPECT(sparse.glyphInfoFor(0x20ac)->advanceX == 7);
+    // missing codepoints, including those between and after the ranges use the fallback glyph
+    EXPECT(sparse.glyphInfoFor('2')->advanceX == 3);
+    EXPECT(sparse.glyphInfoFor(0x10e)->advanceX == 3);
+    EXPECT(sparse.glyphInfoFor(0x1f600)->advanceX == 3);
+    EXPECT(sparse.glyphInfoFor(0)->advanceX == 3);
+}
+
+TEST(font, textWidthUTF8) {
+    // "0č1€" 
+    EXPECT(sparse.textWidth("0\xc4\x8d" "1\xe2\x82\xac") == 1 + 5 + 2 + 7);
+    // ascii fonts render anything outside of the printable range as question mark, one per codepoint, except for latin letters that use their base letter
+    Coord q = assets::Iosevka16.glyphInfoFor('?')->advanceX;
+    EXPECT(assets::Iosevka16.textWidth("\xe2\x82\xac\xe2\x82\xac") == 2 * q);
+    EXPECT(assets::Iosevka16.glyphInfoFor(0x17e) == assets::Iosevka16.glyphInfoFor('z'));
+    EXPECT(assets::Iosevka16.glyphInfoFor(0xc1) == assets::Iosevka16.glyphInfoFor('A'));
+    EXPECT(assets::Iosevka16.glyphInfoFor(0xf7) == assets::Iosevka16.glyphInfoFor('?'));
+    EXPECT(assets::Iosevka16.glyphInfoFor(10) == assets::Iosevka16.glyphInfoFor('?'));
+    EXPECT(assets::Iosevka16.glyphInfoFor('A') == & assets::Iosevka16.glyphs['A' - 32]);
+}
+
+TEST(font, kerning) {
+    EXPECT(kerned.kerning(& glyphs[0], & glyphs[1]) == -1);
+    EXPECT(kerned.kerning(& glyphs[1], & glyphs[2]) == 2);
+    EXPECT(kerned.kerning(& glyphs[1], & glyphs[6]) == 1);
+    EXPECT(kerned.kerning(& glyphs[1], & glyphs[0]) == 0);
+    EXPECT(kerned.kerning(nullptr, & glyphs[0]) == 0);
+    EXPECT(sparse.kerning(& glyphs[0], & glyphs[1]) == 0);
+    EXPECT(kerned.textWidth("01") == 1 + 2 - 1);
+    EXPECT(kerned.textWidth("01?1") == 1 + 2 - 1 + 3 + 2 + 2);
+}
+
+TEST(font, glyphRun) {
+    // "0č1€"
+    GlyphRun run{Font{kerned}, "0\xc4\x8d" "1\xe2\x82\xac"};
+    EXPECT(run.size() == 4);
+    EXPECT(run.glyph(1) == & glyphs[4]);
+    EXPECT(run.x(0) == 0);
+    EXPECT(run.x(1) == 1);
+    EXPECT(run.x(2) == 6);
+    EXPECT(run.x(3) == 9);
+    EXPECT(run.right(3) == 16);
+    EXPECT(run.width() == kerned.textWidth("0\xc4\x8d" "1\xe2\x82\xac"));
+    EXPECT(run.indexAt(-1) == 4);
+    EXPECT(run.indexAt(0) == 0);
+    EXPECT(run.indexAt(1) == 1);
+    EXPECT(run.indexAt(5) == 1);
+    EXPECT(run.indexAt(8) == 2);
+    EXPECT(run.indexAt(9) == 3);
+    EXPECT(run.indexAt(15) == 3);
+    EXPECT(run.indexAt(16) == 4);
+    run.shape(Font{kerned}, "");
+    EXPECT(run.empty());
+    EXPECT(run.width() == 0);
+    EXPECT(run.indexAt(0) == 0);
+}
@@ -0,0 +1,94 @@
+#include <platform/tests.h>
+
+#include <rckid/graphics/canvas.h>
+#include <rckid/graphics/palette.h>
+
+using namespace rckid;
+
+namespace {
+
+    Palette testPalette() {
+        Palette p{16};
+        for (uint32_t i = 0; i < 16; ++i)
+            p.setColor(i, Color::RGB565{static_cast<uint16_t>(i + 1)});
+        return p;
+    }
+}
+
+TEST(palette, rotate) {
+    Palette p = testPalette();
+    p.rotate(4, 4);
+    EXPECT(p[4] == 8);
+    EXPECT(p[5] == 5);
+    EXPECT(p[7] == 7);
+    EXPECT(p[3] == 4);
+    EXPECT(p[8] == 9);
+    p.rotate(4, 4, -1);
+    for (uint32_t i = 0; i < 16; ++i)
+        EXPECT(p[i] == i + 1);
+    // full cycle is identity
+    p.rotate(0, 16, 16);
+    EXPECT(p[0] == 1);
+    // rotations change the base colors as well so that fades keep the cycle
+    p.rotate(0, 2);
+    EXPECT(p.base(0) == 2);
+}
+
+TEST(palette, fadeAndReset) {
+    Palette p{4};
+    p.setColor(0, Color::White().toRGB565());
+    p.setColor(1, Color::Red().toRGB565());
+    p.fade(Color::Black(), 0);
+    EXPECT(p[0] == Color::White().toRGB565());
+    p.fade(Color::Black(), 255);
+    EXPECT(p[0] == Color::Black().toRGB565());
+    EXPECT(p[1] == Color::Black().toRGB565());
+    EXPECT(p.base(1) == Color::Red().toRGB565());
+    p.fade(Color::Black(), 128);
+    EXPECT(Color{p[0]}.r < 200 && Color{p[0]}.r > 50);
+    p.reset();
+    EXPECT(p[0] == Color::White().toRGB565());
+    p.setOverride(1, Color::Blue().toRGB565());
+    EXPECT(p[1] == Color::Blue().toRGB565());
+    EXPECT(p.base(1) == Color::Red().toRGB565());
+}
+
+TEST(palette, fadeToPalette) {
+    Palette day = testPalette();
+    Palette night{16};
+    night.setColor(0, Color::Blue().toRGB565());
+    day.fade(night, 255);
+    EXPECT(day[0] == Color::Blue().toRGB565());
+    EXPECT(day[1] == 0);
+    day.fade(night, 0);
+    EXPECT(day[1] == 2);
+}
+
+TEST(palette, bitmapOverride) {
+    Bitmap bmp{2, 2, Color::Representation::Index16};
+    Palette own = testPalette();
+    bmp.setPalette(immutable_ptr<Color::RGB565>{new Color::RGB565[16], 16});
+    memcpy(const_cast<Color::RGB565 *>(bmp.palette()), own.colors(), 16 * sizeof(Color::RGB565));
+    bmp.setTransparentColor(std::nullopt);
+    bmp.setPixel(0, 0, 3);
+    bmp.setPixel(0, 1, 4);
+    Color::RGB565 buffer[2];
+    bmp.renderColumn(0, 0, buffer, 2);
+    EXPECT(buffer[0] == 4);
+    EXPECT(buffer[1] == 5);
+    // rotate the animated palette, the bitmap pixels stay the same
+    Palette anim = testPalette();
+    bmp.setPaletteOverride(anim);
+    anim.rotate(3, 2);
+    bmp.renderColumn(0, 0, buffer, 2);
+    EXPECT(buffer[0] == 5);
+    EXPECT(buffer[1] == 4);
+    // blitting to canvas uses the override as well
+    Canvas c{2, 2};
+    c.fill(0);
+    c.blit(Point{0, 0}, bmp);
+    EXPECT(c.getPixel(0, 0) == 5);
+    bmp.setPaletteOverride(nullptr);
+    bmp.renderColumn(0, 0, buffer, 2);
+    EXPECT(buffer[0] == 4);
+}
@@ -0,0 +1,124 @@
+#include <platform/tests.h>
+
+#include <rckid/graphics/qoi.h>
+
+using namespace rckid;
+
+namespace {
+
+    /** Creates bitmap with runs, small and large color differences so that all QOI ops are used.
+     */
+    Bitmap testBitmap() {
+        Bitmap bmp{7, 5, Color::Representation::RGB565};
+        for (Coord x = 0; x < 7; ++x) {
+            for (Coord y = 0; y < 5; ++y) {
+                Color c = Color::White();
+                if (y == 1)
+                    c = Color::RGB(static_cast<uint8_t>(x * 8), 100, 100);
+                else if (y == 2)
+                    c = Color::RGB(static_cast<uint8_t>(x * 40), static_cast<uint8_t>(255 - x * 30), static_cast<uint8_t>(x * 13));
+                else if (y == 3)
+                    c = (x % 2) ? Color::Red() : Color::Blue();
+                bmp.setPixel(x, y, c.toRGB565());
+            }
+        }
+        bmp.setPixel(3, 4, 0);
+        return bmp;
+    }
+
+    unique_ptr<RandomReadStream> encode(Bitmap const & bmp) {
+        MemoryStream * s = new MemoryStream{MemoryStream::withCapacity(1024)};
+        QOIEncoder::encode(bmp, *s);
+        s->seek(0);
+        return unique_ptr<RandomReadStream>{s};
+    }
+}
+
+TEST(qoi, roundtripRGB565) {
+    Bitmap bmp = testBitmap();
+    QOIImageDecoder dec{encode(bmp)};
+    EXPECT(dec.good());
+    EXPECT(dec.width() == 7);
+    EXPECT(dec.height() == 5);
+    Bitmap result = dec.decode();
+    for (Coord x = 0; x < 7; ++x)
+        for (Coord y = 0; y < 5; ++y)
+            EXPECT(result.getPixel(x, y) == bmp.getPixel(x, y));
+}
+
+TEST(qoi, roundtripIndexed) {
+    Bitmap bmp = testBitmap();
+    QOIImageDecoder dec{encode(bmp), Color::Representation::Index256};
+    Bitmap result = dec.decode();
+    EXPECT(result.colorRepresentation() == Color::Representation::Index256);
+    EXPECT(result.palette() != nullptr);
+    for (Coord x = 0; x < 7; ++x)
+        for (Coord y = 0; y < 5; ++y)
+            EXPECT(result.palette()[result.getPixel(x, y)] == bmp.getPixel(x, y));
+}
+
+TEST(qoi, decodeIndex16ClosestColors) {
+    Bitmap bmp = testBitmap();
+    QOIImageDecoder dec{encode(bmp), Color::Representation::Index16};
+    Bitmap result = dec.decode();
+    // the first 16 colors are exact, red comes after the palette is full and is mapped to the closest entry
+    EXPECT(result.palette()[result.getPixel(0, 0)] == Color::White().toRGB565());
+    EXPECT(result.palette()[result.getPixel(6, 2)] == bmp.getPixel(6, 2));
+    Color::RGB565 red = result.palette()[result.getPixel(1, 3)];
+    EXPECT(red.r() > 128 && red.b() < 128);
+}
+
+TEST(qoi, imageSource) {
+    Bitmap bmp = testBitmap();
+    unique_ptr<RandomReadStream> s = encode(bmp);
+    uint32_t size = s->size();
+    uint8_t * data = new uint8_t[size];
+    s->read(data, size);
+    ImageSource src{immutable_ptr<uint8_t>{data, size}};
+    EXPECT(src.getImageType() == ImageSource::ImageType::QOI);
+    Bitmap result{std::move(src)};
+    EXPECT(result.width() == 7);
+    EXPECT(result.getPixel(6, 2) == bmp.getPixel(6, 2));
+}
+
+TEST(qoi, decodeRows) {
+    Bitmap bmp = testBitmap();
+    Color::Representation reps[] = { Color::Representation::RGB565, Color::Representation::Index16 };
+    for (Color::Representation rep : reps) {
+        Bitmap whole = QOIImageDecoder{encode(bmp), rep}.decode();
+        QOIImageDecoder dec{encode(bmp), rep};
+        Bitmap result;
+        EXPECT(! dec.decodeRows(result, 2));
+        EXPECT(result.width() == 7 && result.height() == 5);
+        EXPECT(! dec.decodeRows(result, 2));
+        EXPECT(dec.decodeRows(result, 2));
+        for (Coord x = 0; x < 7; ++x)
+            for (Coord y = 0; y < 5; ++y)
+                EXPECT(result.palette() == nullptr ? result.getPixel(x, y) == whole.getPixel(x, y) : result.palette()[result.getPixel(x, y)] == whole.palette()[whole.getPixel(x, y)]);
+    }
+}
+
+TEST(qoi, invalidHeader) {
+    uint8_t data[] = { 'q', 'o', 'i', 'x', 0, 0, 0, 2, 0, 0, 0, 2, 3, 0, 0xfe, 0, 0, 0 };
+    QOIImageDecoder bad{unique_ptr<RandomReadStream>{new MemoryStream{MemoryStream::copyOf(data, sizeof(data))}}};
+    EXPECT(! bad.good());
+    EXPECT(bad.decode().empty());
+    Bitmap result;
+    EXPECT(bad.decodeRows(result, 1));
+    EXPECT(result.empty());
+    // width too large for any bitmap
+    data[3] = 'f';
+    data[4] = 0x7f;
+    QOIImageDecoder large{unique_ptr<RandomReadStream>{new MemoryStream{MemoryStream::copyOf(data, sizeof(data))}}};
+    EXPECT(! large.good());
+    EXPECT(large.decode().empty());
+}
+
+TEST(qoi, decodeRowsMismatchedBitmap) {
+    Bitmap bmp = testBitmap();
+    QOIImageDecoder dec{encode(bmp)};
+    Bitmap other{3, 3, Color::Representation::RGB565};
+    other.setPixel(0, 0, 1);
+    EXPECT(dec.decodeRows(other, 5));
+    EXPECT(other.width() == 3 && other.getPixel(0, 0) == 1);
+}
@@ -0,0 +1,150 @@
+#include <platform/tests.h>
+
+#include <vector>
+
+#include <rckid/graphics/screen_capture.h>
+#include <rckid/graphics/qoi.h>
+
+using namespace rckid;
+
+namespace {
+
+    /** Write stream that appends to a vector owned by the test, so that the data survive the capture task.
+     */
+    class VectorStream : public WriteStream {
+    public:
+        VectorStream(std::vector<uint8_t> & data): data_{data} {}
+
+        uint32_t tryWrite(uint8_t const * buffer, uint32_t bufferSize) override {
+            data_.insert(data_.end(), buffer, buffer + bufferSize);
+            return bufferSize;
+        }
+
+    private:
+        std::vector<uint8_t> & data_;
+    };
+
+    /** Screen-like bitmap taller than a single strip with enough colors to exercise the encoder.
+     */
+    Bitmap testScreen(Coord w, Coord h) {
+        Bitmap bmp{w, h, Color::Representation::RGB565};
+        bmp.setTransparentColor(std::nullopt);
+        for (Coord x = 0; x < w; ++x)
+            for (Coord y = 0; y < h; ++y)
+                bmp.setPixel(x, y, Color::RGB(static_cast<uint8_t>(x * 7), static_cast<uint8_t>(y * 5), static_cast<uint8_t>((x ^ y) * 3)).toRGB565());
+        return bmp;
+    }
+
+    /** Emulates display::update() by sending the bitmap as display would receive it, in chunks of given size.
+     */
+    void renderFrame(ScreenCapture * capture, Bitmap const & bmp, display::RefreshDirection dir, uint32_t chunk) {
+        Coord w = bmp.width();
+        Coord h = bmp.height();
+        if (! capture->beginFrame(Rect::WH(w, h), dir))
+            return;
+        std::vector<Color::RGB565> frame;
+        if (dir == display::RefreshDirection::ColumnFirst) {
+            for (Coord x = w - 1; x >= 0; --x)
+                for (Coord y = 0; y < h; ++y)
+                    frame.push_back(bmp.getPixel(x, y));
+        } else {
+            for (Coord y = 0; y < h; ++y)
+                for (Coord x = 0; x < w; ++x)
+                    frame.push_back(bmp.getPixel(x, y));
+        }
+        for (uint32_t i = 0; i < frame.size(); i += chunk)
+            capture->capture(frame.data() + i, std::min(chunk, static_cast<uint32_t>(frame.size() - i)));
+    }
+
+    /** Captures the bitmap rendered repeatedly as display frames, returning the number of frames it took, or 0 if the capture failed.
+     */
+    uint32_t captureFrames(Bitmap const & bmp, display::RefreshDirection dir, uint32_t chunk, std::vector<uint8_t> & result) {
+        display::enable(Rect::WH(bmp.width(), bmp.height()), dir);
+        bool done = false;
+        if (! ScreenCapture::start(unique_ptr<WriteStream>{new VectorStream{result}}, [&done](bool success) { done = success; }))
+            return 0;
+        uint32_t frames = 0;
+        while (ScreenCapture::active() != nullptr) {
+            renderFrame(ScreenCapture::active(), bmp, dir, chunk);
+            Task::runAll();
+            ++frames;
+        }
+        return done ? frames : 0;
+    }
+
+    std::vector<uint8_t> encode(Bitmap const & bmp) {
+        std::vector<uint8_t> result;
+        VectorStream s{result};
+        QOIEncoder::encode(bmp, s);
+        return result;
+    }
+}
+
+TEST(screenCapture, columnFirstMatchesEncoder) {
+    Bitmap bmp = testScreen(20, 40);
+    std::vector<uint8_t> captured;
+    // chunks not aligned to columns, one strip per frame
+    EXPECT(captureFrames(bmp, display::RefreshDirection::ColumnFirst, 17, captured) == 3);
+    EXPECT(captured == encode(bmp));
+}
+
+TEST(screenCapture, rowFirstMatchesEncoder) {
+    Bitmap bmp = testScreen(20, 33);
+    std::vector<uint8_t> captured;
+    EXPECT(captureFrames(bmp, display::RefreshDirection::RowFirst, 7, captured) == 3);
+    EXPECT(captured == encode(bmp));
+}
+
+TEST(screenCapture, skipsOtherDisplayArea) {
+    Bitmap bmp = testScreen(20, 40);
+    Bitmap other = testScreen(20, 10);
+    std::vector<uint8_t> captured;
+    display::enable(Rect::WH(20, 40), display::RefreshDirection::ColumnFirst);
+    bool done = false;
+    EXPECT(ScreenCapture::start(unique_ptr<WriteStream>{new VectorStream{captured}}, [&done](bool success) { done = success; }));
+    EXPECT(ScreenCapture::holdsFrame());
+    renderFrame(ScreenCapture::active(), bmp, display::RefreshDirection::ColumnFirst, 40);
+    Task::runAll();
+    // frame rendered to another display area is not captured
+    display::enable(Rect::WH(20, 10), display::RefreshDirection::ColumnFirst);
+    EXPECT(! ScreenCapture::active()->beginFrame(Rect::WH(20, 10), display::RefreshDirection::ColumnFirst));
+    Task::runAll();
+    display::enable(Rect::WH(20, 40), display::RefreshDirection::ColumnFirst);
+    while (ScreenCapture::active() != nullptr) {
+        renderFrame(ScreenCapture::active(), bmp, display::RefreshDirection::ColumnFirst, 40);
+        Task::runAll();
+    }
+    EXPECT(done);
+    EXPECT(! ScreenCapture::holdsFrame());
+    EXPECT(captured == encode(bmp));
+    // the capture fails if the original area does not come back
+    captured.clear();
+    EXPECT(ScreenCapture::start(unique_ptr<WriteStream>{new VectorStream{captured}}, [&done](bool success) { done = success; }));
+    for (uint32_t i = 0; i <= ScreenCapture::MAX_SKIPPED_FRAMES && ScreenCapture::active() != nullptr; ++i) {
+        renderFrame(ScreenCapture::active(), other, display::RefreshDirection::ColumnFirst, 40);
+        Task::runAll();
+    }
+    EXPECT(ScreenCapture::active() == nullptr);
+    EXPECT(! done);
+}
+
+TEST(screenCapture, singleActiveCapture) {
+    std::vector<uint8_t> data;
+    EXPECT(ScreenCapture::start(unique_ptr<WriteStream>{new VectorStream{data}}));
+    EXPECT(! ScreenCapture::start(unique_ptr<WriteStream>{new VectorStream{data}}));
+    delete ScreenCapture::active();
+    EXPECT(ScreenCapture::active() == nullptr);
+}
+
+TEST(screenCapture, decodes) {
+    Bitmap bmp = testScreen(10, 20);
+    std::vector<uint8_t> captured;
+    EXPECT(captureFrames(bmp, display::RefreshDirection::ColumnFirst, 20, captured) == 2);
+    uint8_t * data = new uint8_t[captured.size()];
+    memcpy(data, captured.data(), captured.size());
+    QOIImageDecoder dec{ImageSource{immutable_ptr<uint8_t>{data, static_cast<uint32_t>(captured.size())}}};
+    Bitmap result = dec.decode();
+    for (Coord x = 0; x < 10; ++x)
+        for (Coord y = 0; y < 20; ++y)
+            EXPECT(result.getPixel(x, y) == bmp.getPixel(x, y));
+}
@@ -0,0 +1,108 @@
+#include <platform/tests.h>
+
+#include <rckid/graphics/tile_grid.h>
+
+using namespace rckid;
+
+namespace {
+
+    Color::RGB565 palette[32];
+
+    /** Renders all columns of the grid into a column-first buffer so that two grids can be compared.
+     */
+    std::vector<Color::RGB565> render(TileGrid & g) {
+        std::vector<Color::RGB565> result(g.width() * g.height());
+        for (Coord x = 0; x < g.width(); ++x)
+            g.renderColumn(x, 0, result.data() + x * g.height(), g.height());
+        return result;
+    }
+}
+
+TEST(tileGrid, scroll) {
+    for (uint32_t i = 0; i < 32; ++i)
+        palette[i] = Color::RGB565{static_cast<uint16_t>(i * 100)};
+    TileGrid g{4, 3, palette};
+    g.clear();
+    g.text(0, 0) << "ab\ncd\nef\ngh";
+    EXPECT(g.scrollOffset() == 1);
+    EXPECT(g.at(0, 0).tileAsChar() == 'c');
+    EXPECT(g.at(1, 1).tileAsChar() == 'f');
+    EXPECT(g.at(0, 2).tileAsChar() == 'g');
+    EXPECT(g.at(2, 2).tileAsChar() == ' ');
+    // the scrolled grid renders the same as a grid with the same contents written directly
+    TileGrid expected{4, 3, palette};
+    expected.clear();
+    expected.text(0, 0) << "cd\nef\ngh";
+    EXPECT(expected.scrollOffset() == 0);
+    EXPECT(render(g) == render(expected));
+    // rendering from a row in the middle of the grid wraps around the ring buffer
+    Color::RGB565 a[24];
+    Color::RGB565 b[24];
+    g.renderColumn(3, 20, a, 24);
+    expected.renderColumn(3, 20, b, 24);
+    EXPECT(memcmp(a, b, sizeof(a)) == 0);
+    g.text(0, 2) << "\n\n\nij";
+    EXPECT(g.scrollOffset() == 1);
+    EXPECT(g.at(0, 2).tileAsChar() == 'i');
+}
+
+TEST(tileGrid, damage) {
+    TileGrid g{10, 4, palette};
+    EXPECT(g.damage().width() == g.width());
+    EXPECT(g.damage().height() == g.height());
+    g.clearDamage();
+    EXPECT(g.damage().empty());
+    g.appendChar(Point{3, 1}, 'x');
+    Rect d = g.damage();
+    EXPECT(d.left() == 24 && d.top() == 16 && d.width() == 8 && d.height() == 16);
+    EXPECT(g.damaged(3, 1));
+    EXPECT(! g.damaged(4, 1));
+    EXPECT(g.columnDamaged(3));
+    EXPECT(! g.columnDamaged(2));
+    g.appendChar(Point{6, 2}, 'y');
+    d = g.damage();
+    EXPECT(d.left() == 24 && d.top() == 16 && d.width() == 32 && d.height() == 32);
+    // reading the tiles does not damage them
+    g.clearDamage();
+    TileGrid const & cg = g;
+    EXPECT(cg.at(3, 1).tileAsChar() == 'x');
+    EXPECT(g.damage().empty());
+    // unchanged icons do not damage the grid
+    EXPECT(g.setTileIcon(0, 0, TileIcon::wifi()));
+    EXPECT(! g.damage().empty());
+    g.clearDamage();
+    EXPECT(! g.setTileIcon(0, 0, TileIcon::wifi()));
+    EXPECT(g.damage().empty());
+    // writing the same tile does not damage it
+    g.appendChar(Point{3, 1}, 'x');
+    EXPECT(g.damage().empty());
+    // neither does modifying the tile directly, unless marked
+    g.at(5, 3) = 'z';
+    EXPECT(g.damage().empty());
+    g.markDamaged(5, 3);
+    EXPECT(g.damaged(5, 3));
+}
+
+TEST(tileGrid, scrollDamage) {
+    TileGrid g{6, 4, palette};
+    g.clear();
+    g.text(0, 0) << "ab\nab\n\ncd";
+    g.clearDamage();
+    g.newline();
+    // rows 0 and 1 had the same contents, row 1 gets the empty row 2 and row 2 gets row 3, the new bottom row is cleared
+    EXPECT(! g.damaged(0, 0) && ! g.damaged(1, 0));
+    EXPECT(g.damaged(0, 1) && g.damaged(1, 1));
+    EXPECT(g.damaged(0, 2) && g.damaged(1, 2));
+    EXPECT(g.damaged(0, 3) && g.damaged(1, 3));
+    // the trailing spaces are the same in all rows, including the cleared bottom one
+    for (Coord y = 0; y < 4; ++y)
+        EXPECT(! g.damaged(4, y));
+    EXPECT(g.at(0, 2).tileAsChar() == 'c');
+    // the damage stays in screen coordinates after the scroll
+    g.clearDamage();
+    g.appendChar(Point{5, 0}, 'x');
+    EXPECT(g.damaged(5, 0));
+    EXPECT(! g.damaged(5, 3));
+    Rect d = g.damage();
+    EXPECT(d.left() == 40 && d.top() == 0 && d.width() == 8 && d.height() == 16);
+}
@@ -0,0 +1,137 @@
+#include <platform/tests.h>
+
+#include <rckid/graphics/bitmap.h>
+#include <rckid/graphics/transform.h>
+
+using namespace rckid;
+
+namespace {
+
+    /** 4x4 bitmap where each pixel has raw value x * 4 + y + 1, with the transparency disabled.
+     */
+    Bitmap testBitmap(Color::Representation rep = Color::Representation::RGB565) {
+        Bitmap bmp{4, 4, rep};
+        for (Coord x = 0; x < 4; ++x)
+            for (Coord y = 0; y < 4; ++y)
+                bmp.setPixel(x, y, static_cast<uint16_t>(x * 4 + y + 1));
+        bmp.setTransparentColor(std::nullopt);
+        return bmp;
+    }
+
+    uint16_t expected(Coord x, Coord y) { return static_cast<uint16_t>(x * 4 + y + 1); }
+}
+
+TEST(transform, identityAndInverse) {
+    Transform t = Transform::Translate(3, -2) * Transform::Scale(2);
+    EXPECT(t.map(Point{1, 1}).x == 5);
+    EXPECT(t.map(Point{1, 1}).y == 0);
+    Transform i = t.inverse();
+    EXPECT(i.map(Point{5, 0}).x == 1);
+    EXPECT(i.map(Point{5, 0}).y == 1);
+    EXPECT((t * i).isIdentity());
+    Transform r = Transform::Rotate(90);
+    EXPECT(r.map(Point{1, 0}).x == 0);
+    EXPECT(r.map(Point{1, 0}).y == 1);
+    EXPECT(r.inverse().map(Point{0, 1}).x == 1);
+}
+
+TEST(transform, renderTranslated) {
+    Bitmap bmp = testBitmap();
+    Transform inv = Transform::Translate(1, 1).inverse();
+    Color::RGB565 buffer[6];
+    for (Coord x = 0; x < 6; ++x) {
+        for (Coord y = 0; y < 6; ++y)
+            buffer[y] = 0;
+        bmp.renderColumn(x, 0, buffer, 6, inv);
+        for (Coord y = 0; y < 6; ++y) {
+            if (x >= 1 && x < 5 && y >= 1 && y < 5)
+                EXPECT(buffer[y] == expected(x - 1, y - 1));
+            else
+                EXPECT(buffer[y] == 0);
+        }
+    }
+}
+
+TEST(transform, renderScaled) {
+    Bitmap bmp = testBitmap(Color::Representation::RGB332);
+    Transform inv = Transform::Scale(2).inverse();
+    Color::RGB565 buffer[8];
+    for (Coord x = 0; x < 8; ++x) {
+        bmp.renderColumn(x, 0, buffer, 8, inv);
+        for (Coord y = 0; y < 8; ++y)
+            EXPECT(buffer[y] == static_cast<uint16_t>(Color::RGB332{expected(x / 2, y / 2)}));
+    }
+    // downscale, pixel centers map to the odd source pixels
+    inv = Transform::Scale(0.5f).inverse();
+    bmp.renderColumn(1, 0, buffer, 2, inv);
+    EXPECT(buffer[0] == static_cast<uint16_t>(Color::RGB332{expected(3, 1)}));
+    EXPECT(buffer[1] == static_cast<uint16_t>(Color::RGB332{expected(3, 3)}));
+}
+
+TEST(transform, renderRotated) {
+    Bitmap bmp = testBitmap();
+    // rotate by 90 degrees around the bitmap center, so that (x, y) goes to (3 - y, x)
+    Transform inv = Transform::RotateScale(90, 1, Point{2, 2}).inverse();
+    Color::RGB565 buffer[4];
+    for (Coord x = 0; x < 4; ++x) {
+        bmp.renderColumn(x, 0, buffer, 4, inv);
+        for (Coord y = 0; y < 4; ++y)
+            EXPECT(buffer[y] == expected(y, 3 - x));
+    }
+}
+
+TEST(transform, renderTransparent) {
+    Bitmap bmp = testBitmap(Color::Representation::Index256);
+    immutable_ptr<Color::RGB565> palette{new Color::RGB565[256], 256};
+    for (uint32_t i = 0; i < 256; ++i)
+        const_cast<Color::RGB565 *>(palette.get())[i] = static_cast<uint16_t>(i + 100);
+    bmp.setPalette(std::move(palette));
+    bmp.setTransparentColor(expected(0, 0));
+    Transform inv = Transform::Scale(1, 2).inverse();
+    Color::RGB565 buffer[2] = { 0, 0 };
+    bmp.renderColumn(0, 0, buffer, 2, inv);
+    EXPECT(buffer[0] == 0);
+    EXPECT(buffer[1] == 0);
+    bmp.renderColumn(0, 2, buffer, 2, inv);
+    EXPECT(buffer[0] == expected(0, 1) + 100);
+    EXPECT(buffer[1] == expected(0, 1) + 100);
+}
+
+TEST(transform, renderBoxFilter) {
+    Bitmap bmp{2, 2, Color::Representation::RGB565};
+    bmp.setTransparentColor(std::nullopt);
+    bmp.setPixel(0, 0, Color::White().toRGB565());
+    bmp.setPixel(1, 0, Color::Black().toRGB565());
+    bmp.setPixel(0, 1, Color::White().toRGB565());
+    bmp.setPixel(1, 1, Color::Black().toRGB565());
+    Color::RGB565 buffer[2];
+    // identity maps to the source pixel centers and is exact
+    Transform inv = Transform::Identity();
+    bmp.renderColumn(0, 0, buffer, 2, inv, Filter::Box);
+    EXPECT(buffer[0] == Color::White().toRGB565() && buffer[1] == Color::White().toRGB565());
+    bmp.renderColumn(1, 0, buffer, 2, inv, Filter::Box);
+    EXPECT(buffer[0] == Color::Black().toRGB565() && buffer[1] == Color::Black().toRGB565());
+    // when upscaled 2x, the second column maps between the source columns
+    inv = Transform::Scale(0.5f);
+    bmp.renderColumn(1, 0, buffer, 2, inv, Filter::Box);
+    uint16_t gray = buffer[0];
+    EXPECT(gray != Color::White().toRGB565());
+    EXPECT(gray != Color::Black().toRGB565());
+    EXPECT(buffer[1] == gray);
+    // while the edges are clamped
+    bmp.renderColumn(0, 0, buffer, 2, inv, Filter::Box);
+    EXPECT(buffer[0] == Color::White().toRGB565());
+    bmp.renderColumn(3, 0, buffer, 2, inv, Filter::Box);
+    EXPECT(buffer[0] == Color::Black().toRGB565());
+}
+
+TEST(transform, renderExtremeDownscale) {
+    // the source position of the last column is far beyond the 16.16 fixed point range
+    Bitmap bmp = testBitmap();
+    Transform inv = Transform::Scale(1.0f / 1000).inverse();
+    Color::RGB565 buffer[2] = { 0, 0 };
+    bmp.renderColumn(319, 0, buffer, 2, inv);
+    EXPECT(buffer[0] == 0 && buffer[1] == 0);
+    bmp.renderColumn(319, 0, buffer, 2, inv, Filter::Box);
+    EXPECT(buffer[0] == 0 && buffer[1] == 0);
+}
@@ -5,6 +5,23 @@
 namespace {
     uint8_t const foo[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
 
+    /** Stream over foo that returns at most 3 bytes per read.
+     */
+    class ChunkedStream : public rckid::ReadStream {
+    public:
+        uint32_t read(uint8_t * buffer, uint32_t bufferSize) override {
+            uint32_t n = std::min(std::min(bufferSize, 3u), static_cast<uint32_t>(sizeof(foo)) - pos_);
+            memcpy(buffer, foo + pos_, n);
+            pos_ += n;
+            return n;
+        }
+
+        bool eof() const override { return pos_ == sizeof(foo); }
+
+    private:
+        uint32_t pos_ = 0;
+    };
+
 } // namespace rckid
 
 TEST(stream, memoryStream) {
@@ -39,4 +56,15 @@ TEST(stream, memoryStream) {
     EXPECT(s.readByte() == 33);
     EXPECT(g_.usedDelta() == 16);
     EXPECT(g_.reservedDelta() == 16);
-}   
+}
+
+TEST(stream, readFully) {
+    ChunkedStream s;
+    uint8_t buffer[16];
+    EXPECT(s.readFully(buffer, 8) == 8);
+    EXPECT(memcmp(buffer, foo, 8) == 0);
+    // stops at the end of the stream
+    EXPECT(s.readFully(buffer, 8) == 2);
+    EXPECT(buffer[0] == 9 && buffer[1] == 10);
+    EXPECT(s.readFully(buffer, 8) == 0);
+}
@@ -160,3 +160,44 @@ TEST(string, builder) {
     EXPECT(s == "foo 42");
 }
 
+
+TEST(string, decodeUTF8) {
+    using namespace rckid;
+    // "Až€😀" followed by a truncated sequence
+    char const * str = "A\xc5\xbe\xe2\x82\xac\xf0\x9f\x98\x80\xc5";
+    EXPECT(decodeUTF8(str) == 'A');
+    EXPECT(decodeUTF8(str) == 0x17e);
+    EXPECT(decodeUTF8(str) == 0x20ac);
+    EXPECT(decodeUTF8(str) == 0x1f600);
+    EXPECT(decodeUTF8(str) == UTF8_REPLACEMENT_CHAR);
+    EXPECT(*str == 0);
+    char const * text = "a\xc5\xbe" "b";
+    EXPECT(prevUTF8Offset(text, 4) == 3);
+    EXPECT(prevUTF8Offset(text, 3) == 1);
+    EXPECT(prevUTF8Offset(text, 1) == 0);
+}
+
+TEST(string, utf8Decoder) {
+    using namespace rckid;
+    UTF8Decoder d;
+    uint32_t cp = 0;
+    EXPECT(d.decode('x', cp) && cp == 'x');
+    EXPECT(! d.decode('\xe2', cp));
+    EXPECT(! d.decode('\x82', cp));
+    EXPECT(d.decode('\xac', cp) && cp == 0x20ac);
+    // interrupted sequence is dropped
+    EXPECT(! d.decode('\xc5', cp));
+    EXPECT(d.decode('y', cp) && cp == 'y');
+    EXPECT(d.decode('\xff', cp) && cp == UTF8_REPLACEMENT_CHAR);
+}
+
+TEST(string, isWordSeparator) {
+    using namespace rckid;
+    EXPECT(String::isWordSeparator(' '));
+    EXPECT(String::isWordSeparator('\r'));
+    EXPECT(! String::isWordSeparator('a'));
+    EXPECT(! String::isWordSeparator('_'));
+    // non-ASCII letters, even those whose lowest byte is a separator (0x10d is 'č')
+    EXPECT(! String::isWordSeparator(0x10d));
+    EXPECT(! String::isWordSeparator('\xc4'));
+}
@@ -0,0 +1,99 @@
+#include <platform/tests.h>
+#include <rckid/ui/root_widget.h>
+#include <rckid/ui/carousel.h>
+#include <rckid/graphics/qoi.h>
+
+using namespace rckid;
+using namespace rckid::ui;
+
+namespace {
+
+    /** Creates QOI image in memory, so that its decoding can be spread over multiple ticks.
+     */
+    ImageSource qoiIcon(Coord w, Coord h, Color c) {
+        Bitmap bmp{w, h, Color::Representation::RGB565};
+        for (Coord x = 0; x < w; ++x)
+            for (Coord y = 0; y < h; ++y)
+                bmp.setPixel(x, y, c.toRGB565());
+        MemoryStream s{MemoryStream::withCapacity(1024)};
+        QOIEncoder::encode(bmp, s);
+        uint32_t size = s.size();
+        uint8_t * data = new uint8_t[size];
+        s.seek(0);
+        s.read(data, size);
+        return ImageSource{immutable_ptr<uint8_t>{data, size}};
+    }
+
+    Menu iconMenu() {
+        Menu m;
+        m << MenuItem{"red", qoiIcon(4, 16, Color::Red()), [](){}}
+          << MenuItem{"green", qoiIcon(4, 16, Color::Green()), [](){}}
+          << MenuItem{"blue", qoiIcon(4, 16, Color::Blue()), [](){}};
+        return m;
+    }
+}
+
+TEST(carousel, prefetch) {
+    Menu m = iconMenu();
+    CarouselPrefetcher p;
+    p.setRowsPerTick(8);
+    p.prefetch(m, 1, 2);
+    EXPECT(! p.ready(1));
+    EXPECT(! p.ready(2));
+    // the first item is decoded first, 8 rows at a time
+    Task::runAll();
+    EXPECT(! p.ready(1));
+    Task::runAll();
+    EXPECT(p.ready(1));
+    EXPECT(! p.ready(2));
+    Task::runAll();
+    Task::runAll();
+    EXPECT(p.ready(2));
+    Bitmap green = p.take(m, 1);
+    EXPECT(green.height() == 16);
+    EXPECT(green.getPixel(2, 10) == Color::Green().toRGB565());
+    EXPECT(! p.ready(1));
+}
+
+TEST(carousel, prefetchSame) {
+    // in a two item menu both neighbors are the same item, which is decoded only once
+    Menu m = iconMenu();
+    CarouselPrefetcher p;
+    p.setRowsPerTick(8);
+    p.prefetch(m, 1, 1);
+    Task::runAll();
+    Task::runAll();
+    EXPECT(p.ready(1));
+    Bitmap green = p.take(m, 1);
+    EXPECT(green.getPixel(2, 10) == Color::Green().toRGB565());
+    // no other copy of the icon is being decoded
+    Task::runAll();
+    Task::runAll();
+    EXPECT(! p.ready(1));
+}
+
+TEST(carousel, prefetchPartial) {
+    Menu m = iconMenu();
+    CarouselPrefetcher p;
+    p.setRowsPerTick(4);
+    p.prefetch(m, 2, 0);
+    Task::runAll();
+    // partially decoded icon is finished when taken, not prefetched icons are decoded directly
+    Bitmap blue = p.take(m, 2);
+    EXPECT(blue.getPixel(3, 15) == Color::Blue().toRGB565());
+    Bitmap green = p.take(m, 1);
+    EXPECT(green.getPixel(0, 0) == Color::Green().toRGB565());
+    // moving keeps the already prefetched items
+    p.prefetch(m, 1, 2);
+    Task::runAll();
+    Task::runAll();
+    Task::runAll();
+    Task::runAll();
+    EXPECT(p.ready(1));
+    p.prefetch(m, 0, 1);
+    EXPECT(p.ready(1));
+    EXPECT(! p.ready(0));
+    EXPECT(! p.ready(2));
+    p.reset();
+    EXPECT(! p.ready(1));
+}
@@ -0,0 +1,64 @@
+#include <platform/tests.h>
+#include <rckid/ui/header.h>
+
+using namespace rckid;
+using namespace rckid::ui;
+
+namespace {
+
+    /** Renders the header over a patterned background, either through the cache, or directly from its tiles.
+     */
+    std::vector<Color::RGB565> render(Header * h, bool fromTiles) {
+        std::vector<Color::RGB565> result(h->width() * h->height());
+        for (uint32_t i = 0; i < result.size(); ++i)
+            result[i] = Color::RGB565{static_cast<uint16_t>(i * 37)};
+        for (Coord x = 0; x < h->width(); ++x) {
+            if (fromTiles)
+                h->contents().renderColumn(x, 0, result.data() + x * h->height(), h->height());
+            else
+                h->renderColumn(x, 0, result.data() + x * h->height(), h->height());
+        }
+        return result;
+    }
+}
+
+TEST(header, cachedRendering) {
+    Header * h = Header::instance();
+    h->invalidateCache();
+    EXPECT(! h->cached(0));
+    Widget::renderEssentials();
+    for (Coord i = 0; i < h->contents().width() / ui::TileGrid::tileWidth(); ++i)
+        EXPECT(h->cached(i));
+    EXPECT(render(h, false) == render(h, true));
+    // the cache is rendered from the tiles, partial columns must match as well
+    Color::RGB565 a[8] = {};
+    Color::RGB565 b[8] = {};
+    h->renderColumn(h->width() - 3, 5, a, 8);
+    h->contents().renderColumn(h->width() - 3, 5, b, 8);
+    EXPECT(memcmp(a, b, sizeof(a)) == 0);
+}
+
+TEST(header, invalidatedOnlyOnChange) {
+    Header * h = Header::instance();
+    Widget::renderEssentials();
+    EXPECT(h->cached(10));
+    // updating the header with the same values keeps the columns cached (column 10 is always empty, the clock and icons may change with time)
+    Header::update();
+    EXPECT(h->cached(10));
+    // changed tiles are damaged, which invalidates their cached columns
+    rckid::TileGrid::TileInfo t = h->contents().at(20, 0);
+    t = 'x';
+    h->contents().set(20, 0, t);
+    EXPECT(! h->cached(20));
+    EXPECT(h->cached(19) && h->cached(21));
+    Widget::renderEssentials();
+    EXPECT(h->cached(20));
+    EXPECT(render(h, false) == render(h, true));
+    // changes via the non-const at() must invalidate the cache explicitly
+    h->contents().at(20, 0) = 'y';
+    h->invalidateCache();
+    EXPECT(! h->cached(20));
+    Widget::renderEssentials();
+    EXPECT(h->cached(20));
+    EXPECT(render(h, false) == render(h, true));
+}
@@ -0,0 +1,128 @@
+#include <platform/tests.h>
+#include <rckid/ui/layout.h>
+
+using namespace rckid;
+using namespace rckid::ui;
+
+namespace {
+
+    /** Widget of fixed size that counts how many times it was resized.
+     */
+    class Box : public Widget {
+    public:
+        Box(Coord w, Coord h, uint32_t * changes = nullptr): w_{w}, h_{h}, changes_{changes} {}
+
+        Point measure() const override { return Point{w_, h_}; }
+
+    protected:
+        void onChange() override {
+            if (changes_ != nullptr)
+                ++(*changes_);
+        }
+
+    private:
+        Coord w_;
+        Coord h_;
+        uint32_t * changes_;
+    };
+
+    /** Plain widget that can be rendered by the tests.
+     */
+    class Container : public Widget {
+    public:
+        using Widget::onRender;
+    };
+}
+
+TEST(layout, column) {
+    Stack s;
+    s.setRect(Rect::WH(100, 100));
+    Widget * a = s.addChild(new Box{20, 10});
+    Widget * b = s.addChild(new Box{40, 20});
+    with(&s)
+        << SetSpacing(5)
+        << SetPadding(2);
+    s.setHAlign(HAlign::Left);
+    s.setVAlign(VAlign::Top);
+    EXPECT(s.layoutDirty());
+    s.arrange();
+    EXPECT(! s.layoutDirty());
+    EXPECT(a->rect() == Rect::XYWH(2, 2, 20, 10));
+    EXPECT(b->rect() == Rect::XYWH(2, 17, 40, 20));
+    EXPECT(s.measure().x == 44 && s.measure().y == 39);
+    // centered column, each child centered horizontally, the whole column vertically
+    s.setHAlign(HAlign::Center);
+    s.setVAlign(VAlign::Center);
+    s.arrange();
+    EXPECT(a->rect() == Rect::XYWH(40, 32, 20, 10));
+    EXPECT(b->rect() == Rect::XYWH(30, 47, 40, 20));
+    s.setHAlign(HAlign::Right);
+    s.setVAlign(VAlign::Bottom);
+    s.arrange();
+    EXPECT(a->rect() == Rect::XYWH(78, 63, 20, 10));
+    EXPECT(b->rect() == Rect::XYWH(58, 78, 40, 20));
+}
+
+TEST(layout, nestedRow) {
+    Stack s;
+    s.setRect(Rect::WH(100, 100));
+    s.setVAlign(VAlign::Top);
+    Widget * a = s.addChild(new Box{20, 10});
+    Stack * row = s.addChild(new Stack{Stack::Orientation::Row}) << SetSpacing(4);
+    Widget * b = row->addChild(new Box{10, 6});
+    Widget * c = row->addChild(new Box{12, 10});
+    s.arrange();
+    EXPECT(row->rect() == Rect::XYWH(37, 10, 26, 10));
+    EXPECT(row->layoutDirty());
+    row->arrange();
+    EXPECT(b->rect() == Rect::XYWH(0, 2, 10, 6));
+    EXPECT(c->rect() == Rect::XYWH(14, 0, 12, 10));
+    // hidden children are skipped and invalidate the layout
+    s.arrange();
+    row->arrange();
+    b->setVisibility(false);
+    EXPECT(row->layoutDirty());
+    EXPECT(s.layoutDirty());
+    s.arrange();
+    row->arrange();
+    EXPECT(row->rect() == Rect::XYWH(44, 10, 12, 10));
+    EXPECT(c->rect() == Rect::XYWH(0, 0, 12, 10));
+    EXPECT(a->rect() == Rect::XYWH(40, 0, 20, 10));
+}
+
+TEST(layout, arrangeOnlyWhenChanged) {
+    uint32_t changes = 0;
+    Stack s;
+    s.setRect(Rect::WH(100, 100));
+    s.addChild(new Box{20, 10, &changes});
+    s.arrange();
+    EXPECT(changes == 1);
+    // arranging again does not touch the children whose rectangles did not change
+    s.arrange();
+    EXPECT(changes == 1);
+    // moving the stack does not require new arrangement, resizing it does
+    s.setRect(Rect::XYWH(10, 10, 100, 100));
+    EXPECT(! s.layoutDirty());
+    s.setRect(Rect::XYWH(10, 10, 50, 100));
+    EXPECT(s.layoutDirty());
+    s.arrange();
+    EXPECT(changes == 2);
+}
+
+TEST(layout, renderClearsDirty) {
+    Container root;
+    root.setRect(Rect::WH(100, 100));
+    Stack * s = root.addChild(new Stack{});
+    s->setRect(Rect::WH(100, 100));
+    Widget * a = s->addChild(new Box{20, 10});
+    EXPECT(root.layoutDirty() && s->layoutDirty());
+    root.onRender();
+    EXPECT(! root.layoutDirty());
+    EXPECT(! s->layoutDirty());
+    EXPECT(a->rect().w == 20);
+    // invalidating the layout again marks the whole chain
+    a->setVisibility(false);
+    EXPECT(root.layoutDirty() && s->layoutDirty());
+    root.onRender();
+    EXPECT(! root.layoutDirty() && ! s->layoutDirty());
+}
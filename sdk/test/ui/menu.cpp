@@ -0,0 +1,82 @@
+#include <platform/tests.h>
+#include <rckid/ui/menu.h>
+
+using namespace rckid;
+using namespace rckid::ui;
+
+namespace {
+
+    /** Source that creates numbered items and counts how many were created.
+     */
+    class NumberSource : public Menu::Source {
+    public:
+        NumberSource(uint32_t size, uint32_t & created): size_{size}, created_{created} {}
+
+        uint32_t size() override { return size_; }
+
+        MenuItem itemAt(uint32_t index) override {
+            ++created_;
+            return MenuItem{STR(index), [](){}}.withPayload(index);
+        }
+
+    private:
+        uint32_t size_;
+        uint32_t & created_;
+    };
+}
+
+TEST(menu, virtualItems) {
+    uint32_t created = 0;
+    Menu m{unique_ptr<Menu::Source>{new NumberSource{1000, created}}};
+    EXPECT(m.isVirtual());
+    EXPECT(m.size() == 1000);
+    EXPECT(created == 0);
+    EXPECT(m[0].payload == 0);
+    EXPECT(m[999].text == "999");
+    EXPECT(m[500].payload == 500);
+    EXPECT(created == 3);
+    // cached items are not created again
+    EXPECT(m[999].payload == 999);
+    EXPECT(m[0].payload == 0);
+    EXPECT(created == 3);
+}
+
+TEST(menu, virtualCacheEviction) {
+    uint32_t created = 0;
+    Menu m{unique_ptr<Menu::Source>{new NumberSource{100, created}}};
+    for (uint32_t i = 0; i < Menu::CACHE_SIZE; ++i)
+        m[i];
+    EXPECT(created == Menu::CACHE_SIZE);
+    // use the first item so that the second one becomes least recently used and gets replaced
+    m[0];
+    m[50];
+    EXPECT(created == Menu::CACHE_SIZE + 1);
+    m[0];
+    EXPECT(created == Menu::CACHE_SIZE + 1);
+    m[1];
+    EXPECT(created == Menu::CACHE_SIZE + 2);
+}
+
+TEST(menu, staticItems) {
+    Menu m;
+    EXPECT(! m.isVirtual());
+    EXPECT(m.empty());
+    m << MenuItem{"a", [](){}} << MenuItem{"c", [](){}};
+    m.insert(m.begin() + 1, MenuItem{"b", [](){}});
+    EXPECT(m.size() == 3);
+    EXPECT(m[1].text == "b");
+    m.erase(m.begin());
+    EXPECT(m.size() == 2);
+    EXPECT(m[0].text == "b");
+    EXPECT(m[1].text == "c");
+}
+
+TEST(menu, itemMoveAssign) {
+    MenuItem a{"action", [](){}};
+    a = MenuItem::Generator("generator", []() { return std::make_unique<Menu>(); });
+    EXPECT(a.isGenerator());
+    EXPECT(a.text == "generator");
+    EXPECT(a.generator()()->empty());
+    a = MenuItem{"action", [](){}};
+    EXPECT(a.isAction());
+}
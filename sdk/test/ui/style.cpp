@@ -0,0 +1,93 @@
+#include <platform/tests.h>
+#include <rckid/ui/panel.h>
+#include <rckid/ui/label.h>
+#include <rckid/ui/header.h>
+
+using namespace rckid;
+using namespace rckid::ui;
+
+namespace {
+
+    Style themeFrom(char const * ini) {
+        MemoryStream s{MemoryStream::copyOf(reinterpret_cast<uint8_t const *>(ini), strlen(ini))};
+        ini::Reader reader{s};
+        Style result;
+        result.load(reader);
+        return result;
+    }
+}
+
+TEST(style, colorTables) {
+    Style s;
+    uint32_t v = s.version();
+    s.setAccentBg(Color::RGB(255, 0, 0));
+    EXPECT(s.version() != v);
+    EXPECT(s.colors().accentBg == Color::RGB(255, 0, 0).toRGB565());
+    s.setDefaultFg(Color::RGB(0, 0, 255));
+    EXPECT(s.colors().defaultFg == Color::RGB(0, 0, 255).toRGB565());
+    EXPECT(s.colors().defaultText[0] == Color::Black().toRGB565());
+    EXPECT(s.colors().defaultText[3] == Color::RGB(0, 0, 255).toRGB565());
+    // icon colors follow the header foreground
+    s.setHeaderRed(Color::RGB(255, 128, 0));
+    EXPECT(s.colors().header[Header::PaletteOffsetRed + 1] == s.colors().header[15]);
+    EXPECT(s.colors().header[Header::PaletteOffsetRed + 2] == Color::RGB(255, 128, 0).toRGB565());
+}
+
+TEST(style, loadTheme) {
+    Style s = themeFrom(
+        "[accent]\n"
+        "bg=#00ff00\n"
+        "[header]\n"
+        "fg=#ffff00\n"
+    );
+    EXPECT(s.accentBg() == Color::RGB(0, 255, 0));
+    EXPECT(s.colors().accentBg == Color::RGB(0, 255, 0).toRGB565());
+    EXPECT(s.colors().header[15] == Color::RGB(255, 255, 0).toRGB565());
+    // fields not in the theme keep their defaults
+    EXPECT(s.defaultFg() == Color::White());
+    s.setBackgroundImage(ImageSource{"bg.qoi"});
+    // themes without the background section keep the current background
+    char const * ini = "[default]\nfg=#ff0000\n";
+    MemoryStream theme{MemoryStream::copyOf(reinterpret_cast<uint8_t const *>(ini), strlen(ini))};
+    ini::Reader reader{theme};
+    s.load(reader);
+    EXPECT(s.backgroundImage().type() == ImageSource::Type::SD && strcmp(s.backgroundImage().path(), "bg.qoi") == 0);
+}
+
+TEST(style, headerFollowsDefaultFg) {
+    Style s;
+    s.setDefaultFg(Color::RGB(255, 0, 0));
+    EXPECT(s.headerFg() == Color::RGB(255, 0, 0));
+    EXPECT(s.colors().header[15] == Color::RGB(255, 0, 0).toRGB565());
+    Style t = themeFrom("[default]\nfg=#00ff00\n");
+    EXPECT(t.headerFg() == Color::RGB(0, 255, 0));
+    // once set, the header foreground no longer follows
+    t.setHeaderFg(Color::RGB(0, 0, 255));
+    t.setDefaultFg(Color::RGB(255, 0, 0));
+    EXPECT(t.headerFg() == Color::RGB(0, 0, 255));
+    // and neither does the header foreground loaded from a theme
+    Style u = themeFrom("[header]\nfg=#ffff00\n[default]\nfg=#00ff00\n");
+    EXPECT(u.headerFg() == Color::RGB(255, 255, 0));
+    u.setDefaultFg(Color::RGB(255, 0, 0));
+    EXPECT(u.headerFg() == Color::RGB(255, 255, 0));
+}
+
+TEST(style, applyStyleRecursive) {
+    Panel p;
+    Panel * child = p.addChild(new Panel{});
+    Panel * explicitChild = p.addChild(new Panel{});
+    explicitChild->setBg(Color::RGB(1, 2, 3));
+    Label * label = p.addChild(new Label{});
+    label->setFg(Color::RGB(4, 5, 6));
+    Style s = themeFrom("[accent]\nbg=#0000ff\n[default]\nfg=#ff0000\n");
+    p.applyStyleRecursive(s);
+    EXPECT(child->bg() == Color::RGB(0, 0, 255));
+    // explicitly set colors are kept
+    EXPECT(explicitChild->bg() == Color::RGB(1, 2, 3));
+    EXPECT(label->fg() == Color::RGB(4, 5, 6));
+    // the raw color is used for rendering
+    Color::RGB565 buffer[4];
+    child->setRect(Rect::WH(4, 4));
+    child->renderColumn(0, 0, buffer, 4);
+    EXPECT(buffer[3] == Color::RGB(0, 0, 255).toRGB565());
+}
@@ -0,0 +1,63 @@
+#include <platform/tests.h>
+#include <rckid/ui/tile_grid.h>
+
+using namespace rckid;
+
+namespace {
+
+    Color::RGB565 palette[256];
+
+    /** Tile grid widget that can be rendered outside of an app.
+     */
+    class Grid : public ui::TileGrid {
+    public:
+        Grid(): ui::TileGrid{6, 2, palette} {
+            setRect(Rect::WH(6 * tileWidth(), 2 * tileHeight()));
+        }
+
+        void render() { onRender(); }
+    };
+
+    /** Renders the widget over a patterned background, either through the cache, or directly from its tiles.
+     */
+    std::vector<Color::RGB565> render(Grid & g, bool fromTiles) {
+        std::vector<Color::RGB565> result(g.width() * g.height());
+        for (uint32_t i = 0; i < result.size(); ++i)
+            result[i] = Color::RGB565{static_cast<uint16_t>(i * 37)};
+        for (Coord x = 0; x < g.width(); ++x) {
+            if (fromTiles)
+                g.contents().renderColumn(x, 0, result.data() + x * g.height(), g.height());
+            else
+                g.renderColumn(x, 0, result.data() + x * g.height(), g.height());
+        }
+        return result;
+    }
+}
+
+TEST(uiTileGrid, cache) {
+    for (uint32_t i = 0; i < 256; ++i)
+        palette[i] = Color::RGB565{static_cast<uint16_t>(i * 100 + 1)};
+    Grid g;
+    g.contents().clear();
+    g.contents().text(0, 0) << "ab\ncd";
+    // without the cache, the tiles are rendered every time
+    g.render();
+    EXPECT(! g.cached(0));
+    EXPECT(render(g, false) == render(g, true));
+    g.enableCache();
+    g.render();
+    for (Coord i = 0; i < 6; ++i)
+        EXPECT(g.cached(i));
+    EXPECT(render(g, false) == render(g, true));
+    // only the changed tile column is redrawn, rendering clears the damage
+    g.contents().text(4, 1) << "x";
+    EXPECT(! g.cached(4));
+    EXPECT(g.cached(3) && g.cached(5));
+    g.render();
+    EXPECT(g.cached(4));
+    EXPECT(g.contents().damage().empty());
+    EXPECT(render(g, false) == render(g, true));
+    g.disableCache();
+    EXPECT(! g.cached(0));
+    EXPECT(render(g, false) == render(g, true));
+}
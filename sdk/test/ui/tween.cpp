@@ -0,0 +1,133 @@
+#include <platform/tests.h>
+#include <rckid/ui/tween.h>
+
+using namespace rckid;
+using namespace rckid::ui;
+
+TEST(tween, value) {
+    Coord x = 0;
+    uint32_t t = time::uptimeUs();
+    Tweens::Handle h = Tweens::start(Tween::Value(&x, 100, 200, 100).withEasing(Tween::Easing::Linear));
+    EXPECT(Tweens::active(h));
+    EXPECT(x == 100);
+    Tweens::updateAll(t + 50000);
+    EXPECT(x >= 148 && x <= 150);
+    Tweens::updateAll(t + 200000);
+    EXPECT(x == 200);
+    EXPECT(! Tweens::active(h));
+    EXPECT(Tweens::size() == 0);
+    // cancelling finished tween does nothing
+    Tweens::cancel(h);
+}
+
+TEST(tween, groups) {
+    // tweens with different easings are kept in their groups when others are added and removed
+    Coord v[20];
+    Tweens::Handle h[20];
+    uint32_t t = time::uptimeUs();
+    for (uint32_t i = 0; i < 20; ++i)
+        h[i] = Tweens::start(Tween::Value(v + i, 0, 1000, 100 + i * 10).withEasing(static_cast<Tween::Easing>(i % Tween::NUM_EASINGS)));
+    EXPECT(Tweens::size() == 20);
+    for (uint32_t i = 0; i < 20; i += 3)
+        Tweens::cancel(h[i]);
+    EXPECT(Tweens::size() == 13);
+    Tweens::updateAll(t + 50000);
+    for (uint32_t i = 0; i < 20; ++i) {
+        if (i % 3 == 0) {
+            EXPECT(v[i] == 0);
+            EXPECT(! Tweens::active(h[i]));
+            continue;
+        }
+        EXPECT(Tweens::active(h[i]));
+        // each tween is updated with its own easing
+        Coord linear = static_cast<Coord>(50 * 1000 / (100 + i * 10));
+        switch (static_cast<Tween::Easing>(i % Tween::NUM_EASINGS)) {
+            case Tween::Easing::Linear:
+                EXPECT(v[i] >= linear - 20 && v[i] <= linear);
+                break;
+            case Tween::Easing::In:
+                EXPECT(v[i] < linear - 20);
+                break;
+            case Tween::Easing::Out:
+                EXPECT(v[i] > linear);
+                break;
+            default:
+                EXPECT(v[i] > 0 && v[i] < 1000);
+                break;
+        }
+    }
+    // tweens finish at different times
+    Tweens::updateAll(t + 195000);
+    EXPECT(Tweens::size() == 7);
+    Tweens::updateAll(t + 300000);
+    EXPECT(Tweens::size() == 0);
+    for (uint32_t i = 0; i < 20; ++i) {
+        // in-out-in easing goes forth and back
+        if (i % 3 == 0 || static_cast<Tween::Easing>(i % Tween::NUM_EASINGS) == Tween::Easing::InOutIn)
+            EXPECT(v[i] == 0);
+        else
+            EXPECT(v[i] == 1000);
+    }
+}
+
+TEST(tween, chain) {
+    Coord x = 0;
+    uint32_t t = time::uptimeUs();
+    Tweens::Handle a = Tweens::start(Tween::Value(&x, 0, 10, 100).withEasing(Tween::Easing::Linear));
+    Tweens::Handle b = Tweens::then(a, Tween::Value(&x, 10, 0, 100).withEasing(Tween::Easing::Linear));
+    EXPECT(Tweens::size() == 2);
+    Tweens::updateAll(t + 99000);
+    EXPECT(x >= 9 && x <= 10);
+    Tweens::updateAll(t + 101000);
+    EXPECT(! Tweens::active(a));
+    EXPECT(Tweens::active(b));
+    EXPECT(x == 10);
+    Tweens::updateAll(t + 150000);
+    EXPECT(x >= 5 && x <= 6);
+    Tweens::updateAll(t + 250000);
+    EXPECT(x == 0);
+    EXPECT(Tweens::size() == 0);
+    // cancelling the first tween cancels the whole chain
+    a = Tweens::start(Tween::Value(&x, 0, 10, 100));
+    b = Tweens::then(a, Tween::Value(&x, 10, 20, 100));
+    Tweens::then(b, Tween::Value(&x, 20, 30, 100));
+    EXPECT(Tweens::size() == 3);
+    Tweens::cancel(a);
+    EXPECT(Tweens::size() == 0);
+    EXPECT(x == 0);
+}
+
+TEST(tween, widget) {
+    Widget w;
+    w.setRect(Rect::XYWH(0, 0, 10, 10));
+    Coord v = 0;
+    uint32_t t = time::uptimeUs();
+    Tweens::start(Tween::X(&w, 100, 0).withDuration(100));
+    Tweens::start(Tween::Value(&v, 0, 5, 200, &w).withDelay(50));
+    EXPECT(w.x() == 100);
+    EXPECT(! w.idle());
+    Tweens::updateAll(t + 150000);
+    EXPECT(w.x() == 0);
+    EXPECT(! w.idle());
+    Tweens::updateAll(t + 300000);
+    EXPECT(v == 5);
+    EXPECT(w.idle());
+    // cancelling widget's animations cancels its tweens too
+    Tweens::start(Tween::Y(&w, 50, 0).withRepeat());
+    Tweens::updateAll(t + 10000000);
+    EXPECT(! w.idle());
+    w.cancelAnimations();
+    EXPECT(w.idle());
+    EXPECT(Tweens::size() == 0);
+}
+
+TEST(tween, capacity) {
+    Coord v[Tweens::CAPACITY + 1];
+    for (uint32_t i = 0; i < Tweens::CAPACITY; ++i)
+        EXPECT(Tweens::start(Tween::Value(v + i, 0, 1, 100)) != Tweens::NONE);
+    // when full, the target is set to its final value
+    EXPECT(Tweens::start(Tween::Value(v + Tweens::CAPACITY, 0, 1, 100)) == Tweens::NONE);
+    EXPECT(v[Tweens::CAPACITY] == 1);
+    Tweens::updateAll(time::uptimeUs() + 1000000);
+    EXPECT(Tweens::size() == 0);
+}